@@ -17,8 +17,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
 #include <time.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "ttf.h"
 #include "test.h"
 
@@ -27,11 +29,26 @@
 // Local functions...
 //
 
+static const char *compare_cache(ttf_cache_t *a, ttf_cache_t *b);
 static void	error_cb(void *data, const char *message);
+static void	error_copy_cb(char *buffer, const char *message);
+static void	error_count_cb(int *count, const char *message);
 static char	*format_name(char *buffer, size_t bufsize, const char *family, ttf_style_t fstyle, ttf_weight_t fweight, ttf_stretch_t fstretch);
 static int	list_fonts(bool verbose);
+static void	outline_cb(size_t *count, const ttf_path_t *segment);
+static int	test_cache(void);
+static int	test_cff(const char *filename);
+static int	test_class_kerning(const char *filename, bool gpos);
 static int	test_find_font(ttf_cache_t *cache, const char *family, ttf_style_t fstyle, ttf_weight_t fweight, ttf_stretch_t fstretch);
+static int	test_fixed(const char *filename);
 static int	test_font(const char *filename, ttf_t *font);
+static int	test_hdmx(const char *filename);
+static int	test_kerning(const char *filename);
+static int	test_ligatures(const char *filename);
+static int	test_metrics(const char *filename);
+static int	test_render(const char *filename);
+static int	test_variation(const char *filename);
+static int	test_vertical(const char *filename, bool vorg);
 
 
 //
@@ -65,6 +82,19 @@ main(int  argc,				// I - Number of command-line arguments
     errors += test_font("testfiles/OpenSans-Bold.ttf", /*font*/NULL);
     errors += test_font("testfiles/OpenSans-Regular.ttf", /*font*/NULL);
     errors += test_font("testfiles/NotoSansJP-Regular.otf", /*font*/NULL);
+    errors += test_cache();
+    errors += test_cff("testfiles/OpenSans-CFF.otf");
+    errors += test_class_kerning("testfiles/OpenSans-KernClass.ttf", /*gpos*/false);
+    errors += test_class_kerning("testfiles/OpenSans-GPOS.ttf", /*gpos*/true);
+    errors += test_fixed("testfiles/OpenSans-Mono.ttf");
+    errors += test_hdmx("testfiles/OpenSans-Hdmx.ttf");
+    errors += test_kerning("testfiles/OpenSans-Kern.ttf");
+    errors += test_ligatures("testfiles/OpenSans-Ligatures.ttf");
+    errors += test_metrics("testfiles/OpenSans-Regular.ttf");
+    errors += test_render("testfiles/OpenSans-Regular.ttf");
+    errors += test_variation("testfiles/OpenSans-Variable.ttf");
+    errors += test_vertical("testfiles/OpenSans-Vertical.ttf", /*vorg*/false);
+    errors += test_vertical("testfiles/OpenSans-VORG.ttf", /*vorg*/true);
 
     errors += list_fonts(false);
   }
@@ -73,6 +103,66 @@ main(int  argc,				// I - Number of command-line arguments
 }
 
 
+//
+// 'compare_cache()' - Compare two font caches.
+//
+
+static const char *			// O - First difference or `NULL` if the same
+compare_cache(ttf_cache_t *a,		// I - First cache
+              ttf_cache_t *b)		// I - Second cache
+{
+  size_t	i, j,			// Looping vars
+		num_fonts,		// Number of fonts
+		num_a, num_b;		// Number of fonts containing a character
+  const ttf_coverage_t *acov,		// First coverage
+		*bcov;			// Second coverage
+  ttf_coverage_t *cov;			// Intersection of coverages
+  size_t	afonts[64],		// Fonts containing a character
+		bfonts[64];		// Fonts containing a character
+  static const int chars[] =		// Characters to look up
+  {
+    ' ', 'A', 'z', 0xE9, 0x2014, 0x3042, 0x1F600
+  };
+
+
+  if ((num_fonts = ttfCacheGetNumFonts(a)) != ttfCacheGetNumFonts(b))
+    return ("number of fonts");
+
+  for (i = 0; i < num_fonts; i ++)
+  {
+    if (strcmp(ttfCacheGetFilename(a, i), ttfCacheGetFilename(b, i)) || ttfCacheGetIndex(a, i) != ttfCacheGetIndex(b, i) || ttfCacheGetInstance(a, i) != ttfCacheGetInstance(b, i))
+      return ("filenames");
+
+    if (strcmp(ttfCacheGetFamily(a, i), ttfCacheGetFamily(b, i)) || ttfCacheGetStyle(a, i) != ttfCacheGetStyle(b, i) || ttfCacheGetWeight(a, i) != ttfCacheGetWeight(b, i) || ttfCacheGetStretch(a, i) != ttfCacheGetStretch(b, i))
+      return ("families");
+
+    acov = ttfCacheGetCoverage(a, i);
+    bcov = ttfCacheGetCoverage(b, i);
+
+    if (!acov || !bcov || ttfCoverageGetCount(acov) != ttfCoverageGetCount(bcov) || (cov = ttfCoverageCopy(acov)) == NULL)
+      return ("coverage");
+
+    ttfCoverageIntersect(cov, bcov);
+    j = ttfCoverageGetCount(cov);
+    ttfCoverageDelete(cov);
+
+    if (j != ttfCoverageGetCount(acov))
+      return ("coverage");
+  }
+
+  for (i = 0; i < (sizeof(chars) / sizeof(chars[0])); i ++)
+  {
+    num_a = ttfCacheGetCharFonts(a, chars[i], sizeof(afonts) / sizeof(afonts[0]), afonts);
+    num_b = ttfCacheGetCharFonts(b, chars[i], sizeof(bfonts) / sizeof(bfonts[0]), bfonts);
+
+    if (num_a != num_b || memcmp(afonts, bfonts, (num_a < 64 ? num_a : 64) * sizeof(size_t)))
+      return ("character fonts");
+  }
+
+  return (NULL);
+}
+
+
 //
 // 'error_cb()' - Error callback.
 //
@@ -85,6 +175,30 @@ error_cb(void       *data,		// I - User data (not used)
 }
 
 
+//
+// 'error_copy_cb()' - Error callback that saves the message.
+//
+
+static void
+error_copy_cb(char       *buffer,	// I - Message buffer (256 bytes)
+              const char *message)	// I - Message string
+{
+  snprintf(buffer, 256, "%s", message);
+}
+
+
+//
+// 'error_count_cb()' - Error callback that counts the messages.
+//
+
+static void
+error_count_cb(int        *count,	// I - Message count
+               const char *message)	// I - Message string (not used)
+{
+  (*count) ++;
+}
+
+
 //
 // 'format_name()' - Format a font name.
 //
@@ -239,401 +353,2220 @@ list_fonts(bool verbose)		// I - Be verbose?
     errors += test_find_font(cache, test_serif, TTF_STYLE_NORMAL, TTF_WEIGHT_700, TTF_STRETCH_UNSPEC);
   }
 
+  if (num_fonts > 0)
+  {
+    size_t	num_char_fonts;		// Number of fonts containing 'A'
+    ttf_t	*font;			// Font containing 'A'
+
+    testBegin("ttfCacheFindChar('A')");
+    if ((num_char_fonts = ttfCacheGetCharFonts(cache, 'A', 0, NULL)) > 0 && (font = ttfCacheFindChar(cache, 'A', TTF_STYLE_NORMAL, TTF_WEIGHT_400, TTF_STRETCH_NORMAL)) != NULL && ttfContainsChar(font, 'A'))
+    {
+      testEndMessage(true, "%s, %u fonts", ttfGetFamily(font), (unsigned)num_char_fonts);
+    }
+    else
+    {
+      testEndMessage(false, "%u fonts", (unsigned)num_char_fonts);
+      errors ++;
+    }
+  }
+
   return (errors);
 }
 
 
 //
-// 'test_find_font()' - Test finding a font.
+// 'outline_cb()' - Count glyph outline segments.
 //
 
-static int				// O - Number of errors
-test_find_font(ttf_cache_t   *cache,	// I - Font cache
-	       const char    *family,	// I - Font family
-	       ttf_style_t   fstyle,	// I - Font style
-	       ttf_weight_t  fweight,	// I - Font weight
-	       ttf_stretch_t fstretch)	// I - Font stretch
+static void
+outline_cb(size_t           *count,	// I - Segment count
+           const ttf_path_t *segment)	// I - Segment (not used)
 {
-  ttf_t	*font;				// Matching font
-  char	name[256];			// Font name
-
-
-  testBegin("ttfCacheFind(%s)", format_name(name, sizeof(name), family, fstyle, fweight, fstretch));
-  if ((font = ttfCacheFind(cache, family, fstyle, fweight, fstretch)) != NULL)
-  {
-    testEndMessage(true, "%s", format_name(name, sizeof(name), ttfGetFamily(font), ttfGetStyle(font), ttfGetWeight(font), ttfGetStretch(font)));
-
-    return (test_font(/*filename*/NULL, font));
-  }
-  else
-  {
-    testEnd(false);
-    return (1);
-  }
+  (*count) ++;
 }
 
 
 //
-// 'test_font()' - Test a font file.
+// 'test_cache()' - Test saving and loading the font cache.
+//
+// The cache is created in a temporary directory along with a ".fonts"
+// directory containing links to the Open Sans test fonts.
 //
 
 static int				// O - Number of errors
-test_font(const char *filename,		// I - Font filename or `NULL`
-          ttf_t      *font)		// I - Font or `NULL` to load
+test_cache(void)
 {
-  int		i,			// Looping var
-		errors = 0;		// Number of errors
-  struct stat	fileinfo;		// Font file information
-  FILE		*fp = NULL;		// File pointer
-  void		*data = NULL;		// Memory buffer for font file
-  const char	*value;			// Font (string) value
-  int		intvalue;		// Font (integer) value
-  float		realvalue;		// Font (real) value
-  char		psname[1024];		// Postscript font name
-  ttf_rect_t	bounds;			// Bounds
-  ttf_rect_t	extents;		// Extents
-  size_t	j,			// Looping var
-		num_adjs;		// Number of kerning adjustments
-  double	adjs[1024];		// Kerning adjustments
-  size_t	num_fonts;		// Number of fonts
-  ttf_style_t	style;			// Font style
-  ttf_weight_t	weight;			// Font weight
-  const int	*cmap;			// CMap table
-  size_t	num_cmap;		// Number of CMap entries
-  static const char * const stretches[] =
-  {					// Font stretch strings
-    "TTF_STRETCH_NORMAL",		// normal
-    "TTF_STRETCH_ULTRA_CONDENSED",	// ultra-condensed
-    "TTF_STRETCH_EXTRA_CONDENSED",	// extra-condensed
-    "TTF_STRETCH_CONDENSED",		// condensed
-    "TTF_STRETCH_SEMI_CONDENSED",	// semi-condensed
-    "TTF_STRETCH_SEMI_EXPANDED",	// semi-expanded
-    "TTF_STRETCH_EXPANDED",		// expanded
-    "TTF_STRETCH_EXTRA_EXPANDED",	// extra-expanded
-    "TTF_STRETCH_ULTRA_EXPANDED"	// ultra-expanded
-  };
-  static const char * const strings[] =	// Test strings
-  {
-    "Hello, World!",			// English
-    "مرحبا بالعالم!",			// Arabic
-    "Bonjour le monde!",		// French
-    "Γειά σου Κόσμε!",			// Greek
-    "שלום עולם!",			// Hebrew
-    "Привет мир!",			// Russian
-    "こんにちは世界！"			// Japanese
-  };
-  static const char * const styles[] =	// Font style names
+  int		errors = 0;		// Number of errors
+  ttf_cache_t	*cache,			// Scanned font cache
+		*cache2;		// Loaded font cache
+  char		*home,			// Old HOME
+		*cache_home,		// Old XDG_CACHE_HOME
+		tmpdir[256],		// Temporary directory
+		cwd[1024],		// Current directory
+		fontdir[1024],		// Font directory
+		filename[1024],		// Font filename
+		target[1024],		// Link target
+		cachefile[1024];	// Cache filename
+  const char	*diff;			// First difference
+  struct stat	info;			// Cache file information
+  off_t		size;			// Size of cache file
+  ino_t		inode;			// Inode of cache file
+  size_t	i,			// Looping var
+		base,			// Base font of named instances
+		num_instances;		// Number of named instances
+  ttf_t		*font;			// Variable font
+  static const char * const fonts[] =	// Test fonts
   {
-    "TTF_STYLE_NORMAL",
-    "TTF_STYLE_ITALIC",
-    "TTF_STYLE_OBLIQUE"
+    "OpenSans-Bold.ttf",
+    "OpenSans-Regular.ttf",
+    "OpenSans-Variable.ttf"
   };
 
 
-  if (filename && !font)
+  testBegin("ttfCacheCreate(temporary cache)");
+
+  snprintf(tmpdir, sizeof(tmpdir), "%s/testttf.XXXXXX", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+  if (!mkdtemp(tmpdir) || !getcwd(cwd, sizeof(cwd)))
   {
-    testBegin("ttfCreate(\"%s\")", filename);
-    if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
-      testEnd(true);
-    else
-      return (1);
+    testEndMessage(false, "%s", strerror(errno));
+    return (1);
   }
 
-  testBegin("ttfContainsChar(' ')");
-  testEnd(ttfContainsChar(font, ' '));
-
-  testBegin("ttfContainsChar('\\177')");
-  testEnd(!ttfContainsChar(font, '\177'));
-
-  testBegin("ttfContainsChars(\"Hello, World!\")");
-  testEnd(ttfContainsChars(font, "Hello, World!"));
+  snprintf(fontdir, sizeof(fontdir), "%s/.fonts", tmpdir);
+  snprintf(cachefile, sizeof(cachefile), "%s/testttf.dat", tmpdir);
 
-  testBegin("ttfGetAscent");
-  if ((intvalue = ttfGetAscent(font)) > 0)
+  mkdir(fontdir, 0700);
+  for (i = 0; i < (sizeof(fonts) / sizeof(fonts[0])); i ++)
   {
-    testEndMessage(true, "%d", intvalue);
-  }
-  else
-  {
-    testEndMessage(false, "%d", intvalue);
-    errors ++;
+    snprintf(filename, sizeof(filename), "%s/%s", fontdir, fonts[i]);
+    snprintf(target, sizeof(target), "%s/testfiles/%s", cwd, fonts[i]);
+    symlink(target, filename);
   }
 
-  testBegin("ttfGetBounds");
-  if (ttfGetBounds(font, &bounds))
-  {
-    testEndMessage(true, "%g %g %g %g", bounds.left, bounds.bottom, bounds.right, bounds.top);
-  }
-  else
-  {
-    testEnd(false);
-    errors ++;
-  }
+  home       = getenv("HOME") ? strdup(getenv("HOME")) : NULL;
+  cache_home = getenv("XDG_CACHE_HOME") ? strdup(getenv("XDG_CACHE_HOME")) : NULL;
 
-  testBegin("ttfGetCapHeight");
-  if ((intvalue = ttfGetCapHeight(font)) > 0)
-  {
-    testEndMessage(true, "%d", intvalue);
-  }
-  else
-  {
-    testEndMessage(false, "%d", intvalue);
-    errors ++;
-  }
+  setenv("HOME", tmpdir, 1);
+  setenv("XDG_CACHE_HOME", tmpdir, 1);
 
-  testBegin("ttfGetCMap");
-  if ((cmap = ttfGetCMap(font, &num_cmap)) != NULL && num_cmap > 0)
-  {
-    testEndMessage(true, "%lu entries", (unsigned long)num_cmap);
-  }
-  else
+  // Scan the fonts and then load the saved cache...
+  cache = ttfCacheCreate("testttf", error_cb, /*err_cbdata*/NULL);
+  size  = stat(cachefile, &info) ? 0 : info.st_size;
+  inode = info.st_ino;
+
+  if (!cache || size == 0)
   {
-    testEndMessage(false, "%lu entries", (unsigned long)num_cmap);
+    testEndMessage(false, "cache not saved");
     errors ++;
   }
-
-  testBegin("ttfGetCopyright");
-  if ((value = ttfGetCopyright(font)) != NULL)
+  else if (ttfCacheGetNumFonts(cache) < 4 || !ttfCacheFind(cache, "Open Sans", TTF_STYLE_NORMAL, TTF_WEIGHT_700, TTF_STRETCH_NORMAL))
   {
-    testEndMessage(true, "%s", value);
+    testEndMessage(false, "test fonts not found");
+    errors ++;
   }
   else
   {
-    testEndMessage(true, "warning: no copyright found");
-  }
+    testEndMessage(true, "%u fonts, %u bytes", (unsigned)ttfCacheGetNumFonts(cache), (unsigned)size);
 
-  for (i = 0; i < (int)(sizeof(strings) / sizeof(strings[0])); i ++)
-  {
-    testBegin("ttfGetExtents(\"%s\")", strings[i]);
-    if (ttfGetExtents(font, 12.0f, strings[i], &extents))
+    testBegin("ttfCacheCreate(saved cache)");
+    if ((cache2 = ttfCacheCreate("testttf", error_cb, /*err_cbdata*/NULL)) == NULL)
     {
-      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+      errors ++;
     }
-    else
+    else if ((diff = compare_cache(cache, cache2)) != NULL)
     {
-      testEnd(false);
+      testEndMessage(false, "%s differ", diff);
+      errors ++;
+    }
+    else if (stat(cachefile, &info) || info.st_ino != inode)
+    {
+      testEndMessage(false, "cache saved again");
       errors ++;
     }
+    else
+    {
+      testEnd(true);
+    }
 
-    testBegin("ttfGetKernedExtents(\"%s\")", strings[i]);
-    if ((num_adjs = ttfGetKernedExtents(font, 12.0f, strings[i], &extents, sizeof(adjs) / sizeof(adjs[0]), adjs)) > 0)
+    ttfCacheDelete(cache2);
+
+    // Named instances should share the variable font...
+    testBegin("ttfCacheGetFont(named instances)");
+    for (base = 0; base < ttfCacheGetNumFonts(cache); base ++)
     {
-      testEndMessage(true, "%.1f %.1f %.1f %.1f, num_adjs=%u", extents.left, extents.bottom, extents.right, extents.top, (unsigned)num_adjs);
-      for (j = 0; j < num_adjs; j ++)
+      if (strstr(ttfCacheGetFilename(cache, base), "Variable") && ttfCacheGetInstance(cache, base) == 0)
+        break;
+    }
+
+    if (base >= ttfCacheGetNumFonts(cache) || (font = ttfCacheGetFont(cache, base)) == NULL)
+    {
+      testEndMessage(false, "variable font not found");
+      errors ++;
+    }
+    else
+    {
+      for (i = 0, num_instances = 0; i < ttfCacheGetNumFonts(cache); i ++)
       {
-        if (adjs[j] != 0.0)
-          testMessage("    adjs[%u]=%.3f", (unsigned)j, adjs[j]);
+        if (!strcmp(ttfCacheGetFilename(cache, i), ttfCacheGetFilename(cache, base)) && ttfCacheGetInstance(cache, i) > 0)
+        {
+          if (ttfCacheGetFont(cache, i) != ttfGetInstance(font, ttfCacheGetInstance(cache, i) - 1))
+            break;
+
+          num_instances ++;
+        }
+      }
+
+      if (i < ttfCacheGetNumFonts(cache) || num_instances == 0)
+      {
+        testEndMessage(false, "instance %u not shared", (unsigned)num_instances);
+        errors ++;
+      }
+      else
+      {
+        testEndMessage(true, "%u instances", (unsigned)num_instances);
       }
     }
-    else
+
+    // Truncate the cache file, which should be rescanned and saved again...
+    testBegin("ttfCacheCreate(truncated cache)");
+    if (truncate(cachefile, size / 2))
     {
-      testEnd(false);
+      testEndMessage(false, "%s", strerror(errno));
       errors ++;
     }
-  }
+    else if ((cache2 = ttfCacheCreate("testttf", error_cb, /*err_cbdata*/NULL)) == NULL)
+    {
+      errors ++;
+    }
+    else
+    {
+      if ((diff = compare_cache(cache, cache2)) != NULL)
+      {
+        testEndMessage(false, "%s differ", diff);
+        errors ++;
+      }
+      else if (stat(cachefile, &info) || info.st_size != size || info.st_ino == inode)
+      {
+        testEndMessage(false, "cache not saved again");
+        errors ++;
+      }
+      else
+      {
+        testEnd(true);
+      }
 
-  testBegin("ttfGetFamily");
-  if ((value = ttfGetFamily(font)) != NULL)
-  {
-    testEndMessage(true, "%s", value);
+      ttfCacheDelete(cache2);
+    }
   }
+
+  ttfCacheDelete(cache);
+
+  // Restore the environment and clean up...
+  if (home)
+    setenv("HOME", home, 1);
+  else
+    unsetenv("HOME");
+
+  if (cache_home)
+    setenv("XDG_CACHE_HOME", cache_home, 1);
   else
+    unsetenv("XDG_CACHE_HOME");
+
+  free(home);
+  free(cache_home);
+
+  for (i = 0; i < (sizeof(fonts) / sizeof(fonts[0])); i ++)
   {
-    testEnd(false);
-    errors ++;
+    snprintf(filename, sizeof(filename), "%s/%s", fontdir, fonts[i]);
+    unlink(filename);
   }
 
-  testBegin("ttfGetItalicAngle");
-  if ((realvalue = ttfGetItalicAngle(font)) >= -180.0 && realvalue <= 180.0)
-  {
+  unlink(cachefile);
+  rmdir(fontdir);
+  rmdir(tmpdir);
+
+  return (errors);
+}
+
+
+//
+// 'test_cff()' - Test subsetting a CFF font.
+//
+// The test font is an ASCII subset of Open Sans with the TrueType outlines
+// converted to a "CFF" table.
+//
+
+static int				// O - Number of errors
+test_cff(const char *filename)		// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font,			// Font
+		*subfont = NULL;	// Subset font
+  int		glyphs[5],		// Glyphs for "Hello"
+		glyph;			// Glyph for "A"
+  size_t	num_glyphs,		// Number of glyphs
+		subsize;		// Size of subset font
+  unsigned char	*subdata = NULL;	// Subset font data
+  ttf_rect_t	extents,		// Ink extents in font
+		subextents,		// Ink extents in subset font
+		bounds;			// Bounds of "A"
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  testBegin("ttfSubset(\"Hello\")");
+  if ((num_glyphs = ttfGetGlyphs(font, "Hello", 0, glyphs, sizeof(glyphs) / sizeof(glyphs[0]))) != 5)
+  {
+    testEndMessage(false, "got %u glyphs, expected 5", (unsigned)num_glyphs);
+    errors ++;
+  }
+  else if ((subsize = ttfSubset(font, glyphs, num_glyphs, NULL, 0)) == 0 || (subdata = malloc(subsize)) == NULL)
+  {
+    testEnd(false);
+    errors ++;
+  }
+  else if (ttfSubset(font, glyphs, num_glyphs, subdata, subsize) != subsize || memcmp(subdata, "OTTO", 4))
+  {
+    testEndMessage(false, "bad subset font");
+    errors ++;
+  }
+  else if ((subfont = ttfCreateData(subdata, subsize, /*idx*/0, error_cb, /*err_data*/NULL)) == NULL)
+  {
+    errors ++;
+  }
+  else
+  {
+    testEndMessage(true, "%u bytes", (unsigned)subsize);
+
+    // Ink extents at 2048 points are in font units...
+    testBegin("ttfGetInkExtents(\"Hello\", subset)");
+    ttfGetInkExtents(font, 2048.0f, "Hello", &extents);
+    ttfGetInkExtents(subfont, 2048.0f, "Hello", &subextents);
+
+    if (!memcmp(&extents, &subextents, sizeof(extents)) && extents.left == 201.0f && extents.bottom == -20.0f && extents.right == 4818.0f && extents.top == 1556.0f)
+    {
+      testEndMessage(true, "%g %g %g %g", subextents.left, subextents.bottom, subextents.right, subextents.top);
+    }
+    else
+    {
+      testEndMessage(false, "%g %g %g %g, expected %g %g %g %g", subextents.left, subextents.bottom, subextents.right, subextents.top, extents.left, extents.bottom, extents.right, extents.top);
+      errors ++;
+    }
+
+    // Unused glyphs have empty charstrings...
+    testBegin("ttfGetGlyphBounds(\"A\", subset)");
+    ttfGetGlyphs(font, "A", 0, &glyph, 1);
+
+    if (ttfGetGlyphBounds(font, glyph, &bounds) && bounds.right > bounds.left && ttfGetGlyphBounds(subfont, glyph, &bounds) && bounds.right <= bounds.left)
+    {
+      testEnd(true);
+    }
+    else
+    {
+      testEndMessage(false, "%g %g %g %g", bounds.left, bounds.bottom, bounds.right, bounds.top);
+      errors ++;
+    }
+  }
+
+  ttfDelete(subfont);
+  free(subdata);
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_class_kerning()' - Test class-based kerning.
+//
+// The "kern" test font has a format 2 (class) subtable and the "GPOS" test
+// font has a PairPos format 1 subtable for "A" and "T", a PairPos format 2
+// subtable for "V" and "W", and a trailing PairPos format 1 subtable with
+// different values for the same pairs, along with a "kern" table that must be
+// ignored.
+// Both fonts have the following kerning, in units of 1/2048th:
+//
+//   A T -150
+//   A V -100
+//   T o -200
+//   V A -120
+//
+// The "kern" test font puts "V" and "W" in the same classes while the "GPOS"
+// test font has a separate class for "W" with a "W" "A" kerning of -80.
+//
+
+static int				// O - Number of errors
+test_class_kerning(
+    const char *filename,		// I - Font filename
+    bool       gpos)			// I - Font uses GPOS kerning?
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  ttf_rect_t	extents,		// Unkerned extents
+		kextents;		// Kerned extents
+  size_t	num_adjs;		// Number of kerning adjustments
+  double	adjs[10],		// Kerning adjustments
+		waw[2];			// Expected "WAW" adjustments
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  // Kerned widths at 2048 points are in font units...
+  testBegin("ttfGetKernedExtents(\"AVAT To\")");
+  ttfGetExtents(font, 2048.0f, "AVAT To", &extents);
+  if ((num_adjs = ttfGetKernedExtents(font, 2048.0f, "AVAT To", &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs)) == 6 && adjs[0] == -100.0 && adjs[1] == -120.0 && adjs[2] == -150.0 && adjs[3] == 0.0 && adjs[4] == 0.0 && adjs[5] == -200.0 && fabs(kextents.right - extents.right + 570.0) < 0.01)
+  {
+    testEndMessage(true, "%g %g %g %g %g %g", adjs[0], adjs[1], adjs[2], adjs[3], adjs[4], adjs[5]);
+  }
+  else
+  {
+    testEndMessage(false, "%u adjustments, width %g, expected %g", (unsigned)num_adjs, kextents.right - kextents.left, extents.right - extents.left - 570.0);
+    errors ++;
+  }
+
+  if (gpos)
+  {
+    waw[0] = -80.0;
+    waw[1] = 0.0;
+  }
+  else
+  {
+    waw[0] = -120.0;
+    waw[1] = -100.0;
+  }
+
+  testBegin("ttfGetKernedExtents(\"WAW\")");
+  ttfGetExtents(font, 2048.0f, "WAW", &extents);
+  if ((num_adjs = ttfGetKernedExtents(font, 2048.0f, "WAW", &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs)) == 2 && adjs[0] == waw[0] && adjs[1] == waw[1] && fabs(kextents.right - extents.right - waw[0] - waw[1]) < 0.01)
+  {
+    testEndMessage(true, "%g %g", adjs[0], adjs[1]);
+  }
+  else
+  {
+    testEndMessage(false, "%u adjustments, expected %g %g", (unsigned)num_adjs, waw[0], waw[1]);
+    errors ++;
+  }
+
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_find_font()' - Test finding a font.
+//
+
+static int				// O - Number of errors
+test_find_font(ttf_cache_t   *cache,	// I - Font cache
+	       const char    *family,	// I - Font family
+	       ttf_style_t   fstyle,	// I - Font style
+	       ttf_weight_t  fweight,	// I - Font weight
+	       ttf_stretch_t fstretch)	// I - Font stretch
+{
+  ttf_t	*font;				// Matching font
+  char	name[256];			// Font name
+
+
+  testBegin("ttfCacheFind(%s)", format_name(name, sizeof(name), family, fstyle, fweight, fstretch));
+  if ((font = ttfCacheFind(cache, family, fstyle, fweight, fstretch)) != NULL)
+  {
+    testEndMessage(true, "%s", format_name(name, sizeof(name), ttfGetFamily(font), ttfGetStyle(font), ttfGetWeight(font), ttfGetStretch(font)));
+
+    return (test_font(/*filename*/NULL, font));
+  }
+  else
+  {
+    testEnd(false);
+    return (1);
+  }
+}
+
+
+//
+// 'test_fixed()' - Test a fixed-pitch font.
+//
+// The test font is an ASCII subset of Open Sans with every advance width set
+// to 1229 units and the "post" table's isFixedPitch flag set, so that
+// @link ttfGetExtents@ uses its fixed-pitch fast path for printable ASCII.
+//
+
+static int				// O - Number of errors
+test_fixed(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  size_t	i;			// Looping var
+  ttf_rect_t	extents,		// Extents using the fast path
+		kextents;		// Extents using the glyph widths
+  double	adjs[64];		// Kerning adjustments
+  static const struct
+  {
+    const char	*s;			// String
+    int		count;			// Number of characters with a width
+  }		strings[] =		// Test strings
+  {
+    { "Hello, World!", 13 },
+    { "~{}|", 4 },
+    { "caf\303\251 au lait", 11 }	// No "é" in the font
+  };
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  testBegin("ttfIsFixedPitch");
+  if (ttfIsFixedPitch(font))
+  {
+    testEnd(true);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  // Widths at 2048 points are in font units, and the kerned extents are
+  // always measured one glyph at a time...
+  for (i = 0; i < (sizeof(strings) / sizeof(strings[0])); i ++)
+  {
+    testBegin("ttfGetExtents(\"%s\", fixed)", strings[i].s);
+
+    ttfGetExtents(font, 2048.0f, strings[i].s, &extents);
+    ttfGetKernedExtents(font, 2048.0f, strings[i].s, &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs);
+
+    if (!memcmp(&extents, &kextents, sizeof(extents)) && fabs(extents.right - extents.left - 1229.0 * strings[i].count) < 0.01)
+    {
+      testEndMessage(true, "%g", extents.right - extents.left);
+    }
+    else
+    {
+      testEndMessage(false, "%g %g %g %g, expected %g %g %g %g and width %d", extents.left, extents.bottom, extents.right, extents.top, kextents.left, kextents.bottom, kextents.right, kextents.top, 1229 * strings[i].count);
+      errors ++;
+    }
+  }
+
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_font()' - Test a font file.
+//
+
+static int				// O - Number of errors
+test_font(const char *filename,		// I - Font filename or `NULL`
+          ttf_t      *font)		// I - Font or `NULL` to load
+{
+  int		i,			// Looping var
+		errors = 0;		// Number of errors
+  struct stat	fileinfo;		// Font file information
+  FILE		*fp = NULL;		// File pointer
+  void		*data = NULL;		// Memory buffer for font file
+  const char	*value;			// Font (string) value
+  int		intvalue;		// Font (integer) value
+  float		realvalue;		// Font (real) value
+  char		psname[1024];		// Postscript font name
+  ttf_rect_t	bounds;			// Bounds
+  ttf_rect_t	extents,		// Extents
+		sextents[7],		// Extents of test strings
+		skextents[7];		// Kerned extents of test strings
+  size_t	j,			// Looping var
+		num_adjs;		// Number of kerning adjustments
+  double	adjs[1024];		// Kerning adjustments
+  size_t	num_fonts;		// Number of fonts
+  ttf_style_t	style;			// Font style
+  ttf_weight_t	weight;			// Font weight
+  const int	*cmap;			// CMap table
+  size_t	num_cmap;		// Number of CMap entries
+  size_t	hits,			// Number of extents cache hits
+		misses;			// Number of extents cache misses
+  float		carets[100];		// Caret positions
+  size_t	num_carets;		// Number of caret positions
+  ttf_measure_t	*measure;		// Streaming measurement
+  ttf_run_t	runs[2];		// Text runs
+  float		advances[2];		// Advances of text runs
+  ttf_text_t	*text;			// Prepared text
+  ttf_wrap_t	wrap;			// Line breaking algorithm
+  ttf_line_t	lines[100];		// Lines
+  size_t	num_lines;		// Number of lines
+  int		chars[100],		// Unicode characters
+		glyphs[100],		// Glyphs
+		glyphs32[100];		// Glyphs from Unicode characters
+  size_t	num_glyphs;		// Number of glyphs
+  ttf_glyph_range_t granges[1000];	// Glyph ranges
+  size_t	num_granges;		// Number of glyph ranges
+  const int	*unicodes;		// Glyph to Unicode map
+  void		*subdata;		// Font subset data
+  size_t	subsize;		// Size of font subset
+  ttf_t		*subfont;		// Font subset
+  ttf_path_t	path[1000];		// Glyph outline
+  size_t	num_path,		// Number of outline segments
+		num_segments;		// Number of outline callbacks
+  unsigned char	pixels[2][160 * 24];	// Rendered text
+  const ttf_coverage_t *coverage;	// Character coverage
+  ttf_coverage_t *ucoverage;		// Union of character coverage
+  ttf_font_run_t fruns[4];		// Font runs
+  size_t	num_fruns;		// Number of font runs
+  int		ink;			// Total coverage of rendered text
+  const ttf_axis_t *axes;		// Variation axes
+  size_t	num_axes,		// Number of variation axes
+		num_instances;		// Number of named instances
+  ttf_t		*instance;		// Variation instance
+  static const char * const paragraph =	// Test paragraph
+    "The quick brown fox jumps over the lazy dog.  Pack my box with five "
+    "dozen liquor jugs!  How vexingly quick daft zebras jump; the five "
+    "boxing wizards jump quickly.\nSphinx of black quartz, judge my vow - "
+    "a well-known pangram.";
+  static const char * const stretches[] =
+  {					// Font stretch strings
+    "TTF_STRETCH_NORMAL",		// normal
+    "TTF_STRETCH_ULTRA_CONDENSED",	// ultra-condensed
+    "TTF_STRETCH_EXTRA_CONDENSED",	// extra-condensed
+    "TTF_STRETCH_CONDENSED",		// condensed
+    "TTF_STRETCH_SEMI_CONDENSED",	// semi-condensed
+    "TTF_STRETCH_SEMI_EXPANDED",	// semi-expanded
+    "TTF_STRETCH_EXPANDED",		// expanded
+    "TTF_STRETCH_EXTRA_EXPANDED",	// extra-expanded
+    "TTF_STRETCH_ULTRA_EXPANDED"	// ultra-expanded
+  };
+  static const char * const strings[] =	// Test strings
+  {
+    "Hello, World!",			// English
+    "مرحبا بالعالم!",			// Arabic
+    "Bonjour le monde!",		// French
+    "Γειά σου Κόσμε!",			// Greek
+    "שלום עולם!",			// Hebrew
+    "Привет мир!",			// Russian
+    "こんにちは世界！"			// Japanese
+  };
+  static const char * const styles[] =	// Font style names
+  {
+    "TTF_STYLE_NORMAL",
+    "TTF_STYLE_ITALIC",
+    "TTF_STYLE_OBLIQUE"
+  };
+
+
+  if (filename && !font)
+  {
+    testBegin("ttfCreate(\"%s\")", filename);
+    if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+      testEnd(true);
+    else
+      return (1);
+  }
+
+  testBegin("ttfContainsChar(' ')");
+  testEnd(ttfContainsChar(font, ' '));
+
+  testBegin("ttfContainsChar('\\177')");
+  testEnd(!ttfContainsChar(font, '\177'));
+
+  testBegin("ttfContainsChars(\"Hello, World!\")");
+  testEnd(ttfContainsChars(font, "Hello, World!"));
+
+  testBegin("ttfCoverageFindMissing(\"Hello,\\177World!\")");
+  if ((coverage = ttfGetCoverage(font)) != NULL && (j = ttfCoverageFindMissing(coverage, "Hello,\177World!", 0)) == 6)
+  {
+    testEndMessage(true, "%u characters", (unsigned)ttfCoverageGetCount(coverage));
+  }
+  else
+  {
+    testEndMessage(false, "got offset %d", coverage ? (int)j : -1);
+    errors ++;
+  }
+
+  testBegin("ttfCoverageUnion");
+  if ((ucoverage = ttfCoverageCopy(NULL)) != NULL && ttfCoverageUnion(ucoverage, coverage) && ttfCoverageGetCount(ucoverage) == ttfCoverageGetCount(coverage) && ttfCoverageContainsChar(ucoverage, 'H') && ttfCoverageIntersect(ucoverage, coverage) && ttfCoverageGetCount(ucoverage) == ttfCoverageGetCount(coverage))
+  {
+    testEnd(true);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  ttfCoverageDelete(ucoverage);
+
+  testBegin("ttfGetFontRuns(\"Hello, \\U0010FFFD World!\")");
+  if ((num_fruns = ttfGetFontRuns(&font, 1, "Hello, \364\217\277\275 World!", 0, sizeof(fruns) / sizeof(fruns[0]), fruns)) == 3 && fruns[0].font == font && fruns[0].end == 7 && !fruns[1].font && fruns[1].font_index == 1 && fruns[1].end == 11 && fruns[2].font == font && fruns[2].end == 18)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    testEndMessage(false, "%u runs", (unsigned)num_fruns);
+    errors ++;
+  }
+
+  testBegin("ttfGetFontRuns(no fonts)");
+  if ((num_fruns = ttfGetFontRuns(NULL, 0, "ab", 0, sizeof(fruns) / sizeof(fruns[0]), fruns)) == 1 && !fruns[0].font && fruns[0].font_index == 0 && fruns[0].start == 0 && fruns[0].end == 2)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    testEndMessage(false, "%u runs", (unsigned)num_fruns);
+    errors ++;
+  }
+
+  testBegin("ttfGetAscent");
+  if ((intvalue = ttfGetAscent(font)) > 0)
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetBounds");
+  if (ttfGetBounds(font, &bounds))
+  {
+    testEndMessage(true, "%g %g %g %g", bounds.left, bounds.bottom, bounds.right, bounds.top);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetCapHeight");
+  if ((intvalue = ttfGetCapHeight(font)) > 0)
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetCMap");
+  if ((cmap = ttfGetCMap(font, &num_cmap)) != NULL && num_cmap > 0)
+  {
+    testEndMessage(true, "%lu entries", (unsigned long)num_cmap);
+  }
+  else
+  {
+    testEndMessage(false, "%lu entries", (unsigned long)num_cmap);
+    errors ++;
+  }
+
+  testBegin("ttfGetGlyphs(\"%s\")", strings[0]);
+  if ((num_glyphs = ttfGetGlyphs(font, strings[0], 0, glyphs, sizeof(glyphs) / sizeof(glyphs[0]))) == strlen(strings[0]))
+  {
+    for (j = 0; j < num_glyphs; j ++)
+    {
+      chars[j] = strings[0][j];
+
+      if (glyphs[j] != (chars[j] < (int)num_cmap && cmap[chars[j]] > 0 ? cmap[chars[j]] : 0))
+        break;
+    }
+
+    if (j < num_glyphs)
+    {
+      testEndMessage(false, "got glyph %d for '%c', expected %d", glyphs[j], chars[j], cmap[chars[j]]);
+      errors ++;
+    }
+    else if (ttfGetGlyphsUTF32(font, chars, num_glyphs, glyphs32) != num_glyphs || memcmp(glyphs, glyphs32, num_glyphs * sizeof(int)))
+    {
+      testEndMessage(false, "ttfGetGlyphsUTF32 does not match");
+      errors ++;
+    }
+    else
+    {
+      testEndMessage(true, "%u glyphs", (unsigned)num_glyphs);
+    }
+
+    testBegin("ttfGetGlyphAdvance");
+    if ((intvalue = ttfGetGlyphAdvance(font, glyphs[0])) == ttfGetWidth(font, strings[0][0]) && intvalue > 0)
+    {
+      testEndMessage(true, "%d", intvalue);
+    }
+    else
+    {
+      testEndMessage(false, "got %d, expected %d", intvalue, ttfGetWidth(font, strings[0][0]));
+      errors ++;
+    }
+
+    testBegin("ttfGetWidthRanges");
+    if ((num_granges = ttfGetWidthRanges(font, NULL, 0, granges, sizeof(granges) / sizeof(granges[0]))) > 0 && ttfGetWidthRanges(font, glyphs, num_glyphs, granges, sizeof(granges) / sizeof(granges[0])) <= num_glyphs)
+    {
+      for (j = 0; j < num_glyphs && j < sizeof(granges) / sizeof(granges[0]); j ++)
+      {
+        if (granges[j].first <= glyphs[0] && granges[j].last >= glyphs[0])
+          break;
+      }
+
+      if (j < num_glyphs && granges[j].value == ttfGetGlyphAdvance(font, glyphs[0]))
+      {
+        testEndMessage(true, "%u ranges for all glyphs", (unsigned)num_granges);
+      }
+      else
+      {
+        testEndMessage(false, "width of glyph %d not found", glyphs[0]);
+        errors ++;
+      }
+    }
+    else
+    {
+      testEndMessage(false, "%u ranges", (unsigned)num_granges);
+      errors ++;
+    }
+
+    testBegin("ttfGetUnicodeMap");
+    if ((unicodes = ttfGetUnicodeMap(font, &j)) != NULL && j > 0 && (size_t)glyphs[0] < j && unicodes[glyphs[0]] == strings[0][0] && ttfGetUnicodeRanges(font, glyphs, num_glyphs, granges, sizeof(granges) / sizeof(granges[0])) > 0)
+    {
+      testEndMessage(true, "%u glyphs", (unsigned)j);
+    }
+    else
+    {
+      testEnd(false);
+      errors ++;
+    }
+
+    testBegin("ttfGetGlyphLeftBearing");
+    if ((intvalue = ttfGetGlyphLeftBearing(font, glyphs[0])) > -1000 && intvalue < 1000)
+    {
+      testEndMessage(true, "%d", intvalue);
+    }
+    else
+    {
+      testEndMessage(false, "%d", intvalue);
+      errors ++;
+    }
+
+    testBegin("ttfGetGlyphPath");
+    num_segments = 0;
+    if ((num_path = ttfGetGlyphPath(font, glyphs[0], path, sizeof(path) / sizeof(path[0]))) > 1 && num_path <= (sizeof(path) / sizeof(path[0])) && path[0].op == TTF_PATH_MOVE && path[num_path - 1].op == TTF_PATH_CLOSE && ttfGetGlyphOutline(font, glyphs[0], (ttf_path_cb_t)outline_cb, &num_segments) && num_segments == num_path)
+    {
+      testEndMessage(true, "%u segments", (unsigned)num_path);
+    }
+    else
+    {
+      testEndMessage(false, "%u segments, %u callbacks", (unsigned)num_path, (unsigned)num_segments);
+      errors ++;
+    }
+
+    testBegin("ttfRenderString(\"%s\")", strings[0]);
+    memset(pixels, 0, sizeof(pixels));
+    if (ttfRenderString(font, 16.0f, strings[0], pixels[0], 160, 24, 160, 0.0f, 18.0f) && ttfRenderString(font, 16.0f, strings[0], pixels[1], 160, 24, 160, 0.0f, 18.0f))
+    {
+      for (j = 0, ink = 0; j < sizeof(pixels[0]); j ++)
+        ink += pixels[0][j];
+
+      if (ink > 0 && !memcmp(pixels[0], pixels[1], sizeof(pixels[0])))
+      {
+        testEndMessage(true, "%.1f pixels of ink", ink / 255.0);
+      }
+      else
+      {
+        testEndMessage(false, "%.1f pixels of ink, cached rendering %s", ink / 255.0, memcmp(pixels[0], pixels[1], sizeof(pixels[0])) ? "differs" : "matches");
+        errors ++;
+      }
+    }
+    else
+    {
+      testEnd(false);
+      errors ++;
+    }
+
+    testBegin("ttfSubset(\"%s\")", strings[0]);
+    if ((subsize = ttfSubset(font, glyphs, num_glyphs, NULL, 0)) == 0)
+    {
+      testEnd(false);
+      errors ++;
+    }
+    else if ((subdata = malloc(subsize)) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      errors ++;
+    }
+    else
+    {
+      if (ttfSubset(font, glyphs, num_glyphs, subdata, subsize) != subsize)
+      {
+        testEndMessage(false, "size changed");
+        errors ++;
+      }
+      else if ((subfont = ttfCreateData(subdata, subsize, /*idx*/0, error_cb, /*err_data*/NULL)) == NULL)
+      {
+        errors ++;
+      }
+      else
+      {
+        ttfGetExtents(font, 12.0f, strings[0], &extents);
+        ttfGetExtents(subfont, 12.0f, strings[0], &bounds);
+
+        if (ttfGetGlyphs(subfont, strings[0], 0, glyphs32, sizeof(glyphs32) / sizeof(glyphs32[0])) != num_glyphs || memcmp(glyphs, glyphs32, num_glyphs * sizeof(int)))
+        {
+          testEndMessage(false, "glyphs do not match");
+          errors ++;
+        }
+        else if (extents.left != bounds.left || extents.right != bounds.right || extents.top != bounds.top || extents.bottom != bounds.bottom)
+        {
+          testEndMessage(false, "extents do not match");
+          errors ++;
+        }
+        else
+        {
+          testEndMessage(true, "%u bytes", (unsigned)subsize);
+        }
+
+        ttfDelete(subfont);
+      }
+
+      free(subdata);
+    }
+  }
+  else
+  {
+    testEndMessage(false, "got %u glyphs, expected %u", (unsigned)num_glyphs, (unsigned)strlen(strings[0]));
+    errors ++;
+  }
+
+  testBegin("ttfGetCopyright");
+  if ((value = ttfGetCopyright(font)) != NULL)
+  {
+    testEndMessage(true, "%s", value);
+  }
+  else
+  {
+    testEndMessage(true, "warning: no copyright found");
+  }
+
+  for (i = 0; i < (int)(sizeof(strings) / sizeof(strings[0])); i ++)
+  {
+    testBegin("ttfGetExtents(\"%s\")", strings[i]);
+    if (ttfGetExtents(font, 12.0f, strings[i], &extents))
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+      sextents[i] = extents;
+    }
+    else
+    {
+      testEnd(false);
+      errors ++;
+    }
+
+    testBegin("ttfGetKernedExtents(\"%s\")", strings[i]);
+    if ((num_adjs = ttfGetKernedExtents(font, 12.0f, strings[i], &extents, sizeof(adjs) / sizeof(adjs[0]), adjs)) > 0)
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f, num_adjs=%u", extents.left, extents.bottom, extents.right, extents.top, (unsigned)num_adjs);
+      skextents[i] = extents;
+      for (j = 0; j < num_adjs; j ++)
+      {
+        if (adjs[j] != 0.0)
+          testMessage("    adjs[%u]=%.3f", (unsigned)j, adjs[j]);
+      }
+    }
+    else
+    {
+      testEnd(false);
+      errors ++;
+    }
+  }
+
+  testBegin("ttfGetGlyphKerning");
+  for (j = 1, intvalue = 0; j < num_glyphs; j ++)
+    intvalue += ttfGetGlyphKerning(font, glyphs[j - 1], glyphs[j]);
+
+  if (fabs(intvalue - 1000.0 * (skextents[0].right - sextents[0].right) / 12.0) <= num_glyphs)
+  {
+    testEndMessage(true, "%d total", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "got %d total, expected %.0f", intvalue, 1000.0 * (skextents[0].right - sextents[0].right) / 12.0);
+    errors ++;
+  }
+
+  testBegin("ttfSetExtentsCache(1024)");
+  if (ttfSetExtentsCache(font, 1024))
+  {
+    testEnd(true);
+
+    for (j = 0; j < 2; j ++)
+    {
+      for (i = 0; i < (int)(sizeof(strings) / sizeof(strings[0])); i ++)
+      {
+	testBegin("ttfGetExtents(\"%s\", pass %u)", strings[i], (unsigned)j + 1);
+	if (ttfGetExtents(font, 12.0f, strings[i], &extents) && !memcmp(&extents, sextents + i, sizeof(extents)))
+	{
+	  testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+	}
+	else
+	{
+	  testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, sextents[i].left, sextents[i].bottom, sextents[i].right, sextents[i].top);
+	  errors ++;
+	}
+
+        testBegin("ttfGetKernedExtents(\"%s\", pass %u)", strings[i], (unsigned)j + 1);
+        if (ttfGetKernedExtents(font, 12.0f, strings[i], &extents, sizeof(adjs) / sizeof(adjs[0]), adjs) > 0 && !memcmp(&extents, skextents + i, sizeof(extents)))
+        {
+          testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+        }
+        else
+        {
+	  testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, skextents[i].left, skextents[i].bottom, skextents[i].right, skextents[i].top);
+	  errors ++;
+        }
+      }
+    }
+
+    testBegin("ttfGetExtentsCacheStats");
+    ttfGetExtentsCacheStats(font, &hits, &misses);
+    if (hits == 2 * sizeof(strings) / sizeof(strings[0]) && misses == hits)
+    {
+      testEndMessage(true, "%u hits, %u misses", (unsigned)hits, (unsigned)misses);
+    }
+    else
+    {
+      testEndMessage(false, "%u hits, %u misses", (unsigned)hits, (unsigned)misses);
+      errors ++;
+    }
+
+    // Cached kerning adjustments that don't fit are measured again...
+    testBegin("ttfGetKernedExtents(\"%s\", 2 adjustments)", strings[0]);
+    num_adjs = ttfGetKernedExtents(font, 12.0f, strings[0], &extents, 2, adjs);
+    ttfGetExtentsCacheStats(font, &hits, &misses);
+    if (num_adjs == 2 && hits == 2 * sizeof(strings) / sizeof(strings[0]) && misses == hits + 1)
+    {
+      testEndMessage(true, "%u hits, %u misses", (unsigned)hits, (unsigned)misses);
+    }
+    else
+    {
+      testEndMessage(false, "%u hits, %u misses", (unsigned)hits, (unsigned)misses);
+      errors ++;
+    }
+
+    ttfSetExtentsCache(font, 0);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetPixelExtents(12, \"%s\")", strings[0]);
+  if (ttfGetPixelExtents(font, 12, strings[0], &extents) && extents.left == 0.0f && extents.right == (int)extents.right && fabs(extents.right - (sextents[0].right - sextents[0].left)) <= strlen(strings[0]) && extents.top > 0.0f && extents.bottom <= 0.0f)
+  {
+    testEndMessage(true, "%.0f %.0f %.0f %.0f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected width %.1f", extents.left, extents.bottom, extents.right, extents.top, sextents[0].right - sextents[0].left);
+    errors ++;
+  }
+
+  testBegin("ttfGetInkExtents(\"%s\")", strings[0]);
+  if (ttfGetInkExtents(font, 12.0f, strings[0], &extents) && extents.right > extents.left && extents.top > 0.0f && extents.top <= sextents[0].top && extents.bottom >= sextents[0].bottom && extents.right <= (sextents[0].right - sextents[0].left))
+  {
+    testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "got %.1f %.1f %.1f %.1f, font extents %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, sextents[0].left, sextents[0].bottom, sextents[0].right, sextents[0].top);
+    errors ++;
+  }
+
+  testBegin("ttfGetVerticalExtents(\"%s\")", strings[0]);
+  num_glyphs = ttfGetGlyphs(font, strings[0], 0, glyphs, sizeof(glyphs) / sizeof(glyphs[0]));
+  for (j = 0, intvalue = 0; j < num_glyphs; j ++)
+    intvalue += ttfGetGlyphVerticalAdvance(font, glyphs[j]);
+
+  if (ttfGetVerticalExtents(font, 12.0f, strings[0], &extents) && extents.right > 0.0f && extents.left == -extents.right && intvalue > 0 && fabs(extents.bottom + 0.012 * intvalue) <= 0.012 * num_glyphs)
+  {
+    testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "got %.1f %.1f %.1f %.1f, advances %d", extents.left, extents.bottom, extents.right, extents.top, intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfSetLigatures(true)");
+  if (ttfSetLigatures(font, true))
+  {
+    testEnd(true);
+
+    testBegin("ttfGetExtents(\"%s\", ligatures)", strings[0]);
+    if (ttfGetExtents(font, 12.0f, strings[0], &extents) && !memcmp(&extents, sextents, sizeof(extents)))
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+    }
+    else
+    {
+      testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, sextents[0].left, sextents[0].bottom, sextents[0].right, sextents[0].top);
+      errors ++;
+    }
+
+    testBegin("ttfGetExtents(\"office\", ligatures)");
+    if (ttfGetExtents(font, 12.0f, "office", &extents) && extents.right > extents.left)
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+    }
+    else
+    {
+      testEndMessage(false, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+      errors ++;
+    }
+
+    ttfSetLigatures(font, false);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetCaretPositions(\"%s\")", strings[0]);
+  if ((num_carets = ttfGetCaretPositions(font, 12.0f, strings[0], sizeof(carets) / sizeof(carets[0]), carets, NULL)) == (strlen(strings[0]) + 1) && carets[0] == 0.0f && fabs(carets[num_carets - 1] - (skextents[0].right - skextents[0].left)) < 0.01)
+  {
+    testEndMessage(true, "%u positions, %.1f wide", (unsigned)num_carets, carets[num_carets - 1]);
+
+    testBegin("ttfFindCaret");
+    for (j = 0; j < num_carets; j ++)
+    {
+      if (ttfFindCaret(carets, num_carets, carets[j] + 0.1f) != j)
+        break;
+    }
+
+    if (j < num_carets)
+    {
+      testEndMessage(false, "got %u for position %u", (unsigned)ttfFindCaret(carets, num_carets, carets[j] + 0.1f), (unsigned)j);
+      errors ++;
+    }
+    else if (ttfFindCaret(carets, num_carets, -1.0f) != 0 || ttfFindCaret(carets, num_carets, 1000.0f) != (num_carets - 1))
+    {
+      testEndMessage(false, "bad position for out-of-range x");
+      errors ++;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+  else
+  {
+    testEndMessage(false, "%u positions, %.1f wide", (unsigned)num_carets, num_carets > 0 ? carets[num_carets - 1] : 0.0f);
+    errors ++;
+  }
+
+  testBegin("ttfMeasureCreate");
+  if ((measure = ttfMeasureCreate(font, 12.0f, /*kerned*/true)) != NULL)
+  {
+    testEnd(true);
+
+    for (i = 0; i < (int)(sizeof(strings) / sizeof(strings[0])); i ++)
+    {
+      // Add the string one byte at a time to split UTF-8 sequences...
+      testBegin("ttfMeasureAdd(\"%s\")", strings[i]);
+      ttfMeasureReset(measure);
+
+      for (value = strings[i]; *value; value ++)
+      {
+        if (!ttfMeasureAdd(measure, value, 1))
+          break;
+      }
+
+      if (*value)
+      {
+        testEndMessage(false, "failed at offset %u", (unsigned)(value - strings[i]));
+        errors ++;
+      }
+      else if (ttfMeasureGetExtents(measure, &extents) && fabs(extents.left - skextents[i].left) < 0.01 && fabs(extents.right - skextents[i].right) < 0.01 && extents.bottom == skextents[i].bottom && extents.top == skextents[i].top)
+      {
+        testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+      }
+      else
+      {
+	testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, skextents[i].left, skextents[i].bottom, skextents[i].right, skextents[i].top);
+	errors ++;
+      }
+    }
+
+    ttfMeasureDelete(measure);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetBlockExtents");
+  if ((num_lines = ttfGetBlockExtents(font, 12.0f, "Hello, World!\r\n\tHello, World!\n", 0.0f, /*kerned*/true, &extents, sizeof(lines) / sizeof(lines[0]), lines)) == 2 && lines[0].start == 0 && lines[0].end == 13 && fabs(lines[0].width - (skextents[0].right - skextents[0].left)) < 0.01 && lines[1].start == 15 && lines[1].end == 29 && lines[1].width > lines[0].width && extents.right == lines[1].width && fabs(extents.top - extents.bottom - 12.0f * ttfGetLineHeight(font) / 1000.0f - (sextents[0].top - sextents[0].bottom)) < 0.1)
+  {
+    testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "%u lines, %.1f %.1f %.1f %.1f", (unsigned)num_lines, extents.left, extents.bottom, extents.right, extents.top);
+    errors ++;
+  }
+
+  // The line height is the sum of the hhea or typographic ascent, descent, and
+  // line gap...
+  testBegin("ttfGetLineGap");
+  if ((intvalue = ttfGetLineGap(font)) >= 0 && (abs(ttfGetLineHeight(font) - (ttfGetAscent(font) - ttfGetDescent(font) + intvalue)) <= 2 || (intvalue == ttfGetTypoLineGap(font) && abs(ttfGetLineHeight(font) - (ttfGetTypoAscent(font) - ttfGetTypoDescent(font) + intvalue)) <= 2)))
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetLineHeight");
+  if ((intvalue = ttfGetLineHeight(font)) >= (ttfGetAscent(font) - ttfGetDescent(font)))
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetCellCount");
+  if ((j = ttfGetCellCount(strings[0])) == 13 && (j = ttfGetCellCount(strings[6])) == 16 && (j = ttfGetCellCount("Cafe\xCC\x81\t")) == 4 && (j = ttfGetCellCount("Caf\xE9 au lait")) == 3)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    testEndMessage(false, "got %u", (unsigned)j);
+    errors ++;
+  }
+
+  testBegin("ttfGetCellExtents(\"%s\")", strings[6]);
+  if (ttfGetCellExtents(font, 12.0f, strings[6], &extents) && fabs(extents.right - 16.0f * 12.0f * ttfGetWidth(font, '0') / 1000.0f) < 0.2)
+  {
+    testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+    errors ++;
+  }
+
+  testBegin("ttfGetRunExtents");
+  runs[0].font = font;
+  runs[0].size = 12.0f;
+  runs[0].s    = strings[0];
+  runs[0].len  = 7;
+  runs[1].font = font;
+  runs[1].size = 12.0f;
+  runs[1].s    = strings[0] + 7;
+  runs[1].len  = 0;
+
+  if (ttfGetRunExtents(runs, 2, /*kerned*/true, advances, &extents) && fabs(extents.right - skextents[0].right) < 0.01 && fabs(advances[0] + advances[1] - (skextents[0].right - skextents[0].left)) < 0.01 && extents.top > 0.0f && extents.bottom < 0.0f)
+  {
+    testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+  }
+  else
+  {
+    testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected right %.1f", extents.left, extents.bottom, extents.right, extents.top, skextents[0].right);
+    errors ++;
+  }
+
+  testBegin("ttfTextCreate(\"%s\")", strings[0]);
+  if ((text = ttfTextCreate(strings[0])) != NULL)
+  {
+    testEnd(true);
+
+    testBegin("ttfTextGetExtents");
+    if (ttfTextGetExtents(text, font, 12.0f, /*kerned*/false, &extents) && !memcmp(&extents, sextents + 0, sizeof(extents)))
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+    }
+    else
+    {
+      testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, sextents[0].left, sextents[0].bottom, sextents[0].right, sextents[0].top);
+      errors ++;
+    }
+
+    testBegin("ttfTextGetExtents(kerned)");
+    if (ttfTextGetExtents(text, font, 12.0f, /*kerned*/true, &extents) && fabs(extents.right - skextents[0].right) < 0.01)
+    {
+      testEndMessage(true, "%.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top);
+    }
+    else
+    {
+      testEndMessage(false, "got %.1f %.1f %.1f %.1f, expected %.1f %.1f %.1f %.1f", extents.left, extents.bottom, extents.right, extents.top, skextents[0].left, skextents[0].bottom, skextents[0].right, skextents[0].top);
+      errors ++;
+    }
+
+    testBegin("ttfTextGetFitSize");
+    if (fabs((realvalue = ttfTextGetFitSize(text, font, /*kerned*/true, 2.0f * (skextents[0].right - skextents[0].left), 0.0f)) - 24.0f) < 0.01)
+    {
+      testEndMessage(true, "%.2f", realvalue);
+    }
+    else
+    {
+      testEndMessage(false, "got %.2f, expected 24.00", realvalue);
+      errors ++;
+    }
+
+    testBegin("ttfTextGetGlyphs");
+    if (ttfTextGetGlyphs(text, font, &j) != NULL && j == strlen(strings[0]))
+    {
+      testEndMessage(true, "%u glyphs", (unsigned)j);
+    }
+    else
+    {
+      testEndMessage(false, "%u glyphs", (unsigned)j);
+      errors ++;
+    }
+
+    ttfTextDelete(text);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfTextCreate(\"Caf\\xE9 au lait\")");
+  if ((text = ttfTextCreate("Caf\xE9 au lait")) != NULL && ttfTextGetGlyphs(text, font, &j) != NULL && j == 3)
+  {
+    testEndMessage(true, "%u glyphs", (unsigned)j);
+  }
+  else
+  {
+    testEndMessage(false, "%u glyphs, expected 3", text ? (unsigned)j : 0);
+    errors ++;
+  }
+
+  ttfTextDelete(text);
+
+  for (wrap = TTF_WRAP_GREEDY; wrap <= TTF_WRAP_OPTIMAL; wrap ++)
+  {
+    testBegin("ttfBreakLines(%s)", wrap == TTF_WRAP_GREEDY ? "TTF_WRAP_GREEDY" : "TTF_WRAP_OPTIMAL");
+    if ((num_lines = ttfBreakLines(font, 12.0f, paragraph, 144.0f, wrap, sizeof(lines) / sizeof(lines[0]), lines)) > 2 && num_lines <= (sizeof(lines) / sizeof(lines[0])))
+    {
+      for (j = 0; j < num_lines; j ++)
+      {
+        if (lines[j].width > 144.0f || lines[j].start >= lines[j].end || lines[j].end > strlen(paragraph) || (j > 0 && lines[j].start < lines[j - 1].end))
+          break;
+      }
+
+      if (j < num_lines)
+      {
+	testEndMessage(false, "bad line %u: %u to %u, %.1f wide", (unsigned)j + 1, (unsigned)lines[j].start, (unsigned)lines[j].end, lines[j].width);
+	errors ++;
+      }
+      else
+      {
+	testEndMessage(true, "%u lines", (unsigned)num_lines);
+      }
+    }
+    else
+    {
+      testEndMessage(false, "%u lines", (unsigned)num_lines);
+      errors ++;
+    }
+  }
+
+  testBegin("ttfGetFamily");
+  if ((value = ttfGetFamily(font)) != NULL)
+  {
+    testEndMessage(true, "%s", value);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetItalicAngle");
+  if ((realvalue = ttfGetItalicAngle(font)) >= -180.0 && realvalue <= 180.0)
+  {
     testEndMessage(true, "%g", realvalue);
   }
   else
   {
-    testEndMessage(false, "%g", realvalue);
+    testEndMessage(false, "%g", realvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetNumFonts");
+  if ((num_fonts = ttfGetNumFonts(font)) > 0)
+  {
+    testEndMessage(true, "%u", (unsigned)num_fonts);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetPostScriptName");
+  if ((value = ttfGetPostScriptName(font)) != NULL)
+  {
+    testEndMessage(true, "%s", value);
+
+    strncpy(psname, value, sizeof(psname) - 1);
+    psname[sizeof(psname) - 1] = '\0';
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetStretch");
+  if ((intvalue = (int)ttfGetStretch(font)) >= TTF_STRETCH_NORMAL && intvalue <= TTF_STRETCH_ULTRA_EXPANDED)
+  {
+    testEndMessage(true, "%s", stretches[intvalue]);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetStyle");
+  if ((style = ttfGetStyle(font)) >= TTF_STYLE_NORMAL && style <= TTF_STYLE_OBLIQUE)
+  {
+    testEndMessage(true, "%s", styles[style]);
+  }
+  else
+  {
+    testEndMessage(false, "Unknown/%d", style);
+    errors ++;
+  }
+
+  testBegin("ttfGetVariation");
+  axes          = ttfGetAxes(font, &num_axes);
+  num_instances = ttfGetNumInstances(font);
+
+  if (num_axes == 0)
+  {
+    // Static fonts are their own default instance...
+    if (!axes && num_instances == 0 && ttfGetVariation(font, NULL, 0) == font)
+    {
+      testEndMessage(true, "no axes");
+    }
+    else
+    {
+      testEnd(false);
+      errors ++;
+    }
+  }
+  else
+  {
+    // Named instances are cached...
+    for (j = 0; j < num_instances; j ++)
+    {
+      if ((instance = ttfGetInstance(font, j)) == NULL || ttfGetInstance(font, j) != instance || ttfGetWidth(instance, ' ') <= 0)
+        break;
+    }
+
+    if (j >= num_instances)
+    {
+      testEndMessage(true, "%u axes, %u instances", (unsigned)num_axes, (unsigned)num_instances);
+    }
+    else
+    {
+      testEndMessage(false, "instance %u", (unsigned)j);
+      errors ++;
+    }
+  }
+
+  testBegin("ttfGetVersion");
+  if ((value = ttfGetVersion(font)) != NULL)
+  {
+    testEndMessage(true, "%s", value);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetWeight");
+  if ((weight = ttfGetWeight(font)) >= 0)
+  {
+    testEndMessage(true, "%u", (unsigned)weight);
+  }
+  else
+  {
+    testEnd(false);
+    errors ++;
+  }
+
+  testBegin("ttfGetWidth(' ')");
+
+  if ((intvalue = ttfGetWidth(font, ' ')) > 0)
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfGetXHeight");
+  if ((intvalue = ttfGetXHeight(font)) > 0)
+  {
+    testEndMessage(true, "%d", intvalue);
+  }
+  else
+  {
+    testEndMessage(false, "%d", intvalue);
+    errors ++;
+  }
+
+  testBegin("ttfIsFixedPitch");
+  testEndMessage(true, "%s", ttfIsFixedPitch(font) ? "true" : "false");
+
+  // Return immediately if we don't have the original filename...
+  if (!filename)
+    return (errors);
+
+  // Delete the first font and try getting it from memory...
+  ttfDelete(font);
+  font = NULL;
+
+  // Now copy the font to memory and open it that way...
+  testBegin("fopen(\"%s\", \"rb\")", filename);
+  if ((fp = fopen(filename, "rb")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    errors ++;
+  }
+  else
+  {
+    testEndMessage(true, "%d", fileno(fp));
+    testBegin("fstat(%d)", fileno(fp));
+    if (fstat(fileno(fp), &fileinfo))
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      errors ++;
+    }
+    else
+    {
+      testEndMessage(true, "%lu bytes", (unsigned long)fileinfo.st_size);
+
+      testBegin("malloc(%lu)", (unsigned long)fileinfo.st_size);
+      if ((data = malloc((size_t)fileinfo.st_size)) == NULL)
+      {
+	testEndMessage(false, "%s", strerror(errno));
+	errors ++;
+      }
+      else
+      {
+	testEnd(true);
+        testBegin("fread(%lu)", (unsigned long)fileinfo.st_size);
+        if (fread(data, (size_t)fileinfo.st_size, 1, fp) != 1)
+        {
+	  testEndMessage(false, "%s", strerror(errno));
+	  errors ++;
+        }
+        else
+        {
+          testEnd(true);
+          testBegin("ttfCreateData()");
+          if ((font = ttfCreateData(data, (size_t)fileinfo.st_size, /*idx*/0, error_cb, /*err_data*/NULL)) == NULL)
+          {
+            errors ++;
+          }
+          else
+          {
+            testEnd(true);
+
+	    testBegin("ttfGetPostScriptName");
+	    if ((value = ttfGetPostScriptName(font)) != NULL)
+	    {
+	      if (!strcmp(value, psname))
+	      {
+		testEndMessage(true, "%s", value);
+	      }
+	      else
+	      {
+		testEndMessage(false, "got \"%s\", expected \"%s\"", value, psname);
+		errors ++;
+	      }
+	    }
+	    else
+	    {
+	      testEnd(false);
+	      errors ++;
+	    }
+          }
+        }
+      }
+    }
+
+    if (fp)
+      fclose(fp);
+
+    free(data);
+
+    ttfDelete(font);
+  }
+
+  return (errors);
+}
+
+
+//
+// 'test_hdmx()' - Test the device metrics of a font.
+//
+// The test font has an "hdmx" record for 12 pixels per em with each advance
+// width one pixel wider than the rounded scaled advance, and a "VDMX" table
+// with a maximum of 11 pixels and a minimum of -4 pixels at 12 pixels per
+// em.  There are no device metrics for 13 pixels per em.
+//
+
+static int				// O - Number of errors
+test_hdmx(const char *filename)		// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  ttf_rect_t	extents;		// Pixel extents of "Hello"
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  // "Hello" is 29 pixels wide at 12 pixels per em without device metrics...
+  testBegin("ttfGetPixelExtents(12, \"Hello\")");
+  if (ttfGetPixelExtents(font, 12, "Hello", &extents) && extents.left == 0.0f && extents.right == 34.0f && extents.top == 11.0f && extents.bottom == -4.0f)
+  {
+    testEndMessage(true, "%g %g %g %g", extents.left, extents.top, extents.right, extents.bottom);
+  }
+  else
+  {
+    testEndMessage(false, "%g %g %g %g, expected 0 11 34 -4", extents.left, extents.top, extents.right, extents.bottom);
+    errors ++;
+  }
+
+  testBegin("ttfGetPixelExtents(13, \"Hello\")");
+  if (ttfGetPixelExtents(font, 13, "Hello", &extents) && extents.left == 0.0f && extents.right == 31.0f && extents.top == 14.0f && extents.bottom == -4.0f)
+  {
+    testEndMessage(true, "%g %g %g %g", extents.left, extents.top, extents.right, extents.bottom);
+  }
+  else
+  {
+    testEndMessage(false, "%g %g %g %g, expected 0 14 31 -4", extents.left, extents.top, extents.right, extents.bottom);
+    errors ++;
+  }
+
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_kerning()' - Test kerning with a font containing a "kern" table.
+//
+// The test font has the following kerning pairs in a format 0 subtable, in
+// units of 1/2048th:
+//
+//   A T -150
+//   A V -120
+//   A W -80
+//   T o -200
+//   V A -120
+//   W A -80
+//
+
+static int				// O - Number of errors
+test_kerning(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  ttf_rect_t	extents,		// Unkerned extents
+		kextents;		// Kerned extents
+  size_t	num_adjs;		// Number of kerning adjustments
+  double	adjs[10];		// Kerning adjustments
+  FILE		*fp;			// Font file
+  unsigned char	*data = NULL,		// Font data
+		*entry;			// Table directory entry
+  long		data_size = 0;		// Size of font data
+  unsigned	i,			// Looping var
+		num_tables;		// Number of tables
+  char		message[256];		// Error message
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  // Kerned widths at 2048 points are in font units...
+  testBegin("ttfGetKernedExtents(\"AVAT To\")");
+  ttfGetExtents(font, 2048.0f, "AVAT To", &extents);
+  if ((num_adjs = ttfGetKernedExtents(font, 2048.0f, "AVAT To", &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs)) == 6 && adjs[0] == -120.0 && adjs[1] == -120.0 && adjs[2] == -150.0 && adjs[3] == 0.0 && adjs[4] == 0.0 && adjs[5] == -200.0 && fabs(kextents.right - extents.right + 590.0) < 0.01)
+  {
+    testEndMessage(true, "%g %g %g %g %g %g", adjs[0], adjs[1], adjs[2], adjs[3], adjs[4], adjs[5]);
+  }
+  else
+  {
+    testEndMessage(false, "%u adjustments, width %g, expected %g", (unsigned)num_adjs, kextents.right - kextents.left, extents.right - extents.left - 590.0);
+    errors ++;
+  }
+
+  testBegin("ttfGetKernedExtents(\"WAW\")");
+  if ((num_adjs = ttfGetKernedExtents(font, 1024.0f, "WAW", &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs)) == 2 && adjs[0] == -40.0 && adjs[1] == -40.0)
+  {
+    testEndMessage(true, "%g %g", adjs[0], adjs[1]);
+  }
+  else
+  {
+    testEndMessage(false, "%u adjustments", (unsigned)num_adjs);
+    errors ++;
+  }
+
+  ttfDelete(font);
+
+  // Truncate the "kern" table in a copy of the font...
+  testBegin("truncated kern table");
+  if ((fp = fopen(filename, "rb")) != NULL)
+  {
+    fseek(fp, 0, SEEK_END);
+    data_size = ftell(fp);
+    rewind(fp);
+
+    if (data_size > 12 && (data = malloc((size_t)data_size)) != NULL && fread(data, (size_t)data_size, 1, fp) != 1)
+    {
+      free(data);
+      data = NULL;
+    }
+
+    fclose(fp);
+  }
+
+  for (i = 0, entry = NULL, num_tables = data ? (unsigned)((data[4] << 8) | data[5]) : 0; i < num_tables && 12 + 16 * (long)(i + 1) <= data_size; i ++)
+  {
+    if (!memcmp(data + 12 + 16 * i, "kern", 4))
+    {
+      entry = data + 12 + 16 * i;
+      break;
+    }
+  }
+
+  if (!entry)
+  {
+    testEndMessage(false, "unable to find kern table");
+    errors ++;
+  }
+  else
+  {
+    testEnd(true);
+
+    // A table too short for a kerning subtable is ignored...
+    entry[12] = entry[13] = entry[14] = 0;
+    entry[15] = 10;
+
+    testBegin("ttfCreateData(kern length 10)");
+    message[0] = '\0';
+    if ((font = ttfCreateData(data, (size_t)data_size, /*idx*/0, (ttf_err_cb_t)error_copy_cb, message)) != NULL && (num_adjs = ttfGetKernedExtents(font, 2048.0f, "AVAT", &kextents, sizeof(adjs) / sizeof(adjs[0]), adjs)) == 3 && adjs[0] == 0.0 && adjs[1] == 0.0 && adjs[2] == 0.0)
+    {
+      testEnd(true);
+    }
+    else
+    {
+      testEndMessage(false, "%s", font ? "kerned" : message);
+      errors ++;
+    }
+
+    ttfDelete(font);
+
+    // A subtable whose pairs extend past the end of the table is an error...
+    entry[15] = 20;
+
+    testBegin("ttfCreateData(kern length 20)");
+    message[0] = '\0';
+    if ((font = ttfCreateData(data, (size_t)data_size, /*idx*/0, (ttf_err_cb_t)error_copy_cb, message)) == NULL && !strcmp(message, "Truncated kern subtable."))
+    {
+      testEndMessage(true, "%s", message);
+    }
+    else
+    {
+      testEndMessage(false, "%s", font ? "loaded" : message);
+      errors ++;
+    }
+
+    ttfDelete(font);
+  }
+
+  free(data);
+
+  return (errors);
+}
+
+
+//
+// 'test_ligatures()' - Test standard ligatures.
+//
+// The test font has a "GSUB" table with "liga" ligatures for "ff", "fi",
+// "fl", "ffi", and "ffl".  The "ff" ligature is 1 unit wider than two "f"s
+// and the "ffi" ligature is 3 units wider than "f", "f", and "i", while the
+// "fi" ligature is the same width as "f" and "i".
+//
+
+static int				// O - Number of errors
+test_ligatures(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  size_t	i;			// Looping var
+  int		count;			// Number of errors reported
+  ttf_rect_t	extents,		// Extents without ligatures
+		lextents;		// Extents with ligatures
+  static const struct
+  {
+    const char	*s;			// String
+    float	width,			// Width without ligatures
+		lwidth;			// Width with ligatures
+  }		strings[] =		// Test strings
+  {
+    { "office", 5267.0f, 5270.0f },
+    { "fluff", 3857.0f, 3858.0f },
+    { "fifi", 2424.0f, 2424.0f }
+  };
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
+  }
+  else
+  {
+    return (1);
+  }
+
+  // Widths at 2048 points are in font units...
+  for (i = 0; i < (sizeof(strings) / sizeof(strings[0])); i ++)
+  {
+    testBegin("ttfGetExtents(\"%s\", ligatures)", strings[i].s);
+
+    ttfSetLigatures(font, true);
+    ttfGetExtents(font, 2048.0f, strings[i].s, &lextents);
+    ttfSetLigatures(font, false);
+    ttfGetExtents(font, 2048.0f, strings[i].s, &extents);
+
+    if ((lextents.right - lextents.left) == strings[i].lwidth && (extents.right - extents.left) == strings[i].width)
+    {
+      testEndMessage(true, "%g %g", lextents.right - lextents.left, extents.right - extents.left);
+    }
+    else
+    {
+      testEndMessage(false, "%g %g, expected %g %g", lextents.right - lextents.left, extents.right - extents.left, strings[i].lwidth, strings[i].width);
+      errors ++;
+    }
+  }
+
+  ttfDelete(font);
+
+  // Invalid UTF-8 after a ligature candidate should only be reported once...
+  testBegin("ttfGetExtents(\"of\\377ice\", ligatures)");
+  if ((font = ttfCreate(filename, 0, (ttf_err_cb_t)error_count_cb, &count)) != NULL)
+  {
+    count = 0;
+
+    ttfSetLigatures(font, true);
+    ttfGetExtents(font, 2048.0f, "of\377ice", &lextents);
+
+    if (count == 1)
+    {
+      testEnd(true);
+    }
+    else
+    {
+      testEndMessage(false, "%d errors reported, expected 1", count);
+      errors ++;
+    }
+
+    ttfDelete(font);
+  }
+  else
+  {
+    testEnd(false);
     errors ++;
   }
 
-  testBegin("ttfGetNumFonts");
-  if ((num_fonts = ttfGetNumFonts(font)) > 0)
+  return (errors);
+}
+
+
+//
+// 'test_metrics()' - Test the line metrics of Open Sans.
+//
+// Open Sans has an "hhea" ascender of 2189, descender of -600, and line gap
+// of 0, and "OS/2" typographic values of 1567, -492, and 132, in units of
+// 1/2048th.  The typographic metrics are not used for the line height.
+//
+
+static int				// O - Number of errors
+test_metrics(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  int		values[7];		// Metric values
+  static const int expected[7] =	// Expected values
   {
-    testEndMessage(true, "%u", (unsigned)num_fonts);
+    1068, -292, 0, 1361, 765, -240, 64
+  };
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
   }
   else
   {
-    testEnd(false);
-    errors ++;
+    return (1);
   }
 
-  testBegin("ttfGetPostScriptName");
-  if ((value = ttfGetPostScriptName(font)) != NULL)
-  {
-    testEndMessage(true, "%s", value);
+  testBegin("ttfGetLineGap/ttfGetLineHeight");
+  values[0] = ttfGetAscent(font);
+  values[1] = ttfGetDescent(font);
+  values[2] = ttfGetLineGap(font);
+  values[3] = ttfGetLineHeight(font);
+  values[4] = ttfGetTypoAscent(font);
+  values[5] = ttfGetTypoDescent(font);
+  values[6] = ttfGetTypoLineGap(font);
 
-    strncpy(psname, value, sizeof(psname) - 1);
-    psname[sizeof(psname) - 1] = '\0';
+  if (!memcmp(values, expected, sizeof(values)))
+  {
+    testEndMessage(true, "%d %d %d %d %d %d %d", values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
   }
   else
   {
-    testEnd(false);
+    testEndMessage(false, "%d %d %d %d %d %d %d, expected %d %d %d %d %d %d %d", values[0], values[1], values[2], values[3], values[4], values[5], values[6], expected[0], expected[1], expected[2], expected[3], expected[4], expected[5], expected[6]);
     errors ++;
   }
 
-  testBegin("ttfGetStretch");
-  if ((intvalue = (int)ttfGetStretch(font)) >= TTF_STRETCH_NORMAL && intvalue <= TTF_STRETCH_ULTRA_EXPANDED)
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_render()' - Test rendering a glyph with known coverage.
+//
+// The "l" in Open Sans Regular is a rectangle from (176,0) to (342,1556) in
+// font units.  At 128 pixels per em (16 units per pixel) with the pen at
+// (0,100) that is columns 11 to 21.375 and rows 2.75 to 100, so columns 11
+// to 20 of rows 3 to 99 are fully covered, column 21 is 3/8 covered, and row
+// 2 is 1/4 covered.
+//
+
+static int				// O - Number of errors
+test_render(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  int		glyph,			// Glyph for "l"
+		x, y;			// Looping vars
+  unsigned	ink,			// Sum of coverage values
+		expected;		// Expected coverage value
+  static unsigned char pixels[112][32];	// Glyph bitmap
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
   {
-    testEndMessage(true, "%s", stretches[intvalue]);
+    testEnd(true);
   }
   else
   {
-    testEndMessage(false, "%d", intvalue);
-    errors ++;
+    return (1);
   }
 
-  testBegin("ttfGetStyle");
-  if ((style = ttfGetStyle(font)) >= TTF_STYLE_NORMAL && style <= TTF_STYLE_OBLIQUE)
+  testBegin("ttfRenderGlyph(\"l\")");
+  ttfGetGlyphs(font, "l", 0, &glyph, 1);
+  memset(pixels, 0, sizeof(pixels));
+
+  if (ttfRenderGlyph(font, 128.0f, glyph, pixels[0], 32, 112, 32, 0.0f, 100.0f))
   {
-    testEndMessage(true, "%s", styles[style]);
+    for (y = 0, ink = 0; y < 112; y ++)
+    {
+      for (x = 0; x < 32; x ++)
+      {
+        ink += pixels[y][x];
+
+        if (x < 11 || x > 21 || y < 2 || y > 99)
+          expected = 0;
+        else if (x == 21 && y == 2)
+          expected = 24;
+        else if (x == 21)
+          expected = 96;
+        else if (y == 2)
+          expected = 64;
+        else
+          expected = 255;
+
+        if (pixels[y][x] != expected)
+          break;
+      }
+
+      if (x < 32)
+        break;
+    }
+
+    if (y < 112)
+    {
+      testEndMessage(false, "pixel (%d,%d) is %u, expected %u", x, y, pixels[y][x], expected);
+      errors ++;
+    }
+    else if (ink != 257326)
+    {
+      testEndMessage(false, "%u total coverage, expected 257326", ink);
+      errors ++;
+    }
+    else
+    {
+      testEndMessage(true, "%.2f pixels of ink", ink / 255.0);
+    }
   }
   else
   {
-    testEndMessage(false, "Unknown/%d", style);
+    testEnd(false);
     errors ++;
   }
 
-  testBegin("ttfGetVersion");
-  if ((value = ttfGetVersion(font)) != NULL)
+  ttfDelete(font);
+
+  return (errors);
+}
+
+
+//
+// 'test_variation()' - Test a variable font.
+//
+// The test font has a "wght" axis from 300 to 700 (default 400), named
+// instances at 300 and 700, an "avar" table mapping 0.5 to 0.6, an "HVAR"
+// table that adds 50 units to every advance at 700 and subtracts 30 at 300,
+// and an "MVAR" table that adds 20 units to the cap height and 10 units to
+// the ascent at 700.
+//
+
+static int				// O - Number of errors
+test_variation(const char *filename)	// I - Font filename
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font,			// Font
+		*instance;		// Variation instance
+  const ttf_axis_t *axes;		// Variation axes
+  size_t	i,			// Looping var
+		num_axes;		// Number of variation axes
+  float		wght;			// Weight coordinate
+  ttf_rect_t	extents;		// Extents of "A"
+  static const float weights[3][2] =	// Weights and advance of "A"
   {
-    testEndMessage(true, "%s", value);
+    { 300.0f, 1266.0f },
+    { 550.0f, 1326.0f },		// avar maps 0.5 to 0.6
+    { 700.0f, 1346.0f }
+  };
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
   }
   else
   {
-    testEnd(false);
+    return (1);
+  }
+
+  testBegin("ttfGetAxes");
+  if ((axes = ttfGetAxes(font, &num_axes)) != NULL && num_axes == 1 && !strcmp(axes[0].tag, "wght") && axes[0].min_value == 300.0f && axes[0].default_value == 400.0f && axes[0].max_value == 700.0f && ttfGetNumInstances(font) == 2)
+  {
+    testEndMessage(true, "%s %g %g %g", axes[0].tag, axes[0].min_value, axes[0].default_value, axes[0].max_value);
+  }
+  else
+  {
+    testEndMessage(false, "%u axes, %u instances", (unsigned)num_axes, (unsigned)ttfGetNumInstances(font));
     errors ++;
   }
 
-  testBegin("ttfGetWeight");
-  if ((weight = ttfGetWeight(font)) >= 0)
+  testBegin("ttfGetVariation(wght=400)");
+  wght = 400.0f;
+  if (ttfGetVariation(font, &wght, 1) == font)
   {
-    testEndMessage(true, "%u", (unsigned)weight);
+    testEnd(true);
   }
   else
   {
-    testEnd(false);
+    testEndMessage(false, "default instance is not the font");
     errors ++;
   }
 
-  testBegin("ttfGetWidth(' ')");
+  for (i = 0; i < (sizeof(weights) / sizeof(weights[0])); i ++)
+  {
+    testBegin("ttfGetVariation(wght=%g)", weights[i][0]);
+    if ((instance = ttfGetVariation(font, weights[i], 1)) != NULL && instance != font && ttfGetExtents(instance, 2048.0f, "A", &extents) && extents.right == weights[i][1] && ttfGetVariation(font, weights[i], 1) == instance)
+    {
+      testEndMessage(true, "advance %g", extents.right);
+    }
+    else
+    {
+      testEndMessage(false, "advance %g, expected %g", instance ? extents.right : 0.0f, weights[i][1]);
+      errors ++;
+    }
+  }
 
-  if ((intvalue = ttfGetWidth(font, ' ')) > 0)
+  testBegin("ttfGetInstance");
+  if ((instance = ttfGetInstance(font, 0)) != NULL && instance == ttfGetVariation(font, weights[0], 1) && ttfGetWeight(instance) == TTF_WEIGHT_300 && (instance = ttfGetInstance(font, 1)) != NULL && instance == ttfGetVariation(font, weights[2], 1) && ttfGetWeight(instance) == TTF_WEIGHT_700)
   {
-    testEndMessage(true, "%d", intvalue);
+    testEnd(true);
   }
   else
   {
-    testEndMessage(false, "%d", intvalue);
+    testEndMessage(false, "named instances not cached");
     errors ++;
   }
 
-  testBegin("ttfGetXHeight");
-  if ((intvalue = ttfGetXHeight(font)) > 0)
+  testBegin("ttfGetCapHeight/ttfGetAscent(wght=700)");
+  if ((instance = ttfGetVariation(font, weights[2], 1)) != NULL && ttfGetCapHeight(font) == 1068 && ttfGetCapHeight(instance) == 1078 && ttfGetAscent(font) == 1068 && ttfGetAscent(instance) == 1073)
   {
-    testEndMessage(true, "%d", intvalue);
+    testEndMessage(true, "%d %d", ttfGetCapHeight(instance), ttfGetAscent(instance));
   }
   else
   {
-    testEndMessage(false, "%d", intvalue);
+    testEndMessage(false, "%d %d", instance ? ttfGetCapHeight(instance) : 0, instance ? ttfGetAscent(instance) : 0);
     errors ++;
   }
 
-  testBegin("ttfIsFixedPitch");
-  testEndMessage(true, "%s", ttfIsFixedPitch(font) ? "true" : "false");
+  ttfDelete(font);
 
-  // Return immediately if we don't have the original filename...
-  if (!filename)
-    return (errors);
+  return (errors);
+}
 
-  // Delete the first font and try getting it from memory...
-  ttfDelete(font);
-  font = NULL;
 
-  // Now copy the font to memory and open it that way...
-  testBegin("fopen(\"%s\", \"rb\")", filename);
-  if ((fp = fopen(filename, "rb")) == NULL)
+//
+// 'test_vertical()' - Test a font with vertical metrics.
+//
+// The test fonts have a "vhea" table and a "vmtx" table with 50 long
+// metrics - glyph N has an advance height of 2048+N units and a top side
+// bearing of 100+N units, and the remaining glyphs have an advance height of
+// 2097 units and a top side bearing of 200 units.  The "VORG" test font adds
+// a default vertical origin of 1900 units, 1800 units for glyph 5 ('"'), and
+// 1700 units for glyph 60 ('Y').
+//
+
+static int				// O - Number of errors
+test_vertical(const char *filename,	// I - Font filename
+              bool       vorg)		// I - Font has a "VORG" table?
+{
+  int		errors = 0;		// Number of errors
+  ttf_t		*font;			// Font
+  ttf_rect_t	extents;		// Vertical extents of "Aa"
+  int		origins[4];		// Vertical origins
+  static const int glyphs[4] =		// Glyphs for '"', 'A', 'Y', and 'a'
   {
-    testEndMessage(false, "%s", strerror(errno));
-    errors ++;
+    5, 36, 60, 68
+  };
+  static const int vorigins[2][4] =	// Expected vertical origins
+  {
+    { 765, 783, 811, 641 },		// y_max + tsb
+    { 878, 927, 830, 927 }		// VORG
+  };
+
+
+  testBegin("ttfCreate(\"%s\")", filename);
+  if ((font = ttfCreate(filename, 0, error_cb, NULL)) != NULL)
+  {
+    testEnd(true);
   }
   else
   {
-    testEndMessage(true, "%d", fileno(fp));
-    testBegin("fstat(%d)", fileno(fp));
-    if (fstat(fileno(fp), &fileinfo))
-    {
-      testEndMessage(false, "%s", strerror(errno));
-      errors ++;
-    }
-    else
-    {
-      testEndMessage(true, "%lu bytes", (unsigned long)fileinfo.st_size);
-
-      testBegin("malloc(%lu)", (unsigned long)fileinfo.st_size);
-      if ((data = malloc((size_t)fileinfo.st_size)) == NULL)
-      {
-	testEndMessage(false, "%s", strerror(errno));
-	errors ++;
-      }
-      else
-      {
-	testEnd(true);
-        testBegin("fread(%lu)", (unsigned long)fileinfo.st_size);
-        if (fread(data, (size_t)fileinfo.st_size, 1, fp) != 1)
-        {
-	  testEndMessage(false, "%s", strerror(errno));
-	  errors ++;
-        }
-        else
-        {
-          testEnd(true);
-          testBegin("ttfCreateData()");
-          if ((font = ttfCreateData(data, (size_t)fileinfo.st_size, /*idx*/0, error_cb, /*err_data*/NULL)) == NULL)
-          {
-            errors ++;
-          }
-          else
-          {
-            testEnd(true);
+    return (1);
+  }
 
-	    testBegin("ttfGetPostScriptName");
-	    if ((value = ttfGetPostScriptName(font)) != NULL)
-	    {
-	      if (!strcmp(value, psname))
-	      {
-		testEndMessage(true, "%s", value);
-	      }
-	      else
-	      {
-		testEndMessage(false, "got \"%s\", expected \"%s\"", value, psname);
-		errors ++;
-	      }
-	    }
-	    else
-	    {
-	      testEnd(false);
-	      errors ++;
-	    }
-          }
-        }
-      }
-    }
+  testBegin("ttfGetGlyphVerticalAdvance");
+  if (ttfGetGlyphVerticalAdvance(font, 36) == 1017 && ttfGetGlyphVerticalAdvance(font, 68) == 1023)
+  {
+    testEndMessage(true, "%d %d", ttfGetGlyphVerticalAdvance(font, 36), ttfGetGlyphVerticalAdvance(font, 68));
+  }
+  else
+  {
+    testEndMessage(false, "%d %d, expected 1017 1023", ttfGetGlyphVerticalAdvance(font, 36), ttfGetGlyphVerticalAdvance(font, 68));
+    errors ++;
+  }
 
-    if (fp)
-      fclose(fp);
+  origins[0] = ttfGetGlyphVerticalOrigin(font, glyphs[0]);
+  origins[1] = ttfGetGlyphVerticalOrigin(font, glyphs[1]);
+  origins[2] = ttfGetGlyphVerticalOrigin(font, glyphs[2]);
+  origins[3] = ttfGetGlyphVerticalOrigin(font, glyphs[3]);
 
-    free(data);
+  testBegin("ttfGetGlyphVerticalOrigin");
+  if (!memcmp(origins, vorigins[vorg], sizeof(origins)))
+  {
+    testEndMessage(true, "%d %d %d %d", origins[0], origins[1], origins[2], origins[3]);
+  }
+  else
+  {
+    testEndMessage(false, "%d %d %d %d, expected %d %d %d %d", origins[0], origins[1], origins[2], origins[3], vorigins[vorg][0], vorigins[vorg][1], vorigins[vorg][2], vorigins[vorg][3]);
+    errors ++;
+  }
 
-    ttfDelete(font);
+  // Vertical extents at 2048 points are in font units...
+  testBegin("ttfGetVerticalExtents(\"Aa\")");
+  if (ttfGetVerticalExtents(font, 2048.0f, "Aa", &extents) && extents.top == -136.0f && extents.bottom == -4181.0f && extents.left == -extents.right && extents.right > 0.0f)
+  {
+    testEndMessage(true, "%g %g %g %g", extents.left, extents.top, extents.right, extents.bottom);
+  }
+  else
+  {
+    testEndMessage(false, "%g %g %g %g, expected top -136 and bottom -4181", extents.left, extents.top, extents.right, extents.bottom);
+    errors ++;
   }
 
+  ttfDelete(font);
+
   return (errors);
 }
@@ -21,11 +21,12 @@
 // Constants...
 //
 
+#define TTF_CACHE_BYTE_ORDER	0x01020304
+					// Byte order marker
 #define TTF_CACHE_HEADER	"ttf-cache"
-					// Header/prefix string for first line
-#define TTF_CACHE_HEADERLEN	9	// Length of header string
+					// Magic string at start of file
 #define TTF_CACHE_MAX		65536	// Maximum number of cached fonts
-#define TTF_CACHE_VERSION	0	// Version number of cache format
+#define TTF_CACHE_VERSION	3	// Version number of cache format
 
 
 //
@@ -38,11 +39,46 @@ typedef struct _ttf_cfont_s		// Cached font
   char          *filename,              // Filename or URL
                 *family;                // Family
   size_t        idx;                    // Index inside collection
+  size_t        instance;               // Named instance number plus 1 or 0 for default instance
+  size_t	base;			// Index of base font plus 1 for named instances, if known
   ttf_stretch_t stretch;                // Stretch
   ttf_style_t   style;                  // Style
   ttf_weight_t  weight;                 // Weight
+  ttf_coverage_t *coverage;		// Character coverage
+  bool		mapped;			// Do the names and coverage point into the cache file?
 } _ttf_cfont_t;
 
+typedef struct _ttf_cheader_s		// Cache file header
+{
+  char		magic[10];		// "ttf-cache" and nul
+  unsigned short version;		// Version number of cache format
+  uint32_t	byte_order,		// Byte order marker
+		num_fonts,		// Number of fonts
+		num_pages,		// Number of coverage page bitsets
+		num_char_fonts,		// Number of inverted index entries
+		strings_size,		// Size of string table
+		reserved;		// Reserved (0)
+  uint32_t	font_index[256];	// Index for fonts
+  uint32_t	char_index[TTF_COVERAGE_PAGES + 1];
+					// First inverted index entry for each page of characters
+} _ttf_cheader_t;
+
+typedef struct _ttf_centry_s		// Cache file entry
+{
+  uint64_t	summary[TTF_COVERAGE_SUMMARY];
+					// Coverage page summary
+  uint32_t	filename,		// Offset of filename in string table
+		family,			// Offset of family name in string table
+		idx,			// Index inside collection
+		instance,		// Named instance number plus 1 or 0 for default instance
+		first_page,		// First coverage page bitset
+		num_pages;		// Number of coverage page bitsets
+  int32_t	stretch,		// Stretch
+		style,			// Style
+		weight,			// Weight
+		reserved;		// Reserved (0)
+} _ttf_centry_t;
+
 
 struct _ttf_cache_s			// Font cache
 {
@@ -53,6 +89,14 @@ struct _ttf_cache_s			// Font cache
 		alloc_fonts;		// Allocated cached fonts
   _ttf_cfont_t	*fonts;			// Cached fonts
   size_t	font_index[256];	// Index for fonts
+  size_t	char_index[TTF_COVERAGE_PAGES + 1];
+					// First entry in char_fonts for each page of characters
+  uint32_t	*char_fonts;		// Fonts covering each page of characters
+  bool		map_char_fonts;		// Does char_fonts point into the cache file?
+  void		*map_data;		// Mapped or loaded cache file, if any
+  size_t	map_size;		// Size of cache file
+  bool		map_mapped;		// Is the cache file memory-mapped?
+  ttf_coverage_t *map_coverages;	// Character coverage for fonts from the cache file
   char		current_name[1024];	// Current font filename
   size_t	current_index;		// Current font index
 };
@@ -62,20 +106,22 @@ struct _ttf_cache_s			// Font cache
 // Local functions...
 //
 
-static void	ttf_add_font(ttf_cache_t *cache, ttf_t *font, const char *filename, size_t idx, bool delete_it);
+static void	ttf_add_font(ttf_cache_t *cache, ttf_t *font, const char *filename, size_t idx, size_t instance, bool delete_it);
 static void	ttf_cache_err_cb(ttf_cache_t *cache, const char *message);
 static int	ttf_compare_fonts(_ttf_cfont_t *a, _ttf_cfont_t *b);
-static char	*ttf_gets(FILE *fp, char *buffer, size_t bufsize);
 static bool	ttf_load_cache(ttf_cache_t *cache);
 static time_t	ttf_load_fonts(ttf_cache_t *cache, const char *d, int depth, bool scanonly);
 static void	ttf_save_cache(ttf_cache_t *cache);
+static int	ttf_score_font(_ttf_cfont_t *font, ttf_style_t style, ttf_weight_t weight, ttf_stretch_t stretch);
 static void	ttf_sort_fonts(ttf_cache_t *cache);
+static void	ttf_unmap_cache(ttf_cache_t *cache);
 
 
 //
 // 'ttfCacheAdd()' - Add a font to the cache.
 //
-// This function adds the specified font to the cache.
+// This function adds the specified font to the cache.  The named instances of
+// a variable font on disk are added as separate entries.
 //
 // > **Note**: Once added, the cache takes over management of the font.  Do not
 // > call @link ttfDelete@ with the font pointer.  Instead, the font will be
@@ -98,7 +144,7 @@ ttfCacheAdd(ttf_cache_t *cache,		// I - Font cache
     size_t	i,			// Index
 		num_fonts;		// Number of fonts in a collection
 
-    ttf_add_font(cache, font, filename, /*idx*/0, /*delete_it*/false);
+    ttf_add_font(cache, font, filename, /*idx*/0, /*instance*/0, /*delete_it*/false);
 
     for (i = 1, num_fonts = ttfGetNumFonts(font); i < num_fonts; i ++)
     {
@@ -106,13 +152,13 @@ ttfCacheAdd(ttf_cache_t *cache,		// I - Font cache
       ttf_t *font_n = ttfCreate(filename, i, cache->err_cb, cache->err_cbdata);
 
       if (font_n)
-        ttf_add_font(cache, font_n, filename, /*idx*/i, /*delete_it*/false);
+        ttf_add_font(cache, font_n, filename, /*idx*/i, /*instance*/0, /*delete_it*/false);
     }
   }
   else
   {
     // Add an in-memory font...
-    ttf_add_font(cache, font, /*filename*/NULL, /*idx*/0, /*delete_it*/false);
+    ttf_add_font(cache, font, /*filename*/NULL, /*idx*/0, /*instance*/0, /*delete_it*/false);
   }
 
   ttf_sort_fonts(cache);
@@ -251,13 +297,11 @@ ttfCacheCreate(const char   *appname,	// I - Application name
     for (i = 0; i < num_dirs; i ++)
       ttf_load_fonts(cache, dirs[i], /*depth*/0, /*scanonly*/false);
 
-    // Save the cache...
+    // Sort and save the cache...
+    ttf_sort_fonts(cache);
     ttf_save_cache(cache);
   }
 
-  // Sort the fonts in the cache...
-  ttf_sort_fonts(cache);
-
   TTF_DEBUG("ttfCacheNew: Found %lu fonts.\n", (unsigned long)cache->num_fonts);
 
   // Return the font cache...
@@ -282,11 +326,22 @@ ttfCacheDelete(ttf_cache_t *cache)		// I - Font cache
     for (i = cache->num_fonts, font = cache->fonts; i > 0; i --, font ++)
     {
       ttfDelete(font->font);
-      free(font->filename);
-      free(font->family);
+
+      if (!font->mapped)
+      {
+        free(font->filename);
+        free(font->family);
+        ttfCoverageDelete(font->coverage);
+      }
     }
 
     free(cache->fonts);
+    free(cache->map_coverages);
+
+    if (!cache->map_char_fonts)
+      free(cache->char_fonts);
+
+    ttf_unmap_cache(cache);
     free(cache);
   }
 }
@@ -332,23 +387,7 @@ ttfCacheFind(ttf_cache_t   *cache,	// I - Font cache
     else if (result > 0)
       break;
 
-    if (weight == TTF_WEIGHT_UNSPEC)
-      score = 0;
-    else if (font->weight > weight)
-      score = (int)(font->weight - weight);
-    else
-      score = (int)(weight - font->weight);
-
-    if (stretch != TTF_STRETCH_UNSPEC)
-    {
-      if (font->stretch > stretch)
-        score += (int)(font->stretch - stretch) * 10;
-      else
-        score += (int)(stretch - font->stretch) * 10;
-    }
-
-    if (style != TTF_STYLE_UNSPEC && (style != TTF_STYLE_NORMAL) != (font->style != TTF_STYLE_NORMAL))
-      score ++;
+    score = ttf_score_font(font, style, weight, stretch);
 
     TTF_DEBUG("ttfCacheFind: [%u] score=%d\n", (unsigned)i, score);
 
@@ -364,17 +403,160 @@ ttfCacheFind(ttf_cache_t   *cache,	// I - Font cache
 
   TTF_DEBUG("ttfCacheFind: best_font=%p(%p)\n", (void *)best_font, best_font ? (void *)best_font->font : NULL);
 
-  if (best_font)
+  // Load and return the matching font or named instance...
+  return (best_font ? ttfCacheGetFont(cache, (size_t)(best_font - cache->fonts)) : NULL);
+}
+
+
+//
+// 'ttfCacheFindChar()' - Find a font in the cache that contains a character.
+//
+// This function finds the font that best matches the specified style, weight,
+// and stretch out of all of the fonts in the cache that contain the Unicode
+// character "ch".  The character coverage of each font is stored in the cache
+// so only the matching font is loaded.  The returned `ttf_t` object is managed
+// by the cache and should not be deleted.
+//
+
+ttf_t *					// O - Font or `NULL` if no font contains the character
+ttfCacheFindChar(ttf_cache_t   *cache,	// I - Font cache
+                 int           ch,	// I - Unicode character
+                 ttf_style_t   style,	// I - Font style or `TTF_STYLE_UNSPEC`
+                 ttf_weight_t  weight,	// I - Font weight or `TTF_WEIGHT_UNSPEC`
+                 ttf_stretch_t stretch)	// I - Font stretch or `TTF_STRETCH_UNSPEC`
+{
+  size_t	i,			// Looping var
+		best_font = 0;		// Best font
+  _ttf_cfont_t	*font;			// Current font
+  int		score,			// Current score
+		best_score = 999999;	// Best score
+
+
+  // Range check input...
+  if (!cache || ch < 0 || ch >= TTF_FONT_MAX_CHAR || !cache->char_fonts)
+    return (NULL);
+
+  // Loop through the fonts covering this page of characters...
+  for (i = cache->char_index[ch / 256]; i < cache->char_index[ch / 256 + 1]; i ++)
   {
-    // Load the font as needed...
-    if (!best_font->font && best_font->filename)
-      best_font->font = ttfCreate(best_font->filename, best_font->idx, cache->err_cb, cache->err_cbdata);
+    font = cache->fonts + cache->char_fonts[i];
+
+    if (!ttfCoverageContainsChar(font->coverage, ch))
+      continue;
+
+    if ((score = ttf_score_font(font, style, weight, stretch)) < best_score)
+    {
+      best_score = score;
+      best_font  = cache->char_fonts[i];
 
-    // Return the matching font...
-    return (best_font->font);
+      if (score == 0)
+        break;
+    }
+  }
+
+  return (best_score < 999999 ? ttfCacheGetFont(cache, best_font) : NULL);
+}
+
+
+//
+// 'ttfCacheFindFonts()' - Find a stack of fonts in the cache.
+//
+// This function finds the fonts for each of the "num_families" family names in
+// "families", in the manner of a CSS font stack, for use with
+// @link ttfGetFontRuns@.  Families that are not in the cache are skipped, so
+// the number of fonts stored in the "fonts" array, which must have room for
+// "num_families" fonts, is returned.  The returned `ttf_t` objects are managed
+// by the cache and should not be deleted.
+//
+
+size_t					// O - Number of fonts found
+ttfCacheFindFonts(
+    ttf_cache_t        *cache,		// I - Font cache
+    const char * const *families,	// I - Family names in order of preference
+    size_t             num_families,	// I - Number of family names
+    ttf_style_t        style,		// I - Font style or `TTF_STYLE_UNSPEC`
+    ttf_weight_t       weight,		// I - Font weight or `TTF_WEIGHT_UNSPEC`
+    ttf_stretch_t      stretch,		// I - Font stretch or `TTF_STRETCH_UNSPEC`
+    ttf_t              **fonts)		// O - Fonts
+{
+  size_t	i,			// Looping var
+		num_fonts = 0;		// Number of fonts
+  ttf_t		*font;			// Current font
+
+
+  // Range check input...
+  if (!cache || !families || !fonts)
+    return (0);
+
+  for (i = 0; i < num_families; i ++)
+  {
+    if ((font = ttfCacheFind(cache, families[i], style, weight, stretch)) != NULL)
+      fonts[num_fonts ++] = font;
   }
 
-  return (NULL);
+  return (num_fonts);
+}
+
+
+//
+// 'ttfCacheGetCharFonts()' - Get the fonts in the cache that contain a character.
+//
+// This function finds all of the fonts in the cache that contain the Unicode
+// character "ch" without loading them.  Up to "max_fonts" cache indices are
+// stored in the "fonts" array.  The return value is the total number of fonts
+// containing the character, which may be larger than "max_fonts".
+//
+
+size_t					// O - Number of fonts
+ttfCacheGetCharFonts(
+    ttf_cache_t *cache,			// I - Font cache
+    int         ch,			// I - Unicode character
+    size_t      max_fonts,		// I - Maximum number of fonts
+    size_t      *fonts)			// O - Cache indices of fonts
+{
+  size_t	i,			// Looping var
+		num_fonts = 0;		// Number of fonts
+  unsigned	n;			// Font index
+
+
+  // Range check input...
+  if (!cache || ch < 0 || ch >= TTF_FONT_MAX_CHAR || !cache->char_fonts)
+    return (0);
+
+  if (!fonts)
+    max_fonts = 0;
+
+  // Loop through the fonts covering this page of characters...
+  for (i = cache->char_index[ch / 256]; i < cache->char_index[ch / 256 + 1]; i ++)
+  {
+    n = cache->char_fonts[i];
+
+    if (ttfCoverageContainsChar(cache->fonts[n].coverage, ch))
+    {
+      if (num_fonts < max_fonts)
+        fonts[num_fonts] = n;
+
+      num_fonts ++;
+    }
+  }
+
+  return (num_fonts);
+}
+
+
+//
+// 'ttfCacheGetCoverage()' - Get the character coverage for the font at index N.
+//
+// The coverage is stored in the cache file so the font does not need to be
+// loaded.  The returned coverage is managed by the cache and should not be
+// freed.
+//
+
+const ttf_coverage_t *			// O - Character coverage or `NULL`
+ttfCacheGetCoverage(ttf_cache_t *cache,	// I - Font cache
+                    size_t      n)	// I - Font index starting at `0`
+{
+  return ((cache && n < cache->num_fonts) ? cache->fonts[n].coverage : NULL);
 }
 
 
@@ -413,20 +595,48 @@ ttf_t *					// O - Font
 ttfCacheGetFont(ttf_cache_t *cache,	// I - Font cache
 		size_t      n)		// I - Font index starting at `0`
 {
-  ttf_t	*font;				// Font
+  ttf_t		*font;			// Font
+  _ttf_cfont_t	*cfont,			// Cached font
+		*base;			// Base font
+  size_t	i;			// Looping var
 
 
   // Range check input...
   if (!cache || n >= cache->num_fonts)
     return (NULL);
 
+  cfont = cache->fonts + n;
+
+  if (cfont->instance && cfont->filename)
+  {
+    // Named instances are owned by the base font, so find it...
+    if (!cfont->base)
+    {
+      for (i = 0, base = cache->fonts; i < cache->num_fonts; i ++, base ++)
+      {
+        if (!base->instance && base->idx == cfont->idx && base->filename && !strcmp(base->filename, cfont->filename))
+        {
+          cfont->base = i + 1;
+          break;
+        }
+      }
+    }
+
+    // and share it with the other instances...
+    if (cfont->base && (font = ttfCacheGetFont(cache, cfont->base - 1)) != NULL)
+      return (ttfGetInstance(font, cfont->instance - 1));
+  }
+
   // Load the font as needed...
-  if ((font = cache->fonts[n].font) == NULL && cache->fonts[n].filename)
+  if ((font = cfont->font) == NULL && cfont->filename)
   {
-    if ((font = ttfCreate(cache->fonts[n].filename, cache->fonts[n].idx, cache->err_cb, cache->err_cbdata)) != NULL)
-      cache->fonts[n].font = font;
+    if ((font = ttfCreate(cfont->filename, cfont->idx, cache->err_cb, cache->err_cbdata)) != NULL)
+      cfont->font = font;
   }
 
+  if (font && cfont->instance)
+    font = ttfGetInstance(font, cfont->instance - 1);
+
   return (font);
 }
 
@@ -443,6 +653,21 @@ ttfCacheGetIndex(ttf_cache_t *cache,	// I - Font cache
 }
 
 
+//
+// 'ttfCacheGetInstance()' - Get the named instance number for the font at index N.
+//
+// The named instance number is one more than the instance number passed to
+// @link ttfGetInstance@, or `0` for the default instance of a font.
+//
+
+size_t					// O - Named instance number plus 1 or `0`
+ttfCacheGetInstance(ttf_cache_t *cache,	// I - Font cache
+                    size_t      n)	// I - Cached font index starting at `0`
+{
+  return ((cache && n < cache->num_fonts) ? cache->fonts[n].instance : 0);
+}
+
+
 //
 // 'ttfCacheGetStretch()' - Get the font stretch at index N.
 //
@@ -493,12 +718,16 @@ ttfCacheGetNumFonts(ttf_cache_t *cache)	// I - Font cache
 //
 // 'ttf_add_font()' - Add a font to the cache and optionally delete it.
 //
+// The named instances of a variable font on disk are added after the font
+// itself.  Instances are owned by their base font and are loaded on demand.
+//
 
 static void
 ttf_add_font(ttf_cache_t *cache,	// I - Font cache
              ttf_t       *font,		// I - Font to add
              const char  *filename,	// I - Filename/URL or `NULL` for in-memory
              size_t      idx,		// I - Font index
+             size_t      instance,	// I - Named instance number plus 1 or 0 for default instance
              bool        delete_it)	// I - Delete the font after adding?
 {
   _ttf_cfont_t	*cfont;			// Cached font
@@ -506,7 +735,7 @@ ttf_add_font(ttf_cache_t *cache,	// I - Font cache
 
 
 #if DEBUG > 1
-  TTF_DEBUG("ttf_add_font(cache=%p, font=%p(%s), filename=\"%s\", idx=%u, delete_it=%s)\n", (void *)cache, (void *)font, ttfGetFamily(font), filename, (unsigned)idx, delete_it ? "true" : "false");
+  TTF_DEBUG("ttf_add_font(cache=%p, font=%p(%s), filename=\"%s\", idx=%u, instance=%u, delete_it=%s)\n", (void *)cache, (void *)font, ttfGetFamily(font), filename, (unsigned)idx, (unsigned)instance, delete_it ? "true" : "false");
 #endif // DEBUG > 1
 
   // Expand the font cache array as needed...
@@ -524,9 +753,10 @@ ttf_add_font(ttf_cache_t *cache,	// I - Font cache
 
   memset(cfont, 0, sizeof(_ttf_cfont_t));
 
-  cfont->font     = delete_it ? NULL : font;
+  cfont->font     = delete_it || instance ? NULL : font;
   cfont->filename = filename ? strdup(filename) : NULL;
   cfont->idx      = idx;
+  cfont->instance = instance;
   cfont->stretch  = ttfGetStretch(font);
   cfont->style    = ttfGetStyle(font);
   cfont->weight   = ttfGetWeight(font);
@@ -534,8 +764,30 @@ ttf_add_font(ttf_cache_t *cache,	// I - Font cache
   if ((family = ttfGetFamily(font)) == NULL || (cfont->family = strdup(family)) == NULL)
     goto cleanup;
 
+  if ((cfont->coverage = ttfCoverageCopy(ttfGetCoverage(font))) == NULL)
+  {
+    free(cfont->filename);
+    free(cfont->family);
+    goto cleanup;
+  }
+
   cache->num_fonts ++;
 
+  if (filename && !instance)
+  {
+    // Add the named instances of a variable font...
+    size_t	i,			// Looping var
+		num_instances = ttfGetNumInstances(font);
+					// Number of named instances
+    ttf_t	*ifont;			// Instance font
+
+    for (i = 0; i < num_instances; i ++)
+    {
+      if ((ifont = ttfGetInstance(font, i)) != NULL && ifont != font)
+        ttf_add_font(cache, ifont, filename, idx, /*instance*/i + 1, /*delete_it*/false);
+    }
+  }
+
   cleanup:
 
   if (delete_it)
@@ -601,183 +853,232 @@ ttf_compare_fonts(_ttf_cfont_t *a,	// I - First entry
       ret = -1;
   }
 
-  return (ret);
-}
-
-
-//
-// 'ttf_gets()' - Read a line from the cache file and strip any trailing newline.
-//
-
-static char *				// O - Line or `NULL` on EOF
-ttf_gets(FILE   *fp,			// I - File pointer
-         char   *buffer,		// I - Line buffer
-         size_t bufsize)		// I - Size of line buffer
-{
-  char	*bufend;			// End of line
-
-
-  // Try reading a line...
-  if (!fgets(buffer, (int)bufsize, fp))
-    return (NULL);
-
-  // Strip any trailing newline and return it...
-  bufend = buffer + strlen(buffer) - 1;
-
-  if (bufend >= buffer && *bufend == '\n')
-    *bufend = '\0';
+  if (!ret)
+    ret = (int)a->instance - (int)b->instance;
 
-  return (buffer);
+  return (ret);
 }
 
 
 //
 // 'ttf_load_cache()' - Load all fonts from the cache.
 //
+// The cache file is mapped into memory and used in place - the family and
+// file names, character coverage, and inverted character index all point into
+// the mapped file, and since the fonts are stored in sorted order no sorting is
+// needed.
+//
 
 static bool				// O - `true` on success, `false` on error
 ttf_load_cache(ttf_cache_t *cache)	// I - Font cache
 {
-  FILE		*fp;			// Cache file
+  int		fd;			// Cache file descriptor
+  struct stat	info;			// Cache file information
+  ssize_t	bytes;			// Bytes read
+#ifdef _WIN32
+  HANDLE	mapping;		// File mapping handle
+#endif // _WIN32
+  const _ttf_cheader_t *header;		// Cache file header
+  const _ttf_centry_t *entry;		// Current cache entry
+  const uint64_t (*pages)[4];		// Coverage page bitsets
+  const uint32_t *char_fonts;		// Inverted character index
+  const char	*strings;		// String table
   _ttf_cfont_t	*font;			// Current cached font
-  char		line[1024],		// Header/attributes line
-		*lineptr;		// Pointer into line
-  long		num_fonts,		// Number of fonts in cache
-		idx,			// Font index in a file
-		stretch,		// Font stretch
-		style,			// Font style
-		weight;			// Font weight
+  size_t	i,			// Looping var
+		num_fonts,		// Number of fonts
+		num_pages,		// Number of coverage page bitsets
+		first_page,		// First page for the next entry
+		offset;			// Offset of string table
 
 
   // Try opening the cache file...
-  if ((fp = fopen(cache->cname, "r")) == NULL)
+  if ((fd = open(cache->cname, O_RDONLY | O_BINARY)) < 0)
   {
     TTF_DEBUG("ttf_load_cache: Unable to open '%s': %s\n", cache->cname, strerror(errno));
     return (false);
   }
 
-  // Read the first line of the form:
-  //
-  // ttf-cacheVERSION NUM-FONTS
-  if (!ttf_gets(fp, line, sizeof(line)))
-    goto error;
+  if (fstat(fd, &info) || info.st_size < (off_t)sizeof(_ttf_cheader_t))
+  {
+    TTF_DEBUG("ttf_load_cache: Cache file too short.\n");
+    close(fd);
+    return (false);
+  }
 
-  TTF_DEBUG("ttf_load_cache: (version-numfont) %s\n", line);
+  cache->map_size = (size_t)info.st_size;
 
-  if (strncmp(line, TTF_CACHE_HEADER, TTF_CACHE_HEADERLEN))
-    goto error;
+  // Map the file into memory so that it can be used in place...
+#ifdef _WIN32
+  if ((mapping = CreateFileMapping((HANDLE)_get_osfhandle(fd), NULL, PAGE_READONLY, 0, 0, NULL)) != NULL)
+  {
+    cache->map_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+  }
+#else
+  if ((cache->map_data = mmap(NULL, cache->map_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+    cache->map_data = NULL;
+#endif // _WIN32
 
-  if (strtol(line + TTF_CACHE_HEADERLEN, &lineptr, 10) != TTF_CACHE_VERSION || !lineptr || !isspace(*lineptr & 255))
-    goto error;
+  if (cache->map_data)
+  {
+    cache->map_mapped = true;
+  }
+  else if ((cache->map_data = malloc(cache->map_size)) != NULL)
+  {
+    // Unable to map the file, read it instead...
+    for (i = 0; i < cache->map_size; i += (size_t)bytes)
+    {
+      if ((bytes = read(fd, (char *)cache->map_data + i, cache->map_size - i)) <= 0)
+      {
+        TTF_DEBUG("ttf_load_cache: Unable to read '%s': %s\n", cache->cname, bytes < 0 ? strerror(errno) : "Short read");
+        close(fd);
+        goto error;
+      }
+    }
+  }
+  else
+  {
+    TTF_DEBUG("ttf_load_cache: Unable to allocate memory for '%s'.\n", cache->cname);
+    close(fd);
+    return (false);
+  }
+
+  close(fd);
 
-  if ((num_fonts = strtol(lineptr, &lineptr, 10)) < 1 || num_fonts > TTF_CACHE_MAX || !lineptr || *lineptr)
+  // Validate the header...
+  header = (const _ttf_cheader_t *)cache->map_data;
+
+  if (memcmp(header->magic, TTF_CACHE_HEADER, sizeof(header->magic)) || header->version != TTF_CACHE_VERSION || header->byte_order != TTF_CACHE_BYTE_ORDER)
+  {
+    TTF_DEBUG("ttf_load_cache: Bad header, version, or byte order.\n");
     goto error;
+  }
+
+  num_fonts = header->num_fonts;
+  num_pages = header->num_pages;
 
-  // Allocate memory for the specified number of fonts...
-  if ((font = calloc((size_t)num_fonts, sizeof(_ttf_cfont_t))) == NULL)
+  if (num_fonts < 1 || num_fonts > TTF_CACHE_MAX || num_pages > num_fonts * TTF_COVERAGE_PAGES || header->num_char_fonts != num_pages)
+  {
+    TTF_DEBUG("ttf_load_cache: Bad number of fonts (%lu) or pages (%lu).\n", (unsigned long)num_fonts, (unsigned long)num_pages);
     goto error;
+  }
 
-  cache->alloc_fonts = (size_t)num_fonts;
-  cache->fonts       = font;
+  offset = sizeof(_ttf_cheader_t) + num_fonts * sizeof(_ttf_centry_t) + num_pages * sizeof(pages[0]) + num_pages * sizeof(uint32_t);
 
-  // Read cache entries of the form:
-  //
-  // INDEX FILENAME
-  // STRETCH STYLE WEIGHT FAMILY
+  if (offset > cache->map_size || header->strings_size != cache->map_size - offset || header->strings_size == 0)
+  {
+    TTF_DEBUG("ttf_load_cache: Bad cache file size.\n");
+    goto error;
+  }
 
-  while (ttf_gets(fp, line, sizeof(line)))
+  pages      = (const uint64_t (*)[4])((const char *)cache->map_data + sizeof(_ttf_cheader_t) + num_fonts * sizeof(_ttf_centry_t));
+  char_fonts = (const uint32_t *)(pages + num_pages);
+  strings    = (const char *)cache->map_data + offset;
+
+  if (strings[header->strings_size - 1])
   {
-    // Get index and filename...
-    TTF_DEBUG("ttf_load_cache: (index-filename ) %s\n", line);
+    TTF_DEBUG("ttf_load_cache: Bad string table.\n");
+    goto error;
+  }
 
-    if ((idx = strtol(line, &lineptr, 10)) < 0 || !lineptr || !isspace(*lineptr & 255))
+  // Validate the family and character indices...
+  for (i = 0; i < 256; i ++)
+  {
+    if (header->font_index[i] > num_fonts)
     {
-      TTF_DEBUG("ttf_load_cache: Bad index or filename.\n");
+      TTF_DEBUG("ttf_load_cache: Bad font index.\n");
       goto error;
     }
 
-    while (*lineptr && isspace(*lineptr & 255))
-      lineptr ++;
+    cache->font_index[i] = header->font_index[i];
+  }
 
-    if (!*lineptr)
-    {
-      TTF_DEBUG("ttf_load_cache: Bad filename.\n");
-      goto error;
-    }
+  if (header->char_index[0] || header->char_index[TTF_COVERAGE_PAGES] != num_pages)
+  {
+    TTF_DEBUG("ttf_load_cache: Bad character index.\n");
+    goto error;
+  }
 
-    if (access(lineptr, R_OK))
+  for (i = 0; i < TTF_COVERAGE_PAGES; i ++)
+  {
+    if (header->char_index[i] > header->char_index[i + 1])
     {
-      TTF_DEBUG("ttf_load_cache: Unable to access '%s': %s\n", lineptr, strerror(errno));
+      TTF_DEBUG("ttf_load_cache: Bad character index.\n");
       goto error;
     }
 
-    if ((font->filename = strdup(lineptr)) == NULL)
-    {
-      TTF_DEBUG("ttf_load_cache: Unable to allocate filename.\n");
-      goto error;
-    }
+    cache->char_index[i] = header->char_index[i];
+  }
 
-    font->idx = (size_t)idx;
-    cache->num_fonts ++;
+  cache->char_index[i] = header->char_index[i];
 
-    // Get font attributes (stretch, style, weight, and family name)...
-    if (!ttf_gets(fp, line, sizeof(line)))
+  for (i = 0; i < num_pages; i ++)
+  {
+    if (char_fonts[i] >= num_fonts)
     {
-      TTF_DEBUG("ttf_load_cache: Unable to get font attributes line.\n");
+      TTF_DEBUG("ttf_load_cache: Bad character index.\n");
       goto error;
     }
+  }
 
-    TTF_DEBUG("ttf_load_cache: (str-sty-wgt-fam) %s\n", line);
+  // Allocate memory for the fonts and their coverage...
+  if ((cache->fonts = calloc(num_fonts, sizeof(_ttf_cfont_t))) == NULL || (cache->map_coverages = calloc(num_fonts, sizeof(ttf_coverage_t))) == NULL)
+  {
+    TTF_DEBUG("ttf_load_cache: Unable to allocate memory for %lu fonts.\n", (unsigned long)num_fonts);
+    goto error;
+  }
 
-    if ((stretch = strtol(line, &lineptr, 10)) < TTF_STRETCH_NORMAL || stretch > TTF_STRETCH_ULTRA_EXPANDED || !lineptr || !isspace(*lineptr & 255))
-    {
-      TTF_DEBUG("ttf_load_cache: Bad stretch.\n");
-      goto error;
-    }
+  cache->alloc_fonts = num_fonts;
 
-    if ((style = strtol(lineptr, &lineptr, 10)) < TTF_STYLE_NORMAL || style > TTF_STYLE_OBLIQUE || !lineptr || !isspace(*lineptr & 255))
+  // Point the fonts at the cache entries...
+  for (i = 0, first_page = 0, entry = (const _ttf_centry_t *)(header + 1), font = cache->fonts; i < num_fonts; i ++, entry ++, font ++)
+  {
+    if (entry->filename >= header->strings_size || !strings[entry->filename] || entry->family >= header->strings_size)
     {
-      TTF_DEBUG("ttf_load_cache: Bad style.\n");
+      TTF_DEBUG("ttf_load_cache: Bad filename or family name.\n");
       goto error;
     }
 
-    if ((weight = strtol(lineptr, &lineptr, 10)) < TTF_WEIGHT_100 || weight > TTF_WEIGHT_900 || !lineptr || !isspace(*lineptr & 255))
+    if (entry->instance > 65535)
     {
-      TTF_DEBUG("ttf_load_cache: Bad weight.\n");
+      TTF_DEBUG("ttf_load_cache: Bad instance.\n");
       goto error;
     }
 
-    while (*lineptr && isspace(*lineptr & 255))
-      lineptr ++;
-
-    if (!*lineptr)
+    if (entry->stretch < TTF_STRETCH_NORMAL || entry->stretch > TTF_STRETCH_ULTRA_EXPANDED || entry->style < TTF_STYLE_NORMAL || entry->style > TTF_STYLE_OBLIQUE || entry->weight < TTF_WEIGHT_100 || entry->weight > TTF_WEIGHT_900)
     {
-      TTF_DEBUG("ttf_load_cache: Bad family name.\n");
+      TTF_DEBUG("ttf_load_cache: Bad stretch, style, or weight.\n");
       goto error;
     }
 
-    if ((font->family = strdup(lineptr)) == NULL)
+    if (entry->first_page != first_page || entry->num_pages > num_pages - first_page || !_ttfCoverageSetPages(cache->map_coverages + i, entry->summary, pages + first_page, entry->num_pages))
     {
-      TTF_DEBUG("ttf_load_cache: Unable to allocate family name.\n");
+      TTF_DEBUG("ttf_load_cache: Bad coverage.\n");
       goto error;
     }
 
-    font->stretch = (ttf_stretch_t)stretch;
-    font->style   = (ttf_style_t)style;
-    font->weight  = (ttf_weight_t)weight;
-
-    font ++;
+    font->filename = (char *)strings + entry->filename;
+    font->family   = (char *)strings + entry->family;
+    font->idx      = entry->idx;
+    font->instance = entry->instance;
+    font->stretch  = (ttf_stretch_t)entry->stretch;
+    font->style    = (ttf_style_t)entry->style;
+    font->weight   = (ttf_weight_t)entry->weight;
+    font->coverage = cache->map_coverages + i;
+    font->mapped   = true;
+
+    first_page += entry->num_pages;
   }
 
-  // See if we got as many fonts as advertised in the header...
-  if (cache->num_fonts < cache->alloc_fonts)
+  if (first_page != num_pages)
   {
-    TTF_DEBUG("ttf_load_cache: Got %lu fonts, expected %lu fonts.\n", (unsigned long)cache->num_fonts, (unsigned long)cache->alloc_fonts);
+    TTF_DEBUG("ttf_load_cache: Got %lu coverage pages, expected %lu.\n", (unsigned long)first_page, (unsigned long)num_pages);
     goto error;
   }
 
-  // Everything was good, close the cache file and return...
-  fclose(fp);
+  cache->num_fonts      = num_fonts;
+  cache->char_fonts     = (uint32_t *)char_fonts;
+  cache->map_char_fonts = true;
 
   TTF_DEBUG("ttf_load_cache: Returning true.\n");
 
@@ -786,19 +1087,16 @@ ttf_load_cache(ttf_cache_t *cache)	// I - Font cache
   // If we get here there was a problem...
   error:
 
-  // Close the cache file...
-  fclose(fp);
+  free(cache->fonts);
+  free(cache->map_coverages);
+  ttf_unmap_cache(cache);
 
-  // Clear any loaded fonts...
-  size_t i;				// Looping var
+  cache->fonts         = NULL;
+  cache->alloc_fonts   = 0;
+  cache->map_coverages = NULL;
 
-  for (i = cache->num_fonts, font = cache->fonts; i > 0; i --, font ++)
-  {
-    free(font->filename);
-    free(font->family);
-  }
-
-  cache->num_fonts = 0;
+  memset(cache->font_index, 0, sizeof(cache->font_index));
+  memset(cache->char_index, 0, sizeof(cache->char_index));
 
   TTF_DEBUG("ttf_load_cache: Returning false.\n");
 
@@ -908,7 +1206,7 @@ ttf_load_fonts(ttf_cache_t *cache,	// I - Font cache
 
         num_fonts = ttfGetNumFonts(font);
 
-        ttf_add_font(cache, font, filename, /*idx*/0, /*delete_it*/true);
+        ttf_add_font(cache, font, filename, /*idx*/0, /*instance*/0, /*delete_it*/true);
 
 	for (i = 1; i < num_fonts; i ++)
 	{
@@ -917,7 +1215,7 @@ ttf_load_fonts(ttf_cache_t *cache,	// I - Font cache
 	  if ((font = ttfCreate(filename, /*idx*/i, (ttf_err_cb_t)ttf_cache_err_cb, cache)) != NULL)
 	  {
 	    if ((family = ttfGetFamily(font)) != NULL && *family != '.')
-	      ttf_add_font(cache, font, filename, /*idx*/i, /*delete_it*/true);
+	      ttf_add_font(cache, font, filename, /*idx*/i, /*instance*/0, /*delete_it*/true);
 	    else
 	      ttfDelete(font);
 	  }
@@ -941,36 +1239,168 @@ ttf_load_fonts(ttf_cache_t *cache,	// I - Font cache
 //
 // 'ttf_save_cache()' - Save a font cache.
 //
+// The cache file contains a header with the family and character indices,
+// followed by the (sorted) font entries, the coverage page bitsets, the
+// inverted character index, and the string table.  Values are stored in native
+// byte order since the file is only used on the current system.
+//
 
 static void
 ttf_save_cache(ttf_cache_t *cache)	// I - Font cache
 {
   FILE		*fp;			// Cache file
-  size_t	i;			// Looping var
+  char		tname[1024];		// Temporary filename
+  size_t	i,			// Looping var
+		j,			// Looping var
+		num_pages = 0,		// Number of coverage pages
+		strings_size = 0;	// Size of string table
   _ttf_cfont_t	*font;			// Current font
+  _ttf_cheader_t *header;		// Cache file header
+  _ttf_centry_t	entry;			// Cache file entry
+  uint64_t	bits[4];		// Coverage page bits
+
+
+  if (cache->num_fonts == 0 || cache->num_fonts > TTF_CACHE_MAX || !cache->cname[0])
+    return;
+
+  // Size the coverage pages and string table...
+  for (i = cache->num_fonts, font = cache->fonts; i > 0; i --, font ++)
+  {
+    if (!font->filename || !font->family)
+      return;
 
+    num_pages    += font->coverage ? font->coverage->num_pages : 0;
+    strings_size += strlen(font->filename) + strlen(font->family) + 2;
+  }
+
+  if (strings_size > UINT32_MAX || num_pages != cache->char_index[TTF_COVERAGE_PAGES])
+    return;
 
-  if (cache->num_fonts == 0)
+  // Build the header...
+  if ((header = calloc(1, sizeof(_ttf_cheader_t))) == NULL)
     return;
 
-  if ((fp = fopen(cache->cname, "w")) == NULL)
+  memcpy(header->magic, TTF_CACHE_HEADER, sizeof(header->magic));
+  header->version        = TTF_CACHE_VERSION;
+  header->byte_order     = TTF_CACHE_BYTE_ORDER;
+  header->num_fonts      = (uint32_t)cache->num_fonts;
+  header->num_pages      = (uint32_t)num_pages;
+  header->num_char_fonts = (uint32_t)num_pages;
+  header->strings_size   = (uint32_t)strings_size;
+
+  for (i = 0; i < 256; i ++)
+    header->font_index[i] = (uint32_t)cache->font_index[i];
+
+  for (i = 0; i <= TTF_COVERAGE_PAGES; i ++)
+    header->char_index[i] = (uint32_t)cache->char_index[i];
+
+  // Write to a temporary file and then rename it so that other processes
+  // never see a partial cache file...
+  snprintf(tname, sizeof(tname), "%s.tmp", cache->cname);
+
+  if ((fp = fopen(tname, "wb")) == NULL)
   {
-    TTF_DEBUG("ttf_load_cache: Unable to create '%s': %s\n", cache->cname, strerror(errno));
+    TTF_DEBUG("ttf_save_cache: Unable to create '%s': %s\n", tname, strerror(errno));
+    free(header);
     return;
   }
 
-  fprintf(fp, TTF_CACHE_HEADER "%d %lu\n", TTF_CACHE_VERSION, (unsigned long)cache->num_fonts);
+  fwrite(header, sizeof(_ttf_cheader_t), 1, fp);
+  free(header);
+
+  // Font entries...
+  for (i = 0, num_pages = 0, strings_size = 0, font = cache->fonts; i < cache->num_fonts; i ++, font ++)
+  {
+    memset(&entry, 0, sizeof(entry));
+
+    if (font->coverage)
+      memcpy(entry.summary, font->coverage->summary, sizeof(entry.summary));
+
+    entry.filename   = (uint32_t)strings_size;
+    entry.family     = (uint32_t)(strings_size + strlen(font->filename) + 1);
+    entry.idx        = (uint32_t)font->idx;
+    entry.instance   = (uint32_t)font->instance;
+    entry.first_page = (uint32_t)num_pages;
+    entry.num_pages  = font->coverage ? (uint32_t)font->coverage->num_pages : 0;
+    entry.stretch    = (int32_t)font->stretch;
+    entry.style      = (int32_t)font->style;
+    entry.weight     = (int32_t)font->weight;
+
+    fwrite(&entry, sizeof(entry), 1, fp);
+
+    num_pages    += entry.num_pages;
+    strings_size += strlen(font->filename) + strlen(font->family) + 2;
+  }
+
+  // Coverage pages...
+  for (i = cache->num_fonts, font = cache->fonts; i > 0; i --, font ++)
+  {
+    for (j = 0; _ttfCoverageGetPage(font->coverage, j, bits) >= 0; j ++)
+      fwrite(bits, sizeof(bits), 1, fp);
+  }
 
+  // Inverted character index...
+  if (num_pages > 0)
+    fwrite(cache->char_fonts, sizeof(uint32_t), num_pages, fp);
+
+  // String table...
   for (i = cache->num_fonts, font = cache->fonts; i > 0; i --, font ++)
   {
-    if (!font->filename || !font->family)
-      continue;
+    fwrite(font->filename, strlen(font->filename) + 1, 1, fp);
+    fwrite(font->family, strlen(font->family) + 1, 1, fp);
+  }
 
-    fprintf(fp, "%u %s\n", (unsigned)font->idx, font->filename);
-    fprintf(fp, "%d %d %d %s\n", font->stretch, font->style, font->weight, font->family);
+  if (ferror(fp) | fclose(fp))
+  {
+    TTF_DEBUG("ttf_save_cache: Unable to write '%s': %s\n", tname, strerror(errno));
+    unlink(tname);
+    return;
   }
 
-  fclose(fp);
+#if _WIN32
+  unlink(cache->cname);
+#endif // _WIN32
+
+  if (rename(tname, cache->cname))
+  {
+    TTF_DEBUG("ttf_save_cache: Unable to rename '%s' to '%s': %s\n", tname, cache->cname, strerror(errno));
+    unlink(tname);
+  }
+}
+
+
+//
+// 'ttf_score_font()' - Score how well a font matches a style, weight, and stretch.
+//
+
+static int				// O - Score (0 is an exact match)
+ttf_score_font(_ttf_cfont_t  *font,	// I - Cached font
+               ttf_style_t   style,	// I - Font style or `TTF_STYLE_UNSPEC`
+               ttf_weight_t  weight,	// I - Font weight or `TTF_WEIGHT_UNSPEC`
+               ttf_stretch_t stretch)	// I - Font stretch or `TTF_STRETCH_UNSPEC`
+{
+  int	score;				// Score
+
+
+  if (weight == TTF_WEIGHT_UNSPEC)
+    score = 0;
+  else if (font->weight > weight)
+    score = (int)(font->weight - weight);
+  else
+    score = (int)(weight - font->weight);
+
+  if (stretch != TTF_STRETCH_UNSPEC)
+  {
+    if (font->stretch > stretch)
+      score += (int)(font->stretch - stretch) * 10;
+    else
+      score += (int)(stretch - font->stretch) * 10;
+  }
+
+  if (style != TTF_STYLE_UNSPEC && (style != TTF_STYLE_NORMAL) != (font->style != TTF_STYLE_NORMAL))
+    score ++;
+
+  return (score);
 }
 
 
@@ -981,14 +1411,21 @@ ttf_save_cache(ttf_cache_t *cache)	// I - Font cache
 static void
 ttf_sort_fonts(ttf_cache_t *cache)	// I - Font cache
 {
-  size_t	i;			// Looping var
+  size_t	i,			// Looping var
+		j;			// Looping var
   _ttf_cfont_t	*font;			// Current font
+  int		page;			// Coverage page
+  uint64_t	bits[4];		// Coverage page bits
+  size_t	next[TTF_COVERAGE_PAGES];	// Next entry for each page
 
 
-  // First sort the fonts...
+  // First sort the fonts, which moves the base fonts of any named instances...
   if (cache->num_fonts > 1)
     qsort(cache->fonts, cache->num_fonts, sizeof(_ttf_cfont_t), (int (*)(const void *, const void *))ttf_compare_fonts);
 
+  for (i = 0, font = cache->fonts; i < cache->num_fonts; i ++, font ++)
+    font->base = 0;
+
   // Then re-index the fonts by the first character of the font family...
   for (i = 0; i < 256; i ++)
     cache->font_index[i] = cache->num_fonts;
@@ -1001,4 +1438,62 @@ ttf_sort_fonts(ttf_cache_t *cache)	// I - Font cache
     if (i < cache->font_index[idx])
       cache->font_index[idx] = i;
   }
+
+  // Finally build an inverted index of the fonts covering each page of
+  // characters...
+  if (!cache->map_char_fonts)
+    free(cache->char_fonts);
+
+  cache->char_fonts     = NULL;
+  cache->map_char_fonts = false;
+  memset(cache->char_index, 0, sizeof(cache->char_index));
+
+  for (i = 0, font = cache->fonts; i < cache->num_fonts; i ++, font ++)
+  {
+    for (j = 0; (page = _ttfCoverageGetPage(font->coverage, j, bits)) >= 0; j ++)
+      cache->char_index[page + 1] ++;
+  }
+
+  for (i = 0; i < TTF_COVERAGE_PAGES; i ++)
+    cache->char_index[i + 1] += cache->char_index[i];
+
+  memcpy(next, cache->char_index, sizeof(next));
+
+  if (cache->char_index[TTF_COVERAGE_PAGES] > 0 && (cache->char_fonts = malloc(cache->char_index[TTF_COVERAGE_PAGES] * sizeof(uint32_t))) == NULL)
+  {
+    memset(cache->char_index, 0, sizeof(cache->char_index));
+    return;
+  }
+
+  for (i = 0, font = cache->fonts; i < cache->num_fonts; i ++, font ++)
+  {
+    for (j = 0; (page = _ttfCoverageGetPage(font->coverage, j, bits)) >= 0; j ++)
+      cache->char_fonts[next[page] ++] = (uint32_t)i;
+  }
+}
+
+
+//
+// 'ttf_unmap_cache()' - Unmap or free the cache file.
+//
+
+static void
+ttf_unmap_cache(ttf_cache_t *cache)	// I - Font cache
+{
+  if (cache->map_mapped)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(cache->map_data);
+#else
+    munmap(cache->map_data, cache->map_size);
+#endif // _WIN32
+  }
+  else
+  {
+    free(cache->map_data);
+  }
+
+  cache->map_data   = NULL;
+  cache->map_size   = 0;
+  cache->map_mapped = false;
 }
@@ -0,0 +1,835 @@
+//
+// CFF (Compact Font Format) code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+#include <math.h>
+
+
+//
+// Constants...
+//
+
+#define TTF_OFF_CFF		0x43464620
+					// Compact Font Format table
+#define TTF_CFF_MAX_DEPTH	10	// Maximum subroutine nesting
+#define TTF_CFF_MAX_STACK	48	// Maximum argument stack size
+
+
+//
+// Local types...
+//
+
+typedef struct _ttf_cff_path_s		// Charstring path state
+{
+  _ttf_outline_cb_t cb;			// Outline callback
+  void		*data;			// Callback data
+  float		x,			// Current X position
+		y;			// Current Y position
+  bool		open;			// Is a contour open?
+} _ttf_cff_path_t;
+
+
+//
+// Local functions...
+//
+
+static void	cff_close(_ttf_cff_path_t *path);
+static void	cff_curve(_ttf_cff_path_t *path, float dx1, float dy1, float dx2, float dy2, float dx3, float dy3);
+static void	cff_line(_ttf_cff_path_t *path, float dx, float dy);
+static void	cff_move(_ttf_cff_path_t *path, float dx, float dy);
+static unsigned	get_bias(unsigned count);
+
+
+//
+// '_ttfCFFCreate()' - Load the CFF outline data for a font.
+//
+// Only CFF version 1 tables are supported.  `NULL` is returned if the font has
+// no usable CFF table.
+//
+
+_ttf_cff_t *				// O - CFF outline data or `NULL`
+_ttfCFFCreate(ttf_t *font)		// I - Font
+{
+  _ttf_cff_t		*cff;		// CFF outline data
+  const unsigned char	*data;		// CFF table
+  size_t		length,		// Length of CFF table
+			offset,		// Offset of DICT
+			bytes;		// Size of DICT
+  _ttf_cff_index_t	name_index,	// Name INDEX
+			top_index,	// Top DICT INDEX
+			string_index,	// String INDEX
+			fd_index;	// FDArray INDEX
+  unsigned		i;		// Looping var
+  int			values[2];	// DICT operand values
+
+
+  if ((data = _ttfGetTable(font, TTF_OFF_CFF, &length)) == NULL || length < 4 || data[0] != 1 || data[2] < 4)
+    return (NULL);
+
+  if ((cff = (_ttf_cff_t *)calloc(1, sizeof(_ttf_cff_t))) == NULL)
+    return (NULL);
+
+  cff->data   = data;
+  cff->length = length;
+
+  // Find the INDEXes following the header...
+  if (!_ttfCFFGetIndex(data, length, data[2], &name_index) || !_ttfCFFGetIndex(data, length, name_index.end, &top_index) || top_index.count < 1 || !_ttfCFFGetIndex(data, length, top_index.end, &string_index) || !_ttfCFFGetIndex(data, length, string_index.end, &cff->gsubrs))
+    goto error;
+
+  // Then the CharStrings INDEX from the Top DICT...
+  offset = _ttfCFFGetObject(data, &top_index, 0, &bytes);
+
+  if ((offset + bytes) > length)
+    goto error;
+
+  if (!_ttfCFFGetDict(data + offset, bytes, TTF_CFF_CharStrings, values, 1) || values[0] < 0 || !_ttfCFFGetIndex(data, length, (size_t)values[0], &cff->charstrings) || cff->charstrings.count == 0)
+    goto error;
+
+  // CID-keyed fonts have a Private DICT for each Font DICT, selected by
+  // FDSelect, while other fonts have a single Private DICT...
+  if (_ttfCFFGetDict(data + offset, bytes, TTF_CFF_FDArray, values, 1))
+  {
+    if (values[0] < 0 || !_ttfCFFGetIndex(data, length, (size_t)values[0], &fd_index) || fd_index.count == 0)
+      goto error;
+
+    if (_ttfCFFGetDict(data + offset, bytes, TTF_CFF_FDSelect, values, 1))
+    {
+      if (values[0] < 0 || (size_t)values[0] >= (length - 3))
+        goto error;
+
+      cff->fdselect        = data + values[0];
+      cff->fdselect_length = length - (size_t)values[0];
+    }
+
+    cff->num_subrs = fd_index.count;
+  }
+  else
+  {
+    memset(&fd_index, 0, sizeof(fd_index));
+    cff->num_subrs = 1;
+  }
+
+  if ((cff->subrs = (_ttf_cff_index_t *)calloc(cff->num_subrs, sizeof(_ttf_cff_index_t))) == NULL)
+    goto error;
+
+  for (i = 0; i < cff->num_subrs; i ++)
+  {
+    if (fd_index.count)
+      offset = _ttfCFFGetObject(data, &fd_index, i, &bytes);
+
+    if ((offset + bytes) > length || !_ttfCFFGetDict(data + offset, bytes, TTF_CFF_Private, values, 2) || values[0] < 0 || values[1] < 0 || (size_t)values[1] > length || (size_t)values[0] > (length - (size_t)values[1]))
+      continue;
+
+    // Local Subrs offset is relative to the Private DICT...
+    offset = (size_t)values[1];
+
+    if (_ttfCFFGetDict(data + offset, (size_t)values[0], TTF_CFF_Subrs, values, 1) && values[0] > 0)
+      _ttfCFFGetIndex(data, length, offset + (size_t)values[0], cff->subrs + i);
+  }
+
+  return (cff);
+
+  // If we get here the CFF table could not be used...
+  error:
+
+  _ttfCFFDelete(cff);
+
+  return (NULL);
+}
+
+
+//
+// '_ttfCFFDelete()' - Free the CFF outline data.
+//
+
+void
+_ttfCFFDelete(_ttf_cff_t *cff)		// I - CFF outline data
+{
+  if (cff)
+  {
+    free(cff->subrs);
+    free(cff);
+  }
+}
+
+
+//
+// '_ttfCFFGetDict()' - Get the integer operands of a CFF DICT operator.
+//
+
+bool					// O - `true` if found, `false` otherwise
+_ttfCFFGetDict(
+    const unsigned char *data,		// I - DICT data
+    size_t              length,		// I - Length of DICT data
+    unsigned            op,		// I - Operator
+    int                 *values,	// O - Operand values
+    unsigned            num_values)	// I - Number of operand values
+{
+  const unsigned char	*dataptr,	// Pointer into DICT data
+			*dataend;	// End of DICT data
+  int			operands[48];	// Operands
+  unsigned		num_operands = 0,
+					// Number of operands
+			i;		// Looping var
+  unsigned		b0;		// First byte of operator or operand
+
+
+  for (dataptr = data, dataend = data + length; dataptr < dataend;)
+  {
+    b0 = *dataptr++;
+
+    if (b0 <= 21)
+    {
+      // Operator...
+      if (b0 == 12)
+      {
+        if (dataptr >= dataend)
+          break;
+
+        b0 = 0x0c00 | *dataptr++;
+      }
+
+      if (b0 == op)
+      {
+        if (num_operands < num_values)
+          return (false);
+
+        for (i = 0; i < num_values; i ++)
+          values[i] = operands[num_operands - num_values + i];
+
+        return (true);
+      }
+
+      num_operands = 0;
+      continue;
+    }
+
+    // Operand...
+    if (num_operands >= (sizeof(operands) / sizeof(operands[0])))
+      break;
+
+    if (b0 >= 32 && b0 <= 246)
+    {
+      operands[num_operands ++] = (int)b0 - 139;
+    }
+    else if (b0 >= 247 && b0 <= 250 && dataptr < dataend)
+    {
+      operands[num_operands ++] = ((int)b0 - 247) * 256 + *dataptr++ + 108;
+    }
+    else if (b0 >= 251 && b0 <= 254 && dataptr < dataend)
+    {
+      operands[num_operands ++] = -((int)b0 - 251) * 256 - *dataptr++ - 108;
+    }
+    else if (b0 == 28 && (dataend - dataptr) >= 2)
+    {
+      operands[num_operands ++] = (short)TTF_GET_USHORT(dataptr);
+      dataptr += 2;
+    }
+    else if (b0 == 29 && (dataend - dataptr) >= 4)
+    {
+      operands[num_operands ++] = (int)TTF_GET_ULONG(dataptr);
+      dataptr += 4;
+    }
+    else if (b0 == 30)
+    {
+      // Real number, skip nibbles until the end nibble...
+      while (dataptr < dataend && (*dataptr & 0x0f) != 0x0f && (*dataptr & 0xf0) != 0xf0)
+        dataptr ++;
+
+      if (dataptr < dataend)
+        dataptr ++;
+
+      operands[num_operands ++] = 0;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return (false);
+}
+
+
+//
+// '_ttfCFFGetIndex()' - Get the location of a CFF INDEX.
+//
+
+bool					// O - `true` on success, `false` on error
+_ttfCFFGetIndex(
+    const unsigned char *cff,		// I - CFF table
+    size_t              length,		// I - Length of CFF table
+    size_t              offset,		// I - Offset of INDEX
+    _ttf_cff_index_t    *index)		// O - INDEX information
+{
+  size_t	data,			// Offset of object data
+		last;			// Last offset in INDEX
+
+
+  memset(index, 0, sizeof(_ttf_cff_index_t));
+
+  if (length < 2 || offset > (length - 2))
+    return (false);
+
+  index->offset = offset;
+
+  if ((index->count = TTF_GET_USHORT(cff + offset)) == 0)
+  {
+    // Empty INDEX is just the count...
+    index->end = offset + 2;
+    return (true);
+  }
+
+  if (offset > (length - 3) || (index->off_size = cff[offset + 2]) < 1 || index->off_size > 4)
+    return (false);
+
+  data = offset + 3 + (index->count + 1) * index->off_size;
+
+  if (data > length)
+    return (false);
+
+  if ((index->end = _ttfCFFGetObject(cff, index, index->count - 1, &last) + last) > length)
+    return (false);
+
+  return (true);
+}
+
+
+//
+// '_ttfCFFGetObject()' - Get the location of an object in a CFF INDEX.
+//
+
+size_t					// O - Offset of object
+_ttfCFFGetObject(
+    const unsigned char    *cff,	// I - CFF table
+    const _ttf_cff_index_t *index,	// I - INDEX information
+    unsigned               n,		// I - Object number (0-based)
+    size_t                 *bytes)	// O - Size of object in bytes
+{
+  const unsigned char	*offptr;	// Pointer to offsets
+  size_t		start = 0,	// Start of object
+			end = 0;	// End of object
+  unsigned		i;		// Looping var
+
+
+  offptr = cff + index->offset + 3 + n * index->off_size;
+
+  for (i = 0; i < index->off_size; i ++)
+    start = (start << 8) | offptr[i];
+
+  for (offptr += index->off_size, i = 0; i < index->off_size; i ++)
+    end = (end << 8) | offptr[i];
+
+  *bytes = end > start ? end - start : 0;
+
+  // Offsets are relative to the byte before the object data...
+  return (index->offset + 2 + (index->count + 1) * index->off_size + start);
+}
+
+
+//
+// '_ttfCFFGetOutline()' - Decode the Type 2 charstring for a glyph.
+//
+// The outline is reported to the callback as move, line, cubic curve, and
+// close operations with absolute coordinates in font units.  Hints are
+// ignored.
+//
+
+bool					// O - `true` on success, `false` on error
+_ttfCFFGetOutline(
+    _ttf_cff_t        *cff,		// I - CFF outline data
+    unsigned          glyph,		// I - Glyph index
+    _ttf_outline_cb_t cb,		// I - Outline callback
+    void              *data)		// I - Callback data
+{
+  _ttf_cff_path_t	path;		// Path state
+  const _ttf_cff_index_t *subrs;	// Local Subrs INDEX
+  const unsigned char	*ptr,		// Pointer into charstring
+			*end,		// End of charstring
+			*calls[TTF_CFF_MAX_DEPTH][2];
+					// Subroutine return stack
+  int			depth = 0;	// Subroutine depth
+  float			stack[TTF_CFF_MAX_STACK],
+					// Argument stack
+			dx,		// Flex X delta
+			dy;		// Flex Y delta
+  unsigned		num = 0,	// Number of arguments
+			i,		// Looping var
+			op,		// Operator
+			fd = 0,		// Font DICT
+			num_stems = 0,	// Number of stem hints
+			count;		// Number of ranges
+  bool			have_width = false;
+					// Have the (optional) width argument been seen?
+  size_t		offset,		// Offset of charstring
+			bytes;		// Size of charstring
+  const _ttf_cff_index_t *index;	// Subroutine INDEX
+  int			subr;		// Subroutine number
+
+
+  if (!cff || glyph >= cff->charstrings.count)
+    return (false);
+
+  // Find the local subroutines for the glyph...
+  if (cff->fdselect && cff->fdselect[0] == 0)
+  {
+    // Format 0: Font DICT for each glyph
+    if ((1 + (size_t)glyph) < cff->fdselect_length)
+      fd = cff->fdselect[1 + glyph];
+  }
+  else if (cff->fdselect && cff->fdselect[0] == 3)
+  {
+    // Format 3: ranges of glyphs with a sentinel
+    count = TTF_GET_USHORT(cff->fdselect + 1);
+
+    if ((5 + 3 * (size_t)count) <= cff->fdselect_length)
+    {
+      for (i = 0; i < count; i ++)
+      {
+        if (glyph < TTF_GET_USHORT(cff->fdselect + 6 + 3 * i))
+        {
+          fd = cff->fdselect[5 + 3 * i];
+          break;
+        }
+      }
+    }
+  }
+
+  subrs = fd < cff->num_subrs ? cff->subrs + fd : cff->subrs;
+
+  // Get the charstring...
+  offset = _ttfCFFGetObject(cff->data, &cff->charstrings, glyph, &bytes);
+
+  if (offset > cff->length || bytes > (cff->length - offset))
+    return (false);
+
+  memset(&path, 0, sizeof(path));
+  path.cb   = cb;
+  path.data = data;
+
+  // Interpret the charstring...
+  for (ptr = cff->data + offset, end = ptr + bytes;;)
+  {
+    if (ptr >= end)
+    {
+      // Implicit return at the end of a subroutine...
+      if (depth == 0)
+        break;
+
+      depth --;
+      ptr = calls[depth][0];
+      end = calls[depth][1];
+      continue;
+    }
+
+    op = *ptr++;
+
+    if (op >= 32 || op == 28)
+    {
+      // Operand...
+      if (num >= TTF_CFF_MAX_STACK)
+        return (false);
+
+      if (op <= 246 && op != 28)
+      {
+        stack[num ++] = (float)((int)op - 139);
+      }
+      else if (op == 28)
+      {
+        if ((end - ptr) < 2)
+          return (false);
+
+        stack[num ++] = (float)TTF_GET_SHORT(ptr);
+        ptr += 2;
+      }
+      else if (op <= 250)
+      {
+        if (ptr >= end)
+          return (false);
+
+        stack[num ++] = (float)(((int)op - 247) * 256 + *ptr++ + 108);
+      }
+      else if (op <= 254)
+      {
+        if (ptr >= end)
+          return (false);
+
+        stack[num ++] = (float)(-((int)op - 251) * 256 - *ptr++ - 108);
+      }
+      else
+      {
+        // 16.16 fixed point number...
+        if ((end - ptr) < 4)
+          return (false);
+
+        stack[num ++] = (int)TTF_GET_ULONG(ptr) / 65536.0f;
+        ptr += 4;
+      }
+      continue;
+    }
+
+    if (op == 12)
+    {
+      if (ptr >= end)
+        return (false);
+
+      op = 0x0c00 | *ptr++;
+    }
+
+    // The first stack-clearing operator may have an extra width argument...
+    i = 0;
+
+    switch (op)
+    {
+      case 1 :				// hstem
+      case 3 :				// vstem
+      case 18 :				// hstemhm
+      case 23 :				// vstemhm
+          if (!have_width && (num & 1))
+            i = 1;
+
+          have_width = true;
+          num_stems  += num / 2;
+          num        = 0;
+          break;
+
+      case 19 :				// hintmask
+      case 20 :				// cntrmask
+          if (!have_width && (num & 1))
+            i = 1;
+
+          have_width = true;
+          num_stems  += num / 2;
+          num        = 0;
+          ptr        += (num_stems + 7) / 8;
+          break;
+
+      case 21 :				// rmoveto
+          if (!have_width && num > 2)
+            i = 1;
+
+          have_width = true;
+
+          if ((num - i) < 2)
+            return (false);
+
+          cff_move(&path, stack[i], stack[i + 1]);
+          num = 0;
+          break;
+
+      case 22 :				// hmoveto
+      case 4 :				// vmoveto
+          if (!have_width && num > 1)
+            i = 1;
+
+          have_width = true;
+
+          if ((num - i) < 1)
+            return (false);
+
+          if (op == 22)
+            cff_move(&path, stack[i], 0.0f);
+          else
+            cff_move(&path, 0.0f, stack[i]);
+
+          num = 0;
+          break;
+
+      case 5 :				// rlineto
+          for (; (i + 1) < num; i += 2)
+            cff_line(&path, stack[i], stack[i + 1]);
+
+          num = 0;
+          break;
+
+      case 6 :				// hlineto
+      case 7 :				// vlineto
+          for (; i < num; i ++)
+          {
+            if ((i & 1) == (op == 6 ? 0U : 1U))
+              cff_line(&path, stack[i], 0.0f);
+            else
+              cff_line(&path, 0.0f, stack[i]);
+          }
+
+          num = 0;
+          break;
+
+      case 8 :				// rrcurveto
+          for (; (i + 5) < num; i += 6)
+            cff_curve(&path, stack[i], stack[i + 1], stack[i + 2], stack[i + 3], stack[i + 4], stack[i + 5]);
+
+          num = 0;
+          break;
+
+      case 24 :				// rcurveline
+          for (; (i + 7) < num; i += 6)
+            cff_curve(&path, stack[i], stack[i + 1], stack[i + 2], stack[i + 3], stack[i + 4], stack[i + 5]);
+
+          if ((i + 1) < num)
+            cff_line(&path, stack[i], stack[i + 1]);
+
+          num = 0;
+          break;
+
+      case 25 :				// rlinecurve
+          for (; (i + 7) < num; i += 2)
+            cff_line(&path, stack[i], stack[i + 1]);
+
+          if ((i + 5) < num)
+            cff_curve(&path, stack[i], stack[i + 1], stack[i + 2], stack[i + 3], stack[i + 4], stack[i + 5]);
+
+          num = 0;
+          break;
+
+      case 26 :				// vvcurveto
+          dx = 0.0f;
+
+          if (num & 1)
+            dx = stack[i ++];
+
+          for (; (i + 3) < num; i += 4, dx = 0.0f)
+            cff_curve(&path, dx, stack[i], stack[i + 1], stack[i + 2], 0.0f, stack[i + 3]);
+
+          num = 0;
+          break;
+
+      case 27 :				// hhcurveto
+          dy = 0.0f;
+
+          if (num & 1)
+            dy = stack[i ++];
+
+          for (; (i + 3) < num; i += 4, dy = 0.0f)
+            cff_curve(&path, stack[i], dy, stack[i + 1], stack[i + 2], stack[i + 3], 0.0f);
+
+          num = 0;
+          break;
+
+      case 30 :				// vhcurveto
+      case 31 :				// hvcurveto
+          for (count = op == 31 ? 0 : 1; (i + 3) < num; i += 4, count ++)
+          {
+            // The last curve may have a fifth argument...
+            dx = (i + 5) == num ? stack[i + 4] : 0.0f;
+
+            if (count & 1)
+              cff_curve(&path, 0.0f, stack[i], stack[i + 1], stack[i + 2], stack[i + 3], dx);
+            else
+              cff_curve(&path, stack[i], 0.0f, stack[i + 1], stack[i + 2], dx, stack[i + 3]);
+          }
+
+          num = 0;
+          break;
+
+      case 0x0c00 | 34 :		// hflex
+          if (num >= 7)
+          {
+            cff_curve(&path, stack[0], 0.0f, stack[1], stack[2], stack[3], 0.0f);
+            cff_curve(&path, stack[4], 0.0f, stack[5], -stack[2], stack[6], 0.0f);
+          }
+
+          num = 0;
+          break;
+
+      case 0x0c00 | 35 :		// flex
+          if (num >= 12)
+          {
+            cff_curve(&path, stack[0], stack[1], stack[2], stack[3], stack[4], stack[5]);
+            cff_curve(&path, stack[6], stack[7], stack[8], stack[9], stack[10], stack[11]);
+          }
+
+          num = 0;
+          break;
+
+      case 0x0c00 | 36 :		// hflex1
+          if (num >= 9)
+          {
+            cff_curve(&path, stack[0], stack[1], stack[2], stack[3], stack[4], 0.0f);
+            cff_curve(&path, stack[5], 0.0f, stack[6], stack[7], stack[8], -(stack[1] + stack[3] + stack[7]));
+          }
+
+          num = 0;
+          break;
+
+      case 0x0c00 | 37 :		// flex1
+          if (num >= 11)
+          {
+            dx = stack[0] + stack[2] + stack[4] + stack[6] + stack[8];
+            dy = stack[1] + stack[3] + stack[5] + stack[7] + stack[9];
+
+            cff_curve(&path, stack[0], stack[1], stack[2], stack[3], stack[4], stack[5]);
+
+            if (fabsf(dx) > fabsf(dy))
+              cff_curve(&path, stack[6], stack[7], stack[8], stack[9], stack[10], -dy);
+            else
+              cff_curve(&path, stack[6], stack[7], stack[8], stack[9], -dx, stack[10]);
+          }
+
+          num = 0;
+          break;
+
+      case 10 :				// callsubr
+      case 29 :				// callgsubr
+          index = op == 10 ? subrs : &cff->gsubrs;
+
+          if (num == 0 || depth >= TTF_CFF_MAX_DEPTH)
+            return (false);
+
+          subr = (int)stack[-- num] + (int)get_bias(index->count);
+
+          if (subr < 0 || (unsigned)subr >= index->count)
+            return (false);
+
+          offset = _ttfCFFGetObject(cff->data, index, (unsigned)subr, &bytes);
+
+          if (offset > cff->length || bytes > (cff->length - offset))
+            return (false);
+
+          calls[depth][0] = ptr;
+          calls[depth][1] = end;
+          depth ++;
+
+          ptr = cff->data + offset;
+          end = ptr + bytes;
+          break;
+
+      case 11 :				// return
+          if (depth == 0)
+            return (false);
+
+          depth --;
+          ptr = calls[depth][0];
+          end = calls[depth][1];
+          break;
+
+      case 14 :				// endchar
+          cff_close(&path);
+          return (true);
+
+      default :				// Arithmetic and other operators are not supported
+          num = 0;
+          break;
+    }
+  }
+
+  cff_close(&path);
+
+  return (true);
+}
+
+
+//
+// 'cff_close()' - Close the current contour.
+//
+
+static void
+cff_close(_ttf_cff_path_t *path)	// I - Path state
+{
+  if (path->open)
+  {
+    (path->cb)(path->data, _TTF_OUTLINE_CLOSE, NULL);
+    path->open = false;
+  }
+}
+
+
+//
+// 'cff_curve()' - Add a cubic Bézier curve to the current contour.
+//
+
+static void
+cff_curve(_ttf_cff_path_t *path,	// I - Path state
+          float           dx1,		// I - First control point X delta
+          float           dy1,		// I - First control point Y delta
+          float           dx2,		// I - Second control point X delta
+          float           dy2,		// I - Second control point Y delta
+          float           dx3,		// I - End point X delta
+          float           dy3)		// I - End point Y delta
+{
+  float	points[6];			// Curve points
+
+
+  points[0] = path->x + dx1;
+  points[1] = path->y + dy1;
+  points[2] = points[0] + dx2;
+  points[3] = points[1] + dy2;
+  points[4] = points[2] + dx3;
+  points[5] = points[3] + dy3;
+
+  path->x = points[4];
+  path->y = points[5];
+
+  (path->cb)(path->data, _TTF_OUTLINE_CUBIC, points);
+}
+
+
+//
+// 'cff_line()' - Add a line to the current contour.
+//
+
+static void
+cff_line(_ttf_cff_path_t *path,		// I - Path state
+         float           dx,		// I - X delta
+         float           dy)		// I - Y delta
+{
+  float	points[2];			// Line end point
+
+
+  path->x += dx;
+  path->y += dy;
+
+  points[0] = path->x;
+  points[1] = path->y;
+
+  (path->cb)(path->data, _TTF_OUTLINE_LINE, points);
+}
+
+
+//
+// 'cff_move()' - Start a new contour.
+//
+
+static void
+cff_move(_ttf_cff_path_t *path,		// I - Path state
+         float           dx,		// I - X delta
+         float           dy)		// I - Y delta
+{
+  float	points[2];			// Start point
+
+
+  cff_close(path);
+
+  path->x += dx;
+  path->y += dy;
+  path->open = true;
+
+  points[0] = path->x;
+  points[1] = path->y;
+
+  (path->cb)(path->data, _TTF_OUTLINE_MOVE, points);
+}
+
+
+//
+// 'get_bias()' - Get the subroutine number bias for a Subrs INDEX.
+//
+
+static unsigned				// O - Bias
+get_bias(unsigned count)		// I - Number of subroutines
+{
+  if (count < 1240)
+    return (107);
+  else if (count < 33900)
+    return (1131);
+  else
+    return (32768);
+}
@@ -0,0 +1,760 @@
+//
+// Character coverage code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+
+
+//
+// Local functions...
+//
+
+static bool	combine_coverage(ttf_coverage_t *coverage, const ttf_coverage_t *other, bool intersect);
+static bool	contains_char(const ttf_coverage_t *coverage, int ch);
+static unsigned	count_bits(uint64_t bits);
+static const uint64_t *get_page(const ttf_coverage_t *coverage, unsigned page);
+static bool	is_extender(int ch);
+static bool	is_printable(const uint64_t *bits);
+static int	next_char(const unsigned char **ptr, const unsigned char *end);
+
+
+//
+// 'ttfCoverageContainsChar()' - Test whether a character is covered.
+//
+
+bool					// O - `true` if covered, `false` otherwise
+ttfCoverageContainsChar(
+    const ttf_coverage_t *coverage,	// I - Coverage
+    int                  ch)		// I - Unicode character
+{
+  return (coverage && contains_char(coverage, ch));
+}
+
+
+//
+// 'ttfCoverageCopy()' - Copy a character coverage set.
+//
+// This function makes a copy of the coverage that can be combined with other
+// coverage sets using @link ttfCoverageIntersect@ and @link ttfCoverageUnion@.
+// Pass `NULL` to create an empty coverage set.  The copy must be freed using
+// @link ttfCoverageDelete@.
+//
+
+ttf_coverage_t *			// O - New coverage or `NULL` on error
+ttfCoverageCopy(
+    const ttf_coverage_t *coverage)	// I - Coverage or `NULL` for none
+{
+  ttf_coverage_t	*copy;		// New coverage
+
+
+  if ((copy = calloc(1, sizeof(ttf_coverage_t))) == NULL)
+    return (NULL);
+
+  if (coverage && coverage->num_pages > 0)
+  {
+    if ((copy->pages = malloc(coverage->num_pages * sizeof(copy->pages[0]))) == NULL)
+    {
+      free(copy);
+      return (NULL);
+    }
+
+    memcpy(copy->summary, coverage->summary, sizeof(copy->summary));
+    memcpy(copy->rank, coverage->rank, sizeof(copy->rank));
+    memcpy(copy->pages, coverage->pages, coverage->num_pages * sizeof(copy->pages[0]));
+
+    copy->printable   = coverage->printable;
+    copy->num_pages   = coverage->num_pages;
+    copy->alloc_pages = coverage->num_pages;
+  }
+
+  return (copy);
+}
+
+
+//
+// 'ttfCoverageDelete()' - Free a character coverage set.
+//
+// Only coverage sets returned by @link ttfCoverageCopy@ should be freed.
+//
+
+void
+ttfCoverageDelete(
+    ttf_coverage_t *coverage)		// I - Coverage
+{
+  if (coverage)
+  {
+    if (coverage->alloc_pages)
+      free(coverage->pages);
+
+    free(coverage);
+  }
+}
+
+
+//
+// 'ttfCoverageFindMissing()' - Find the first character that is not covered.
+//
+// This function checks each character in the UTF-8 string "s" and returns the
+// byte offset of the first character that is not covered.  The "len" argument
+// specifies the length of the string in bytes or `0` if the string is
+// nul-terminated.  If all characters are covered, the length of the string is
+// returned.  Invalid UTF-8 sequences are never covered.
+//
+
+size_t					// O - Offset of first missing character or length of string
+ttfCoverageFindMissing(
+    const ttf_coverage_t *coverage,	// I - Coverage
+    const char           *s,		// I - UTF-8 string
+    size_t               len)		// I - Length of string in bytes or `0` for nul-terminated
+{
+  const unsigned char	*start,		// Start of string
+			*ptr,		// Pointer into string
+			*cptr,		// Start of current character
+			*end;		// End of string
+  const uint64_t	*ascii;		// ASCII bitset
+  uint64_t		word,		// 8 bytes of string
+			missing;	// Missing characters
+  int			ch,		// Current character
+			i;		// Looping var
+
+
+  if (!s)
+    return (0);
+
+  if (!len)
+    len = strlen(s);
+
+  if (!coverage)
+    return (0);
+
+  start = ptr = (const unsigned char *)s;
+  end   = start + len;
+  ascii = get_page(coverage, 0);
+
+  while (ptr < end)
+  {
+    if ((end - ptr) >= 8 && ascii)
+    {
+      // Check 8 ASCII characters at a time...
+      memcpy(&word, ptr, sizeof(word));
+
+      if (!(word & 0x8080808080808080ULL))
+      {
+        if (coverage->printable && ((word - 0x2020202020202020ULL) & 0x8080808080808080ULL) == 0 && (((word ^ 0x7f7f7f7f7f7f7f7fULL) - 0x0101010101010101ULL) & ~(word ^ 0x7f7f7f7f7f7f7f7fULL) & 0x8080808080808080ULL) == 0)
+        {
+          // All printable and all covered...
+          ptr += 8;
+          continue;
+        }
+
+        for (i = 0, missing = 0; i < 8; i ++)
+          missing |= ((~ascii[ptr[i] >> 6] >> (ptr[i] & 63)) & 1) << i;
+
+        if (!missing)
+        {
+          ptr += 8;
+          continue;
+        }
+
+        for (i = 0; !(missing & 1); i ++, missing >>= 1);
+
+        return ((size_t)(ptr + i - start));
+      }
+    }
+
+    // Check the next character...
+    cptr = ptr;
+
+    if ((ch = next_char(&ptr, end)) < 0 || !contains_char(coverage, ch))
+      return ((size_t)(cptr - start));
+  }
+
+  return (len);
+}
+
+
+//
+// 'ttfCoverageGetCount()' - Get the number of characters covered.
+//
+
+size_t					// O - Number of characters
+ttfCoverageGetCount(
+    const ttf_coverage_t *coverage)	// I - Coverage
+{
+  size_t	count = 0,		// Number of characters
+		i;			// Looping var
+
+
+  if (coverage)
+  {
+    for (i = 0; i < coverage->num_pages * 4; i ++)
+    {
+      count += count_bits(coverage->pages[i / 4][i & 3]);
+    }
+  }
+
+  return (count);
+}
+
+
+//
+// 'ttfCoverageIntersect()' - Intersect two character coverage sets.
+//
+// This function removes any characters from "coverage" that are not also in
+// "other".
+//
+
+bool					// O - `true` on success, `false` on error
+ttfCoverageIntersect(
+    ttf_coverage_t       *coverage,	// I - Coverage to modify
+    const ttf_coverage_t *other)	// I - Other coverage
+{
+  if (!coverage || !other)
+    return (false);
+
+  return (combine_coverage(coverage, other, true));
+}
+
+
+//
+// 'ttfCoverageUnion()' - Combine two character coverage sets.
+//
+// This function adds the characters in "other" to "coverage".
+//
+
+bool					// O - `true` on success, `false` on error
+ttfCoverageUnion(
+    ttf_coverage_t       *coverage,	// I - Coverage to modify
+    const ttf_coverage_t *other)	// I - Other coverage
+{
+  if (!coverage || !other)
+    return (false);
+
+  return (combine_coverage(coverage, other, false));
+}
+
+
+//
+// 'ttfGetCoverage()' - Get the character coverage of a font.
+//
+// This function returns the set of Unicode characters in the font, which is
+// built the first time it is requested.  The coverage holds a summary of the
+// 256-character pages used by the font and a bitset for each of those pages.
+// The returned coverage belongs to the font and must not be freed - use
+// @link ttfCoverageCopy@ to get a copy that can be combined with others.
+//
+
+const ttf_coverage_t *			// O - Coverage or `NULL` on error
+ttfGetCoverage(ttf_t *font)		// I - Font
+{
+  ttf_coverage_t	*coverage;	// Coverage
+  size_t		ch;		// Current character
+  unsigned		page;		// Current page
+  uint64_t		bits[4];	// Current page bits
+  bool			empty;		// Is the current page empty?
+
+
+  if (!font)
+    return (NULL);
+
+  _ttfMutexLock(&font->lock);
+
+  if (!font->coverage && (coverage = ttfCoverageCopy(NULL)) != NULL)
+  {
+    // Build the coverage from the Unicode to glyph map...
+    for (page = 0; page < TTF_COVERAGE_PAGES && page * 256 < font->num_cmap; page ++)
+    {
+      memset(bits, 0, sizeof(bits));
+      empty = true;
+
+      for (ch = page * 256; ch < (page + 1) * 256 && ch < font->num_cmap; ch ++)
+      {
+        if (font->cmap[ch] > 0)
+        {
+          bits[(ch & 255) / 64] |= (uint64_t)1 << (ch & 63);
+          empty = false;
+        }
+      }
+
+      if (!empty && !_ttfCoverageAddPage(coverage, page, bits))
+      {
+        _ttfError(font, "Unable to allocate memory for character coverage.");
+        ttfCoverageDelete(coverage);
+        coverage = NULL;
+        break;
+      }
+    }
+
+    font->coverage = coverage;
+  }
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (font->coverage);
+}
+
+
+//
+// 'ttfGetFontRuns()' - Split a string into runs using a stack of fonts.
+//
+// This function splits the UTF-8 string "s" into maximal runs of characters
+// that use the same font from the ordered list of "num_fonts" fonts in
+// "fonts", in the manner of a CSS font stack.  Each character uses the first
+// font that contains it.  Characters that are not in any font are grouped into
+// runs whose "font" is `NULL` and "font_index" is "num_fonts" - these render
+// using the ".notdef" glyph.  The "len" argument specifies the length of the
+// string in bytes or `0` if the string is nul-terminated.
+//
+// Spaces stay in the current run when its font contains them, while control
+// characters, combining marks, joiners, and variation selectors always stay
+// with the preceding character.
+//
+// The "runs" argument points to an array of up to "max_runs" `ttf_font_run_t`
+// structures that receive the byte offsets and font of each run.  The return
+// value is the total number of runs, which may be larger than "max_runs".
+//
+
+size_t					// O - Number of runs
+ttfGetFontRuns(ttf_t          **fonts,	// I - Fonts in order of preference
+               size_t         num_fonts,	// I - Number of fonts
+               const char     *s,	// I - UTF-8 string
+               size_t         len,	// I - Length of string in bytes or `0` for nul-terminated
+               size_t         max_runs,	// I - Maximum number of runs
+               ttf_font_run_t *runs)	// O - Runs
+{
+  size_t		i,		// Looping var
+			current = 0,	// Font for current run
+			num_runs = 0;	// Number of runs
+  const ttf_coverage_t	**coverages = NULL;
+					// Coverage for each font
+  const unsigned char	*start,		// Start of string
+			*ptr,		// Pointer into string
+			*cptr,		// Start of current character
+			*end;		// End of string
+  int			ch;		// Current character
+
+
+  // Range check input...
+  if (!s || (num_fonts > 0 && !fonts))
+    return (0);
+
+  if (!runs)
+    max_runs = 0;
+
+  if (!len)
+    len = strlen(s);
+
+  if (num_fonts > 0)
+  {
+    if ((coverages = calloc(num_fonts, sizeof(ttf_coverage_t *))) == NULL)
+      return (0);
+
+    for (i = 0; i < num_fonts; i ++)
+      coverages[i] = ttfGetCoverage(fonts[i]);
+  }
+
+  start = ptr = (const unsigned char *)s;
+  end   = start + len;
+
+  while (ptr < end)
+  {
+    if (num_runs > 0 && current == 0 && num_fonts > 0 && coverages[0])
+    {
+      // Skip characters in the first font, 8 ASCII characters at a time...
+      if ((ptr += ttfCoverageFindMissing(coverages[0], (const char *)ptr, (size_t)(end - ptr))) >= end)
+        break;
+    }
+
+    cptr = ptr;
+    ch   = next_char(&ptr, end);
+
+    if (ch >= 0 && is_extender(ch))
+      continue;
+
+    if (num_runs > 0 && current < num_fonts && (ch == ' ' || ch == 0xa0 || ch == 0x3000) && contains_char(coverages[current], ch))
+      continue;
+
+    // Find the first font containing the character...
+    for (i = 0; i < num_fonts; i ++)
+    {
+      if (coverages[i] && ch >= 0 && contains_char(coverages[i], ch))
+        break;
+    }
+
+    if (num_runs > 0 && i == current)
+      continue;
+
+    // Start a new run...
+    if (num_runs > 0 && num_runs <= max_runs)
+      runs[num_runs - 1].end = (size_t)(cptr - start);
+
+    if (num_runs < max_runs)
+    {
+      runs[num_runs].start      = num_runs > 0 ? (size_t)(cptr - start) : 0;
+      runs[num_runs].end        = len;
+      runs[num_runs].font_index = i;
+      runs[num_runs].font       = i < num_fonts ? fonts[i] : NULL;
+    }
+
+    current = i;
+    num_runs ++;
+  }
+
+  if (num_runs == 0 && len > 0)
+  {
+    // String only contains control characters and marks, use the first font...
+    if (max_runs > 0)
+    {
+      runs[0].start      = 0;
+      runs[0].end        = len;
+      runs[0].font_index = 0;
+      runs[0].font       = num_fonts > 0 ? fonts[0] : NULL;
+    }
+
+    num_runs = 1;
+  }
+
+  free(coverages);
+
+  return (num_runs);
+}
+
+
+//
+// '_ttfCoverageAddPage()' - Add a page bitset to a coverage set.
+//
+// Pages must be added in increasing order.
+//
+
+bool					// O - `true` on success, `false` on error
+_ttfCoverageAddPage(
+    ttf_coverage_t *coverage,		// I - Coverage
+    unsigned       page,		// I - Page number
+    const uint64_t *bits)		// I - Page bits
+{
+  unsigned	i;			// Looping var
+  uint64_t	(*pages)[4];		// New page bitsets
+
+
+  if (page >= TTF_COVERAGE_PAGES || (coverage->summary[page / 64] >> (page & 63)))
+    return (false);
+
+  for (i = page / 64 + 1; i < TTF_COVERAGE_SUMMARY; i ++)
+  {
+    if (coverage->summary[i])
+      return (false);			// Not in increasing order
+  }
+
+  if (coverage->num_pages >= coverage->alloc_pages)
+  {
+    if ((pages = realloc(coverage->pages, (coverage->alloc_pages + 16) * sizeof(pages[0]))) == NULL)
+      return (false);
+
+    coverage->pages       = pages;
+    coverage->alloc_pages += 16;
+  }
+
+  memcpy(coverage->pages[coverage->num_pages], bits, sizeof(coverage->pages[0]));
+
+  coverage->num_pages ++;
+  coverage->summary[page / 64] |= (uint64_t)1 << (page & 63);
+
+  for (i = page / 64 + 1; i < TTF_COVERAGE_SUMMARY; i ++)
+    coverage->rank[i] ++;
+
+  if (page == 0)
+    coverage->printable = is_printable(bits);
+
+  return (true);
+}
+
+
+//
+// '_ttfCoverageGetPage()' - Get the Nth page bitset in a coverage set.
+//
+
+int					// O - Page number or `-1` if none
+_ttfCoverageGetPage(
+    const ttf_coverage_t *coverage,	// I - Coverage
+    size_t               n,		// I - Page bitset index
+    uint64_t             *bits)		// O - Page bits
+{
+  unsigned	i,			// Looping var
+		count;			// Number of pages in summary word
+  uint64_t	pages;			// Pages in summary word
+  int		page;			// Page number
+
+
+  if (!coverage || n >= coverage->num_pages)
+    return (-1);
+
+  // Find the summary word and bit for this page...
+  for (i = TTF_COVERAGE_SUMMARY - 1; i > 0 && (coverage->rank[i] > n || !coverage->summary[i]); i --);
+
+  for (pages = coverage->summary[i], count = coverage->rank[i], page = (int)i * 64; pages; pages >>= 1, page ++)
+  {
+    if ((pages & 1) && count ++ == n)
+      break;
+  }
+
+  memcpy(bits, coverage->pages[n], sizeof(coverage->pages[0]));
+
+  return (page);
+}
+
+
+//
+// '_ttfCoverageSetPages()' - Use existing page bitsets for a coverage set.
+//
+// The page bitsets are not copied and must remain valid for the life of the
+// coverage set, which must not be freed with @link ttfCoverageDelete@.  The
+// number of pages must match the summary.
+//
+
+bool					// O - `true` on success, `false` if the pages don't match the summary
+_ttfCoverageSetPages(
+    ttf_coverage_t       *coverage,	// I - Coverage
+    const uint64_t       *summary,	// I - Page summary
+    const uint64_t       (*pages)[4],	// I - Page bitsets
+    size_t               num_pages)	// I - Number of page bitsets
+{
+  unsigned	i;			// Looping var
+  size_t	count = 0;		// Number of pages in summary
+
+
+  memset(coverage, 0, sizeof(ttf_coverage_t));
+
+  for (i = 0; i < TTF_COVERAGE_SUMMARY; i ++)
+  {
+    coverage->summary[i] = summary[i];
+    coverage->rank[i]    = (unsigned short)count;
+    count                += count_bits(summary[i]);
+  }
+
+  if (count != num_pages)
+    return (false);
+
+  coverage->num_pages = num_pages;
+  coverage->pages     = (uint64_t (*)[4])pages;
+
+  if (summary[0] & 1)
+    coverage->printable = is_printable(pages[0]);
+
+  return (true);
+}
+
+
+//
+// 'combine_coverage()' - Intersect or union two coverage sets.
+//
+// The page summaries are combined first so that only pages present in either
+// (union) or both (intersection) sets are visited.
+//
+
+static bool				// O - `true` on success, `false` on error
+combine_coverage(
+    ttf_coverage_t       *coverage,	// I - Coverage to modify
+    const ttf_coverage_t *other,	// I - Other coverage
+    bool                 intersect)	// I - Intersect instead of union?
+{
+  ttf_coverage_t	temp;		// New coverage
+  unsigned		i,		// Looping var
+			page;		// Current page
+  uint64_t		pages,		// Pages in current summary word
+			bits[4];	// Combined page bits
+  const uint64_t	*a,		// Page bits in coverage
+			*b;		// Page bits in other
+  static const uint64_t	none[4] = { 0, 0, 0, 0 };
+					// Empty page
+
+
+  memset(&temp, 0, sizeof(temp));
+
+  for (i = 0; i < TTF_COVERAGE_SUMMARY; i ++)
+  {
+    if (intersect)
+      pages = coverage->summary[i] & other->summary[i];
+    else
+      pages = coverage->summary[i] | other->summary[i];
+
+    for (page = i * 64; pages; page ++, pages >>= 1)
+    {
+      if (!(pages & 1))
+        continue;
+
+      if ((a = get_page(coverage, page)) == NULL)
+        a = none;
+      if ((b = get_page(other, page)) == NULL)
+        b = none;
+
+      if (intersect)
+      {
+        bits[0] = a[0] & b[0];
+        bits[1] = a[1] & b[1];
+        bits[2] = a[2] & b[2];
+        bits[3] = a[3] & b[3];
+      }
+      else
+      {
+        bits[0] = a[0] | b[0];
+        bits[1] = a[1] | b[1];
+        bits[2] = a[2] | b[2];
+        bits[3] = a[3] | b[3];
+      }
+
+      if ((bits[0] | bits[1] | bits[2] | bits[3]) && !_ttfCoverageAddPage(&temp, page, bits))
+      {
+        free(temp.pages);
+        return (false);
+      }
+    }
+  }
+
+  free(coverage->pages);
+
+  *coverage = temp;
+
+  return (true);
+}
+
+
+//
+// 'contains_char()' - Test whether a character is covered.
+//
+
+static bool				// O - `true` if covered, `false` otherwise
+contains_char(
+    const ttf_coverage_t *coverage,	// I - Coverage
+    int                  ch)		// I - Unicode character
+{
+  const uint64_t	*bits;			// Page bits
+
+
+  if (ch < 0 || ch >= TTF_FONT_MAX_CHAR || (bits = get_page(coverage, (unsigned)ch / 256)) == NULL)
+    return (false);
+
+  return ((bits[(ch & 255) / 64] >> (ch & 63)) & 1);
+}
+
+
+//
+// 'count_bits()' - Count the number of bits that are set.
+//
+
+static unsigned				// O - Number of bits set
+count_bits(uint64_t bits)		// I - Bits
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return ((unsigned)__builtin_popcountll(bits));
+#else
+  unsigned	count;			// Number of bits
+
+
+  for (count = 0; bits; bits &= bits - 1)
+    count ++;
+
+  return (count);
+#endif // __GNUC__ || __clang__
+}
+
+
+//
+// 'get_page()' - Get the bitset for a page.
+//
+// The page bitsets are stored in page order, so the index of a page's bitset
+// is the number of pages before it in the summary.
+//
+
+static const uint64_t *			// O - Page bits or `NULL` if none
+get_page(
+    const ttf_coverage_t *coverage,	// I - Coverage
+    unsigned             page)		// I - Page number
+{
+  uint64_t	summary = coverage->summary[page / 64],
+					// Summary word
+		mask = (uint64_t)1 << (page & 63);
+					// Bit for page
+
+
+  if (!(summary & mask))
+    return (NULL);
+
+  return (coverage->pages[coverage->rank[page / 64] + count_bits(summary & (mask - 1))]);
+}
+
+
+//
+// 'is_extender()' - Determine whether a character continues the current run.
+//
+// Control characters, combining marks, joiners, and variation selectors stay
+// with the preceding character's font even when they are not in its cmap.
+//
+
+static bool				// O - `true` if character continues the run
+is_extender(int ch)			// I - Unicode character
+{
+  return (ch < 0x20 || ch == 0x7f || (ch >= 0x0300 && ch <= 0x036f) || (ch >= 0x1ab0 && ch <= 0x1aff) || (ch >= 0x1dc0 && ch <= 0x1dff) || ch == 0x200c || ch == 0x200d || (ch >= 0x20d0 && ch <= 0x20ff) || (ch >= 0xfe00 && ch <= 0xfe0f) || (ch >= 0xfe20 && ch <= 0xfe2f) || (ch >= 0xe0100 && ch <= 0xe01ef));
+}
+
+
+//
+// 'is_printable()' - Determine whether a page contains all printable ASCII.
+//
+
+static bool				// O - `true` if all printable ASCII is present
+is_printable(const uint64_t *bits)	// I - Bits for first page
+{
+  // 0x20 to 0x3f are in the first word, 0x40 to 0x7e in the second...
+  return ((bits[0] & 0xffffffff00000000ULL) == 0xffffffff00000000ULL && (bits[1] & 0x7fffffffffffffffULL) == 0x7fffffffffffffffULL);
+}
+
+
+//
+// 'next_char()' - Decode the next UTF-8 character.
+//
+
+static int				// O  - Unicode character or `-1` if invalid
+next_char(const unsigned char **ptr,	// IO - Pointer into string
+          const unsigned char *end)	// I  - End of string
+{
+  const unsigned char	*p = *ptr;	// Pointer into string
+  int			ch;		// Unicode character
+
+
+  if (*p < 0x80)
+  {
+    ch = *p++;
+  }
+  else if ((*p & 0xe0) == 0xc0 && (end - p) >= 2 && (p[1] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+    p  += 2;
+  }
+  else if ((*p & 0xf0) == 0xe0 && (end - p) >= 3 && (p[1] & 0xc0) == 0x80 && (p[2] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+    p  += 3;
+  }
+  else if ((*p & 0xf8) == 0xf0 && (end - p) >= 4 && (p[1] & 0xc0) == 0x80 && (p[2] & 0xc0) == 0x80 && (p[3] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+    p  += 4;
+  }
+  else
+  {
+    // Invalid UTF-8, skip a byte...
+    ch = -1;
+    p  ++;
+  }
+
+  *ptr = p;
+
+  return (ch);
+}
@@ -10,17 +10,28 @@
 //
 
 #include "ttf-private.h"
+#include <math.h>
 
 
 //
 // Constants...
 //
 
-#define TTF_FONT_MAX_CHAR	262144	// Maximum number of character values
 #define TTF_FONT_MAX_GROUPS	65536	// Maximum number of sub-groups
 #define TTF_FONT_MAX_KERNING	262144	// Maximum number of kerning pairs
+#define TTF_KERNING_ORDER_SIZE	10	// Size of a kerning pair with its original order
+#define TTF_OFF_GPOS_kern	0x6b65726e	// GPOS kerning feature
+#define TTF_OFF_GPOS_Extension	9	// GPOS extension lookup type
+#define TTF_OFF_GPOS_PairPos	2	// GPOS pair adjustment lookup type
+#define TTF_OFF_GSUB_DFLT	0x44464c54	// GSUB default script
+#define TTF_OFF_GSUB_latn	0x6c61746e	// GSUB Latin script
+#define TTF_OFF_GSUB_liga	0x6c696761	// GSUB standard ligatures feature
+#define TTF_OFF_GSUB_Extension	7	// GSUB extension lookup type
+#define TTF_OFF_GSUB_Ligature	4	// GSUB ligature substitution lookup type
 #define TTF_FONT_MAX_NAMES	16777216// Maximum size of names table we support
 
+#define TTF_EXTENTS_SHARDS	16	// Number of extents cache shards
+
 
 //
 // TTF/OFF tag constants...
@@ -28,14 +39,23 @@
 
 #define TTF_OFF_bhed	0x62686564	// Bitmap font header
 #define TTF_OFF_cmap	0x636d6170	// Character to glyph mapping
+#define TTF_OFF_GPOS	0x47504f53	// Glyph positioning
+#define TTF_OFF_glyf	0x676c7966	// Glyph data
+#define TTF_OFF_GSUB	0x47535542	// Glyph substitution
+#define TTF_OFF_hdmx	0x68646d78	// Horizontal device metrics
 #define TTF_OFF_head	0x68656164	// Font header
 #define TTF_OFF_hhea	0x68686561	// Horizontal header
 #define TTF_OFF_hmtx	0x686d7478	// Horizontal metrics
 #define TTF_OFF_kern	0x6b65726e	// Kerning tables
+#define TTF_OFF_loca	0x6c6f6361	// Glyph locations
 #define TTF_OFF_maxp	0x6d617870	// Maximum profile
 #define TTF_OFF_name	0x6e616d65	// Naming table
 #define TTF_OFF_OS_2	0x4f532f32	// OS/2 and Windows specific metrics
 #define TTF_OFF_post	0x706f7374	// PostScript information
+#define TTF_OFF_VDMX	0x56444d58	// Vertical device metrics
+#define TTF_OFF_vhea	0x76686561	// Vertical header
+#define TTF_OFF_vmtx	0x766d7478	// Vertical metrics
+#define TTF_OFF_VORG	0x564f5247	// Vertical origin
 
 #define TTF_OFF_Unicode		0	// Unicode platform ID
 #define TTF_OFF_Unicode_Full_20	4	// Unicode 2.0 full repertoire
@@ -63,98 +83,6 @@
 // Local types...
 //
 
-typedef struct _ttf_kerning_s		// Font kerning data
-{
-  unsigned short left,			// Left glyph
-		right;			// Right glyph
-  short		adj;			// Horizontal adjustment
-} _ttf_kerning_t;
-
-typedef struct _ttf_metric_s		// Font metric information
-{
-  short		width,			// Advance width
-		left_bearing;		// Left side bearing
-} _ttf_metric_t;
-
-typedef struct _ttf_off_dir_s		// OFF/TTF directory entry
-{
-  unsigned	tag;			// Table identifier
-  unsigned	checksum;		// Checksum of table
-  unsigned	offset;			// Offset from the beginning of the file
-  unsigned	length;			// Length
-} _ttf_off_dir_t;
-
-typedef struct _ttf_off_table_s		// OFF/TTF offset table
-{
-  int		num_entries;		// Number of table entries
-  _ttf_off_dir_t *entries;		// Table entries
-} _ttf_off_table_t;
-
-typedef struct _ttf_off_name_s		// OFF/TTF name string
-{
-  unsigned short platform_id,		// Platform identifier
-		encoding_id,		// Encoding identifier
-		language_id,		// Language identifier
-		name_id,		// Name identifier
-		length,			// Length of string
-		offset;			// Offset from start of storage area
-} _ttf_off_name_t;
-
-typedef struct _ttf_off_names_s		// OFF/TTF naming table
-{
-  int		num_names;		// Number of names
-  _ttf_off_name_t *names;		// Names
-  unsigned char	*storage;		// Storage area
-  unsigned	storage_size;		// Size of storage area
-} _ttf_off_names_t;
-
-typedef size_t (*_ttf_read_cb_t)(ttf_t *font, void *buffer, size_t bytes);
-				// Font read callback, returns number of bytes read
-typedef bool (*_ttf_seek_cb_t)(ttf_t *font, size_t offset);
-				// Font seek callback, returns `true` on success
-
-struct _ttf_s
-{
-  _ttf_read_cb_t read_cb;		// Read callback
-  _ttf_seek_cb_t seek_cb;		// Seek callback
-  int		file_fd;		// File descriptor for ttfCreate
-  const char	*data;			// Font data for ttfCreateData
-  size_t	data_size;		// Size of font data for ttfCreateData
-  size_t	data_offset;		// Offset within input
-  size_t	idx;			// Font number in file
-  ttf_err_cb_t	err_cb;			// Error callback, if any
-  void		*err_cbdata;		// Error callback data
-  _ttf_off_table_t table;		// Offset table
-  _ttf_off_names_t names;		// Names
-  size_t	num_fonts;		// Number of fonts in this file
-  char		*copyright;		// Copyright string
-  char		*family;		// Font family string
-  char		*postscript_name;	// PostScript name string
-  char		*version;		// Font version string
-  bool		is_fixed;		// Is this a fixed-width font?
-  int		max_char,		// Last character in font
-		min_char;		// First character in font
-  size_t	num_cmap;		// Number of entries in glyph map
-  int		*cmap;			// Unicode character to glyph map
-  _ttf_metric_t	*widths[TTF_FONT_MAX_CHAR / 256];
-					// Character metrics (sparse array)
-  size_t	num_kerning;		// Number of kerning pairs
-  _ttf_kerning_t *kerning;		// Kerning pairs
-  float		units;			// Width units
-  short		ascent,			// Maximum ascent above baseline
-		descent,		// Maximum descent below baseline
-		cap_height,		// "A" height
-		x_height,		// "x" height
-		x_max,			// Bounding box
-		x_min,
-		y_max,
-		y_min,
-		weight;			// Font weight
-  float		italic_angle;		// Angle of italic text
-  ttf_stretch_t	stretch;		// Font stretch value
-  ttf_style_t	style;			// Font style
-};
-
 typedef struct _ttf_off_cmap4_s		// Format 4 cmap table
 {
   unsigned short startCode,		// First character
@@ -198,7 +126,8 @@ typedef struct _ttf_off_head_s		// Font header
 typedef struct _ttf_off_hhea_s		// Horizontal header
 {
   short		ascender,		// Ascender
-		descender;		// Descender
+		descender,		// Descender
+		lineGap;		// Line gap
   unsigned short numberOfHMetrics;	// Number of horizontal metrics
 } _ttf_off_hhea_t;
 
@@ -206,9 +135,11 @@ typedef struct _ttf_off_os_2_s		// OS/2 information
 {
   unsigned short usWeightClass,		// Font weight
 		usWidthClass,		// Font weight
-		fsType;			// Type bits
+		fsType,			// Type bits
+		fsSelection;		// Selection bits
   short		sTypoAscender,		// Ascender
 		sTypoDescender,		// Descender
+		sTypoLineGap,		// Line gap
 		sxHeight,		// xHeight
 		sCapHeight;		// CapHeight
 } _ttf_off_os_2_t;
@@ -219,1088 +150,3585 @@ typedef struct _ttf_off_post_s		// PostScript information
   unsigned	isFixedPitch;		// Fixed-width font?
 } _ttf_off_post_t;
 
+typedef struct _ttf_outline_bounds_s	// Outline bounds state
+{
+  bool		empty;			// No points yet?
+  float		x,			// Current X position
+		y,			// Current Y position
+		x_min,			// Bounding box
+		y_min,
+		x_max,
+		y_max;
+} _ttf_outline_bounds_t;
+
 
 //
 // Local functions...
 //
 
-static int	compare_kerning(_ttf_kerning_t *a, _ttf_kerning_t *b);
-static char	*copy_name(ttf_t *font, unsigned name_id);
+static void	add_glyph_range(ttf_glyph_range_t *current, bool sequential, int glyph, int value, ttf_glyph_range_t *ranges, size_t max_ranges, size_t *num_ranges);
+static _ttf_kern_class_t *add_kern_class(ttf_t *font, unsigned first_left, unsigned num_left, unsigned first_right, unsigned num_right, unsigned num_left_classes, unsigned num_right_classes);
+static unsigned char *add_kerning(ttf_t *font, const unsigned char *pairs, size_t num_pairs);
+static bool	add_ligature(ttf_t *font, unsigned first, const unsigned char *components, unsigned num_components, unsigned ligature);
+static void	bounds_cb(void *data, _ttf_outline_t op, const float *points);
+static int	compare_kerning(const unsigned char *a, const unsigned char *b);
+static int	compare_kerning_order(const unsigned char *a, const unsigned char *b);
 static ttf_t	*create_font(const char *filename, const void *data, size_t datasize, size_t idx, ttf_err_cb_t err_cb, void *err_cbdata);
-static void	errorf(ttf_t *font, const char *message, ...) TTF_FORMAT_ARGS(2,3);
-static size_t	fd_read_cb(ttf_t *font, void *buffer, size_t bytes);
-static bool	fd_seek_cb(ttf_t *font, size_t offset);
+static bool	find_extents(ttf_t *font, const char *s, bool kerned, size_t max_adjs, _ttf_extents_t *cached);
+static void	free_extents(ttf_t *font);
+static const _ttf_bounds_t *get_glyph_bounds(ttf_t *font, int glyph);
+static _ttf_metric_t *get_glyph_metric(ttf_t *font, int glyph);
+static int	get_ligature(ttf_t *font, int glyph, const char **s);
+static const _ttf_pixel_t *get_pixel(ttf_t *font, int ppem);
+static const _ttf_metric_t *get_vertical_metric(ttf_t *font, int glyph);
+static bool	get_range(const unsigned char *table, size_t length, bool classdef, unsigned n, unsigned *first, unsigned *last, unsigned *value);
+static const int *get_unicodes(ttf_t *font);
+static unsigned char *get_used(ttf_t *font, const int *glyphs, size_t num_glyphs);
+static unsigned	get_value_size(unsigned format);
+static bool	load_ligatures(ttf_t *font);
+static bool	load_vertical(ttf_t *font);
 static size_t	mem_read_cb(ttf_t *font, void *buffer, size_t bytes);
 static bool	mem_seek_cb(ttf_t *font, size_t offset);
-static int	next_unicode(ttf_t *font, const char **s);
+static int	next_unicode(const char **s);
 static bool	read_cmap(ttf_t *font);
+static bool	read_gpos(ttf_t *font);
+static bool	read_gsub(ttf_t *font);
 static bool	read_head(ttf_t *font, _ttf_off_head_t *head);
 static bool	read_hhea(ttf_t *font, _ttf_off_hhea_t *hhea);
 static _ttf_metric_t *read_hmtx(ttf_t *font, _ttf_off_hhea_t *hhea);
 static bool	read_kern(ttf_t *font);
+static bool	read_kern_class(ttf_t *font, const unsigned char *subtable, size_t length);
 static int	read_maxp(ttf_t *font);
 static bool	read_names(ttf_t *font);
 static bool	read_os_2(ttf_t *font, _ttf_off_os_2_t *os_2);
+static bool	read_pair_pos(ttf_t *font, const unsigned char *subtable, size_t length);
 static bool	read_post(ttf_t *font, _ttf_off_post_t *post);
 static int	read_short(ttf_t *font);
 static bool	read_table(ttf_t *font);
 static unsigned	read_ulong(ttf_t *font);
 static int	read_ushort(ttf_t *font);
 static unsigned	seek_table(ttf_t *font, unsigned tag, unsigned offset, bool required);
+static void	sort_kerning(ttf_t *font);
+static void	store_extents(ttf_t *font, const _ttf_extents_t *cached);
 
 
 //
-// 'ttfContainsChar()' - Test for the presence of a Unicode character in a font.
+// '_ttfCopyName()' - Copy a name string from a font.
 //
 
-bool					// O - `true` if font contains the character, `false` otherwise
-ttfContainsChar(ttf_t *font,		// I - Font
-                int   ch)		// I - Unicode character
+char *					// O - Name string or `NULL`
+_ttfCopyName(ttf_t    *font,		// I - Font
+             unsigned name_id)	// I - Name identifier
 {
-  return (font && ch >= 0 && ch < (int)font->num_cmap && font->cmap[ch] > 0);
-}
+  int			i;		// Looping var
+  _ttf_off_name_t	*name;		// Current name
 
 
-//
-// 'ttfContainsChars()' - Test for the presence of all characters in a UTF-8 (Unicode) string in a font.
-//
+  for (i = font->names.num_names, name = font->names.names; i > 0; i --, name ++)
+  {
+    if (name->name_id == name_id &&
+        ((name->platform_id == TTF_OFF_Mac && name->language_id == TTF_OFF_Mac_USEnglish) ||
+         (name->platform_id == TTF_OFF_Windows && (name->language_id & 0xff) == TTF_OFF_Windows_English)))
+    {
+      char	temp[1024],	// Temporary string buffer
+		*tempptr,	// Pointer into temporary string
+		*storptr;	// Pointer into storage
+      int	chars,		// Length of string to copy in characters
+		bpc;		// Bytes per character
 
-bool					// O - `true` if font contains the characters in the string, `false` otherwise
-ttfContainsChars(ttf_t      *font,	// I - Font
-                 const char *s)		// I - UTF-8 string
-{
-  int	ch;				// Current unicode character
+      if ((unsigned)(name->offset + name->length) > font->names.storage_size)
+      {
+        TTF_DEBUG("_ttfCopyName: offset(%d)+length(%d) > storage_size(%d)\n", name->offset, name->length, font->names.storage_size);
+        continue;
+      }
+
+      if (name->platform_id == TTF_OFF_Windows && name->encoding_id == TTF_OFF_Windows_UCS2)
+      {
+        storptr = (char *)font->names.storage + name->offset;
+        chars   = name->length / 2;
+        bpc     = 2;
+      }
+      else if (name->platform_id == TTF_OFF_Windows && name->encoding_id == TTF_OFF_Windows_UCS4)
+      {
+        storptr = (char *)font->names.storage + name->offset;
+        chars   = name->length / 4;
+        bpc     = 4;
+      }
+      else
+      {
+        storptr = (char *)font->names.storage + name->offset;
+        chars   = name->length;
+        bpc     = 1;
+      }
 
+      for (tempptr = temp; chars > 0; storptr += bpc, chars --)
+      {
+        int ch;				// Current character
 
-  // Range check input...
-  if (!font || !s)
-    return (false);
+        // Convert to Unicode...
+        if (bpc == 1)
+          ch = *storptr;
+	else if (bpc == 2)
+	  ch = ((storptr[0] & 255) << 8) | (storptr[1] & 255);
+	else
+	  ch = ((storptr[0] & 255) << 24) | ((storptr[1] & 255) << 16) | ((storptr[2] & 255) << 8) | (storptr[3] & 255);
+
+        // Convert to UTF-8...
+        if (ch < 0x80)
+        {
+          // ASCII...
+	  if (tempptr < (temp + sizeof(temp) - 1))
+	    *tempptr++ = (char)ch;
+	  else
+	    break;
+	}
+	else if (ch < 0x400)
+	{
+	  // Two byte UTF-8
+	  if (tempptr < (temp + sizeof(temp) - 2))
+	  {
+	    *tempptr++ = (char)(0xc0 | (ch >> 6));
+	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
+	  }
+	  else
+	    break;
+	}
+	else if (ch < 0x10000)
+	{
+	  // Three byte UTF-8
+	  if (tempptr < (temp + sizeof(temp) - 3))
+	  {
+	    *tempptr++ = (char)(0xe0 | (ch >> 12));
+	    *tempptr++ = (char)(0x80 | ((ch >> 6) & 0x3f));
+	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
+	  }
+	  else
+	    break;
+	}
+	else
+	{
+	  // Four byte UTF-8
+	  if (tempptr < (temp + sizeof(temp) - 4))
+	  {
+	    *tempptr++ = (char)(0xf0 | (ch >> 18));
+	    *tempptr++ = (char)(0x80 | ((ch >> 12) & 0x3f));
+	    *tempptr++ = (char)(0x80 | ((ch >> 6) & 0x3f));
+	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
+	  }
+	  else
+	    break;
+	}
+      }
+
+      *tempptr = '\0';
+
+      TTF_DEBUG("_ttfCopyName: name_id(%d) = \"%s\"\n", name_id, temp);
+
+      return (strdup(temp));
+    }
+  }
 
-  while ((ch = next_unicode(font, &s)) != 0)
+  TTF_DEBUG("_ttfCopyName: No English name string for %d.\n", name_id);
+#ifdef DEBUG
+  for (i = font->names.num_names, name = font->names.names; i > 0; i --, name ++)
   {
-    if (!ttfContainsChar(font, ch))
-      return (false);
+    if (name->name_id == name_id)
+      TTF_DEBUG("_ttfCopyName: Found name_id=%d, platform_id=%d, language_id=%d(0x%04x)\n", name_id, name->platform_id, name->language_id, name->language_id);
   }
+#endif // DEBUG
 
-  return (true);
+  return (NULL);
 }
 
 
 //
-// 'ttfCreate()' - Create a new font object for the named font file.
-//
-// This function creates a new font object for the named TrueType or OpenType
-// font file or collection.  The "filename" argument specifies the name of the
-// file to read.
-//
-// The "idx" argument specifies the font to load from a collection - the first
-// font is number `0`.  Once created, you can call the @link ttfGetNumFonts@
-// function to determine whether the loaded font file is a collection with more
-// than one font.
-//
-// The "err_cb" and "err_cbdata" arguments specify a callback function and data
-// pointer for receiving error messages.  If `NULL`, errors are sent to the
-// `stderr` file.  The callback function receives the data pointer and a text
-// message string, for example:
+// '_ttfCountPrintable()' - Count the leading printable ASCII characters in a string.
 //
-// ```
-// void my_err_cb(void *err_cbdata, const char *message)
-// {
-//   fprintf(stderr, "ERROR: %s\\n", message);
-// }
-// ```
+// This function returns the number of leading characters in the range 0x20
+// to 0x7E, checking 8 bytes at a time.
 //
 
-ttf_t *					// O - New font object
-ttfCreate(const char   *filename,	// I - Filename
-          size_t       idx,		// I - Font number to create in collection (0-based)
-          ttf_err_cb_t err_cb,		// I - Error callback or `NULL` to log to stderr
-          void         *err_cbdata)	// I - Error callback data
+size_t					// O - Number of printable ASCII characters
+_ttfCountPrintable(const char *s,	// I - String
+                   size_t     len)	// I - Length of string
 {
-  TTF_DEBUG("ttfCreate(filename=\"%s\", idx=%u, err_cb=%p, err_cbdata=%p)\n", filename, (unsigned)idx, (void *)err_cb, err_cbdata);
+  const char	*start = s;		// Start of string
+  uint64_t	word;			// 8 bytes from string
+  const uint64_t ones = 0x0101010101010101ULL,
+					// 0x01 in every byte
+		highs = 0x8080808080808080ULL;
+					// 0x80 in every byte
 
-  // Range check input..
-  if (!filename)
+
+  // Check 8 bytes at a time for any byte less than 0x20 or greater than 0x7E...
+  while (len >= 8)
   {
-    errno = EINVAL;
-    return (NULL);
+    memcpy(&word, s, sizeof(word));
+
+    if ((((word - ones * 0x20) & ~word) | ((word + ones) | word)) & highs)
+      break;
+
+    s   += 8;
+    len -= 8;
   }
 
-  // Open and return the font...
-  return (create_font(filename, /*data*/NULL, /*datasize*/0, idx, err_cb, err_cbdata));
+  // Then finish up a byte at a time...
+  while (len > 0 && *s >= ' ' && *s < 0x7f)
+  {
+    s ++;
+    len --;
+  }
+
+  return ((size_t)(s - start));
 }
 
 
 //
-// 'ttfCreateData()' - Create a new font object from a memory buffer.
-//
-// This function creates a new font object from a memory buffer.  The "data"
-// argument specifies a pointer to the first byte of data and the "datasize"
-// argument specifies the length of the memory buffer in bytes.
-//
-// > **Note:** The caller is responsible for ensuring that the memory buffer is
-// > available until the font object is deleted with @link ttfDelete@.
-//
-// The "idx" argument specifies the font to load from a collection - the first
-// font is number `0`.  Once created, you can call the @link ttfGetNumFonts@
-// function to determine whether the loaded font file is a collection with more
-// than one font.
-//
-// The "err_cb" and "err_cbdata" arguments specify a callback function and data
-// pointer for receiving error messages.  If `NULL`, errors are sent to the
-// `stderr` file.  The callback function receives the data pointer and a text
-// message string, for example:
-//
-// ```
-// void my_err_cb(void *err_cbdata, const char *message)
-// {
-//   fprintf(stderr, "ERROR: %s\\n", message);
-// }
-// ```
+// '_ttfError()' - Show an error message.
 //
 
-ttf_t *					// O - New font object
-ttfCreateData(const void   *data,	// I - Buffer
-              size_t       datasize,	// I - Size of buffer in bytes
-	      size_t       idx,		// I - Font number to create in collection (0-based)
-	      ttf_err_cb_t err_cb,	// I - Error callback or `NULL` to log to stderr
-	      void         *err_cbdata)	// I - Error callback data
+void
+_ttfError(ttf_t      *font,		// I - Font
+          const char *message,		// I - `printf`-style message string
+          ...)				// I - Addition arguments as needed
 {
-  TTF_DEBUG("ttfCreateData(data=%p, datasize=%lu, idx=%u, err_cb=%p, err_cbdata=%p)\n", data, (unsigned long)datasize, (unsigned)idx, (void *)err_cb, err_cbdata);
+  va_list	ap;			// Argument pointer
+  char		buffer[2048];		// Message buffer
 
-  // Range check input..
-  if (!data || datasize == 0)
-  {
-    errno = EINVAL;
-    return (NULL);
-  }
 
-  // Open and return the font...
-  return (create_font(/*filename*/NULL, data, datasize, idx, err_cb, err_cbdata));
+  // Format the message...
+  va_start(ap, message);
+  vsnprintf(buffer, sizeof(buffer), message, ap);
+  va_end(ap);
+
+  // If an error callback is set, sent the message there.  Otherwise write it
+  // to stderr...
+  if (font && font->err_cb)
+    (font->err_cb)(font->err_cbdata, buffer);
+  else
+    fprintf(stderr, "%s\n", buffer);
 }
 
 
 //
-// 'ttfDelete()' - Free all memory used for a font family object.
+// '_ttfGetGlyphData()' - Get the "glyf" table data for a glyph.
+//
+// `NULL` is returned if the font has no "glyf" table or the glyph index is
+// invalid.  Empty glyphs return a non-`NULL` pointer and a size of `0`.
 //
 
-void
-ttfDelete(ttf_t *font)			// I - Font
+const unsigned char *			// O - Glyph data or `NULL`
+_ttfGetGlyphData(ttf_t    *font,	// I - Font
+                 unsigned glyph,	// I - Glyph index
+                 size_t   *bytes)	// O - Size of glyph data
 {
-  int	i;				// Looping var
+  const unsigned char	*head,		// head table
+			*loca,		// loca table
+			*glyf;		// glyf table
+  size_t		head_length,	// Length of head table
+			loca_length,	// Length of loca table
+			glyf_length,	// Length of glyf table
+			start,		// Start of glyph
+			end;		// End of glyph
 
 
-  // Range check input...
-  if (!font)
-    return;
+  *bytes = 0;
 
-  // Close the font file...
-  if (font->file_fd >= 0)
-    close(font->file_fd);
+  if ((head = _ttfGetTable(font, TTF_OFF_head, &head_length)) == NULL || head_length < 54 || (loca = _ttfGetTable(font, TTF_OFF_loca, &loca_length)) == NULL || (glyf = _ttfGetTable(font, TTF_OFF_glyf, &glyf_length)) == NULL)
+    return (NULL);
 
-  // Free all memory used...
-  free(font->copyright);
-  free(font->family);
-  free(font->postscript_name);
-  free(font->version);
+  if (TTF_GET_SHORT(head + 50))
+  {
+    // Long offsets...
+    if ((4 * (size_t)glyph + 8) > loca_length)
+      return (NULL);
 
-  free(font->table.entries);
-  free(font->names.names);
-  free(font->names.storage);
+    start = TTF_GET_ULONG(loca + 4 * glyph);
+    end   = TTF_GET_ULONG(loca + 4 * glyph + 4);
+  }
+  else
+  {
+    // Short offsets (divided by 2)...
+    if ((2 * (size_t)glyph + 4) > loca_length)
+      return (NULL);
 
-  free(font->cmap);
+    start = 2 * (size_t)TTF_GET_USHORT(loca + 2 * glyph);
+    end   = 2 * (size_t)TTF_GET_USHORT(loca + 2 * glyph + 2);
+  }
 
-  for (i = 0; i < 256; i ++)
-    free(font->widths[i]);
+  if (end < start || end > glyf_length)
+    return (NULL);
 
-  free(font);
+  *bytes = end - start;
+
+  return (glyf + start);
 }
 
 
 //
-// 'ttfGetAscent()' - Get the maximum height of non-accented characters.
+// '_ttfGetKerning()' - Get the kerning adjustment for a pair of glyphs.
 //
 
-int					// O - Ascent in 1000ths
-ttfGetAscent(ttf_t *font)		// I - Font
+int					// O - Adjustment in font units
+_ttfGetKerning(ttf_t *font,		// I - Font
+               int   left,		// I - Left glyph
+               int   right)		// I - Right glyph
 {
-  return (font ? (int)(1000 * font->ascent / font->units) : 0);
-}
+  unsigned	first,			// First pair for left glyph
+		last,			// Last pair for left glyph
+		current,		// Current pair
+		glyph,			// Right glyph of current pair
+		lclass,			// Left class
+		rclass;			// Right class
+  const unsigned char *kp;		// Current kerning pair
+  size_t	i;			// Looping var
+  _ttf_kern_class_t *kc;		// Current class-based kerning subtable
+
+
+  if (left < 0 || right < 0)
+    return (0);
 
+  if (font->num_kerning && (size_t)left < (font->num_kerning_index - 1))
+  {
+    // Use the index to find the pairs for the left glyph, then do a binary
+    // search for the right glyph...
+    first = font->kerning_index[left];
+    last  = font->kerning_index[left + 1];
 
-//
-// 'ttfGetBounds()' - Get the bounds of all characters in a font.
-//
-// This function gets the bounds of all characters in a font.  The "bounds"
-// argument is a pointer to a `ttf_rect_t` structure that will be filled with
-// the limits for characters in the font scaled to a 1000x1000 unit square.
-//
-
-ttf_rect_t *				// O - Bounds or `NULL` on error
-ttfGetBounds(ttf_t      *font,		// I - Font
-             ttf_rect_t *bounds)	// I - Bounds buffer
-{
-  // Range check input...
-  if (!font || !bounds)
-  {
-    if (bounds)
-      memset(bounds, 0, sizeof(ttf_rect_t));
+    while (first < last)
+    {
+      current = (first + last) / 2;
+      kp      = font->kerning + current * TTF_KERNING_SIZE;
 
-    return (NULL);
+      if ((glyph = TTF_GET_USHORT(kp + 2)) == (unsigned)right)
+	return (TTF_GET_SHORT(kp + 4));
+      else if (glyph < (unsigned)right)
+	first = current + 1;
+      else
+	last = current;
+    }
   }
 
-  bounds->left   = 1000.0f * font->x_min / font->units;
-  bounds->right  = 1000.0f * font->x_max / font->units;
-  bounds->bottom = 1000.0f * font->y_min / font->units;
-  bounds->top    = 1000.0f * font->y_max / font->units;
-
-  return (bounds);
-}
-
-
-//
-// 'ttfGetCapHeight()' - Get the height of capital letters.
-//
-
-int					// O - Capital letter height in 1000ths
-ttfGetCapHeight(ttf_t *font)		// I - Font
-{
-  return (font ? (int)(1000 * font->cap_height / font->units) : 0);
-}
-
-
-//
-// 'ttfGetCMap()' - Get the Unicode to glyph mapping table.
-//
-
-const int *				// O - CMap table
-ttfGetCMap(ttf_t  *font,		// I - Font
-           size_t *num_cmap)		// O - Number of entries in table
-{
-  // Range check input...
-  if (!font || !num_cmap)
+  // Then look for the first class-based subtable that covers the left glyph...
+  for (i = font->num_kern_classes, kc = font->kern_classes; i > 0; i --, kc ++)
   {
-    if (num_cmap)
-      *num_cmap = 0;
-
-    return (NULL);
-  }
-
-  *num_cmap = font->num_cmap;
-  return (font->cmap);
-}
-
-
-//
-// 'ttfGetCopyright()' - Get the copyright text for a font.
-//
-
-const char *				// O - Copyright text
-ttfGetCopyright(ttf_t *font)		// I - Font
-{
-  return (font ? font->copyright : NULL);
-}
+    if ((unsigned)left < kc->first_left || ((unsigned)left - kc->first_left) >= kc->num_left || (lclass = kc->left_classes[left - kc->first_left]) == 0xffff)
+      continue;
 
+    if ((unsigned)right < kc->first_right || ((unsigned)right - kc->first_right) >= kc->num_right)
+      rclass = 0;
+    else
+      rclass = kc->right_classes[right - kc->first_right];
 
-//
-// 'ttfGetDescent()' - Get the maximum depth of non-accented characters.
-//
+    return (kc->values[lclass * kc->num_right_classes + rclass]);
+  }
 
-int					// O - Descent in 1000ths
-ttfGetDescent(ttf_t *font)		// I - Font
-{
-  return (font ? (int)(1000 * font->descent / font->units) : 0);
+  return (0);
 }
 
 
 //
-// 'ttfGetExtents()' - Get the extents of a UTF-8 string.
+// '_ttfGetLatinKerning()' - Get the kerning matrix for printable ASCII/Latin-1 characters.
 //
-// This function computes the extents of the UTF-8 string "s" when rendered
-// using the specified font "font" and size "size".  The "extents" argument is
-// a pointer to a `ttf_rect_t` structure that is filled with the extents of a
-// simple rendering of the string with no kerning or rewriting applied.  The
-// values are scaled using the specified font size.
+// The matrix is built from the kerning pairs the first time it is needed and
+// contains `TTF_LATIN_COUNT` by `TTF_LATIN_COUNT` adjustments indexed using
+// the `TTF_LATIN_INDEX` macro.  `NULL` is returned if the font has no kerning.
 //
 
-ttf_rect_t *				// O - Pointer to extents or `NULL` on error
-ttfGetExtents(
-    ttf_t      *font,			// I - Font
-    float      size,			// I - Font size
-    const char *s,			// I - String
-    ttf_rect_t *extents)		// O - Extents of the string
+const short *				// O - Kerning matrix or `NULL`
+_ttfGetLatinKerning(ttf_t *font)	// I - Font
 {
-  bool		first = true;		// First character?
+  short		*latin;			// Kerning matrix
+  short		*heads,			// First character for each glyph
+		nexts[TTF_LATIN_COUNT];	// Next character with the same glyph
   int		ch,			// Current character
-		width = 0;		// Width
-  _ttf_metric_t	*widths;		// Widths
+		glyph,			// Current glyph
+		left,			// Left character index
+		right;			// Right character index
+  unsigned	kleft,			// Left glyph of kerning pair
+		kright;			// Right glyph of kerning pair
+  short		adj;			// Adjustment of kerning pair
+  size_t	i;			// Looping var
+  const unsigned char *kp;		// Current kerning pair
 
 
-  TTF_DEBUG("ttfGetExtents(font=%p, size=%.2f, s=\"%s\", extents=%p)\n", (void *)font, size, s, (void *)extents);
+  if ((!font->num_kerning && !font->num_kern_classes) || !font->num_glyphs)
+    return (NULL);
 
-  // Make sure extents is zeroed out...
-  if (extents)
-    memset(extents, 0, sizeof(ttf_rect_t));
+  // Use the matrix without locking once it has been built...
+  if ((latin = (short *)_ttfAtomicGetPtr(&font->latin_kerning)) != NULL)
+    return (latin);
 
-  // Range check input...
-  if (!font || size <= 0.0f || !s || !extents)
-    return (NULL);
+  _ttfMutexLock(&font->lock);
 
-  // Loop through the string...
-  while ((ch = next_unicode(font, &s)) != 0)
+  if ((latin = font->latin_kerning) == NULL && (heads = (short *)malloc(font->num_glyphs * sizeof(short))) != NULL)
   {
-    // Find its width...
-    if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
-    {
-      if (first)
-      {
-        extents->left = -widths[ch & 255].left_bearing / font->units;
-        first         = false;
-      }
+    // Build lists of the characters using each glyph...
+    memset(heads, -1, font->num_glyphs * sizeof(short));
 
-      width += widths[ch & 255].width;
-    }
-    else if ((widths = font->widths[0]) != NULL)
+    for (ch = 0; ch < 256 && ch < (int)font->num_cmap; ch ++)
     {
-      // Use the ".notdef" (0) glyph width...
-      if (first)
+      if ((left = TTF_LATIN_INDEX(ch)) >= 0 && (glyph = font->cmap[ch]) >= 0 && (size_t)glyph < font->num_glyphs)
       {
-        extents->left = -widths[0].left_bearing / font->units;
-        first         = false;
+        nexts[left]  = heads[glyph];
+        heads[glyph] = (short)left;
       }
-
-      width += widths[0].width;
     }
-  }
 
-  // Calculate the bounding box for the text and return...
-  TTF_DEBUG("ttfGetExtents: width=%d\n", width);
+    // Then fill in the matrix for those characters...
+    if ((latin = (short *)calloc(TTF_LATIN_COUNT * TTF_LATIN_COUNT, sizeof(short))) != NULL)
+    {
+      if (font->num_kern_classes)
+      {
+	// Class-based kerning applies to any pair, so look up every pair...
+	for (ch = 0; ch < 256 && ch < (int)font->num_cmap; ch ++)
+	{
+	  if ((left = TTF_LATIN_INDEX(ch)) < 0 || (glyph = font->cmap[ch]) < 0)
+	    continue;
 
-  extents->bottom = size * font->y_min / font->units;
-  extents->right  = size * width / font->units + extents->left;
-  extents->top    = size * font->y_max / font->units;
+	  for (right = 0; right < TTF_LATIN_COUNT; right ++)
+	  {
+	    kright = (unsigned)(right < 0x5f ? right + 0x20 : right + 0x41);
 
-  return (extents);
-}
+	    if (kright < font->num_cmap && font->cmap[kright] >= 0)
+	      latin[left * TTF_LATIN_COUNT + right] = (short)_ttfGetKerning(font, glyph, font->cmap[kright]);
+	  }
+	}
+      }
+      else
+      {
+	// Copy the kerning pairs for those glyphs...
+	for (i = font->num_kerning, kp = font->kerning; i > 0; i --, kp += TTF_KERNING_SIZE)
+	{
+	  kleft  = TTF_GET_USHORT(kp);
+	  kright = TTF_GET_USHORT(kp + 2);
+	  adj    = TTF_GET_SHORT(kp + 4);
 
+	  if (kleft >= font->num_glyphs || kright >= font->num_glyphs)
+	    continue;
 
-//
-// 'ttfGetFamily()' - Get the family name of a font.
-//
+	  for (left = heads[kleft]; left >= 0; left = nexts[left])
+	  {
+	    for (right = heads[kright]; right >= 0; right = nexts[right])
+	      latin[left * TTF_LATIN_COUNT + right] = adj;
+	  }
+	}
+      }
 
-const char *				// O - Family name
-ttfGetFamily(ttf_t *font)		// I - Font
-{
-  return (font ? font->family : NULL);
-}
+      _ttfAtomicSetPtr(&font->latin_kerning, latin);
+    }
 
+    free(heads);
+  }
 
-//
-// 'ttfGetItalicAngle()' - Get the italic angle.
-//
+  _ttfMutexUnlock(&font->lock);
 
-float					// O - Angle in degrees
-ttfGetItalicAngle(ttf_t *font)		// I - Font
-{
-  return (font ? font->italic_angle : 0.0f);
+  return (latin);
 }
 
 
 //
-// 'ttfGetKernedExtents()' - Get the kerned extents of a string.
-//
-// This function computes the kerned extents of the UTF-8 string "s" when
-// rendered using the specified font "font" and size "size".  The "extents"
-// argument is a pointer to a `ttf_rect_t` structure that is filled with the
-// extents of a kerned rendering of the string with no rewriting applied.  The
-// "adjs" argument specifies and array of `double` values up to "max_adjs" long
-// containing the kerning adjustments between each pair of characters.  The
-// extent and adjustment values are scaled using the specified font size.
+// '_ttfGetTable()' - Get a pointer to a table in the font data.
 //
 
-size_t					// O - Number of kerned pairs
-ttfGetKernedExtents(ttf_t      *font,	// I - Font
-                    float      size,	// I - Font size
-                    const char *s,	// I - String
-                    ttf_rect_t *extents,// O - Kerned extents of string
-                    size_t     max_adjs,// I - Maximum number of kerning adjustments
-                    double     *adjs)	// I - Array of kerning adjustments
+const unsigned char *			// O - Table data or `NULL` if not found
+_ttfGetTable(ttf_t    *font,		// I - Font
+             unsigned tag,		// I - Tag to find
+             size_t   *length)		// O - Length of table
 {
-  bool		first = true;		// First character?
-  int		ch,			// Current character
-		width = 0;		// Width
-  _ttf_metric_t	*widths;		// Widths
-  size_t	num_adjs = 0;		// Number of adjustments
-  _ttf_kerning_t key,			// Kerning pair search key
-		*kp;			// Kerning pair, if any
-
-
-  TTF_DEBUG("ttfGetKernedExtents(font=%p, size=%.2f, s=\"%s\", extents=%p, max_adjs=%u, adjs=%p)\n", (void *)font, size, s, (void *)extents, (unsigned)max_adjs, (void *)adjs);
-
-  // Make sure extents and kerning adjustments are zeroed out...
-  if (extents)
-    memset(extents, 0, sizeof(ttf_rect_t));
+  int		i;			// Looping var
+  _ttf_off_dir_t *current;		// Current entry
 
-  if (adjs && max_adjs > 0)
-    memset(adjs, 0, max_adjs * sizeof(double));
 
-  // Range check input...
-  if (!font || size <= 0.0f || !s || !extents || !adjs || max_adjs == 0)
-  {
-    TTF_DEBUG("ttfGetKernedExtents: Bad input, returning 0.\n");
-    return (0);
-  }
+  *length = 0;
 
-  // Loop through the string...
-  while ((ch = next_unicode(font, &s)) != 0)
+  for (i = font->table.num_entries, current = font->table.entries; i  > 0; i --, current ++)
   {
-    // Find its width...
-    if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
+    if (current->tag == tag)
     {
-      if (first)
-        extents->left = -widths[ch & 255].left_bearing / font->units;
+      if (current->offset > font->data_size || current->length > (font->data_size - current->offset))
+        return (NULL);
 
-      width += widths[ch & 255].width;
-    }
-    else if ((widths = font->widths[0]) != NULL)
-    {
-      // Use the ".notdef" (0) glyph width...
-      if (first)
-        extents->left = -widths[0].left_bearing / font->units;
+      *length = current->length;
 
-      width += widths[0].width;
+      return ((const unsigned char *)font->data + current->offset);
     }
+  }
 
-    // Then any kerning...
-    if (first)
-    {
-      // This is the first character in the string so save that as the left
-      // glyph...
-      if (ch < (int)font->num_cmap)
-        key.left = (unsigned short)font->cmap[ch];
-      else
-        key.left = 0;
+  return (NULL);
+}
 
-      first = false;
-    }
-    else if (num_adjs >= max_adjs)
-    {
-      // Too many pairs...
-      break;
-    }
-    else if (font->num_kerning)
-    {
-      // Lookup kerning information for the current pair of characters...
-      if (ch < (int)font->num_cmap)
-        key.right = (unsigned short)font->cmap[ch];
-      else
-        key.right = 0;
 
-      if ((kp = (_ttf_kerning_t *)bsearch(&key, font->kerning, font->num_kerning, sizeof(_ttf_kerning_t), (int (*)(const void *, const void *))compare_kerning)) != NULL)
-      {
-        // Found a pair, add it...
-        width          += kp->adj;
-        adjs[num_adjs] = size * kp->adj / font->units;
-      }
-      else
-      {
-        // No pair, so save as 0...
-        adjs[num_adjs] = 0.0;
-      }
+//
+// '_ttfNextUnicode()' - Get the next Unicode character.
+//
 
-      num_adjs ++;
+int					// O  - Unicode character or `0` on end of string
+_ttfNextUnicode(ttf_t      *font,	// I  - Font
+                const char **s)		// IO - Character pointer
+{
+  int		ch;			// Unicode character
+  const char	*start = *s;		// Start of character
 
-      // The right glyph is the left glyph for the next pair...
-      key.left = key.right;
-    }
-    else
-    {
-      // No kerning information, so just store 0...
-      adjs[num_adjs] = 0.0;
-      num_adjs ++;
-    }
-  }
 
-  // Calculate the bounding box for the text and return...
-  TTF_DEBUG("ttfGetKernedExtents: width=%d, returning %u.\n", width, (unsigned)num_adjs);
+  if ((ch = next_unicode(s)) < 0)
+  {
+    // Invalid UTF-8
+    _ttfError(font, "Invalid UTF-8 sequence starting with 0x%02X.", start[0] & 255);
 
-  extents->bottom = size * font->y_min / font->units;
-  extents->right  = size * width / font->units + extents->left;
-  extents->top    = size * font->y_max / font->units;
+    ch = 0;
+  }
 
-  return (num_adjs);
+  return (ch);
 }
 
 
 //
-// 'ttfGetMaxChar()' - Get the last character in the font.
+// 'ttfContainsChar()' - Test for the presence of a Unicode character in a font.
 //
 
-int					// O - Last character in font
-ttfGetMaxChar(ttf_t *font)		// I - Font
+bool					// O - `true` if font contains the character, `false` otherwise
+ttfContainsChar(ttf_t *font,		// I - Font
+                int   ch)		// I - Unicode character
 {
-  return (font ? font->max_char : 0);
+  return (font && ch >= 0 && ch < (int)font->num_cmap && font->cmap[ch] > 0);
 }
 
 
 //
-// 'ttfGetMinChar()' - Get the first character in the font.
+// 'ttfContainsChars()' - Test for the presence of all characters in a UTF-8 (Unicode) string in a font.
 //
 
-int					// O - First character in font
-ttfGetMinChar(ttf_t *font)		// I - Font
+bool					// O - `true` if font contains the characters in the string, `false` otherwise
+ttfContainsChars(ttf_t      *font,	// I - Font
+                 const char *s)		// I - UTF-8 string
 {
-  return (font ? font->min_char : 0);
+  const ttf_coverage_t *coverage;	// Character coverage
+
+
+  // Range check input...
+  if (!font || !s || (coverage = ttfGetCoverage(font)) == NULL)
+    return (false);
+
+  return (!s[ttfCoverageFindMissing(coverage, s, 0)]);
 }
 
 
 //
-// 'ttfGetNumFonts()' - Get the number of fonts in this collection.
+// 'ttfCreate()' - Create a new font object for the named font file.
+//
+// This function creates a new font object for the named TrueType or OpenType
+// font file or collection.  The "filename" argument specifies the name of the
+// file to read.
+//
+// The "idx" argument specifies the font to load from a collection - the first
+// font is number `0`.  Once created, you can call the @link ttfGetNumFonts@
+// function to determine whether the loaded font file is a collection with more
+// than one font.
+//
+// The "err_cb" and "err_cbdata" arguments specify a callback function and data
+// pointer for receiving error messages.  If `NULL`, errors are sent to the
+// `stderr` file.  The callback function receives the data pointer and a text
+// message string, for example:
+//
+// ```
+// void my_err_cb(void *err_cbdata, const char *message)
+// {
+//   fprintf(stderr, "ERROR: %s\\n", message);
+// }
+// ```
 //
 
-size_t					// O - Number of fonts
-ttfGetNumFonts(ttf_t *font)		// I - Font
+ttf_t *					// O - New font object
+ttfCreate(const char   *filename,	// I - Filename
+          size_t       idx,		// I - Font number to create in collection (0-based)
+          ttf_err_cb_t err_cb,		// I - Error callback or `NULL` to log to stderr
+          void         *err_cbdata)	// I - Error callback data
 {
-  return (font ? font->num_fonts : 0);
+  TTF_DEBUG("ttfCreate(filename=\"%s\", idx=%u, err_cb=%p, err_cbdata=%p)\n", filename, (unsigned)idx, (void *)err_cb, err_cbdata);
+
+  // Range check input..
+  if (!filename)
+  {
+    errno = EINVAL;
+    return (NULL);
+  }
+
+  // Open and return the font...
+  return (create_font(filename, /*data*/NULL, /*datasize*/0, idx, err_cb, err_cbdata));
 }
 
 
 //
-// 'ttfGetPostScriptName()' - Get the PostScript name of a font.
+// 'ttfCreateData()' - Create a new font object from a memory buffer.
+//
+// This function creates a new font object from a memory buffer.  The "data"
+// argument specifies a pointer to the first byte of data and the "datasize"
+// argument specifies the length of the memory buffer in bytes.
+//
+// > **Note:** The caller is responsible for ensuring that the memory buffer is
+// > available until the font object is deleted with @link ttfDelete@.
+//
+// The "idx" argument specifies the font to load from a collection - the first
+// font is number `0`.  Once created, you can call the @link ttfGetNumFonts@
+// function to determine whether the loaded font file is a collection with more
+// than one font.
+//
+// The "err_cb" and "err_cbdata" arguments specify a callback function and data
+// pointer for receiving error messages.  If `NULL`, errors are sent to the
+// `stderr` file.  The callback function receives the data pointer and a text
+// message string, for example:
+//
+// ```
+// void my_err_cb(void *err_cbdata, const char *message)
+// {
+//   fprintf(stderr, "ERROR: %s\\n", message);
+// }
+// ```
 //
 
-const char *				// O - PostScript name
-ttfGetPostScriptName(
-    ttf_t *font)			// I - Font
+ttf_t *					// O - New font object
+ttfCreateData(const void   *data,	// I - Buffer
+              size_t       datasize,	// I - Size of buffer in bytes
+	      size_t       idx,		// I - Font number to create in collection (0-based)
+	      ttf_err_cb_t err_cb,	// I - Error callback or `NULL` to log to stderr
+	      void         *err_cbdata)	// I - Error callback data
 {
-  return (font ? font->postscript_name : NULL);
+  TTF_DEBUG("ttfCreateData(data=%p, datasize=%lu, idx=%u, err_cb=%p, err_cbdata=%p)\n", data, (unsigned long)datasize, (unsigned)idx, (void *)err_cb, err_cbdata);
+
+  // Range check input..
+  if (!data || datasize == 0)
+  {
+    errno = EINVAL;
+    return (NULL);
+  }
+
+  // Open and return the font...
+  return (create_font(/*filename*/NULL, data, datasize, idx, err_cb, err_cbdata));
 }
 
 
 //
-// 'ttfGetStretch()' - Get the font "stretch" value...
+// 'ttfDelete()' - Free all memory used for a font family object.
 //
 
-ttf_stretch_t				// O - Stretch value
-ttfGetStretch(ttf_t *font)		// I - Font
+void
+ttfDelete(ttf_t *font)			// I - Font
 {
-  return (font ? font->stretch : TTF_STRETCH_NORMAL);
-}
+  int	i;				// Looping var
 
 
-//
-// 'ttfGetStyle()' - Get the font style.
-//
+  // Range check input...
+  if (!font)
+    return;
 
-ttf_style_t				// O - Style
-ttfGetStyle(ttf_t *font)		// I - Font
-{
-  return (font ? font->style : TTF_STYLE_NORMAL);
-}
+  // Free any variation instances, which share the font data...
+  _ttfVarDelete(font);
 
+  // Unmap or free the font file...
+  if (font->file_mapped)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(font->file_data);
+#else
+    munmap(font->file_data, font->data_size);
+#endif // _WIN32
+  }
+  else
+  {
+    free(font->file_data);
+  }
 
-//
-// 'ttfGetVersion()' - Get the version number of a font.
-//
+  // Free all memory used...
+  free(font->copyright);
+  free(font->family);
+  free(font->postscript_name);
+  free(font->version);
 
-const char *				// O - Version number
-ttfGetVersion(ttf_t *font)		// I - Font
-{
-  return (font ? font->version : NULL);
+  free(font->table.entries);
+  free(font->names.names);
+  free(font->names.storage);
+
+  free(font->cmap);
+
+  for (i = 0; i < (int)(sizeof(font->widths) / sizeof(font->widths[0])); i ++)
+    free(font->widths[i]);
+
+  free(font->glyph_widths);
+
+  free(font->kerning_buffer);
+  free(font->kerning_index);
+
+  for (i = 0; i < (int)font->num_kern_classes; i ++)
+    free(font->kern_classes[i].left_classes);
+
+  free(font->kern_classes);
+
+  free(font->liga_index);
+  free(font->liga);
+  free(font->pixels);
+  free(font->glyph_bounds);
+
+  if (font->outlines)
+  {
+    for (i = 0; i < (int)font->num_outlines; i ++)
+      free(font->outlines[i].path);
+
+    free(font->outlines);
+    free(font->outline_index);
+  }
+
+  if (font->bitmaps)
+  {
+    for (i = 0; i < TTF_BITMAP_CACHE_MAX; i ++)
+      free(font->bitmaps[i].pixels);
+
+    free(font->bitmaps);
+    free(font->bitmap_hash);
+  }
+
+  ttfCoverageDelete(font->coverage);
+  free(font->vert_metrics);
+  _ttfCFFDelete(font->cff);
+  free(font->unicodes);
+  free(font->width_ranges);
+  free(font->latin_kerning);
+
+  free_extents(font);
+
+  _ttfMutexDestroy(&font->lock);
+
+  free(font);
 }
 
 
 //
-// 'ttfGetWeight()' - Get the weight of a font.
+// 'ttfGetAscent()' - Get the maximum height of non-accented characters.
 //
 
-ttf_weight_t				// O - Weight
-ttfGetWeight(ttf_t *font)		// I - Font
+int					// O - Ascent in 1000ths
+ttfGetAscent(ttf_t *font)		// I - Font
 {
-  return (font ? (ttf_weight_t)font->weight : TTF_WEIGHT_400);
+  return (font ? (int)(1000 * font->ascent / font->units) : 0);
 }
 
 
 //
-// 'ttfGetWidth()' - Get the width of a single character.
+// 'ttfGetBounds()' - Get the bounds of all characters in a font.
+//
+// This function gets the bounds of all characters in a font.  The "bounds"
+// argument is a pointer to a `ttf_rect_t` structure that will be filled with
+// the limits for characters in the font scaled to a 1000x1000 unit square.
 //
 
-int					// O - Width in 1000ths
-ttfGetWidth(ttf_t *font,		// I - Font
-            int   ch)			// I - Unicode character
+ttf_rect_t *				// O - Bounds or `NULL` on error
+ttfGetBounds(ttf_t      *font,		// I - Font
+             ttf_rect_t *bounds)	// I - Bounds buffer
 {
-  int	bin =  ch >> 8;			// Bin in widths array
+  // Range check input...
+  if (!font || !bounds)
+  {
+    if (bounds)
+      memset(bounds, 0, sizeof(ttf_rect_t));
 
+    return (NULL);
+  }
 
-  // Range check input...
-  if (!font || ch < ' ' || ch == 0x7f || ch >= TTF_FONT_MAX_CHAR)
-    return (0);
+  bounds->left   = 1000.0f * font->x_min / font->units;
+  bounds->right  = 1000.0f * font->x_max / font->units;
+  bounds->bottom = 1000.0f * font->y_min / font->units;
+  bounds->top    = 1000.0f * font->y_max / font->units;
 
-  if (font->widths[bin])
-    return ((int)(1000.0f * font->widths[bin][ch & 255].width / font->units));
-  else if (font->widths[0])		// .notdef
-    return ((int)(1000.0f * font->widths[0][0].width / font->units));
-  else
-    return (0);
+  return (bounds);
 }
 
 
 //
-// 'ttfGetXHeight()' - Get the height of lowercase letters.
+// 'ttfGetCapHeight()' - Get the height of capital letters.
 //
 
-int					// O - Lowercase letter height in 1000ths
-ttfGetXHeight(ttf_t *font)		// I - Font
+int					// O - Capital letter height in 1000ths
+ttfGetCapHeight(ttf_t *font)		// I - Font
 {
-  return (font ? (int)(1000 * font->x_height / font->units) : 0);
+  return (font ? (int)(1000 * font->cap_height / font->units) : 0);
 }
 
 
 //
-// 'ttfIsFixedPitch()' - Determine whether a font is fixedpitch.
+// 'ttfGetCMap()' - Get the Unicode to glyph mapping table.
 //
 
-bool					// O - `true` if fixed pitch, `false` otherwise
-ttfIsFixedPitch(ttf_t *font)		// I - Font
+const int *				// O - CMap table
+ttfGetCMap(ttf_t  *font,		// I - Font
+           size_t *num_cmap)		// O - Number of entries in table
 {
-  return (font ? font->is_fixed : false);
+  // Range check input...
+  if (!font || !num_cmap)
+  {
+    if (num_cmap)
+      *num_cmap = 0;
+
+    return (NULL);
+  }
+
+  *num_cmap = font->num_cmap;
+  return (font->cmap);
 }
 
 
 //
-// 'compare_kerning()' - Compare two kerning pairs.
+// 'ttfGetCopyright()' - Get the copyright text for a font.
 //
 
-static int				// O - Result of comparison
-compare_kerning(_ttf_kerning_t *a,	// I - First pair
-                _ttf_kerning_t *b)	// I - Second pair
+const char *				// O - Copyright text
+ttfGetCopyright(ttf_t *font)		// I - Font
 {
-  if (a->left < b->left)
-    return (-1);
-  else if (a->left > b->left)
-    return (1);
-  else if (a->right < b->right)
-    return (-1);
-  else if (a->right > b->right)
-    return (1);
-  else
-    return (0);
+  return (font ? font->copyright : NULL);
 }
 
 
 //
-// 'copy_name()' - Copy a name string from a font.
+// 'ttfGetDescent()' - Get the maximum depth of non-accented characters.
 //
 
-static char *				// O - Name string or `NULL`
-copy_name(ttf_t    *font,		// I - Font
-          unsigned name_id)		// I - Name identifier
+int					// O - Descent in 1000ths
+ttfGetDescent(ttf_t *font)		// I - Font
 {
-  int			i;		// Looping var
-  _ttf_off_name_t	*name;		// Current name
-
-
-  for (i = font->names.num_names, name = font->names.names; i > 0; i --, name ++)
-  {
-    if (name->name_id == name_id &&
-        ((name->platform_id == TTF_OFF_Mac && name->language_id == TTF_OFF_Mac_USEnglish) ||
-         (name->platform_id == TTF_OFF_Windows && (name->language_id & 0xff) == TTF_OFF_Windows_English)))
-    {
-      char	temp[1024],	// Temporary string buffer
-		*tempptr,	// Pointer into temporary string
-		*storptr;	// Pointer into storage
-      int	chars,		// Length of string to copy in characters
-		bpc;		// Bytes per character
+  return (font ? (int)(1000 * font->descent / font->units) : 0);
+}
 
-      if ((unsigned)(name->offset + name->length) > font->names.storage_size)
-      {
-        TTF_DEBUG("copy_name: offset(%d)+length(%d) > storage_size(%d)\n", name->offset, name->length, font->names.storage_size);
-        continue;
-      }
 
-      if (name->platform_id == TTF_OFF_Windows && name->encoding_id == TTF_OFF_Windows_UCS2)
-      {
-        storptr = (char *)font->names.storage + name->offset;
-        chars   = name->length / 2;
-        bpc     = 2;
-      }
-      else if (name->platform_id == TTF_OFF_Windows && name->encoding_id == TTF_OFF_Windows_UCS4)
-      {
-        storptr = (char *)font->names.storage + name->offset;
-        chars   = name->length / 4;
-        bpc     = 4;
-      }
-      else
+//
+// 'ttfGetExtents()' - Get the extents of a UTF-8 string.
+//
+// This function computes the extents of the UTF-8 string "s" when rendered
+// using the specified font "font" and size "size".  The "extents" argument is
+// a pointer to a `ttf_rect_t` structure that is filled with the extents of a
+// simple rendering of the string with no kerning or rewriting applied.  The
+// values are scaled using the specified font size.
+//
+// Standard ligatures such as "fi" are only applied if enabled with the
+// @link ttfSetLigatures@ function.
+//
+// Short strings are looked up in the font's extents cache, if enabled with the
+// @link ttfSetExtentsCache@ function.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetExtents(
+    ttf_t      *font,			// I - Font
+    float      size,			// I - Font size
+    const char *s,			// I - String
+    ttf_rect_t *extents)		// O - Extents of the string
+{
+  bool		first = true;		// First character?
+  int		ch,			// Current character
+		width = 0;		// Width
+  _ttf_metric_t	*widths;		// Widths
+  _ttf_extents_t cached;		// Cached extents
+  const char	*end = NULL;		// End of string
+  size_t	count;			// Number of printable ASCII characters
+  bool		ligatures = false;	// Apply ligatures?
+  int		glyph;			// Ligature glyph
+  _ttf_metric_t	*metric;		// Ligature glyph metrics
+
+
+  TTF_DEBUG("ttfGetExtents(font=%p, size=%.2f, s=\"%s\", extents=%p)\n", (void *)font, size, s, (void *)extents);
+
+  // Make sure extents is zeroed out...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  // Range check input...
+  if (!font || size <= 0.0f || !s || !extents)
+    return (NULL);
+
+  if (font->extents && find_extents(font, s, /*kerned*/false, /*max_adjs*/0, &cached))
+  {
+    // Use the cached extents...
+    extents->left = cached.left;
+    width         = cached.width;
+  }
+  else
+  {
+    // Loop through the string...
+    if (font->use_ligatures)
+      ligatures = load_ligatures(font);
+
+    if (font->fixed_width && !ligatures)
+      end = s + strlen(s);
+
+    while (*s)
+    {
+      if (font->fixed_width && !ligatures && (count = _ttfCountPrintable(s, (size_t)(end - s))) > 0)
       {
-        storptr = (char *)font->names.storage + name->offset;
-        chars   = name->length;
-        bpc     = 1;
+        // Printable ASCII in a fixed-width font all have the same width...
+	if (first)
+	{
+	  extents->left = -font->widths[0][*s & 255].left_bearing / font->units;
+	  first         = false;
+	}
+
+        width += (int)count * font->fixed_width;
+        s     += count;
+        continue;
       }
 
-      for (tempptr = temp; chars > 0; storptr += bpc, chars --)
-      {
-        int ch;				// Current character
+      if ((ch = _ttfNextUnicode(font, &s)) == 0)
+        break;
 
-        // Convert to Unicode...
-        if (bpc == 1)
-          ch = *storptr;
-	else if (bpc == 2)
-	  ch = ((storptr[0] & 255) << 8) | (storptr[1] & 255);
-	else
-	  ch = ((storptr[0] & 255) << 24) | ((storptr[1] & 255) << 16) | ((storptr[2] & 255) << 8) | (storptr[3] & 255);
+      // Find its width...
+      if (ligatures && ch < (int)font->num_cmap && (glyph = get_ligature(font, font->cmap[ch], &s)) > 0)
+      {
+        // Use the ligature glyph width...
+        if ((metric = get_glyph_metric(font, glyph)) == NULL)
+          metric = &font->def_width;
 
-        // Convert to UTF-8...
-        if (ch < 0x80)
-        {
-          // ASCII...
-	  if (tempptr < (temp + sizeof(temp) - 1))
-	    *tempptr++ = (char)ch;
-	  else
-	    break;
-	}
-	else if (ch < 0x400)
+	if (first)
 	{
-	  // Two byte UTF-8
-	  if (tempptr < (temp + sizeof(temp) - 2))
-	  {
-	    *tempptr++ = (char)(0xc0 | (ch >> 6));
-	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
-	  }
-	  else
-	    break;
+	  extents->left = -metric->left_bearing / font->units;
+	  first         = false;
 	}
-	else if (ch < 0x10000)
+
+	width += metric->width;
+      }
+      else if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
+      {
+	if (first)
 	{
-	  // Three byte UTF-8
-	  if (tempptr < (temp + sizeof(temp) - 3))
-	  {
-	    *tempptr++ = (char)(0xe0 | (ch >> 12));
-	    *tempptr++ = (char)(0x80 | ((ch >> 6) & 0x3f));
-	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
-	  }
-	  else
-	    break;
+	  extents->left = -widths[ch & 255].left_bearing / font->units;
+	  first         = false;
 	}
-	else
+
+	width += widths[ch & 255].width;
+      }
+      else if ((widths = font->widths[0]) != NULL)
+      {
+	// Use the ".notdef" (0) glyph width...
+	if (first)
 	{
-	  // Four byte UTF-8
-	  if (tempptr < (temp + sizeof(temp) - 4))
-	  {
-	    *tempptr++ = (char)(0xf0 | (ch >> 18));
-	    *tempptr++ = (char)(0x80 | ((ch >> 12) & 0x3f));
-	    *tempptr++ = (char)(0x80 | ((ch >> 6) & 0x3f));
-	    *tempptr++ = (char)(0x80 | (ch & 0x3f));
-	  }
-	  else
-	    break;
+	  extents->left = -widths[0].left_bearing / font->units;
+	  first         = false;
 	}
+
+	width += widths[0].width;
+      }
+    }
+
+    if (font->extents && cached.s[0])
+    {
+      // Save the extents in the cache...
+      cached.left  = extents->left;
+      cached.width = width;
+
+      store_extents(font, &cached);
+    }
+  }
+
+  // Calculate the bounding box for the text and return...
+  TTF_DEBUG("ttfGetExtents: width=%d\n", width);
+
+  extents->bottom = size * font->y_min / font->units;
+  extents->right  = size * width / font->units + extents->left;
+  extents->top    = size * font->y_max / font->units;
+
+  return (extents);
+}
+
+
+//
+// 'ttfGetExtentsCacheStats()' - Get the number of hits and misses for the extents cache.
+//
+// This function gets the number of @link ttfGetExtents@ and
+// @link ttfGetKernedExtents@ calls that were satisfied from the extents cache
+// ("hits") and the number of calls that had to measure the string ("misses").
+// Both values are `0` if the extents cache is not enabled.
+//
+
+void
+ttfGetExtentsCacheStats(
+    ttf_t  *font,			// I - Font
+    size_t *hits,			// O - Number of cache hits or `NULL`
+    size_t *misses)			// O - Number of cache misses or `NULL`
+{
+  size_t		i,		// Looping var
+			num_hits = 0,	// Number of cache hits
+			num_misses = 0;	// Number of cache misses
+  _ttf_extents_shard_t	*shard;		// Current shard
+
+
+  if (font && font->extents)
+  {
+    for (i = TTF_EXTENTS_SHARDS, shard = font->extents; i > 0; i --, shard ++)
+    {
+      _ttfMutexLock(&shard->mutex);
+      num_hits   += shard->hits;
+      num_misses += shard->misses;
+      _ttfMutexUnlock(&shard->mutex);
+    }
+  }
+
+  if (hits)
+    *hits = num_hits;
+
+  if (misses)
+    *misses = num_misses;
+}
+
+
+//
+// 'ttfGetFamily()' - Get the family name of a font.
+//
+
+const char *				// O - Family name
+ttfGetFamily(ttf_t *font)		// I - Font
+{
+  return (font ? font->family : NULL);
+}
+
+
+//
+// 'ttfGetGlyphAdvance()' - Get the advance width of a glyph.
+//
+// This function returns the advance width of a glyph, for example a glyph
+// returned by a text shaping library or the @link ttfGetGlyphs@ function.
+//
+
+int					// O - Advance width in 1000ths
+ttfGetGlyphAdvance(ttf_t *font,		// I - Font
+                   int   glyph)		// I - Glyph index
+{
+  _ttf_metric_t	*metric;		// Glyph metrics
+
+
+  if ((metric = get_glyph_metric(font, glyph)) == NULL)
+    return (0);
+
+  return ((int)(1000.0f * metric->width / font->units));
+}
+
+
+//
+// 'ttfGetGlyphBounds()' - Get the ink bounding box of a glyph.
+//
+// This function gets the bounding box of the glyph's outline, relative to the
+// glyph origin.  The bounds come from the "glyf" table or are computed from
+// the CFF outline the first time the glyph is used.  All values are `0` for
+// empty glyphs such as spaces.
+//
+
+ttf_rect_t *				// O - Pointer to bounds or `NULL` on error
+ttfGetGlyphBounds(ttf_t      *font,	// I - Font
+                  int        glyph,	// I - Glyph index
+                  ttf_rect_t *bounds)	// O - Bounds in 1000ths
+{
+  const _ttf_bounds_t	*gbounds;	// Glyph bounds
+
+
+  // Make sure bounds is zeroed out...
+  if (bounds)
+    memset(bounds, 0, sizeof(ttf_rect_t));
+
+  // Range check input...
+  if (!font || glyph < 0 || (size_t)glyph >= font->num_glyphs || !bounds)
+    return (NULL);
+
+  if ((gbounds = get_glyph_bounds(font, glyph)) != NULL && gbounds->x_min <= gbounds->x_max)
+  {
+    bounds->left   = 1000.0f * gbounds->x_min / font->units;
+    bounds->top    = 1000.0f * gbounds->y_max / font->units;
+    bounds->right  = 1000.0f * gbounds->x_max / font->units;
+    bounds->bottom = 1000.0f * gbounds->y_min / font->units;
+  }
+
+  return (gbounds ? bounds : NULL);
+}
+
+
+//
+// 'ttfGetGlyphKerning()' - Get the kerning adjustment between two glyphs.
+//
+
+int					// O - Kerning adjustment in 1000ths
+ttfGetGlyphKerning(ttf_t *font,		// I - Font
+                   int   left,		// I - Left glyph index
+                   int   right)		// I - Right glyph index
+{
+  // Range check input...
+  if (!font || left < 0 || (size_t)left >= font->num_glyphs || right < 0 || (size_t)right >= font->num_glyphs)
+    return (0);
+
+  return ((int)(1000.0f * _ttfGetKerning(font, left, right) / font->units));
+}
+
+
+//
+// 'ttfGetGlyphLeftBearing()' - Get the left side bearing of a glyph.
+//
+
+int					// O - Left side bearing in 1000ths
+ttfGetGlyphLeftBearing(ttf_t *font,	// I - Font
+                       int   glyph)	// I - Glyph index
+{
+  _ttf_metric_t	*metric;		// Glyph metrics
+
+
+  if ((metric = get_glyph_metric(font, glyph)) == NULL)
+    return (0);
+
+  return ((int)(1000.0f * metric->left_bearing / font->units));
+}
+
+
+//
+// 'ttfGetGlyphs()' - Map a UTF-8 string to glyphs.
+//
+// This function maps each character in the UTF-8 string "s" to a glyph index
+// in the font.  The "len" argument specifies the length of the string in bytes
+// or `0` if the string is nul-terminated.  Characters not present in the font
+// use glyph 0 (".notdef").
+//
+// Up to "max_glyphs" glyphs are stored in the "glyphs" array.  The number of
+// glyphs stored is returned.
+//
+
+size_t					// O - Number of glyphs
+ttfGetGlyphs(ttf_t      *font,		// I - Font
+             const char *s,		// I - UTF-8 string
+             size_t     len,		// I - Length of string in bytes or `0` for nul-terminated
+             int        *glyphs,	// O - Glyph indices
+             size_t     max_glyphs)	// I - Maximum number of glyphs
+{
+  size_t	num_glyphs = 0;		// Number of glyphs
+  const char	*end;			// End of string
+  uint64_t	word;			// 8 bytes of string
+  int		i,			// Looping var
+		ch;			// Current character
+
+
+  // Range check input...
+  if (!font || !s || !glyphs || max_glyphs == 0)
+    return (0);
+
+  end = s + (len ? len : strlen(s));
+
+  while (s < end && num_glyphs < max_glyphs)
+  {
+    if ((end - s) >= 8 && (max_glyphs - num_glyphs) >= 8)
+    {
+      // Map 8 ASCII characters at a time...
+      memcpy(&word, s, sizeof(word));
+
+      if (!(word & 0x8080808080808080ULL) && ((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL) == 0)
+      {
+        for (i = 0; i < 8; i ++)
+        {
+          ch                     = s[i];
+          glyphs[num_glyphs + i] = ch < (int)font->num_cmap && font->cmap[ch] > 0 ? font->cmap[ch] : 0;
+        }
+
+        s          += 8;
+        num_glyphs += 8;
+        continue;
       }
+    }
+
+    if ((ch = _ttfNextUnicode(font, &s)) == 0)
+      break;
+
+    glyphs[num_glyphs ++] = ch < (int)font->num_cmap && font->cmap[ch] > 0 ? font->cmap[ch] : 0;
+  }
+
+  return (num_glyphs);
+}
+
+
+//
+// 'ttfGetGlyphsUTF32()' - Map an array of Unicode characters to glyphs.
+//
+// This function maps "num_chars" Unicode characters to glyph indices in the
+// font, storing them in the "glyphs" array which must have room for
+// "num_chars" glyphs.  Characters not present in the font use glyph 0
+// (".notdef").
+//
+
+size_t					// O - Number of glyphs
+ttfGetGlyphsUTF32(ttf_t     *font,	// I - Font
+                  const int *chars,	// I - Unicode characters
+                  size_t    num_chars,	// I - Number of characters
+                  int       *glyphs)	// O - Glyph indices
+{
+  size_t	i;			// Looping var
+  const int	*cmap;			// Character to glyph map
+  unsigned	num_cmap;		// Number of characters in map
+  int		glyph;			// Current glyph
+
+
+  // Range check input...
+  if (!font || !chars || !glyphs)
+    return (0);
+
+  for (i = 0, cmap = font->cmap, num_cmap = (unsigned)font->num_cmap; i < num_chars; i ++)
+  {
+    glyph     = (unsigned)chars[i] < num_cmap ? cmap[chars[i]] : 0;
+    glyphs[i] = glyph > 0 ? glyph : 0;
+  }
+
+  return (num_chars);
+}
+
+
+//
+// 'ttfGetGlyphVerticalAdvance()' - Get the vertical advance of a glyph.
+//
+// This function gets the advance height of a glyph from the "vmtx" table.  For
+// fonts without vertical metrics the advance is the typographic ascent minus
+// the typographic descent.
+//
+
+int					// O - Advance height in 1000ths
+ttfGetGlyphVerticalAdvance(ttf_t *font,	// I - Font
+                           int   glyph)	// I - Glyph index
+{
+  const _ttf_metric_t	*metric;	// Vertical glyph metrics
+
+
+  if (!font)
+    return (0);
+
+  load_vertical(font);
+
+  if ((metric = get_vertical_metric(font, glyph)) == NULL)
+    return (0);
+
+  return ((int)(1000.0f * metric->width / font->units));
+}
+
+
+//
+// 'ttfGetGlyphVerticalOrigin()' - Get the vertical origin of a glyph.
+//
+// This function gets the Y position of the vertical origin of a glyph relative
+// to the baseline, which is the point at the top center of the glyph that is
+// placed on the pen position in vertical text.  The origin comes from the
+// "VORG" table, if present, or from the top side bearing and bounding box of
+// the glyph.  For fonts without vertical metrics the origin is the typographic
+// ascent.
+//
+
+int					// O - Vertical origin in 1000ths
+ttfGetGlyphVerticalOrigin(ttf_t *font,	// I - Font
+                          int   glyph)	// I - Glyph index
+{
+  int			origin;		// Vertical origin
+  const _ttf_metric_t	*metric;	// Vertical glyph metrics
+  const _ttf_bounds_t	*bounds;	// Glyph bounds
+
+
+  if (!font)
+    return (0);
+
+  load_vertical(font);
+
+  if ((metric = get_vertical_metric(font, glyph)) == NULL)
+    return (0);
+
+  origin = font->typo_ascent;
+
+  if (font->vorg)
+  {
+    // Binary search the vertical origin records...
+    size_t	left = 0,		// Left record
+		right = font->num_vorg;	// Right record
+    unsigned	current;		// Current glyph
+
+    origin = font->def_vorg;
+
+    while (left < right)
+    {
+      size_t mid = (left + right) / 2;	// Middle record
+
+      if ((current = TTF_GET_USHORT(font->vorg + 4 * mid)) == (unsigned)glyph)
+      {
+        origin = (short)TTF_GET_USHORT(font->vorg + 4 * mid + 2);
+        break;
+      }
+      else if (current < (unsigned)glyph)
+        left = mid + 1;
+      else
+        right = mid;
+    }
+  }
+  else if (font->num_vert_metrics > 0)
+  {
+    // The origin is the top side bearing above the top of the glyph...
+    if ((bounds = get_glyph_bounds(font, glyph)) != NULL && bounds->x_min <= bounds->x_max)
+      origin = bounds->y_max + metric->left_bearing;
+  }
+
+  return ((int)(1000.0f * origin / font->units));
+}
+
+
+//
+// 'ttfGetInkExtents()' - Get the tight ink extents of a UTF-8 string.
+//
+// This function computes the bounding box of the ink of the UTF-8 string "s"
+// using the specified font "font" and size "size".  Unlike
+// @link ttfGetExtents@, which uses the font bounding box for the top and
+// bottom, the "extents" argument is filled with the union of the bounding
+// boxes of the glyphs in the string, relative to the origin of the first
+// character.  All values are `0` if the string has no ink.  No kerning is
+// applied; standard ligatures are applied if enabled with the
+// @link ttfSetLigatures@ function.
+//
+// Glyph bounding boxes are loaded the first time each glyph is used and
+// cached with the font.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetInkExtents(
+    ttf_t      *font,			// I - Font
+    float      size,			// I - Font size
+    const char *s,			// I - String
+    ttf_rect_t *extents)		// O - Extents of the string
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		x = 0,			// Current X position
+		x_min = 0,		// Ink bounding box
+		y_min = 0,
+		x_max = 0,
+		y_max = 0;
+  bool		empty = true,		// No ink yet?
+		ligatures = false;	// Apply ligatures?
+  const _ttf_bounds_t *bounds;		// Glyph bounds
+  _ttf_metric_t	*metric;		// Glyph metrics
+
+
+  TTF_DEBUG("ttfGetInkExtents(font=%p, size=%.2f, s=\"%s\", extents=%p)\n", (void *)font, size, s, (void *)extents);
+
+  // Make sure extents is zeroed out...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  // Range check input...
+  if (!font || size <= 0.0f || !s || !extents)
+    return (NULL);
+
+  if (font->use_ligatures)
+    ligatures = load_ligatures(font);
+
+  while (*s)
+  {
+    if ((ch = _ttfNextUnicode(font, &s)) == 0)
+      break;
+
+    glyph = ch < (int)font->num_cmap && font->cmap[ch] > 0 ? font->cmap[ch] : 0;
+
+    if (ligatures && glyph > 0 && (ch = get_ligature(font, glyph, &s)) > 0)
+      glyph = ch;
+
+    // Add the glyph bounds to the ink box...
+    if ((bounds = get_glyph_bounds(font, glyph)) != NULL && bounds->x_min <= bounds->x_max)
+    {
+      if (empty)
+      {
+        x_min = x + bounds->x_min;
+        y_min = bounds->y_min;
+        x_max = x + bounds->x_max;
+        y_max = bounds->y_max;
+        empty = false;
+      }
+      else
+      {
+        if ((x + bounds->x_min) < x_min)
+          x_min = x + bounds->x_min;
+        if (bounds->y_min < y_min)
+          y_min = bounds->y_min;
+        if ((x + bounds->x_max) > x_max)
+          x_max = x + bounds->x_max;
+        if (bounds->y_max > y_max)
+          y_max = bounds->y_max;
+      }
+    }
+
+    // Then advance...
+    if ((metric = get_glyph_metric(font, glyph)) == NULL)
+      metric = &font->def_width;
+
+    x += metric->width;
+  }
+
+  TTF_DEBUG("ttfGetInkExtents: x_min=%d, y_min=%d, x_max=%d, y_max=%d\n", x_min, y_min, x_max, y_max);
+
+  extents->left   = size * x_min / font->units;
+  extents->top    = size * y_max / font->units;
+  extents->right  = size * x_max / font->units;
+  extents->bottom = size * y_min / font->units;
+
+  return (extents);
+}
+
+
+//
+// 'ttfGetItalicAngle()' - Get the italic angle.
+//
+
+float					// O - Angle in degrees
+ttfGetItalicAngle(ttf_t *font)		// I - Font
+{
+  return (font ? font->italic_angle : 0.0f);
+}
+
+
+//
+// 'ttfGetKernedExtents()' - Get the kerned extents of a string.
+//
+// This function computes the kerned extents of the UTF-8 string "s" when
+// rendered using the specified font "font" and size "size".  The "extents"
+// argument is a pointer to a `ttf_rect_t` structure that is filled with the
+// extents of a kerned rendering of the string with no rewriting applied.  The
+// "adjs" argument specifies and array of `double` values up to "max_adjs" long
+// containing the kerning adjustments between each pair of characters.  The
+// extent and adjustment values are scaled using the specified font size.
+//
+
+size_t					// O - Number of kerned pairs
+ttfGetKernedExtents(ttf_t      *font,	// I - Font
+                    float      size,	// I - Font size
+                    const char *s,	// I - String
+                    ttf_rect_t *extents,// O - Kerned extents of string
+                    size_t     max_adjs,// I - Maximum number of kerning adjustments
+                    double     *adjs)	// I - Array of kerning adjustments
+{
+  bool		first = true;		// First character?
+  int		ch,			// Current character
+		width = 0;		// Width
+  _ttf_metric_t	*widths;		// Widths
+  size_t	num_adjs = 0;		// Number of adjustments
+  int		left = 0,		// Left glyph
+		right,			// Right glyph
+		adj,			// Kerning adjustment
+		lindex = -1,		// Left Latin-1 index
+		rindex;			// Right Latin-1 index
+  const short	*latin;			// Latin-1 kerning matrix
+  _ttf_extents_t cached;		// Cached extents
+
+
+  TTF_DEBUG("ttfGetKernedExtents(font=%p, size=%.2f, s=\"%s\", extents=%p, max_adjs=%u, adjs=%p)\n", (void *)font, size, s, (void *)extents, (unsigned)max_adjs, (void *)adjs);
+
+  // Make sure extents and kerning adjustments are zeroed out...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (adjs && max_adjs > 0)
+    memset(adjs, 0, max_adjs * sizeof(double));
+
+  // Range check input...
+  if (!font || size <= 0.0f || !s || !extents || !adjs || max_adjs == 0)
+  {
+    TTF_DEBUG("ttfGetKernedExtents: Bad input, returning 0.\n");
+    return (0);
+  }
+
+  if (font->extents && find_extents(font, s, /*kerned*/true, max_adjs, &cached))
+  {
+    // Use the cached extents and kerning adjustments...
+    extents->left = cached.left;
+    width         = cached.width;
+
+    for (num_adjs = 0; num_adjs < cached.num_adjs; num_adjs ++)
+      adjs[num_adjs] = size * cached.adjs[num_adjs] / font->units;
+  }
+  else
+  {
+    // Loop through the string...
+    latin = _ttfGetLatinKerning(font);
+
+    while ((ch = _ttfNextUnicode(font, &s)) != 0)
+    {
+      // Find its width...
+      if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
+      {
+	if (first)
+	  extents->left = -widths[ch & 255].left_bearing / font->units;
+
+	width += widths[ch & 255].width;
+      }
+      else if ((widths = font->widths[0]) != NULL)
+      {
+	// Use the ".notdef" (0) glyph width...
+	if (first)
+	  extents->left = -widths[0].left_bearing / font->units;
+
+	width += widths[0].width;
+      }
+
+      // Then any kerning...
+      rindex = TTF_LATIN_INDEX(ch);
+
+      if (first)
+      {
+	// This is the first character in the string so save that as the left
+	// glyph...
+	if (ch < (int)font->num_cmap)
+	  left = font->cmap[ch];
+
+	lindex = rindex;
+	first  = false;
+      }
+      else if (num_adjs >= max_adjs)
+      {
+	// Too many pairs, don't cache the truncated extents...
+	cached.s[0] = '\0';
+	break;
+      }
+      else if (font->num_kerning || font->num_kern_classes)
+      {
+	// Lookup kerning information for the current pair of characters, using
+	// the matrix for printable ASCII/Latin-1...
+	if (ch < (int)font->num_cmap)
+	  right = font->cmap[ch];
+	else
+	  right = 0;
+
+	if (latin && lindex >= 0 && rindex >= 0)
+	  adj = latin[lindex * TTF_LATIN_COUNT + rindex];
+	else
+	  adj = _ttfGetKerning(font, left, right);
+
+	width          += adj;
+	adjs[num_adjs] = size * adj / font->units;
+
+	if (num_adjs < TTF_EXTENTS_MAX_LEN)
+	  cached.adjs[num_adjs] = (short)adj;
+
+	num_adjs ++;
+
+	// The right glyph is the left glyph for the next pair...
+	left   = right;
+	lindex = rindex;
+      }
+      else
+      {
+	// No kerning information, so just store 0...
+	adjs[num_adjs] = 0.0;
+
+	if (num_adjs < TTF_EXTENTS_MAX_LEN)
+	  cached.adjs[num_adjs] = 0;
+
+	num_adjs ++;
+      }
+    }
+
+    if (font->extents && cached.s[0])
+    {
+      // Save the extents and adjustments in the cache...
+      cached.left     = extents->left;
+      cached.width    = width;
+      cached.num_adjs = num_adjs;
+
+      store_extents(font, &cached);
+    }
+  }
+
+  // Calculate the bounding box for the text and return...
+  TTF_DEBUG("ttfGetKernedExtents: width=%d, returning %u.\n", width, (unsigned)num_adjs);
+
+  extents->bottom = size * font->y_min / font->units;
+  extents->right  = size * width / font->units + extents->left;
+  extents->top    = size * font->y_max / font->units;
+
+  return (num_adjs);
+}
+
+
+//
+// 'ttfGetLineGap()' - Get the recommended gap between lines.
+//
+
+int					// O - Line gap in 1000ths
+ttfGetLineGap(ttf_t *font)		// I - Font
+{
+  return (font ? (int)(1000 * (font->use_typo ? font->typo_line_gap : font->line_gap) / font->units) : 0);
+}
+
+
+//
+// 'ttfGetLineHeight()' - Get the recommended distance between baselines.
+//
+// The line height is the ascent, descent, and line gap from the OS/2 table
+// when the font requests "typographic" metrics and from the hhea table
+// otherwise.
+//
+
+int					// O - Line height in 1000ths
+ttfGetLineHeight(ttf_t *font)		// I - Font
+{
+  if (!font)
+    return (0);
+  else if (font->use_typo)
+    return ((int)(1000 * (font->typo_ascent - font->typo_descent + font->typo_line_gap) / font->units));
+  else
+    return ((int)(1000 * (font->ascent - font->descent + font->line_gap) / font->units));
+}
+
+
+//
+// 'ttfGetMaxChar()' - Get the last character in the font.
+//
+
+int					// O - Last character in font
+ttfGetMaxChar(ttf_t *font)		// I - Font
+{
+  return (font ? font->max_char : 0);
+}
+
+
+//
+// 'ttfGetMinChar()' - Get the first character in the font.
+//
+
+int					// O - First character in font
+ttfGetMinChar(ttf_t *font)		// I - Font
+{
+  return (font ? font->min_char : 0);
+}
+
+
+//
+// 'ttfGetNumFonts()' - Get the number of fonts in this collection.
+//
+
+size_t					// O - Number of fonts
+ttfGetNumFonts(ttf_t *font)		// I - Font
+{
+  return (font ? font->num_fonts : 0);
+}
+
+
+//
+// 'ttfGetPixelExtents()' - Get the extents of a UTF-8 string in whole pixels.
+//
+// This function computes the extents of the UTF-8 string "s" when rendered
+// using the specified font "font" at "ppem" pixels per em.  Unlike
+// @link ttfGetExtents@, the advance of each character is a whole number of
+// pixels taken from the font's device metrics ("hdmx" table) when available,
+// or the rounded scaled advance otherwise, so the width matches hinted raster
+// output.  The top and bottom come from the "VDMX" table when available.
+//
+// The "extents" argument is filled with the extents in pixels, with the left
+// edge at `0`.  No kerning is applied.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetPixelExtents(
+    ttf_t      *font,			// I - Font
+    int        ppem,			// I - Pixels per em
+    const char *s,			// I - String
+    ttf_rect_t *extents)		// O - Extents of the string
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		units,			// Units per em
+		width = 0;		// Width in pixels
+  const _ttf_pixel_t *pixel;		// Device metrics for this size
+  const unsigned char *widths = NULL;	// Device advance widths
+  _ttf_metric_t	*metric;		// Glyph metrics
+
+
+  TTF_DEBUG("ttfGetPixelExtents(font=%p, ppem=%d, s=\"%s\", extents=%p)\n", (void *)font, ppem, s, (void *)extents);
+
+  // Make sure extents is zeroed out...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  // Range check input...
+  if (!font || ppem <= 0 || !s || !extents || (units = (int)font->units) <= 0)
+    return (NULL);
+
+  if ((pixel = get_pixel(font, ppem)) != NULL)
+    widths = pixel->widths;
+
+  // Add up the advance widths...
+  while (*s)
+  {
+    if ((ch = _ttfNextUnicode(font, &s)) == 0)
+      break;
+
+    glyph = ch < (int)font->num_cmap && font->cmap[ch] > 0 ? font->cmap[ch] : 0;
+
+    if (widths && (size_t)glyph < font->num_glyphs)
+    {
+      width += widths[glyph];
+    }
+    else
+    {
+      if ((metric = get_glyph_metric(font, glyph)) == NULL)
+        metric = &font->def_width;
+
+      width += (metric->width * ppem + units / 2) / units;
+    }
+  }
+
+  // Then figure out the vertical bounds...
+  if (pixel && pixel->have_bounds)
+  {
+    extents->bottom = pixel->y_min;
+    extents->top    = pixel->y_max;
+  }
+  else
+  {
+    // Round the font bounding box outwards...
+    extents->bottom = -((-font->y_min * ppem + units - 1) / units);
+    extents->top    = (font->y_max * ppem + units - 1) / units;
+  }
+
+  extents->right = width;
+
+  return (extents);
+}
+
+
+//
+// 'ttfGetPostScriptName()' - Get the PostScript name of a font.
+//
+
+const char *				// O - PostScript name
+ttfGetPostScriptName(
+    ttf_t *font)			// I - Font
+{
+  return (font ? font->postscript_name : NULL);
+}
+
+
+//
+// 'ttfGetStretch()' - Get the font "stretch" value...
+//
+
+ttf_stretch_t				// O - Stretch value
+ttfGetStretch(ttf_t *font)		// I - Font
+{
+  return (font ? font->stretch : TTF_STRETCH_NORMAL);
+}
+
+
+//
+// 'ttfGetStyle()' - Get the font style.
+//
+
+ttf_style_t				// O - Style
+ttfGetStyle(ttf_t *font)		// I - Font
+{
+  return (font ? font->style : TTF_STYLE_NORMAL);
+}
+
+
+//
+// 'ttfGetTypoAscent()' - Get the typographic ascent from the OS/2 table.
+//
+
+int					// O - Typographic ascent in 1000ths
+ttfGetTypoAscent(ttf_t *font)		// I - Font
+{
+  return (font ? (int)(1000 * font->typo_ascent / font->units) : 0);
+}
+
+
+//
+// 'ttfGetTypoDescent()' - Get the typographic descent from the OS/2 table.
+//
+
+int					// O - Typographic descent in 1000ths
+ttfGetTypoDescent(ttf_t *font)		// I - Font
+{
+  return (font ? (int)(1000 * font->typo_descent / font->units) : 0);
+}
+
+
+//
+// 'ttfGetTypoLineGap()' - Get the typographic line gap from the OS/2 table.
+//
+
+int					// O - Typographic line gap in 1000ths
+ttfGetTypoLineGap(ttf_t *font)		// I - Font
+{
+  return (font ? (int)(1000 * font->typo_line_gap / font->units) : 0);
+}
+
+
+//
+// 'ttfGetUnicodeMap()' - Get the glyph to Unicode character map.
+//
+// This function returns an array of Unicode characters indexed by glyph, for
+// example to build a PDF ToUnicode CMap.  Glyphs that are not mapped from any
+// character have the value `-1`.  When several characters map to the same
+// glyph, the lowest character is used.  The "num_glyphs" argument receives the
+// number of glyphs in the array.
+//
+// The map is built the first time it is requested and is owned by the font.
+//
+
+const int *				// O - Glyph to Unicode map or `NULL` on error
+ttfGetUnicodeMap(ttf_t  *font,		// I - Font
+                 size_t *num_glyphs)	// O - Number of glyphs
+{
+  const int	*unicodes;		// Glyph to Unicode map
+
+
+  if (num_glyphs)
+    *num_glyphs = 0;
+
+  if (!font || !num_glyphs || (unicodes = get_unicodes(font)) == NULL)
+    return (NULL);
+
+  *num_glyphs = font->num_glyphs;
+
+  return (unicodes);
+}
+
+
+//
+// 'ttfGetUnicodeRanges()' - Get ranges of glyphs mapped to consecutive Unicode characters.
+//
+// This function returns ranges of consecutive glyphs that map to consecutive
+// Unicode characters, in the form used by the "bfrange" entries of a PDF
+// ToUnicode CMap.  The "value" member of each range is the Unicode character
+// of the first glyph.  Ranges do not cross a multiple of 256 glyphs or
+// characters.
+//
+// The "glyphs" and "num_glyphs" arguments specify the glyphs that are used,
+// in any order, or `NULL` and `0` for all glyphs in the font.  Up to
+// "max_ranges" ranges are stored in the "ranges" array.  The number of ranges
+// needed is returned, which may be larger than "max_ranges".
+//
+
+size_t					// O - Number of ranges needed
+ttfGetUnicodeRanges(
+    ttf_t             *font,		// I - Font
+    const int         *glyphs,		// I - Used glyphs or `NULL` for all
+    size_t            num_glyphs,	// I - Number of used glyphs
+    ttf_glyph_range_t *ranges,		// I - Ranges
+    size_t            max_ranges)	// I - Maximum number of ranges
+{
+  size_t		num_ranges = 0;	// Number of ranges
+  const int		*unicodes;	// Glyph to Unicode map
+  unsigned char		*used = NULL;	// Used glyphs
+  int			glyph;		// Current glyph
+  ttf_glyph_range_t	current;	// Current range
+
+
+  // Range check input...
+  if (!font || (!ranges && max_ranges > 0) || (unicodes = get_unicodes(font)) == NULL)
+    return (0);
+
+  if (glyphs && (used = get_used(font, glyphs, num_glyphs)) == NULL)
+    return (0);
+
+  // Add the mapped glyphs...
+  for (glyph = 0; (size_t)glyph < font->num_glyphs; glyph ++)
+  {
+    if (unicodes[glyph] >= 0 && (!used || (used[glyph / 8] & (1 << (glyph & 7)))))
+      add_glyph_range(&current, /*sequential*/true, glyph, unicodes[glyph], ranges, max_ranges, &num_ranges);
+  }
+
+  free(used);
+
+  return (num_ranges);
+}
+
+
+//
+// 'ttfGetVersion()' - Get the version number of a font.
+//
+
+const char *				// O - Version number
+ttfGetVersion(ttf_t *font)		// I - Font
+{
+  return (font ? font->version : NULL);
+}
+
+
+//
+// 'ttfGetVerticalExtents()' - Get the extents of a UTF-8 string set vertically.
+//
+// This function computes the extents of the UTF-8 string "s" when set in a
+// vertical column using the specified font "font" and size "size".  The
+// extents are relative to the vertical origin of the first character with the
+// pen moving down the column, so "top" is the top side bearing of the first
+// character and "bottom" is the (negative) total advance height.  The "left"
+// and "right" values are half of the widest horizontal advance on either side
+// of the column center.
+//
+// The advances come from the "vhea" and "vmtx" tables, which are loaded the
+// first time they are needed.  No vertical glyph substitutions are applied.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetVerticalExtents(
+    ttf_t      *font,			// I - Font
+    float      size,			// I - Font size
+    const char *s,			// I - String
+    ttf_rect_t *extents)		// O - Extents of the string
+{
+  bool			first = true;	// First character?
+  int			ch,		// Current character
+			glyph,		// Current glyph
+			height = 0,	// Total advance height
+			width = 0;	// Maximum advance width
+  const _ttf_metric_t	*metric;	// Vertical glyph metrics
+  const _ttf_metric_t	*hmetric;	// Horizontal glyph metrics
+
+
+  // Make sure extents is zeroed out...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  // Range check input...
+  if (!font || size <= 0.0f || !s || !extents)
+    return (NULL);
+
+  load_vertical(font);
+
+  // Loop through the string...
+  while ((ch = _ttfNextUnicode(font, &s)) != 0)
+  {
+    if (ch < 0 || (size_t)ch >= font->num_cmap || (glyph = font->cmap[ch]) < 0)
+      glyph = 0;			// Use the ".notdef" glyph
+
+    if ((metric = get_vertical_metric(font, glyph)) == NULL)
+      metric = &font->def_vert_metric;
+
+    if (first)
+    {
+      extents->top = -size * metric->left_bearing / font->units;
+      first        = false;
+    }
+
+    height += metric->width;
+
+    if ((hmetric = get_glyph_metric(font, glyph)) != NULL && hmetric->width > width)
+      width = hmetric->width;
+  }
+
+  // Calculate the bounding box for the text and return...
+  TTF_DEBUG("ttfGetVerticalExtents: height=%d, width=%d\n", height, width);
+
+  extents->bottom = -size * height / font->units;
+  extents->right  = 0.5f * size * width / font->units;
+  extents->left   = -extents->right;
+
+  return (extents);
+}
+
+
+//
+// 'ttfGetWeight()' - Get the weight of a font.
+//
+
+ttf_weight_t				// O - Weight
+ttfGetWeight(ttf_t *font)		// I - Font
+{
+  return (font ? (ttf_weight_t)font->weight : TTF_WEIGHT_400);
+}
+
+
+//
+// 'ttfGetWidth()' - Get the width of a single character.
+//
+
+int					// O - Width in 1000ths
+ttfGetWidth(ttf_t *font,		// I - Font
+            int   ch)			// I - Unicode character
+{
+  int	bin =  ch >> 8;			// Bin in widths array
+
+
+  // Range check input...
+  if (!font || ch < ' ' || ch == 0x7f || ch >= TTF_FONT_MAX_CHAR)
+    return (0);
+
+  if (font->widths[bin])
+    return ((int)(1000.0f * font->widths[bin][ch & 255].width / font->units));
+  else if (font->widths[0])		// .notdef
+    return ((int)(1000.0f * font->widths[0][0].width / font->units));
+  else
+    return (0);
+}
+
+
+//
+// 'ttfGetWidthRanges()' - Get ranges of glyphs with the same advance width.
+//
+// This function returns run-length compressed glyph advance widths in 1000ths,
+// in the form used by the "W" array of a PDF CIDFont ("first last width").
+// Each range covers consecutive glyphs with the same width.
+//
+// The "glyphs" and "num_glyphs" arguments specify the glyphs that are used,
+// in any order, or `NULL` and `0` for all glyphs in the font.  Up to
+// "max_ranges" ranges are stored in the "ranges" array.  The number of ranges
+// needed is returned, which may be larger than "max_ranges".
+//
+
+size_t					// O - Number of ranges needed
+ttfGetWidthRanges(
+    ttf_t             *font,		// I - Font
+    const int         *glyphs,		// I - Used glyphs or `NULL` for all
+    size_t            num_glyphs,	// I - Number of used glyphs
+    ttf_glyph_range_t *ranges,		// I - Ranges
+    size_t            max_ranges)	// I - Maximum number of ranges
+{
+  size_t		num_ranges = 0;	// Number of ranges
+  unsigned char		*used;		// Used glyphs
+  int			glyph;		// Current glyph
+  ttf_glyph_range_t	current,	// Current range
+			*width_ranges;	// Cached ranges for all glyphs
+
+
+  // Range check input...
+  if (!font || (!ranges && max_ranges > 0))
+    return (0);
+
+  if (!glyphs)
+  {
+    // Use the cached ranges for all glyphs, without locking once they have
+    // been built...
+    if ((width_ranges = (ttf_glyph_range_t *)_ttfAtomicGetPtr(&font->width_ranges)) == NULL)
+    {
+      _ttfMutexLock(&font->lock);
+
+      if ((width_ranges = font->width_ranges) == NULL && font->num_glyphs > 0)
+      {
+	for (glyph = 0; (size_t)glyph < font->num_glyphs; glyph ++)
+	  add_glyph_range(&current, /*sequential*/false, glyph, (int)(1000.0f * get_glyph_metric(font, glyph)->width / font->units), NULL, 0, &num_ranges);
+
+	if ((width_ranges = (ttf_glyph_range_t *)malloc(num_ranges * sizeof(ttf_glyph_range_t))) != NULL)
+	{
+	  font->num_width_ranges = num_ranges;
+	  num_ranges             = 0;
+
+	  for (glyph = 0; (size_t)glyph < font->num_glyphs; glyph ++)
+	    add_glyph_range(&current, /*sequential*/false, glyph, (int)(1000.0f * get_glyph_metric(font, glyph)->width / font->units), width_ranges, font->num_width_ranges, &num_ranges);
+
+	  _ttfAtomicSetPtr(&font->width_ranges, width_ranges);
+	}
+	else
+	{
+	  _ttfError(font, "Unable to allocate memory for width ranges.");
+	}
+      }
+
+      _ttfMutexUnlock(&font->lock);
+    }
+
+    if (!width_ranges)
+      num_ranges = 0;
+    else if ((num_ranges = font->num_width_ranges) > 0 && max_ranges > 0)
+      memcpy(ranges, width_ranges, (num_ranges < max_ranges ? num_ranges : max_ranges) * sizeof(ttf_glyph_range_t));
+  }
+  else if ((used = get_used(font, glyphs, num_glyphs)) != NULL)
+  {
+    // Add the used glyphs...
+    for (glyph = 0; (size_t)glyph < font->num_glyphs; glyph ++)
+    {
+      if (used[glyph / 8] & (1 << (glyph & 7)))
+        add_glyph_range(&current, /*sequential*/false, glyph, (int)(1000.0f * get_glyph_metric(font, glyph)->width / font->units), ranges, max_ranges, &num_ranges);
+    }
+
+    free(used);
+  }
+
+  return (num_ranges);
+}
+
+
+//
+// 'ttfGetXHeight()' - Get the height of lowercase letters.
+//
+
+int					// O - Lowercase letter height in 1000ths
+ttfGetXHeight(ttf_t *font)		// I - Font
+{
+  return (font ? (int)(1000 * font->x_height / font->units) : 0);
+}
+
+
+//
+// 'ttfIsFixedPitch()' - Determine whether a font is fixedpitch.
+//
+
+bool					// O - `true` if fixed pitch, `false` otherwise
+ttfIsFixedPitch(ttf_t *font)		// I - Font
+{
+  return (font ? font->is_fixed : false);
+}
+
+
+//
+// 'ttfSetExtentsCache()' - Enable or disable the extents cache for a font.
+//
+// This function enables or disables a bounded cache of string extents that is
+// used by the @link ttfGetExtents@ and @link ttfGetKernedExtents@ functions.
+// The "num_entries" argument specifies the maximum number of strings to cache
+// or `0` to disable the cache.  Only strings shorter than 64 bytes are cached.
+//
+// The cache is safe to use from multiple threads, however this function must
+// not be called while other threads are using the font.  Use the
+// @link ttfGetExtentsCacheStats@ function to get the number of cache hits and
+// misses.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfSetExtentsCache(ttf_t  *font,	// I - Font
+                   size_t num_entries)	// I - Maximum number of cached strings or `0` to disable
+{
+  size_t		i;		// Looping var
+  _ttf_extents_shard_t	*shard;		// Current shard
+
+
+  // Range check input...
+  if (!font)
+    return (false);
+
+  // Free any existing cache...
+  free_extents(font);
+
+  if (num_entries == 0)
+    return (true);
+
+  // Allocate the shards and their entries...
+  if ((font->extents = (_ttf_extents_shard_t *)calloc(TTF_EXTENTS_SHARDS, sizeof(_ttf_extents_shard_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for extents cache.");
+    return (false);
+  }
+
+  for (i = 0, shard = font->extents; i < TTF_EXTENTS_SHARDS; i ++, shard ++)
+  {
+    _ttfMutexInit(&shard->mutex);
+
+    shard->num_entries = (num_entries + TTF_EXTENTS_SHARDS - 1) / TTF_EXTENTS_SHARDS;
+
+    if ((shard->entries = (_ttf_extents_t *)calloc(shard->num_entries, sizeof(_ttf_extents_t))) == NULL)
+    {
+      _ttfError(font, "Unable to allocate memory for extents cache.");
+      free_extents(font);
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// 'ttfSetLigatures()' - Enable or disable standard ligatures for a font.
+//
+// This function enables or disables the use of the standard ligatures ("liga"
+// feature) in the font's GSUB table for the default script when measuring text
+// with the @link ttfGetExtents@ function, for example "fi" and "fl".  The
+// ligatures are loaded the first time they are needed.
+//
+// This function must not be called while other threads are using the font.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfSetLigatures(ttf_t *font,		// I - Font
+                bool  enable)		// I - `true` to use ligatures, `false` otherwise
+{
+  size_t		i;		// Looping var
+  _ttf_extents_shard_t	*shard;		// Current shard
+
+
+  // Range check input...
+  if (!font)
+    return (false);
+
+  if (font->use_ligatures != enable && font->extents)
+  {
+    // Flush the extents cache...
+    for (i = 0, shard = font->extents; i < TTF_EXTENTS_SHARDS; i ++, shard ++)
+      memset(shard->entries, 0, shard->num_entries * sizeof(_ttf_extents_t));
+  }
+
+  font->use_ligatures = enable;
+
+  return (true);
+}
+
+
+//
+// 'add_glyph_range()' - Add a glyph to a list of glyph ranges.
+//
+// The glyph is added to the current range if it follows the last glyph and
+// has the same value, or the next value for sequential ranges.  Otherwise a
+// new range is started.  Ranges past "max_ranges" are counted but not stored.
+//
+
+static void
+add_glyph_range(
+    ttf_glyph_range_t *current,		// IO - Current range
+    bool              sequential,	// I  - Values increase with each glyph?
+    int               glyph,		// I  - Glyph
+    int               value,		// I  - Value for glyph
+    ttf_glyph_range_t *ranges,		// I  - Ranges
+    size_t            max_ranges,	// I  - Maximum number of ranges
+    size_t            *num_ranges)	// IO - Number of ranges
+{
+  if (*num_ranges > 0 && current->last == (glyph - 1) && (sequential ? (current->value + glyph - current->first == value && (glyph & 255) && (value & 255)) : current->value == value))
+  {
+    // Extend the current range...
+    current->last = glyph;
+  }
+  else
+  {
+    // Start a new range...
+    current->first = current->last = glyph;
+    current->value = value;
+
+    (*num_ranges) ++;
+  }
+
+  if (*num_ranges <= max_ranges)
+    ranges[*num_ranges - 1] = *current;
+}
+
+
+//
+// 'add_kern_class()' - Add a class-based kerning subtable.
+//
+// The left classes are initialized to `0xffff` (not covered), and the right
+// classes and adjustments are initialized to 0.
+//
+
+static _ttf_kern_class_t *		// O - New subtable or `NULL` on error
+add_kern_class(
+    ttf_t    *font,			// I - Font
+    unsigned first_left,		// I - First left glyph
+    unsigned num_left,			// I - Number of left glyphs
+    unsigned first_right,		// I - First right glyph
+    unsigned num_right,			// I - Number of right glyphs
+    unsigned num_left_classes,		// I - Number of left classes
+    unsigned num_right_classes)		// I - Number of right classes
+{
+  _ttf_kern_class_t *kc;		// New subtable
+  size_t	count;			// Number of class and adjustment values
+
+
+  if ((kc = (_ttf_kern_class_t *)realloc(font->kern_classes, (font->num_kern_classes + 1) * sizeof(_ttf_kern_class_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for kerning classes.");
+    return (NULL);
+  }
+
+  font->kern_classes = kc;
+  kc                 += font->num_kern_classes;
+
+  // Allocate the class arrays and adjustment matrix together...
+  count = num_left + num_right + (size_t)num_left_classes * num_right_classes;
+
+  if ((kc->left_classes = (unsigned short *)calloc(count, sizeof(unsigned short))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for kerning classes.");
+    return (NULL);
+  }
+
+  font->num_kern_classes ++;
+
+  memset(kc->left_classes, 0xff, num_left * sizeof(unsigned short));
+
+  kc->first_left        = first_left;
+  kc->num_left          = num_left;
+  kc->first_right       = first_right;
+  kc->num_right         = num_right;
+  kc->num_right_classes = num_right_classes;
+  kc->right_classes     = kc->left_classes + num_left;
+  kc->values            = (short *)(kc->right_classes + num_right);
+
+  return (kc);
+}
+
+
+//
+// 'add_kerning()' - Add kerning pairs to the merged kerning pairs.
+//
+// If "pairs" is `NULL`, the new pairs are left for the caller to fill in.
+//
+
+static unsigned char *			// O - First new pair or `NULL` on error
+add_kerning(ttf_t               *font,	// I - Font
+            const unsigned char *pairs,	// I - Big-endian kerning pairs or `NULL`
+            size_t              num_pairs)
+					// I - Number of kerning pairs
+{
+  unsigned char	*buffer;		// Merged kerning pairs
+
+
+  if ((font->num_kerning + num_pairs) > TTF_FONT_MAX_KERNING)
+  {
+    TTF_DEBUG("add_kerning: Too many pairs (%u) in font, returning NULL.\n", (unsigned)(font->num_kerning + num_pairs));
+    _ttfError(font, "Too many kerning pairs in font.");
+    return (NULL);
+  }
+
+  if ((buffer = (unsigned char *)realloc(font->kerning_buffer, (font->num_kerning + num_pairs) * TTF_KERNING_SIZE)) == NULL)
+  {
+    TTF_DEBUG("add_kerning: Unable to allocate memory for %u kerning pairs, returning NULL.\n", (unsigned)num_pairs);
+    _ttfError(font, "Unable to allocate memory for %u kerning pairs.", (unsigned)num_pairs);
+    return (NULL);
+  }
+
+  font->kerning_buffer = buffer;
+  buffer               += font->num_kerning * TTF_KERNING_SIZE;
+  font->num_kerning    += num_pairs;
+
+  if (pairs)
+    memcpy(buffer, pairs, num_pairs * TTF_KERNING_SIZE);
+
+  return (buffer);
+}
+
+
+//
+// 'add_ligature()' - Add a ligature to the ligature trie.
+//
+// The first ligature added for a sequence of glyphs wins, matching the order
+// of ligatures in a GSUB ligature set.
+//
+
+static bool				// O - `true` on success, `false` on error
+add_ligature(
+    ttf_t               *font,		// I - Font
+    unsigned            first,		// I - First glyph
+    const unsigned char *components,	// I - Remaining big-endian component glyphs
+    unsigned            num_components,	// I - Number of remaining components
+    unsigned            ligature)	// I - Ligature glyph
+{
+  unsigned	i,			// Looping var
+		glyph,			// Current component glyph
+		parent = 0,		// Parent node or 0 for the first glyph
+		node,			// Current node
+		last;			// Last node for this component
+  _ttf_liga_t	*liga;			// New ligature nodes
+
+
+  if (first >= font->num_glyphs || num_components == 0)
+    return (true);
+
+  for (i = 0; i < num_components; i ++)
+  {
+    glyph = TTF_GET_USHORT(components + 2 * i);
+
+    // Look for an existing node for this component...
+    node = parent ? font->liga[parent].children : font->liga_index[first];
+    last = 0;
+
+    while (node && font->liga[node].glyph != glyph)
+    {
+      last = node;
+      node = font->liga[node].next;
+    }
+
+    if (!node)
+    {
+      // Add a new node, skipping node 0 which means "none"...
+      if (font->num_liga >= font->alloc_liga)
+      {
+        if ((liga = (_ttf_liga_t *)realloc(font->liga, (font->alloc_liga + 256) * sizeof(_ttf_liga_t))) == NULL)
+        {
+          _ttfError(font, "Unable to allocate memory for ligatures.");
+          return (false);
+        }
+
+        font->liga       = liga;
+        font->alloc_liga += 256;
+
+        if (font->num_liga == 0)
+          font->num_liga = 1;
+      }
+
+      node = (unsigned)font->num_liga ++;
+
+      memset(font->liga + node, 0, sizeof(_ttf_liga_t));
+      font->liga[node].glyph = (unsigned short)glyph;
+
+      if (last)
+        font->liga[last].next = node;
+      else if (parent)
+        font->liga[parent].children = node;
+      else
+        font->liga_index[first] = node;
+    }
+
+    parent = node;
+  }
+
+  if (!font->liga[parent].ligature)
+    font->liga[parent].ligature = (unsigned short)ligature;
+
+  return (true);
+}
+
+
+//
+// 'bounds_cb()' - Add an outline segment to a bounding box.
+//
+// The extrema of quadratic and cubic curves are computed so that the bounding
+// box is tight.
+//
+
+static void
+bounds_cb(void           *data,		// I - Outline bounds state
+          _ttf_outline_t op,		// I - Outline operation
+          const float    *points)	// I - Points
+{
+  _ttf_outline_bounds_t	*ob = (_ttf_outline_bounds_t *)data;
+					// Outline bounds state
+  int			i,		// Looping var
+			axis;		// Current axis (0 = X, 1 = Y)
+  float			p0, p1, p2, p3,	// Control values for axis
+			a, b, c,	// Quadratic coefficients of derivative
+			d,		// Discriminant
+			t[2],		// Roots
+			mt,		// 1 - t
+			v,		// Value at root
+			*vmin,		// Minimum for axis
+			*vmax;		// Maximum for axis
+
+
+  switch (op)
+  {
+    case _TTF_OUTLINE_MOVE :
+    case _TTF_OUTLINE_LINE :
+        ob->x = points[0];
+        ob->y = points[1];
+        break;
+
+    case _TTF_OUTLINE_QUAD :
+        // Check the extremum of the curve, where the derivative is 0...
+        for (axis = 0; axis < 2 && !ob->empty; axis ++)
+        {
+          p0   = axis ? ob->y : ob->x;
+          p1   = points[axis];
+          p2   = points[2 + axis];
+          vmin = axis ? &ob->y_min : &ob->x_min;
+          vmax = axis ? &ob->y_max : &ob->x_max;
+
+          if (fabsf(b = p0 - 2.0f * p1 + p2) < 0.0001f || (t[0] = (p0 - p1) / b) <= 0.0f || t[0] >= 1.0f)
+            continue;
+
+          mt = 1.0f - t[0];
+          v  = mt * mt * p0 + 2.0f * mt * t[0] * p1 + t[0] * t[0] * p2;
+
+          if (v < *vmin)
+            *vmin = v;
+          if (v > *vmax)
+            *vmax = v;
+        }
+
+        ob->x = points[2];
+        ob->y = points[3];
+        break;
+
+    case _TTF_OUTLINE_CUBIC :
+        // Check the extrema of the curve, where the derivative is 0...
+        for (axis = 0; axis < 2; axis ++)
+        {
+          p0   = axis ? ob->y : ob->x;
+          p1   = points[axis];
+          p2   = points[2 + axis];
+          p3   = points[4 + axis];
+          vmin = axis ? &ob->y_min : &ob->x_min;
+          vmax = axis ? &ob->y_max : &ob->x_max;
+
+          a = -p0 + 3.0f * p1 - 3.0f * p2 + p3;
+          b = 2.0f * (p0 - 2.0f * p1 + p2);
+          c = p1 - p0;
+
+          if (fabsf(a) < 0.0001f)
+          {
+            t[0] = fabsf(b) < 0.0001f ? -1.0f : -c / b;
+            t[1] = -1.0f;
+          }
+          else if ((d = b * b - 4.0f * a * c) >= 0.0f)
+          {
+            t[0] = (-b + sqrtf(d)) / (2.0f * a);
+            t[1] = (-b - sqrtf(d)) / (2.0f * a);
+          }
+          else
+          {
+            t[0] = t[1] = -1.0f;
+          }
+
+          for (i = 0; i < 2; i ++)
+          {
+            if (t[i] <= 0.0f || t[i] >= 1.0f || ob->empty)
+              continue;
+
+            mt = 1.0f - t[i];
+            v  = mt * mt * mt * p0 + 3.0f * mt * mt * t[i] * p1 + 3.0f * mt * t[i] * t[i] * p2 + t[i] * t[i] * t[i] * p3;
+
+            if (v < *vmin)
+              *vmin = v;
+            if (v > *vmax)
+              *vmax = v;
+          }
+        }
+
+        ob->x = points[4];
+        ob->y = points[5];
+        break;
+
+    default :
+        return;
+  }
+
+  // Add the end point...
+  if (ob->empty)
+  {
+    ob->x_min = ob->x_max = ob->x;
+    ob->y_min = ob->y_max = ob->y;
+    ob->empty = false;
+  }
+  else
+  {
+    if (ob->x < ob->x_min)
+      ob->x_min = ob->x;
+    if (ob->x > ob->x_max)
+      ob->x_max = ob->x;
+    if (ob->y < ob->y_min)
+      ob->y_min = ob->y;
+    if (ob->y > ob->y_max)
+      ob->y_max = ob->y;
+  }
+}
+
+
+//
+// 'compare_kerning()' - Compare two kerning pairs.
+//
+
+static int				// O - Result of comparison
+compare_kerning(const unsigned char *a,	// I - First pair
+                const unsigned char *b)	// I - Second pair
+{
+  // Big-endian left and right glyphs sort the same as bytes...
+  return (memcmp(a, b, 4));
+}
+
+
+//
+// 'compare_kerning_order()' - Compare two kerning pairs and their order.
+//
+
+static int				// O - Result of comparison
+compare_kerning_order(
+    const unsigned char *a,		// I - First pair
+    const unsigned char *b)		// I - Second pair
+{
+  // Big-endian glyphs and order sort the same as bytes...
+  return (memcmp(a, b, 8));
+}
+
+
+//
+// 'create_font()' - Create a font object from the file or data.
+//
+
+static ttf_t *
+create_font(const char   *filename,	// I - Filename or `NULL`
+            const void   *data,		// I - Data pointer or `NULL`
+            size_t       datasize,	// I - Size of data or 0
+            size_t       idx,		// I - Font index
+            ttf_err_cb_t err_cb,	// I - Error callback function
+            void         *err_cbdata)	// I - Error callback data
+{
+  ttf_t			*font = NULL;	// New font object
+  size_t		i;		// Looping var
+  int			fd;		// File descriptor
+  struct stat		fileinfo;	// File information
+  ssize_t		bytes;		// Bytes read
+#ifdef _WIN32
+  HANDLE		mapping;	// File mapping
+#endif // _WIN32
+  int			num_glyphs;	// Number of glyphs
+  _ttf_metric_t		*widths = NULL;	// Glyph metrics
+  _ttf_off_head_t	head;		// head table
+  _ttf_off_hhea_t	hhea;		// hhea table
+  _ttf_off_os_2_t	os_2;		// OS/2 table
+  _ttf_off_post_t	post;		// PostScript table
+  _ttf_metric_t		defWidth;	// Default glyph width
+
+
+  TTF_DEBUG("create_font(filename=\"%s\", data=%p, datasize=%lu, idx=%u, err_cb=%p, err_cbdata=%p)\n", filename ? filename : "(null)", data, (unsigned long)datasize, (unsigned)idx, (void *)err_cb, err_cbdata);
+
+  // Allocate memory...
+  if ((font = (ttf_t *)calloc(1, sizeof(ttf_t))) == NULL)
+    return (NULL);
+
+  font->idx      = idx;
+  font->err_cb   = err_cb;
+  font->err_cbdata = err_cbdata;
+
+  _ttfMutexInit(&font->lock);
+
+  if (filename)
+  {
+    // Open the font file...
+    if ((fd = open(filename, O_RDONLY | O_BINARY)) < 0)
+    {
+      _ttfError(font, "Unable to open '%s': %s", filename, strerror(errno));
+      goto error;
+    }
+
+    TTF_DEBUG("create_font: fd=%d\n", fd);
+
+    if (fstat(fd, &fileinfo) || fileinfo.st_size <= 0)
+    {
+      _ttfError(font, "Unable to get size of '%s': %s", filename, strerror(errno));
+      close(fd);
+      goto error;
+    }
+
+    font->data_size = (size_t)fileinfo.st_size;
+
+    // Map the file into memory so that tables can be used in place...
+#ifdef _WIN32
+    if ((mapping = CreateFileMapping((HANDLE)_get_osfhandle(fd), NULL, PAGE_READONLY, 0, 0, NULL)) != NULL)
+    {
+      font->file_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+    }
+#else
+    if ((font->file_data = mmap(NULL, font->data_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+      font->file_data = NULL;
+#endif // _WIN32
+
+    if (font->file_data)
+    {
+      font->file_mapped = true;
+    }
+    else if ((font->file_data = malloc(font->data_size)) != NULL)
+    {
+      // Unable to map the file, read it instead...
+      for (i = 0; i < font->data_size; i += (size_t)bytes)
+      {
+        if ((bytes = read(fd, (char *)font->file_data + i, font->data_size - i)) <= 0)
+        {
+          _ttfError(font, "Unable to read '%s': %s", filename, bytes < 0 ? strerror(errno) : "Short read");
+          close(fd);
+          goto error;
+        }
+      }
+    }
+    else
+    {
+      _ttfError(font, "Unable to allocate memory for '%s'.", filename);
+      close(fd);
+      goto error;
+    }
+
+    close(fd);
+
+    TTF_DEBUG("create_font: file_data=%p, file_mapped=%s\n", font->file_data, font->file_mapped ? "true" : "false");
+
+    font->data = (const char *)font->file_data;
+  }
+  else
+  {
+    // Read from memory...
+    font->data      = (const char *)data;
+    font->data_size = datasize;
+  }
+
+  font->read_cb = mem_read_cb;
+  font->seek_cb = mem_seek_cb;
+
+  // Read the table of contents and the identifying names...
+  if (!read_table(font))
+    goto error;
+
+  TTF_DEBUG("create_font: num_entries=%d\n", font->table.num_entries);
+
+  if (!read_names(font))
+    goto error;
+
+  TTF_DEBUG("create_font: num_names=%d\n", font->names.num_names);
+
+  // Copy key font meta data strings...
+  font->copyright       = _ttfCopyName(font, TTF_OFF_Copyright);
+  font->family          = _ttfCopyName(font, TTF_OFF_FontFamily);
+  font->postscript_name = _ttfCopyName(font, TTF_OFF_PostScriptName);
+  font->version         = _ttfCopyName(font, TTF_OFF_FontVersion);
+
+  if (read_post(font, &post))
+  {
+    font->italic_angle = post.italicAngle;
+    font->is_fixed     = post.isFixedPitch != 0;
+  }
+
+  TTF_DEBUG("create_font: copyright=\"%s\"\n", font->copyright);
+  TTF_DEBUG("create_font: family=\"%s\"\n", font->family);
+  TTF_DEBUG("create_font: postscript_name=\"%s\"\n", font->postscript_name);
+  TTF_DEBUG("create_font: version=\"%s\"\n", font->version);
+  TTF_DEBUG("create_font: italic_angle=%g\n", font->italic_angle);
+  TTF_DEBUG("create_font: is_fixed=%s\n", font->is_fixed ? "true" : "false");
+
+  if (!read_cmap(font))
+    goto error;
+
+  if (!read_head(font, &head))
+    goto error;
+
+  font->units = (float)head.unitsPerEm;
+  font->x_max = head.xMax;
+  font->x_min = head.xMin;
+  font->y_max = head.yMax;
+  font->y_min = head.yMin;
+
+  if (head.macStyle & TTF_OFF_macStyle_Italic)
+  {
+    if (font->postscript_name && strstr(font->postscript_name, "Oblique"))
+      font->style = TTF_STYLE_OBLIQUE;
+    else
+      font->style = TTF_STYLE_ITALIC;
+  }
+  else
+    font->style = TTF_STYLE_NORMAL;
+
+  if (!read_hhea(font, &hhea))
+    goto error;
+
+  font->ascent        = hhea.ascender;
+  font->descent       = hhea.descender;
+  font->line_gap      = hhea.lineGap;
+  font->typo_ascent   = hhea.ascender;
+  font->typo_descent  = hhea.descender;
+  font->typo_line_gap = hhea.lineGap;
+
+  if ((num_glyphs = read_maxp(font)) < 0)
+    goto error;
+
+  font->num_glyphs = (size_t)num_glyphs;
+
+  if (hhea.numberOfHMetrics > 0)
+  {
+    if ((widths = read_hmtx(font, &hhea)) == NULL)
+      goto error;
+  }
+
+  if (read_os_2(font, &os_2))
+  {
+    // Copy key values from OS/2 table...
+    static const ttf_stretch_t stretches[] =
+    {
+      TTF_STRETCH_ULTRA_CONDENSED,	// ultra-condensed
+      TTF_STRETCH_EXTRA_CONDENSED,	// extra-condensed
+      TTF_STRETCH_CONDENSED,		// condensed
+      TTF_STRETCH_SEMI_CONDENSED,	// semi-condensed
+      TTF_STRETCH_NORMAL,		// normal
+      TTF_STRETCH_SEMI_EXPANDED,	// semi-expanded
+      TTF_STRETCH_EXPANDED,		// expanded
+      TTF_STRETCH_EXTRA_EXPANDED,	// extra-expanded
+      TTF_STRETCH_ULTRA_EXPANDED	// ultra-expanded
+    };
+
+    if (os_2.usWidthClass >= 1 && os_2.usWidthClass <= (int)(sizeof(stretches) / sizeof(stretches[0])))
+      font->stretch = stretches[os_2.usWidthClass - 1];
+
+    if (os_2.usWeightClass < 100 || os_2.usWeightClass > 900)
+      font->weight = 400;
+    else
+      font->weight = (short)os_2.usWeightClass;
+
+    font->cap_height = os_2.sCapHeight;
+    font->x_height   = os_2.sxHeight;
+
+    if (os_2.sTypoAscender || os_2.sTypoDescender)
+    {
+      font->typo_ascent   = os_2.sTypoAscender;
+      font->typo_descent  = os_2.sTypoDescender;
+      font->typo_line_gap = os_2.sTypoLineGap;
+      font->use_typo      = (os_2.fsSelection & 0x80) != 0;
+    }
+  }
+  else
+  {
+    // Default key values since there isn't an OS/2 table...
+    TTF_DEBUG("create_font: Unable to read OS/2 table.\n");
+
+    font->weight = 400;
+  }
+
+  if (font->cap_height == 0)
+    font->cap_height = font->ascent;
+
+  if (font->x_height == 0)
+    font->x_height = 3 * font->ascent / 5;
+
+  // Build a sparse glyph widths table...
+  font->min_char = -1;
+
+  if (hhea.numberOfHMetrics == 0)
+  {
+    // Default width is computed from the head/bhed information...
+    defWidth.width        = head.xMax - head.xMin;
+    defWidth.left_bearing = head.xMin;
+  }
+  else
+  {
+    // Default width is the last one...
+    defWidth = widths[hhea.numberOfHMetrics - 1];
+  }
+
+  for (i = 0; i < font->num_cmap; i ++)
+  {
+    if (font->cmap[i] >= 0)
+    {
+      int	bin = (int)i / 256,	// Sub-array bin
+		glyph = font->cmap[i];	// Glyph index
+
+      // Update min/max...
+      if (font->min_char < 0)
+        font->min_char = (int)i;
+
+      font->max_char = (int)i;
+
+      // Allocate a sub-array as needed...
+      if (!font->widths[bin])
+        font->widths[bin] = (_ttf_metric_t *)calloc(256, sizeof(_ttf_metric_t));
+
+      // Copy the width of the specified glyph or the default one if we are past
+      // the end of the table...
+      if (glyph >= hhea.numberOfHMetrics)
+	font->widths[bin][i & 255] = defWidth;
+      else
+	font->widths[bin][i & 255] = widths[glyph];
+    }
+
+#if DEBUG > 1
+    if (i >= ' ' && i < 127 && font->widths[0])
+      TTF_DEBUG("create_font: width['%c']=%d(%d)\n", (char)i, font->widths[0][i].width, font->widths[0][i].left_bearing);
+#endif // DEBUG > 1
+  }
+
+  if (font->is_fixed && font->widths[0])
+  {
+    // Use a fast path for printable ASCII if those characters all have the
+    // same width...
+    for (i = ' '; i < 0x7f; i ++)
+    {
+      if (i >= font->num_cmap || font->cmap[i] < 0 || font->widths[0][i].width != font->widths[0][' '].width)
+        break;
+    }
+
+    if (i == 0x7f)
+      font->fixed_width = font->widths[0][' '].width;
+  }
+
+  // Keep the glyph metrics for glyph-based measurement...
+  font->glyph_widths     = widths;
+  font->num_glyph_widths = widths ? hhea.numberOfHMetrics : 0;
+  font->def_width        = defWidth;
+  widths                 = NULL;
+
+  // Read any kerning tables...
+  if (!read_kern(font))
+    goto error;
+
+  // Return the font...
+  return (font);
+
+  // If we get here something bad happened...
+  error:
+
+  free(widths);
+  ttfDelete(font);
+
+  return (NULL);
+}
+
+
+//
+// 'find_extents()' - Find a string in the extents cache.
+//
+// The "cached" argument is initialized with the search key.  If the string
+// cannot be cached, the string in "cached" is set to "".  Kerned extents with
+// more than "max_adjs" kerning adjustments are not used and count as a miss.
+//
+
+static bool				// O - `true` if found, `false` otherwise
+find_extents(ttf_t          *font,	// I - Font
+             const char     *s,		// I - String
+             bool           kerned,	// I - Kerned extents?
+             size_t         max_adjs,	// I - Maximum number of kerning adjustments
+             _ttf_extents_t *cached)	// O - Cached extents
+{
+  size_t		len = 0;	// Length of string
+  unsigned		hash = 2166136261U;
+					// FNV-1a hash of string
+  const unsigned char	*sptr;		// Pointer into string
+  _ttf_extents_shard_t	*shard;		// Shard for this string
+  _ttf_extents_t	*entry;		// Cache entry for this string
+  bool			found;		// Found in cache?
+
+
+  // Hash the string...
+  for (sptr = (const unsigned char *)s; *sptr && len < TTF_EXTENTS_MAX_LEN; sptr ++, len ++)
+    hash = (hash ^ *sptr) * 16777619U;
+
+  if (kerned)
+    hash = (hash ^ 255) * 16777619U;	// Keep kerned and unkerned extents apart
+
+  shard = font->extents + (hash % TTF_EXTENTS_SHARDS);
+
+  if (len == 0 || len >= TTF_EXTENTS_MAX_LEN)
+  {
+    // Empty or long string, don't cache...
+    cached->s[0] = '\0';
+
+    _ttfMutexLock(&shard->mutex);
+    shard->misses ++;
+    _ttfMutexUnlock(&shard->mutex);
+
+    return (false);
+  }
+
+  cached->hash   = hash;
+  cached->kerned = kerned;
+  memcpy(cached->s, s, len + 1);
+
+  // Look it up...
+  entry = shard->entries + (hash / TTF_EXTENTS_SHARDS) % shard->num_entries;
+
+  _ttfMutexLock(&shard->mutex);
+
+  if ((found = entry->hash == hash && entry->kerned == kerned && (!kerned || entry->num_adjs <= max_adjs) && !strcmp(entry->s, s)) == true)
+  {
+    memcpy(cached, entry, sizeof(_ttf_extents_t));
+    shard->hits ++;
+  }
+  else
+  {
+    shard->misses ++;
+  }
+
+  _ttfMutexUnlock(&shard->mutex);
+
+  return (found);
+}
+
+
+//
+// 'free_extents()' - Free the extents cache.
+//
+
+static void
+free_extents(ttf_t *font)		// I - Font
+{
+  size_t		i;		// Looping var
+  _ttf_extents_shard_t	*shard;		// Current shard
+
+
+  if (!font->extents)
+    return;
+
+  for (i = 0, shard = font->extents; i < TTF_EXTENTS_SHARDS; i ++, shard ++)
+  {
+    _ttfMutexDestroy(&shard->mutex);
+    free(shard->entries);
+  }
+
+  free(font->extents);
+  font->extents = NULL;
+}
+
+
+//
+// 'get_glyph_bounds()' - Get the bounding box of a glyph.
+//
+// The bounding box is read from the "glyf" table or computed from the CFF
+// outline the first time a glyph is used.  Once loaded, the bounds are used
+// without locking the font.
+//
+
+static const _ttf_bounds_t *		// O - Glyph bounds or `NULL` if invalid
+get_glyph_bounds(ttf_t *font,		// I - Font
+                 int   glyph)		// I - Glyph index
+{
+  _ttf_bounds_t		*bounds;	// Glyph bounds
+  const unsigned char	*data;		// Glyph data
+  size_t		bytes;		// Size of glyph data
+  _ttf_outline_bounds_t	ob;		// Outline bounds state
+
+
+  if (glyph < 0 || (size_t)glyph >= font->num_glyphs)
+    return (NULL);
+
+  // Use the bounds without locking if the glyph has already been loaded...
+  if ((bounds = (_ttf_bounds_t *)_ttfAtomicGetPtr(&font->glyph_bounds)) != NULL && (_ttfAtomicGetByte(font->glyph_bounds_loaded + glyph / 8) & (1 << (glyph & 7))))
+    return (bounds + glyph);
+
+  _ttfMutexLock(&font->lock);
+
+  if ((bounds = font->glyph_bounds) == NULL)
+  {
+    // Allocate the bounds and loaded bitset together...
+    if ((bounds = (_ttf_bounds_t *)calloc(1, font->num_glyphs * sizeof(_ttf_bounds_t) + font->num_glyphs / 8 + 1)) == NULL)
+    {
+      _ttfMutexUnlock(&font->lock);
+      return (NULL);
+    }
+
+    font->glyph_bounds_loaded = (unsigned char *)(bounds + font->num_glyphs);
+
+    _ttfAtomicSetPtr(&font->glyph_bounds, bounds);
+  }
+
+  bounds += glyph;
 
-      *tempptr = '\0';
+  if (font->glyph_bounds_loaded[glyph / 8] & (1 << (glyph & 7)))
+  {
+    // Another thread loaded the bounds...
+    _ttfMutexUnlock(&font->lock);
+    return (bounds);
+  }
 
-      TTF_DEBUG("copy_name: name_id(%d) = \"%s\"\n", name_id, temp);
+  // Start with an empty box...
+  bounds->x_min = bounds->y_min = 1;
+  bounds->x_max = bounds->y_max = 0;
 
-      return (strdup(temp));
+  if ((data = _ttfGetGlyphData(font, (unsigned)glyph, &bytes)) != NULL)
+  {
+    // glyf: numberOfContours, xMin, yMin, xMax, yMax
+    if (bytes >= 10)
+    {
+      bounds->x_min = TTF_GET_SHORT(data + 2);
+      bounds->y_min = TTF_GET_SHORT(data + 4);
+      bounds->x_max = TTF_GET_SHORT(data + 6);
+      bounds->y_max = TTF_GET_SHORT(data + 8);
     }
   }
-
-  TTF_DEBUG("copy_name: No English name string for %d.\n", name_id);
-#ifdef DEBUG
-  for (i = font->names.num_names, name = font->names.names; i > 0; i --, name ++)
+  else
   {
-    if (name->name_id == name_id)
-      TTF_DEBUG("copy_name: Found name_id=%d, platform_id=%d, language_id=%d(0x%04x)\n", name_id, name->platform_id, name->language_id, name->language_id);
+    // CFF: compute the bounds from the outline...
+    if (!font->cff_loaded)
+    {
+      font->cff        = _ttfCFFCreate(font);
+      font->cff_loaded = true;
+    }
+
+    memset(&ob, 0, sizeof(ob));
+    ob.empty = true;
+
+    if (font->cff && _ttfCFFGetOutline(font->cff, (unsigned)glyph, bounds_cb, &ob) && !ob.empty)
+    {
+      bounds->x_min = (short)floorf(ob.x_min);
+      bounds->y_min = (short)floorf(ob.y_min);
+      bounds->x_max = (short)ceilf(ob.x_max);
+      bounds->y_max = (short)ceilf(ob.y_max);
+    }
   }
-#endif // DEBUG
 
-  return (NULL);
+  _ttfAtomicOrByte(font->glyph_bounds_loaded + glyph / 8, (unsigned char)(1 << (glyph & 7)));
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (bounds);
 }
 
 
 //
-// 'create_font()' - Create a font object from the file or data.
+// 'get_glyph_metric()' - Get the metrics for a glyph.
 //
 
-static ttf_t *
-create_font(const char   *filename,	// I - Filename or `NULL`
-            const void   *data,		// I - Data pointer or `NULL`
-            size_t       datasize,	// I - Size of data or 0
-            size_t       idx,		// I - Font index
-            ttf_err_cb_t err_cb,	// I - Error callback function
-            void         *err_cbdata)	// I - Error callback data
+static _ttf_metric_t *			// O - Glyph metrics or `NULL` if invalid
+get_glyph_metric(ttf_t *font,		// I - Font
+                 int   glyph)		// I - Glyph index
 {
-  ttf_t			*font = NULL;	// New font object
-  size_t		i;		// Looping var
-  _ttf_metric_t		*widths = NULL;	// Glyph metrics
-  _ttf_off_head_t	head;		// head table
-  _ttf_off_hhea_t	hhea;		// hhea table
-  _ttf_off_os_2_t	os_2;		// OS/2 table
-  _ttf_off_post_t	post;		// PostScript table
-  _ttf_metric_t		defWidth;	// Default glyph width
+  if (!font || glyph < 0 || (size_t)glyph >= font->num_glyphs)
+    return (NULL);
+  else if ((size_t)glyph < font->num_glyph_widths)
+    return (font->glyph_widths + glyph);
+  else
+    return (&font->def_width);
+}
 
 
-  TTF_DEBUG("create_font(filename=\"%s\", data=%p, datasize=%lu, idx=%u, err_cb=%p, err_cbdata=%p)\n", filename ? filename : "(null)", data, (unsigned long)datasize, (unsigned)idx, (void *)err_cb, err_cbdata);
+//
+// 'get_vertical_metric()' - Get the vertical metrics for a glyph.
+//
+// The vertical metrics must already be loaded with `load_vertical()`.
+//
 
-  // Allocate memory...
-  if ((font = (ttf_t *)calloc(1, sizeof(ttf_t))) == NULL)
+static const _ttf_metric_t *		// O - Vertical metrics or `NULL`
+get_vertical_metric(ttf_t *font,	// I - Font
+                    int   glyph)	// I - Glyph index
+{
+  if (glyph < 0 || (size_t)glyph >= font->num_glyphs)
     return (NULL);
+  else if ((size_t)glyph < font->num_vert_metrics)
+    return (font->vert_metrics + glyph);
+  else
+    return (&font->def_vert_metric);
+}
 
-  font->idx      = idx;
-  font->err_cb   = err_cb;
-  font->err_cbdata = err_cbdata;
 
-  if (filename)
+//
+// 'get_ligature()' - Get the ligature starting with a glyph.
+//
+// The longest matching ligature is used.  If found, the string pointer is
+// advanced past the remaining components of the ligature.
+//
+
+static int				// O - Ligature glyph or 0 if none
+get_ligature(ttf_t      *font,		// I - Font
+             int        glyph,		// I - First glyph
+             const char **s)		// IO - Pointer to next character in string
+{
+  int		ch,			// Next character
+		ligature = 0;		// Ligature glyph
+  unsigned	node,			// Current node
+		next;			// Next component glyph
+  const char	*sptr = *s;		// Pointer into string
+
+
+  if (glyph < 0 || (size_t)glyph >= font->num_glyphs || (node = font->liga_index[glyph]) == 0)
+    return (0);
+
+  // Look ahead without reporting invalid UTF-8, which the caller will do...
+  while (node && (ch = next_unicode(&sptr)) > 0)
   {
-    // Open the font file...
-    if ((font->file_fd = open(filename, O_RDONLY | O_BINARY)) < 0)
+    next = ch < (int)font->num_cmap && font->cmap[ch] > 0 ? (unsigned)font->cmap[ch] : 0;
+
+    while (node && font->liga[node].glyph != next)
+      node = font->liga[node].next;
+
+    if (node)
     {
-      errorf(font, "Unable to open '%s': %s", filename, strerror(errno));
-      goto error;
+      if (font->liga[node].ligature)
+      {
+        ligature = font->liga[node].ligature;
+        *s       = sptr;
+      }
+
+      node = font->liga[node].children;
     }
+  }
+
+  return (ligature);
+}
 
-    TTF_DEBUG("create_font: file_fd=%d\n", font->file_fd);
 
-    font->read_cb   = fd_read_cb;
-    font->seek_cb   = fd_seek_cb;
-  }
-  else
+//
+// 'get_pixel()' - Get the device metrics for a pixel size.
+//
+// The "hdmx" widths are used in place and the "VDMX" bounds for a 1:1 aspect
+// ratio are copied the first time a pixel size is used.
+//
+
+static const _ttf_pixel_t *		// O - Device metrics or `NULL` if none
+get_pixel(ttf_t *font,			// I - Font
+          int   ppem)			// I - Pixels per em
+{
+  _ttf_pixel_t	*pixels,		// Device metrics for each pixel size
+		*pixel;			// Device metrics
+  const unsigned char *table,		// Table data
+		*ratio,			// VDMX ratio range
+		*group;			// VDMX group
+  size_t	length,			// Length of table
+		offset;			// Offset in table
+  unsigned	i,			// Looping var
+		count,			// Number of records
+		size;			// Size of record
+
+
+  if (ppem >= TTF_PIXEL_MAX)
+    return (NULL);
+
+  // Use the metrics without locking once they have been loaded...
+  if ((pixels = (_ttf_pixel_t *)_ttfAtomicGetPtr(&font->pixels)) != NULL && _ttfAtomicGetByte(&pixels[ppem].loaded))
+    return (pixels + ppem);
+
+  _ttfMutexLock(&font->lock);
+
+  if ((pixels = font->pixels) == NULL)
   {
-    // Read from memory...
-    font->file_fd   = -1;
-    font->data      = (const char *)data;
-    font->data_size = datasize;
-    font->read_cb   = mem_read_cb;
-    font->seek_cb   = mem_seek_cb;
+    if ((pixels = (_ttf_pixel_t *)calloc(TTF_PIXEL_MAX, sizeof(_ttf_pixel_t))) == NULL)
+    {
+      _ttfMutexUnlock(&font->lock);
+      return (NULL);
+    }
+
+    _ttfAtomicSetPtr(&font->pixels, pixels);
   }
 
-  // Read the table of contents and the identifying names...
-  if (!read_table(font))
-    goto error;
+  pixel = pixels + ppem;
 
-  TTF_DEBUG("create_font: num_entries=%d\n", font->table.num_entries);
+  if (!pixel->loaded)
+  {
+    // hdmx: version, numRecords, sizeDeviceRecord, records[numRecords] with
+    // pixelSize, maxWidth, widths[numGlyphs]
+    if ((table = _ttfGetTable(font, TTF_OFF_hdmx, &length)) != NULL && length >= 8 && TTF_GET_USHORT(table) == 0)
+    {
+      count = TTF_GET_USHORT(table + 2);
+      size  = TTF_GET_ULONG(table + 4);
 
-  if (!read_names(font))
-    goto error;
+      if (size >= (font->num_glyphs + 2) && (8 + (size_t)count * size) <= length)
+      {
+        for (i = 0, offset = 8; i < count; i ++, offset += size)
+        {
+          if (table[offset] == ppem)
+          {
+            pixel->widths = table + offset + 2;
+            break;
+          }
+        }
+      }
+    }
 
-  TTF_DEBUG("create_font: num_names=%d\n", font->names.num_names);
+    // VDMX: version, numRecs, numRatios, ratRange[numRatios],
+    // offsets[numRatios] with groups of recs, startsz, endsz, entries[recs]
+    if ((table = _ttfGetTable(font, TTF_OFF_VDMX, &length)) != NULL && length >= 6)
+    {
+      if ((6 + 6 * (size_t)(count = TTF_GET_USHORT(table + 4))) > length)
+        count = 0;
 
-  // Copy key font meta data strings...
-  font->copyright       = copy_name(font, TTF_OFF_Copyright);
-  font->family          = copy_name(font, TTF_OFF_FontFamily);
-  font->postscript_name = copy_name(font, TTF_OFF_PostScriptName);
-  font->version         = copy_name(font, TTF_OFF_FontVersion);
+      for (i = 0; i < count; i ++)
+      {
+        // Use the first ratio that includes 1:1 (xRatio of 0 matches all)...
+        ratio = table + 6 + 4 * i;
 
-  if (read_post(font, &post))
-  {
-    font->italic_angle = post.italicAngle;
-    font->is_fixed     = post.isFixedPitch != 0;
-  }
+        if (ratio[1] && (ratio[2] > ratio[1] || ratio[3] < ratio[1]))
+          continue;
 
-  TTF_DEBUG("create_font: copyright=\"%s\"\n", font->copyright);
-  TTF_DEBUG("create_font: family=\"%s\"\n", font->family);
-  TTF_DEBUG("create_font: postscript_name=\"%s\"\n", font->postscript_name);
-  TTF_DEBUG("create_font: version=\"%s\"\n", font->version);
-  TTF_DEBUG("create_font: italic_angle=%g\n", font->italic_angle);
-  TTF_DEBUG("create_font: is_fixed=%s\n", font->is_fixed ? "true" : "false");
+        if ((offset = TTF_GET_USHORT(table + 6 + 4 * count + 2 * i)) > (length - 4))
+          break;
 
-  if (!read_cmap(font))
-    goto error;
+        group = table + offset;
+        size  = TTF_GET_USHORT(group);
 
-  if (!read_head(font, &head))
-    goto error;
+        if ((offset + 4 + 6 * (size_t)size) > length)
+          break;
 
-  font->units = (float)head.unitsPerEm;
-  font->x_max = head.xMax;
-  font->x_min = head.xMin;
-  font->y_max = head.yMax;
-  font->y_min = head.yMin;
+        for (group += 4; size > 0; size --, group += 6)
+        {
+          if (TTF_GET_USHORT(group) == (unsigned)ppem)
+          {
+            pixel->have_bounds = true;
+            pixel->y_max       = TTF_GET_SHORT(group + 2);
+            pixel->y_min       = TTF_GET_SHORT(group + 4);
+            break;
+          }
+        }
+        break;
+      }
+    }
 
-  if (head.macStyle & TTF_OFF_macStyle_Italic)
-  {
-    if (font->postscript_name && strstr(font->postscript_name, "Oblique"))
-      font->style = TTF_STYLE_OBLIQUE;
-    else
-      font->style = TTF_STYLE_ITALIC;
+    _ttfAtomicOrByte(&pixel->loaded, 1);
   }
-  else
-    font->style = TTF_STYLE_NORMAL;
 
-  if (!read_hhea(font, &hhea))
-    goto error;
+  _ttfMutexUnlock(&font->lock);
 
-  font->ascent  = hhea.ascender;
-  font->descent = hhea.descender;
+  return (pixel);
+}
 
-  if (read_maxp(font) < 0)
-    goto error;
 
-  if (hhea.numberOfHMetrics > 0)
-  {
-    if ((widths = read_hmtx(font, &hhea)) == NULL)
-      goto error;
-  }
+//
+// 'get_range()' - Get a range of glyphs from an OpenType Coverage or ClassDef table.
+//
+// For Coverage tables the value is the coverage index of the first glyph in
+// the range.  For ClassDef tables the value is the class of the glyphs in the
+// range.
+//
 
-  if (read_os_2(font, &os_2))
-  {
-    // Copy key values from OS/2 table...
-    static const ttf_stretch_t stretches[] =
-    {
-      TTF_STRETCH_ULTRA_CONDENSED,	// ultra-condensed
-      TTF_STRETCH_EXTRA_CONDENSED,	// extra-condensed
-      TTF_STRETCH_CONDENSED,		// condensed
-      TTF_STRETCH_SEMI_CONDENSED,	// semi-condensed
-      TTF_STRETCH_NORMAL,		// normal
-      TTF_STRETCH_SEMI_EXPANDED,	// semi-expanded
-      TTF_STRETCH_EXPANDED,		// expanded
-      TTF_STRETCH_EXTRA_EXPANDED,	// extra-expanded
-      TTF_STRETCH_ULTRA_EXPANDED	// ultra-expanded
-    };
+static bool				// O - `true` if a range was found, `false` at the end or on error
+get_range(const unsigned char *table,	// I - Coverage or ClassDef table
+          size_t              length,	// I - Length of table data
+          bool                classdef,	// I - ClassDef table?
+          unsigned            n,	// I - Range number (0-based)
+          unsigned            *first,	// O - First glyph in range
+          unsigned            *last,	// O - Last glyph in range
+          unsigned            *value)	// O - Coverage index or class
+{
+  unsigned	format,			// Table format
+		count;			// Number of entries
 
-    if (os_2.usWidthClass >= 1 && os_2.usWidthClass <= (int)(sizeof(stretches) / sizeof(stretches[0])))
-      font->stretch = stretches[os_2.usWidthClass - 1];
 
-    if (os_2.usWeightClass < 100 || os_2.usWeightClass > 900)
-      font->weight = 400;
-    else
-      font->weight = (short)os_2.usWeightClass;
+  if (length < 6)
+    return (false);
 
-    font->cap_height = os_2.sCapHeight;
-    font->x_height   = os_2.sxHeight;
-  }
-  else
+  format = TTF_GET_USHORT(table);
+
+  if (format == 1 && classdef)
   {
-    // Default key values since there isn't an OS/2 table...
-    TTF_DEBUG("create_font: Unable to read OS/2 table.\n");
+    // ClassDef format 1: startGlyphID, glyphCount, classValueArray[glyphCount]
+    count = TTF_GET_USHORT(table + 4);
 
-    font->weight = 400;
+    if (n >= count || (6 + 2 * (size_t)n + 2) > length)
+      return (false);
+
+    *first = *last = TTF_GET_USHORT(table + 2) + n;
+    *value = TTF_GET_USHORT(table + 6 + 2 * n);
   }
+  else if (format == 1)
+  {
+    // Coverage format 1: glyphCount, glyphArray[glyphCount]
+    count = TTF_GET_USHORT(table + 2);
 
-  if (font->cap_height == 0)
-    font->cap_height = font->ascent;
+    if (n >= count || (4 + 2 * (size_t)n + 2) > length)
+      return (false);
 
-  if (font->x_height == 0)
-    font->x_height = 3 * font->ascent / 5;
+    *first = *last = TTF_GET_USHORT(table + 4 + 2 * n);
+    *value = n;
+  }
+  else if (format == 2)
+  {
+    // Coverage and ClassDef format 2: rangeCount, rangeRecords[rangeCount]
+    count = TTF_GET_USHORT(table + 2);
 
-  // Build a sparse glyph widths table...
-  font->min_char = -1;
+    if (n >= count || (4 + 6 * (size_t)n + 6) > length)
+      return (false);
 
-  if (hhea.numberOfHMetrics == 0)
-  {
-    // Default width is computed from the head/bhed information...
-    defWidth.width        = head.xMax - head.xMin;
-    defWidth.left_bearing = head.xMin;
+    *first = TTF_GET_USHORT(table + 4 + 6 * n);
+    *last  = TTF_GET_USHORT(table + 6 + 6 * n);
+    *value = TTF_GET_USHORT(table + 8 + 6 * n);
+
+    if (*last < *first)
+      return (false);
   }
   else
   {
-    // Default width is the last one...
-    defWidth = widths[hhea.numberOfHMetrics - 1];
+    return (false);
   }
 
-  for (i = 0; i < font->num_cmap; i ++)
-  {
-    if (font->cmap[i] >= 0)
-    {
-      int	bin = (int)i / 256,	// Sub-array bin
-		glyph = font->cmap[i];	// Glyph index
+  return (true);
+}
 
-      // Update min/max...
-      if (font->min_char < 0)
-        font->min_char = (int)i;
 
-      font->max_char = (int)i;
+//
+// 'get_unicodes()' - Get the glyph to Unicode map, building it as needed.
+//
 
-      // Allocate a sub-array as needed...
-      if (!font->widths[bin])
-        font->widths[bin] = (_ttf_metric_t *)calloc(256, sizeof(_ttf_metric_t));
+static const int *			// O - Glyph to Unicode map or `NULL` on error
+get_unicodes(ttf_t *font)		// I - Font
+{
+  int	*unicodes;			// Glyph to Unicode map
+  int	ch,				// Current character
+	glyph;				// Current glyph
 
-      // Copy the width of the specified glyph or the default one if we are past
-      // the end of the table...
-      if (glyph >= hhea.numberOfHMetrics)
-	font->widths[bin][i & 255] = defWidth;
-      else
-	font->widths[bin][i & 255] = widths[glyph];
-    }
 
-#if DEBUG > 1
-    if (i >= ' ' && i < 127 && font->widths[0])
-      TTF_DEBUG("create_font: width['%c']=%d(%d)\n", (char)i, font->widths[0][i].width, font->widths[0][i].left_bearing);
-#endif // DEBUG > 1
+  // Use the map without locking once it has been built...
+  if ((unicodes = (int *)_ttfAtomicGetPtr(&font->unicodes)) != NULL)
+    return (unicodes);
+
+  _ttfMutexLock(&font->lock);
+
+  if ((unicodes = font->unicodes) == NULL && font->num_glyphs > 0)
+  {
+    if ((unicodes = (int *)malloc(font->num_glyphs * sizeof(int))) != NULL)
+    {
+      memset(unicodes, -1, font->num_glyphs * sizeof(int));
+
+      // Invert the cmap, keeping the lowest character for each glyph...
+      for (ch = (int)font->num_cmap - 1; ch >= 0; ch --)
+      {
+        if ((glyph = font->cmap[ch]) > 0 && (size_t)glyph < font->num_glyphs)
+          unicodes[glyph] = ch;
+      }
+
+      _ttfAtomicSetPtr(&font->unicodes, unicodes);
+    }
+    else
+    {
+      _ttfError(font, "Unable to allocate memory for Unicode map.");
+    }
   }
 
-  // Read any kerning tables...
-  if (!read_kern(font))
-    goto error;
+  _ttfMutexUnlock(&font->lock);
+
+  return (unicodes);
+}
 
-  // Cleanup and return the font...
-  free(widths);
 
-  return (font);
+//
+// 'get_used()' - Get a bitset of used glyphs.
+//
 
-  // If we get here something bad happened...
-  error:
+static unsigned char *			// O - Bitset of used glyphs or `NULL` on error
+get_used(ttf_t     *font,		// I - Font
+         const int *glyphs,		// I - Used glyphs
+         size_t    num_glyphs)		// I - Number of used glyphs
+{
+  unsigned char	*used;			// Bitset of used glyphs
 
-  free(widths);
-  ttfDelete(font);
 
-  return (NULL);
+  if ((used = (unsigned char *)calloc(font->num_glyphs / 8 + 1, 1)) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for used glyphs.");
+    return (NULL);
+  }
+
+  for (; num_glyphs > 0; num_glyphs --, glyphs ++)
+  {
+    if (*glyphs >= 0 && (size_t)*glyphs < font->num_glyphs)
+      used[*glyphs / 8] |= (unsigned char)(1 << (*glyphs & 7));
+  }
+
+  return (used);
 }
 
 
 //
-// 'errorf()' - Show an error message.
+// 'get_value_size()' - Get the size of an OpenType ValueRecord.
 //
 
-static void
-errorf(ttf_t      *font,		// I - Font
-       const char *message,		// I - `printf`-style message string
-       ...)				// I - Addition arguments as needed
+static unsigned				// O - Size in bytes
+get_value_size(unsigned format)		// I - ValueFormat bits
 {
-  va_list	ap;			// Argument pointer
-  char		buffer[2048];		// Message buffer
+  unsigned	size;			// Size in bytes
 
 
-  // Format the message...
-  va_start(ap, message);
-  vsnprintf(buffer, sizeof(buffer), message, ap);
-  va_end(ap);
+  // Each field (including device table offsets) is 16 bits...
+  for (size = 0, format &= 0xff; format; format >>= 1)
+  {
+    if (format & 1)
+      size += 2;
+  }
 
-  // If an error callback is set, sent the message there.  Otherwise write it
-  // to stderr...
-  if (font && font->err_cb)
-    (font->err_cb)(font->err_cbdata, buffer);
-  else
-    fprintf(stderr, "%s\n", buffer);
+  return (size);
 }
 
 
 //
-// 'fd_read_cb()' - Read from a file.
+// 'load_ligatures()' - Load the ligatures for a font as needed.
 //
 
-static size_t				// O - Number of bytes read
-fd_read_cb(ttf_t  *font,		// I - Font
-           void   *buffer,		// I - Read buffer
-	   size_t bytes)		// I - Number of bytes to read
+static bool				// O - `true` if the font has ligatures, `false` otherwise
+load_ligatures(ttf_t *font)		// I - Font
 {
-  ssize_t	rbytes;			// Bytes read
+  bool	ret;				// Return value
 
 
-  if ((rbytes = read(font->file_fd, buffer, bytes)) < 0)
-    return (0);
+  // Use the ligatures without locking once they have been loaded...
+  if (_ttfAtomicGetByte(&font->ligatures_loaded))
+    return (font->num_liga > 0);
+
+  _ttfMutexLock(&font->lock);
+
+  if (!font->ligatures_loaded)
+  {
+    if (!read_gsub(font))
+    {
+      // Don't use a partial set of ligatures...
+      free(font->liga_index);
+      free(font->liga);
+
+      font->liga_index = NULL;
+      font->liga       = NULL;
+      font->num_liga   = 0;
+      font->alloc_liga = 0;
+    }
+
+    _ttfAtomicOrByte(&font->ligatures_loaded, 1);
+  }
+
+  ret = font->num_liga > 0;
 
-  return ((size_t)rbytes);
+  _ttfMutexUnlock(&font->lock);
+
+  return (ret);
 }
 
 
 //
-// 'fd_seek_cb()' - Seek in a file.
+// 'load_vertical()' - Load the vertical metrics for a font as needed.
+//
+// The "vmtx" advances and top side bearings are expanded to one entry per
+// glyph.  Fonts without vertical metrics use the typographic ascent and
+// descent for every glyph.
 //
 
-static bool				// O - `true` on success, `false` on failure
-fd_seek_cb(ttf_t  *font,		// I - Font
-           size_t offset)		// I - Offset in data
+static bool				// O - `true` if the font has vertical metrics, `false` otherwise
+load_vertical(ttf_t *font)		// I - Font
 {
-  return (lseek(font->file_fd, (off_t)offset, SEEK_SET) == (off_t)offset);
+  bool			ret;		// Return value
+  const unsigned char	*vhea,		// Vertical header table
+			*vmtx,		// Vertical metrics table
+			*vorg;		// Vertical origin table
+  size_t		vhea_length,	// Length of vertical header
+			vmtx_length,	// Length of vertical metrics
+			vorg_length,	// Length of vertical origins
+			i,		// Looping var
+			num_long;	// Number of long vertical metrics
+
+
+  // Use the vertical metrics without locking once they have been loaded...
+  if (_ttfAtomicGetByte(&font->vertical_loaded))
+    return (font->num_vert_metrics > 0);
+
+  _ttfMutexLock(&font->lock);
+
+  if (!font->vertical_loaded)
+  {
+    // Default metrics use the typographic ascent and descent...
+    font->def_vert_metric.width        = (short)(font->typo_ascent - font->typo_descent);
+    font->def_vert_metric.left_bearing = (short)(font->typo_ascent - font->y_max);
+
+    // vhea: version, ascender, descender, lineGap, advanceHeightMax,
+    // minTopSideBearing, minBottomSideBearing, yMaxExtent, caretSlopeRise,
+    // caretSlopeRun, caretOffset, reserved[4], metricDataFormat,
+    // numOfLongVerMetrics
+    if ((vhea = _ttfGetTable(font, TTF_OFF_vhea, &vhea_length)) != NULL && vhea_length >= 36 && (vmtx = _ttfGetTable(font, TTF_OFF_vmtx, &vmtx_length)) != NULL && font->num_glyphs > 0)
+    {
+      num_long = TTF_GET_USHORT(vhea + 34);
+
+      if (num_long == 0 || num_long > font->num_glyphs || vmtx_length < (4 * num_long))
+      {
+        _ttfError(font, "Invalid vmtx table.");
+      }
+      else if ((font->vert_metrics = (_ttf_metric_t *)calloc(font->num_glyphs, sizeof(_ttf_metric_t))) != NULL)
+      {
+        // vmtx: longVerMetric[numOfLongVerMetrics] (advanceHeight,
+        // topSideBearing), then topSideBearing[] for the remaining glyphs
+        for (i = 0; i < font->num_glyphs; i ++)
+        {
+          if (i < num_long)
+          {
+            font->vert_metrics[i].width        = (short)TTF_GET_USHORT(vmtx + 4 * i);
+            font->vert_metrics[i].left_bearing = (short)TTF_GET_USHORT(vmtx + 4 * i + 2);
+          }
+          else
+          {
+            font->vert_metrics[i].width = font->vert_metrics[num_long - 1].width;
+
+            if ((4 * num_long + 2 * (i - num_long + 1)) <= vmtx_length)
+              font->vert_metrics[i].left_bearing = (short)TTF_GET_USHORT(vmtx + 4 * num_long + 2 * (i - num_long));
+          }
+        }
+
+        font->num_vert_metrics = font->num_glyphs;
+      }
+    }
+
+    // VORG: majorVersion, minorVersion, defaultVertOriginY,
+    // numVertOriginYMetrics, vertOriginYMetrics[] (glyphIndex, vertOriginY)
+    if ((vorg = _ttfGetTable(font, TTF_OFF_VORG, &vorg_length)) != NULL && vorg_length >= 8 && TTF_GET_USHORT(vorg) == 1 && (8 + 4 * (size_t)TTF_GET_USHORT(vorg + 6)) <= vorg_length)
+    {
+      font->vorg     = vorg + 8;
+      font->num_vorg = TTF_GET_USHORT(vorg + 6);
+      font->def_vorg = (short)TTF_GET_USHORT(vorg + 4);
+    }
+
+    _ttfAtomicOrByte(&font->vertical_loaded, 1);
+  }
+
+  ret = font->num_vert_metrics > 0;
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (ret);
 }
 
 
@@ -1350,12 +3778,11 @@ mem_seek_cb(ttf_t  *font,		// I - Font
 
 
 //
-// 'next_unicode()' - Get the next Unicode character.
+// 'next_unicode()' - Decode the next UTF-8 character without reporting errors.
 //
 
-static int				// O  - Unicode character or `0` on end of string
-next_unicode(ttf_t      *font,		// I  - Font
-             const char **s)		// IO - Character pointer
+static int				// O  - Unicode character, `0` on end of string, or `-1` if invalid
+next_unicode(const char **s)		// IO - Character pointer
 {
   int		ch;			// Unicode character
   const char	*temp = *s;		// Pointer
@@ -1382,9 +3809,7 @@ next_unicode(ttf_t      *font,		// I  - Font
   else if (temp[0] & 0x80)
   {
     // Invalid UTF-8
-    errorf(font, "Invalid UTF-8 sequence starting with 0x%02X.", temp[0] & 255);
-
-    ch = 0;
+    ch = -1;
     temp ++;
   }
   else
@@ -1466,13 +3891,13 @@ read_cmap(ttf_t *font)			// I - Font
 
   if ((temp = read_ushort(font)) != 0)
   {
-    errorf(font, "Unknown cmap version %d.", temp);
+    _ttfError(font, "Unknown cmap version %d.", temp);
     return (false);
   }
 
   if ((num_tables = read_ushort(font)) < 1)
   {
-    errorf(font, "No cmap tables to read.");
+    _ttfError(font, "No cmap tables to read.");
     return (false);
   }
 
@@ -1528,7 +3953,7 @@ read_cmap(ttf_t *font)			// I - Font
     }
     else
     {
-      errorf(font, "No usable cmap table.");
+      _ttfError(font, "No usable cmap table.");
       return (false);
     }
   }
@@ -1538,7 +3963,7 @@ read_cmap(ttf_t *font)			// I - Font
 
   if ((cformat = read_ushort(font)) < 0)
   {
-    errorf(font, "Unable to read cmap table format at offset %u.", coffset);
+    _ttfError(font, "Unable to read cmap table format at offset %u.", coffset);
     return (false);
   }
 
@@ -1556,7 +3981,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if ((unsigned)read_ushort(font) == (unsigned)-1)
 	  {
-	    errorf(font, "Unable to read cmap format 0 table length at offset %u.", coffset);
+	    _ttfError(font, "Unable to read cmap format 0 table length at offset %u.", coffset);
 	    return (false);
 	  }
 
@@ -1564,7 +3989,7 @@ read_cmap(ttf_t *font)			// I - Font
 
           if (length > (256 + 6) || length < 7)
           {
-	    errorf(font, "Bad cmap format 0 table length %u at offset %u.", length, coffset);
+	    _ttfError(font, "Bad cmap format 0 table length %u at offset %u.", length, coffset);
 	    return (false);
           }
 
@@ -1572,13 +3997,13 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if ((font->cmap = (int *)malloc(font->num_cmap * sizeof(int))) == NULL)
 	  {
-	    errorf(font, "Unable to allocate cmap table.");
+	    _ttfError(font, "Unable to allocate cmap table.");
 	    return (false);
 	  }
 
           if ((font->read_cb)(font, bmap, font->num_cmap) != font->num_cmap)
           {
-	    errorf(font, "Unable to read cmap table length at offset %u.", coffset);
+	    _ttfError(font, "Unable to read cmap table length at offset %u.", coffset);
 	    return (false);
           }
 
@@ -1608,7 +4033,7 @@ read_cmap(ttf_t *font)			// I - Font
           // Read the table...
 	  if ((clength = (unsigned)read_ushort(font)) == (unsigned)-1)
 	  {
-	    errorf(font, "Unable to read cmap format 4 table length at offset %u.", coffset);
+	    _ttfError(font, "Unable to read cmap format 4 table length at offset %u.", coffset);
 	    return (false);
 	  }
 
@@ -1624,7 +4049,7 @@ read_cmap(ttf_t *font)			// I - Font
 
           if (segCount < 2)
           {
-	    errorf(font, "Bad cmap format 4 table - segment count is %d.", segCount);
+	    _ttfError(font, "Bad cmap format 4 table - segment count is %d.", segCount);
 	    return (false);
           }
 
@@ -1634,7 +4059,7 @@ read_cmap(ttf_t *font)			// I - Font
 
           if (!segments || !glyphIdArray)
           {
-            errorf(font, "Unable to allocate memory for cmap.");
+            _ttfError(font, "Unable to allocate memory for cmap.");
             free(segments);
             free(glyphIdArray);
             return (false);
@@ -1665,7 +4090,7 @@ read_cmap(ttf_t *font)			// I - Font
 
             if (segment->startCode > segment->endCode)
             {
-	      errorf(font, "Bad cmap format 4 table segment %u to %u.", segments->startCode, segment->endCode);
+	      _ttfError(font, "Bad cmap format 4 table segment %u to %u.", segments->startCode, segment->endCode);
 	      free(segments);
 	      free(glyphIdArray);
 	      return (false);
@@ -1684,7 +4109,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (font->num_cmap == 0 || font->num_cmap > TTF_FONT_MAX_CHAR)
 	  {
-	    errorf(font, "Invalid cmap format 4 table with %u characters.", (unsigned)font->num_cmap);
+	    _ttfError(font, "Invalid cmap format 4 table with %u characters.", (unsigned)font->num_cmap);
 	    free(segments);
 	    free(glyphIdArray);
 	    return (false);
@@ -1694,7 +4119,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (!font->cmap)
           {
-            errorf(font, "Unable to allocate memory for cmap.");
+            _ttfError(font, "Unable to allocate memory for cmap.");
             free(segments);
             free(glyphIdArray);
             return (false);
@@ -1755,7 +4180,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (read_ulong(font) == 0)
 	  {
-	    errorf(font, "Unable to read cmap format 12 table length at offset %u.", coffset);
+	    _ttfError(font, "Unable to read cmap format 12 table length at offset %u.", coffset);
 	    return (false);
 	  }
 
@@ -1766,13 +4191,13 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (nGroups > TTF_FONT_MAX_GROUPS)
 	  {
-	    errorf(font, "Invalid cmap format 12 table with %u groups.", nGroups);
+	    _ttfError(font, "Invalid cmap format 12 table with %u groups.", nGroups);
 	    return (false);
 	  }
 
 	  if ((groups = (_ttf_off_cmap12_t *)calloc(nGroups, sizeof(_ttf_off_cmap12_t))) == NULL)
           {
-            errorf(font, "Unable to allocate memory for cmap.");
+            _ttfError(font, "Unable to allocate memory for cmap.");
             return (false);
 	  }
 
@@ -1785,7 +4210,7 @@ read_cmap(ttf_t *font)			// I - Font
 
             if (group->startCharCode > group->endCharCode)
             {
-	      errorf(font, "Bad cmap format 12 table segment %u to %u.", group->startCharCode, group->endCharCode);
+	      _ttfError(font, "Bad cmap format 12 table segment %u to %u.", group->startCharCode, group->endCharCode);
 	      free(groups);
 	      return (false);
             }
@@ -1805,7 +4230,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (font->num_cmap == 0 || font->num_cmap > TTF_FONT_MAX_CHAR)
 	  {
-	    errorf(font, "Invalid cmap format 12 table with %u characters.", (unsigned)font->num_cmap);
+	    _ttfError(font, "Invalid cmap format 12 table with %u characters.", (unsigned)font->num_cmap);
 	    free(groups);
 	    return (false);
 	  }
@@ -1814,7 +4239,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (!font->cmap)
           {
-            errorf(font, "Unable to allocate memory for cmap.");
+            _ttfError(font, "Unable to allocate memory for cmap.");
             free(groups);
             return (false);
 	  }
@@ -1854,7 +4279,7 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (read_ulong(font) == 0)
 	  {
-	    errorf(font, "Unable to read cmap format 13 table length at offset %u.", coffset);
+	    _ttfError(font, "Unable to read cmap format 13 table length at offset %u.", coffset);
 	    return (false);
 	  }
 
@@ -1865,13 +4290,13 @@ read_cmap(ttf_t *font)			// I - Font
 
 	  if (nGroups > TTF_FONT_MAX_GROUPS)
 	  {
-	    errorf(font, "Invalid cmap format 13 table with %u groups.", nGroups);
+	    _ttfError(font, "Invalid cmap format 13 table with %u groups.", nGroups);
 	    return (false);
 	  }
 
 	  if ((groups = (_ttf_off_cmap13_t *)calloc(nGroups, sizeof(_ttf_off_cmap13_t))) == NULL)
 	  {
-	    errorf(font, "Unable to allocate memory for cmap.");
+	    _ttfError(font, "Unable to allocate memory for cmap.");
 	    return (false);
 	  }
 
@@ -1884,7 +4309,7 @@ read_cmap(ttf_t *font)			// I - Font
 
             if (group->startCharCode > group->endCharCode)
             {
-	      errorf(font, "Bad cmap format 13 table segment %u to %u.", group->startCharCode, group->endCharCode);
+	      _ttfError(font, "Bad cmap format 13 table segment %u to %u.", group->startCharCode, group->endCharCode);
 	      free(groups);
 	      return (false);
             }
@@ -1893,61 +4318,393 @@ read_cmap(ttf_t *font)			// I - Font
               continue;
             }
 
-            if (group->endCharCode >= font->num_cmap)
-              font->num_cmap = group->endCharCode + 1;
-	  }
+            if (group->endCharCode >= font->num_cmap)
+              font->num_cmap = group->endCharCode + 1;
+	  }
+
+	  // Based on the end code of the segent table, allocate space for the
+	  // uncompressed cmap table...
+          TTF_DEBUG("read_cmap: num_cmap=%u\n", (unsigned)font->num_cmap);
+
+	  if (font->num_cmap == 0 || font->num_cmap > TTF_FONT_MAX_CHAR)
+	  {
+	    _ttfError(font, "Invalid cmap format 13 table with %u characters.", (unsigned)font->num_cmap);
+	    free(groups);
+	    return (false);
+	  }
+
+	  font->cmap = cmapptr = (int *)malloc(font->num_cmap * sizeof(int));
+
+	  if (!font->cmap)
+	  {
+	    _ttfError(font, "Unable to allocate cmap.");
+	    free(groups);
+	    return (false);
+	  }
+
+	  memset(cmapptr, -1, font->num_cmap * sizeof(int));
+
+	  // Now loop through the groups and assign glyph indices from the
+	  // array...
+	  for (gidx = 0, group = groups; gidx < nGroups; gidx ++, group ++)
+	  {
+            if (group->startCharCode >= TTF_FONT_MAX_CHAR || group->endCharCode >= TTF_FONT_MAX_CHAR)
+              continue;
+
+            for (ch = group->startCharCode; ch <= group->endCharCode && ch < font->num_cmap; ch ++)
+              cmapptr[ch] = (int)group->glyphID;
+          }
+
+	  // Free the group data...
+	  free(groups);
+	}
+        break;
+
+    default :
+        _ttfError(font, "Unsupported cmap format %d tables.", cformat);
+        return (false);
+  }
+
+#ifdef DEBUG
+  cmapptr = font->cmap;
+  for (i = 0; i < (int)font->num_cmap && i < 127; i ++)
+  {
+    if (cmapptr[i] >= 0)
+      TTF_DEBUG("read_cmap; cmap[%d]=%d\n", i, cmapptr[i]);
+  }
+#endif // DEBUG
+
+  return (true);
+}
+
+
+//
+// 'read_gpos()' - Read the kerning lookups from the GPOS table.
+//
+// Pair adjustment lookups used by the "kern" feature are read in lookup order.
+// Specific pairs (PairPos format 1) are added to the merged kerning pairs and
+// class pairs (PairPos format 2) are added as class-based kerning subtables.
+// Malformed lookups are ignored.
+//
+
+static bool				// O - `true` on success, `false` on error
+read_gpos(ttf_t *font)			// I - Font
+{
+  const unsigned char *gpos;		// GPOS table
+  size_t	length,			// Length of table
+		feature_offset,		// Offset of FeatureList
+		lookup_offset,		// Offset of LookupList
+		offset,			// Offset of current lookup
+		suboffset;		// Offset of current subtable
+  unsigned	i, j,			// Looping vars
+		num_features,		// Number of features
+		num_lookups,		// Number of lookups
+		num_indices,		// Number of lookup indices in feature
+		num_subtables,		// Number of subtables in lookup
+		lookup_type,		// Lookup type
+		lookup;			// Lookup index
+  bool		*kern_lookups;		// Lookups used for kerning
+
+
+  TTF_DEBUG("read_gpos(font=%p)\n", (void *)font);
+
+  if ((gpos = _ttfGetTable(font, TTF_OFF_GPOS, &length)) == NULL || length < 10)
+  {
+    TTF_DEBUG("read_gpos: No GPOS table, returning true.\n");
+    return (true);
+  }
+
+  feature_offset = TTF_GET_USHORT(gpos + 6);
+  lookup_offset  = TTF_GET_USHORT(gpos + 8);
+
+  if (feature_offset > (length - 2) || lookup_offset > (length - 2))
+    return (true);
+
+  num_features = TTF_GET_USHORT(gpos + feature_offset);
+  num_lookups  = TTF_GET_USHORT(gpos + lookup_offset);
+
+  if ((feature_offset + 2 + 6 * (size_t)num_features) > length || (lookup_offset + 2 + 2 * (size_t)num_lookups) > length || num_lookups == 0)
+    return (true);
+
+  if ((kern_lookups = (bool *)calloc(num_lookups, sizeof(bool))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for GPOS lookups.");
+    return (false);
+  }
+
+  // Find the lookups used by "kern" features...
+  for (i = 0; i < num_features; i ++)
+  {
+    if (TTF_GET_ULONG(gpos + feature_offset + 2 + 6 * i) != TTF_OFF_GPOS_kern)
+      continue;
+
+    offset = feature_offset + TTF_GET_USHORT(gpos + feature_offset + 6 + 6 * i);
+
+    if (offset > (length - 4))
+      continue;
+
+    num_indices = TTF_GET_USHORT(gpos + offset + 2);
+
+    for (j = 0; j < num_indices && (offset + 4 + 2 * (size_t)j + 2) <= length; j ++)
+    {
+      if ((lookup = TTF_GET_USHORT(gpos + offset + 4 + 2 * j)) < num_lookups)
+        kern_lookups[lookup] = true;
+    }
+  }
+
+  // Then read the pair adjustment subtables in those lookups...
+  for (i = 0; i < num_lookups; i ++)
+  {
+    if (!kern_lookups[i])
+      continue;
+
+    offset = lookup_offset + TTF_GET_USHORT(gpos + lookup_offset + 2 + 2 * i);
+
+    if (offset > (length - 6))
+      continue;
+
+    lookup_type   = TTF_GET_USHORT(gpos + offset);
+    num_subtables = TTF_GET_USHORT(gpos + offset + 4);
+
+    TTF_DEBUG("read_gpos: lookup[%u] type=%u, num_subtables=%u\n", i, lookup_type, num_subtables);
+
+    for (j = 0; j < num_subtables && (offset + 6 + 2 * (size_t)j + 2) <= length; j ++)
+    {
+      suboffset = offset + TTF_GET_USHORT(gpos + offset + 6 + 2 * j);
+
+      if (lookup_type == TTF_OFF_GPOS_Extension)
+      {
+        // Extension subtables have a 32-bit offset to the real subtable...
+        if (suboffset > (length - 8) || TTF_GET_USHORT(gpos + suboffset + 2) != TTF_OFF_GPOS_PairPos)
+          break;
+
+        suboffset += TTF_GET_ULONG(gpos + suboffset + 4);
+      }
+      else if (lookup_type != TTF_OFF_GPOS_PairPos)
+      {
+        break;
+      }
+
+      if (suboffset < length && !read_pair_pos(font, gpos + suboffset, length - suboffset))
+      {
+        free(kern_lookups);
+        return (false);
+      }
+    }
+  }
+
+  free(kern_lookups);
+
+  TTF_DEBUG("read_gpos: %u kerning pairs and %u class subtables, returning true.\n", (unsigned)font->num_kerning, (unsigned)font->num_kern_classes);
+
+  return (true);
+}
+
+
+//
+// 'read_gsub()' - Read the standard ligatures from the GSUB table.
+//
+// The ligature substitution lookups used by the "liga" feature of the default
+// language of the "DFLT" (or "latn") script are combined into a single trie
+// indexed by the first glyph.  Malformed lookups are ignored.
+//
+
+static bool				// O - `true` on success, `false` on error
+read_gsub(ttf_t *font)			// I - Font
+{
+  const unsigned char *gsub;		// GSUB table
+  size_t	length,			// Length of table
+		script_offset,		// Offset of ScriptList
+		feature_offset,		// Offset of FeatureList
+		lookup_offset,		// Offset of LookupList
+		langsys = 0,		// Offset of default LangSys
+		offset,			// Offset of current feature or lookup
+		suboffset,		// Offset of current subtable
+		coverage,		// Offset of Coverage table
+		set,			// Offset of LigatureSet
+		liga;			// Offset of Ligature
+  unsigned	i, j, k, n,		// Looping vars
+		tag,			// Script tag
+		num_scripts,		// Number of scripts
+		num_features,		// Number of features
+		num_lookups,		// Number of lookups
+		num_indices,		// Number of indices
+		num_subtables,		// Number of subtables in lookup
+		num_sets,		// Number of LigatureSets
+		num_ligatures,		// Number of Ligatures in set
+		num_components,		// Number of components in Ligature
+		lookup_type,		// Lookup type
+		feature,		// Feature index
+		lookup,			// Lookup index
+		first,			// First glyph in coverage range
+		last,			// Last glyph in coverage range
+		value,			// Coverage index
+		glyph;			// Current glyph
+  bool		*liga_lookups;		// Lookups used for ligatures
+
+
+  TTF_DEBUG("read_gsub(font=%p)\n", (void *)font);
+
+  if ((gsub = _ttfGetTable(font, TTF_OFF_GSUB, &length)) == NULL || length < 10 || !font->num_glyphs)
+  {
+    TTF_DEBUG("read_gsub: No GSUB table, returning true.\n");
+    return (true);
+  }
+
+  script_offset  = TTF_GET_USHORT(gsub + 4);
+  feature_offset = TTF_GET_USHORT(gsub + 6);
+  lookup_offset  = TTF_GET_USHORT(gsub + 8);
+
+  if (script_offset > (length - 2) || feature_offset > (length - 2) || lookup_offset > (length - 2))
+    return (true);
+
+  num_scripts  = TTF_GET_USHORT(gsub + script_offset);
+  num_features = TTF_GET_USHORT(gsub + feature_offset);
+  num_lookups  = TTF_GET_USHORT(gsub + lookup_offset);
+
+  if ((script_offset + 2 + 6 * (size_t)num_scripts) > length || (feature_offset + 2 + 6 * (size_t)num_features) > length || (lookup_offset + 2 + 2 * (size_t)num_lookups) > length || num_lookups == 0)
+    return (true);
+
+  // Find the default LangSys for the default script...
+  for (i = 0; i < num_scripts; i ++)
+  {
+    tag    = TTF_GET_ULONG(gsub + script_offset + 2 + 6 * i);
+    offset = script_offset + TTF_GET_USHORT(gsub + script_offset + 6 + 6 * i);
+
+    if ((tag != TTF_OFF_GSUB_DFLT && tag != TTF_OFF_GSUB_latn) || offset > (length - 2) || !TTF_GET_USHORT(gsub + offset))
+      continue;
+
+    langsys = offset + TTF_GET_USHORT(gsub + offset);
+
+    if (tag == TTF_OFF_GSUB_DFLT)
+      break;
+  }
+
+  if (!langsys || langsys > (length - 6))
+  {
+    TTF_DEBUG("read_gsub: No default script, returning true.\n");
+    return (true);
+  }
+
+  // Find the lookups used by the "liga" features for that LangSys...
+  if ((liga_lookups = (bool *)calloc(num_lookups, sizeof(bool))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for GSUB lookups.");
+    return (false);
+  }
+
+  num_indices = TTF_GET_USHORT(gsub + langsys + 4);
+
+  for (i = 0; i <= num_indices; i ++)
+  {
+    // Index 0 is the required feature, followed by the other features...
+    if (i == 0)
+      feature = TTF_GET_USHORT(gsub + langsys + 2);
+    else if ((langsys + 6 + 2 * (size_t)i) <= length)
+      feature = TTF_GET_USHORT(gsub + langsys + 4 + 2 * i);
+    else
+      break;
+
+    if (feature >= num_features || TTF_GET_ULONG(gsub + feature_offset + 2 + 6 * feature) != TTF_OFF_GSUB_liga)
+      continue;
+
+    offset = feature_offset + TTF_GET_USHORT(gsub + feature_offset + 6 + 6 * feature);
+
+    if (offset > (length - 4))
+      continue;
+
+    for (j = 0, n = TTF_GET_USHORT(gsub + offset + 2); j < n && (offset + 4 + 2 * (size_t)j + 2) <= length; j ++)
+    {
+      if ((lookup = TTF_GET_USHORT(gsub + offset + 4 + 2 * j)) < num_lookups)
+        liga_lookups[lookup] = true;
+    }
+  }
+
+  if ((font->liga_index = (unsigned *)calloc(font->num_glyphs, sizeof(unsigned))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for ligatures.");
+    free(liga_lookups);
+    return (false);
+  }
+
+  // Then add the ligatures from those lookups...
+  for (i = 0; i < num_lookups; i ++)
+  {
+    if (!liga_lookups[i])
+      continue;
+
+    offset = lookup_offset + TTF_GET_USHORT(gsub + lookup_offset + 2 + 2 * i);
+
+    if (offset > (length - 6))
+      continue;
+
+    lookup_type   = TTF_GET_USHORT(gsub + offset);
+    num_subtables = TTF_GET_USHORT(gsub + offset + 4);
+
+    TTF_DEBUG("read_gsub: lookup[%u] type=%u, num_subtables=%u\n", i, lookup_type, num_subtables);
+
+    for (j = 0; j < num_subtables && (offset + 6 + 2 * (size_t)j + 2) <= length; j ++)
+    {
+      suboffset = offset + TTF_GET_USHORT(gsub + offset + 6 + 2 * j);
+
+      if (lookup_type == TTF_OFF_GSUB_Extension)
+      {
+        // Extension subtables have a 32-bit offset to the real subtable...
+        if (suboffset > (length - 8) || TTF_GET_USHORT(gsub + suboffset + 2) != TTF_OFF_GSUB_Ligature)
+          break;
+
+        suboffset += TTF_GET_ULONG(gsub + suboffset + 4);
+      }
+      else if (lookup_type != TTF_OFF_GSUB_Ligature)
+      {
+        break;
+      }
 
-	  // Based on the end code of the segent table, allocate space for the
-	  // uncompressed cmap table...
-          TTF_DEBUG("read_cmap: num_cmap=%u\n", (unsigned)font->num_cmap);
+      // LigatureSubst format 1: substFormat, coverageOffset, ligatureSetCount,
+      // ligatureSetOffsets[ligatureSetCount]
+      if (suboffset > (length - 6) || TTF_GET_USHORT(gsub + suboffset) != 1)
+        continue;
 
-	  if (font->num_cmap == 0 || font->num_cmap > TTF_FONT_MAX_CHAR)
-	  {
-	    errorf(font, "Invalid cmap format 13 table with %u characters.", (unsigned)font->num_cmap);
-	    free(groups);
-	    return (false);
-	  }
+      num_sets = TTF_GET_USHORT(gsub + suboffset + 4);
 
-	  font->cmap = cmapptr = (int *)malloc(font->num_cmap * sizeof(int));
+      if ((suboffset + 6 + 2 * (size_t)num_sets) > length || (coverage = suboffset + TTF_GET_USHORT(gsub + suboffset + 2)) >= length)
+        continue;
 
-	  if (!font->cmap)
-	  {
-	    errorf(font, "Unable to allocate cmap.");
-	    free(groups);
-	    return (false);
-	  }
+      for (n = 0; get_range(gsub + coverage, length - coverage, false, n, &first, &last, &value); n ++)
+      {
+        for (glyph = first; glyph <= last && value < num_sets; glyph ++, value ++)
+        {
+          // LigatureSet: ligatureCount, ligatureOffsets[ligatureCount]
+          if ((set = suboffset + TTF_GET_USHORT(gsub + suboffset + 6 + 2 * value)) > (length - 2))
+            continue;
 
-	  memset(cmapptr, -1, font->num_cmap * sizeof(int));
+          num_ligatures = TTF_GET_USHORT(gsub + set);
 
-	  // Now loop through the groups and assign glyph indices from the
-	  // array...
-	  for (gidx = 0, group = groups; gidx < nGroups; gidx ++, group ++)
-	  {
-            if (group->startCharCode >= TTF_FONT_MAX_CHAR || group->endCharCode >= TTF_FONT_MAX_CHAR)
+          for (k = 0; k < num_ligatures && (set + 2 + 2 * (size_t)k + 2) <= length; k ++)
+          {
+            // Ligature: ligatureGlyph, componentCount, componentGlyphIDs[componentCount - 1]
+            if ((liga = set + TTF_GET_USHORT(gsub + set + 2 + 2 * k)) > (length - 4))
               continue;
 
-            for (ch = group->startCharCode; ch <= group->endCharCode && ch < font->num_cmap; ch ++)
-              cmapptr[ch] = (int)group->glyphID;
-          }
+            num_components = TTF_GET_USHORT(gsub + liga + 2);
 
-	  // Free the group data...
-	  free(groups);
-	}
-        break;
+            if (num_components < 2 || (liga + 4 + 2 * (size_t)(num_components - 1)) > length)
+              continue;
 
-    default :
-        errorf(font, "Unsupported cmap format %d tables.", cformat);
-        return (false);
+            if (!add_ligature(font, glyph, gsub + liga + 4, num_components - 1, TTF_GET_USHORT(gsub + liga)))
+            {
+              free(liga_lookups);
+              return (false);
+            }
+          }
+        }
+      }
+    }
   }
 
-#ifdef DEBUG
-  cmapptr = font->cmap;
-  for (i = 0; i < (int)font->num_cmap && i < 127; i ++)
-  {
-    if (cmapptr[i] >= 0)
-      TTF_DEBUG("read_cmap; cmap[%d]=%d\n", i, cmapptr[i]);
-  }
-#endif // DEBUG
+  free(liga_lookups);
+
+  TTF_DEBUG("read_gsub: %u ligature nodes, returning true.\n", (unsigned)font->num_liga);
 
   return (true);
 }
@@ -2008,7 +4765,7 @@ read_hhea(ttf_t           *font,	// I - Font
   /* minorVersion */        read_ushort(font);
   hhea->ascender          = (short)read_short(font);
   hhea->descender         = (short)read_short(font);
-  /* lineGap */             read_short(font);
+  hhea->lineGap           = (short)read_short(font);
   /* advanceWidthMax */     read_ushort(font);
   /* minLeftSideBearing */  read_short(font);
   /* minRightSideBearing */ read_short(font);
@@ -2048,7 +4805,7 @@ read_hmtx(ttf_t           *font,	// I - Font
 
   if (length < (unsigned)(4 * hhea->numberOfHMetrics))
   {
-    errorf(font, "Length of hhea table is only %u, expected at least %d.", length, 4 * hhea->numberOfHMetrics);
+    _ttfError(font, "Length of hhea table is only %u, expected at least %d.", length, 4 * hhea->numberOfHMetrics);
     return (NULL);
   }
 
@@ -2074,127 +4831,300 @@ read_hmtx(ttf_t           *font,	// I - Font
 static bool				// O - `true` on success, `false` on error
 read_kern(ttf_t *font)			// I - Font
 {
+  const unsigned char *kern,		// kern table
+		*subtable,		// Current subtable
+		*pairs = NULL,		// Pairs in first subtable
+		*kp;			// Current kerning pair
+  size_t	length,			// Table length
+		offset,			// Offset of current subtable
+		num_pairs = 0,		// Total number of kerning pairs
+		num_subtables = 0;	// Number of pair subtables
   unsigned	i, j,			// Looping vars
-		length,			// Table length
 		version,		// Table version
 		nTables,		// Number of kerning tables
 		coverage,		// Coverage of kerning table
-		nPairs;			// Number of kerning pairs
-  _ttf_kerning_t *k;			// Current kerning pair
+		nPairs,			// Number of kerning pairs
+		glyph,			// Current left glyph
+		max_left;		// Maximum left glyph
+  bool		sorted = true;		// Are the pairs already sorted?
 
 
   TTF_DEBUG("read_kern(font=%p)\n", (void *)font);
 
+  // Use the GPOS kerning, if any...
+  if (!read_gpos(font))
+  {
+    // GPOS kerning is optional, so drop any GPOS pairs and classes and fall
+    // back on the kern table...
+    TTF_DEBUG("read_kern: Unable to read GPOS kerning, using kern table.\n");
+
+    free(font->kerning_buffer);
+    font->kerning_buffer = NULL;
+    font->num_kerning    = 0;
+
+    for (i = 0; i < font->num_kern_classes; i ++)
+      free(font->kern_classes[i].left_classes);
+
+    free(font->kern_classes);
+    font->kern_classes     = NULL;
+    font->num_kern_classes = 0;
+  }
+
+  if (font->num_kerning || font->num_kern_classes)
+  {
+    TTF_DEBUG("read_kern: Using GPOS kerning.\n");
+    goto build_index;
+  }
+
   // Find the kern table...
-  if (seek_table(font, TTF_OFF_kern, 0, false) == 0)
+  if ((kern = _ttfGetTable(font, TTF_OFF_kern, &length)) == NULL || length < 14)
   {
     TTF_DEBUG("read_kern: No kern table, returning true.\n");
     return (true);
   }
 
   // Get the version and number of tables...
-  if ((version = (unsigned)read_ushort(font)) != 0)
+  if ((version = TTF_GET_USHORT(kern)) != 0)
   {
-    TTF_DEBUG("read_kern: Unsupported kern table version %d, returning false.\n", version);
-//    errorf(font, "Unsupported kern table version %d.", version);
-    return (false);
+    // Apple kern tables are not supported, so just ignore them...
+    TTF_DEBUG("read_kern: Unsupported kern table version %d, returning true.\n", version);
+    return (true);
   }
 
-  if ((nTables = (unsigned)read_ushort(font)) == 0)
+  if ((nTables = TTF_GET_USHORT(kern + 2)) == 0)
   {
     TTF_DEBUG("read_kern: No subtables in kern table, returning false.\n");
-    errorf(font, "No subtables in kern table.");
+    _ttfError(font, "No subtables in kern table.");
     return (false);
   }
 
   TTF_DEBUG("read_kern: nTables=%u\n", nTables);
 
-  // Then read all the tables...
-  for (i = 0; i < nTables; i ++)
+  // Then scan all the subtables for horizontal kerning...
+  for (i = 0, offset = 4; i < nTables; i ++)
   {
-    if ((version = (unsigned)read_ushort(font)) != 0)
+    if ((offset + 6) > length)
     {
-      TTF_DEBUG("read_kern: Unsupported kern subtable version %d, returning false.\n", version);
-      errorf(font, "Unsupported kern subtable version %d.", version);
+      TTF_DEBUG("read_kern: Truncated kern table, returning false.\n");
+      _ttfError(font, "Truncated kern table.");
       return (false);
     }
 
-    if ((length = (unsigned)read_ushort(font)) == 0)
+    subtable = kern + offset;
+
+    if ((version = TTF_GET_USHORT(subtable)) != 0)
     {
-      TTF_DEBUG("read_kern: Empty kern subtable, returning false.\n");
-      errorf(font, "Empty kern subtable.");
+      TTF_DEBUG("read_kern: Unsupported kern subtable version %d, returning false.\n", version);
+      _ttfError(font, "Unsupported kern subtable version %d.", version);
       return (false);
     }
 
-    TTF_DEBUG("read_kern: length[%u]=%u\n", i, length);
+    coverage = TTF_GET_USHORT(subtable + 4);
 
-    if ((coverage = (unsigned)read_ushort(font)) != 1)
-    {
-      char	buffer[1024];		// Read buffer
-      unsigned	bytes;			// Bytes read
-
-      TTF_DEBUG("read_kern: coverage=%u, skipping.\n", coverage);
+    TTF_DEBUG("read_kern: length[%u]=%u, coverage=%u\n", i, TTF_GET_USHORT(subtable + 2), coverage);
 
-      for (i = length - 6; i > 0; i -= bytes)
+    if (coverage != 0x0001)
+    {
+      // Read format 2 class kerning and skip anything else...
+      if (TTF_GET_USHORT(subtable + 2) < 6)
       {
-        if ((bytes = length) > sizeof(buffer))
-          bytes = sizeof(buffer);
-
-        if ((font->read_cb)(font, buffer, bytes) != bytes)
-	{
-	  TTF_DEBUG("read_kern: Unable to skip kern subtable, returning false.\n");
-	  errorf(font, "Unable to skip kern subtable.");
-	  return (false);
-	}
+        TTF_DEBUG("read_kern: Empty kern subtable, returning false.\n");
+        _ttfError(font, "Empty kern subtable.");
+        return (false);
       }
 
+      if (coverage == 0x0201 && !read_kern_class(font, subtable, length - offset))
+        return (false);
+
+      offset += TTF_GET_USHORT(subtable + 2);
       continue;
     }
 
-    if ((nPairs = (unsigned)read_ushort(font)) == 0)
+    if ((offset + 14) > length || (nPairs = TTF_GET_USHORT(subtable + 6)) == 0)
     {
       TTF_DEBUG("read_kern: No pairs in kern subtable, returning false.\n");
-      errorf(font, "No pairs in kern subtable.");
+      _ttfError(font, "No pairs in kern subtable.");
       return (false);
     }
 
-    if ((nPairs + font->num_kerning) > TTF_FONT_MAX_KERNING)
+    // The 16-bit subtable length overflows for large subtables, so use the
+    // number of pairs to find the end of the subtable...
+    if ((nPairs * TTF_KERNING_SIZE) > (length - offset - 14))
     {
-      TTF_DEBUG("read_kern: Too many pairs (%u) in kern subtable, returning false.\n", (unsigned)(nPairs + font->num_kerning));
-      errorf(font, "Too many pairs in kern subtable.");
+      TTF_DEBUG("read_kern: Truncated kern subtable, returning false.\n");
+      _ttfError(font, "Truncated kern subtable.");
       return (false);
     }
 
-    /*searchRange   = */read_ushort(font);
-    /*entrySelector = */read_ushort(font);
-    /*rangeShift    = */read_ushort(font);
+    if (num_subtables == 0)
+      pairs = subtable + 14;
+
+    num_subtables ++;
+    num_pairs += nPairs;
+    offset    += 14 + nPairs * TTF_KERNING_SIZE;
+  }
+
+  TTF_DEBUG("read_kern: num_subtables=%u, num_pairs=%u\n", (unsigned)num_subtables, (unsigned)num_pairs);
 
-    // Allocate kerning pairs for the font...
-    if ((k = realloc(font->kerning, (font->num_kerning + nPairs) * sizeof(_ttf_kerning_t))) == NULL)
+  if (num_subtables == 1)
+  {
+    // Use the pairs in place if they are already sorted...
+    for (j = 1, kp = pairs; j < num_pairs && sorted; j ++, kp += TTF_KERNING_SIZE)
+      sorted = compare_kerning(kp, kp + TTF_KERNING_SIZE) < 0;
+
+    if (sorted)
     {
-      TTF_DEBUG("read_kern: Unable to allocate memory for %u kerning pairs, returning false.\n", nPairs);
-      errorf(font, "Unable to allocate memory for %u kerning pairs.", nPairs);
-      return (false);
+      font->kerning     = pairs;
+      font->num_kerning = num_pairs;
+      goto build_index;
     }
+  }
 
-    font->kerning     = k;
-    k                 += font->num_kerning;
-    font->num_kerning += nPairs;
+  // Merge the pairs from all of the subtables...
+  for (i = 0, offset = 4; i < nTables && num_pairs > 0; i ++)
+  {
+    subtable = kern + offset;
 
-    // Read the pairs...
-    for (j = 0; j < nPairs; j ++)
+    if (TTF_GET_USHORT(subtable + 4) != 0x0001)
     {
-      k->left  = (unsigned short)read_ushort(font);
-      k->right = (unsigned short)read_ushort(font);
-      k->adj   = (short)read_short(font);
-      k ++;
+      offset += TTF_GET_USHORT(subtable + 2);
+      continue;
     }
+
+    nPairs = TTF_GET_USHORT(subtable + 6);
+
+    if (!add_kerning(font, subtable + 14, nPairs))
+      return (false);
+
+    offset += 14 + nPairs * TTF_KERNING_SIZE;
+  }
+
+  // Sort the merged pairs...
+  build_index:
+
+  if (font->kerning_buffer)
+  {
+    sort_kerning(font);
+    font->kerning = font->kerning_buffer;
+  }
+
+  if (font->num_kerning == 0)
+    return (true);
+
+  // Build an index of the first pair for each left glyph...
+  max_left = TTF_GET_USHORT(font->kerning + (font->num_kerning - 1) * TTF_KERNING_SIZE);
+
+  if ((font->kerning_index = (unsigned *)malloc((max_left + 2) * sizeof(unsigned))) == NULL)
+  {
+    TTF_DEBUG("read_kern: Unable to allocate memory for kerning index, returning false.\n");
+    _ttfError(font, "Unable to allocate memory for kerning index.");
+    return (false);
+  }
+
+  for (j = 0, glyph = 0, kp = font->kerning; j < font->num_kerning; j ++, kp += TTF_KERNING_SIZE)
+  {
+    while (glyph <= TTF_GET_USHORT(kp))
+      font->kerning_index[glyph ++] = j;
+  }
+
+  while (glyph <= (max_left + 1))
+    font->kerning_index[glyph ++] = (unsigned)font->num_kerning;
+
+  font->num_kerning_index = max_left + 2;
+
+  TTF_DEBUG("read_kern: %u kerning pairs and %u class subtables in font (%s), returning true.\n", (unsigned)font->num_kerning, (unsigned)font->num_kern_classes, font->kerning_buffer ? "merged" : "in place");
+
+  return (true);
+}
+
+
+//
+// 'read_kern_class()' - Read a format 2 (class) kern subtable.
+//
+// Format 2 class tables hold byte offsets rather than class numbers: the left
+// offsets are rows of "rowWidth" bytes in the kerning array and the right
+// offsets are columns of 2 bytes, so they are converted to class numbers here.
+//
+
+static bool				// O - `true` on success, `false` on error
+read_kern_class(
+    ttf_t               *font,		// I - Font
+    const unsigned char *subtable,	// I - Subtable
+    size_t              length)		// I - Maximum length of subtable
+{
+  unsigned	i, j,			// Looping vars
+		row_width,		// Width of a row in bytes
+		left_offset,		// Offset of left class table
+		right_offset,		// Offset of right class table
+		array_offset,		// Offset of kerning array
+		first_left,		// First left glyph
+		num_left,		// Number of left glyphs
+		first_right,		// First right glyph
+		num_right,		// Number of right glyphs
+		num_left_classes = 0,	// Number of left classes
+		num_right_classes,	// Number of right classes
+		value;			// Class value
+  size_t	offset;			// Offset of kerning value
+  _ttf_kern_class_t *kc;		// Class-based kerning subtable
+
+
+  if (length < 16)
+    return (true);
+
+  row_width    = TTF_GET_USHORT(subtable + 6);
+  left_offset  = TTF_GET_USHORT(subtable + 8);
+  right_offset = TTF_GET_USHORT(subtable + 10);
+  array_offset = TTF_GET_USHORT(subtable + 12);
+
+  if (row_width < 2 || left_offset > (length - 4) || right_offset > (length - 4))
+    return (true);
+
+  first_left  = TTF_GET_USHORT(subtable + left_offset);
+  num_left    = TTF_GET_USHORT(subtable + left_offset + 2);
+  first_right = TTF_GET_USHORT(subtable + right_offset);
+  num_right   = TTF_GET_USHORT(subtable + right_offset + 2);
+
+  if ((left_offset + 4 + 2 * num_left) > length || (right_offset + 4 + 2 * num_right) > length)
+    return (true);
+
+  num_right_classes = row_width / 2;
+
+  for (i = 0; i < num_left; i ++)
+  {
+    if ((value = TTF_GET_USHORT(subtable + left_offset + 4 + 2 * i)) >= array_offset)
+      value -= array_offset;
+
+    if ((value / row_width) >= num_left_classes)
+      num_left_classes = value / row_width + 1;
+  }
+
+  if ((kc = add_kern_class(font, first_left, num_left, first_right, num_right, num_left_classes, num_right_classes)) == NULL)
+    return (false);
+
+  // Convert the offsets to class numbers...
+  for (i = 0; i < num_left; i ++)
+  {
+    if ((value = TTF_GET_USHORT(subtable + left_offset + 4 + 2 * i)) >= array_offset)
+      value -= array_offset;
+
+    kc->left_classes[i] = (unsigned short)(value / row_width);
   }
 
-  if (font->num_kerning)
-    qsort(font->kerning, font->num_kerning, sizeof(_ttf_kerning_t), (int (*)(const void *, const void *))compare_kerning);
+  for (i = 0; i < num_right; i ++)
+  {
+    if ((value = TTF_GET_USHORT(subtable + right_offset + 4 + 2 * i) / 2) < num_right_classes)
+      kc->right_classes[i] = (unsigned short)value;
+  }
 
-  TTF_DEBUG("read_kern: %u kerning pairs in font, returning true.\n", (unsigned)font->num_kerning);
+  // Then copy the kerning array...
+  for (i = 0; i < num_left_classes; i ++)
+  {
+    for (j = 0; j < num_right_classes; j ++)
+    {
+      if ((offset = array_offset + i * row_width + 2 * j) <= (length - 2))
+        kc->values[i * num_right_classes + j] = TTF_GET_SHORT(subtable + offset);
+    }
+  }
 
   return (true);
 }
@@ -2235,7 +5165,7 @@ read_names(ttf_t *font)			// I - Font
 
   if ((format = read_ushort(font)) < 0 || format > 1)
   {
-    errorf(font, "Unsupported name table format %d.", format);
+    _ttfError(font, "Unsupported name table format %d.", format);
     return (false);
   }
 
@@ -2253,7 +5183,7 @@ read_names(ttf_t *font)			// I - Font
   font->names.storage_size = length - (unsigned)offset;
   if (font->names.storage_size > TTF_FONT_MAX_NAMES)
   {
-    errorf(font, "Name table too large - %u bytes.", (unsigned)font->names.storage_size);
+    _ttfError(font, "Name table too large - %u bytes.", (unsigned)font->names.storage_size);
     return (false);
   }
 
@@ -2293,7 +5223,7 @@ read_names(ttf_t *font)			// I - Font
 
   if ((font->read_cb)(font, font->names.storage, length) == 0)
   {
-    errorf(font, "Unable to read name table: %s", strerror(errno));
+    _ttfError(font, "Unable to read name table: %s", strerror(errno));
     return (false);
   }
 
@@ -2346,14 +5276,13 @@ read_os_2(ttf_t           *font,	// I - Font
   /* ulUnicodeRange2 */     read_ulong(font);
   /* ulUnicodeRange3 */     read_ulong(font);
   /* ulUnicodeRange4 */     read_ulong(font);
-  /* achVendID */           read_ulong(font); read_ulong(font);
-                            read_ulong(font); read_ulong(font);
-  /* fsSelection */         read_ushort(font);
+  /* achVendID */           read_ulong(font);
+  os_2->fsSelection       = (unsigned short)read_ushort(font);
   /* usFirstCharIndex */    read_ushort(font);
   /* usLastCharIndex */     read_ushort(font);
   os_2->sTypoAscender     = (short)read_short(font);
   os_2->sTypoDescender    = (short)read_short(font);
-  /* sTypoLineGap */        read_short(font);
+  os_2->sTypoLineGap      = (short)read_short(font);
   /* usWinAscent */         read_ushort(font);
   /* usWinDescent */        read_ushort(font);
 
@@ -2369,6 +5298,192 @@ read_os_2(ttf_t           *font,	// I - Font
 }
 
 
+//
+// 'read_pair_pos()' - Read a GPOS pair adjustment subtable.
+//
+// Only the horizontal advance of the first glyph is used for kerning.
+//
+
+static bool				// O - `true` on success, `false` on error
+read_pair_pos(
+    ttf_t               *font,		// I - Font
+    const unsigned char *subtable,	// I - Subtable
+    size_t              length)		// I - Maximum length of subtable
+{
+  unsigned	n,			// Range number
+		glyph,			// Current glyph
+		first,			// First glyph in range
+		last,			// Last glyph in range
+		value,			// Coverage index or class
+		format,			// Subtable format
+		format1,		// ValueFormat for first glyph
+		size,			// Size of PairValueRecord or Class2Record
+		xadvance,		// Offset of XAdvance in ValueRecord
+		num_sets,		// Number of PairSets
+		num_classes1,		// Number of left classes
+		num_classes2,		// Number of right classes
+		first_left,		// First left glyph
+		num_left,		// Number of left glyphs
+		min_glyph,		// First glyph
+		max_glyph;		// Last glyph
+  size_t	i,			// Looping var
+		num_pairs,		// Number of pairs
+		coverage,		// Offset of Coverage table
+		classdef1,		// Offset of left ClassDef table
+		classdef2,		// Offset of right ClassDef table
+		set;			// Offset of PairSet
+  unsigned char	*kp;			// Current kerning pair
+  _ttf_kern_class_t *kc;		// Class-based kerning subtable
+
+
+  if (length < 10)
+    return (true);
+
+  format   = TTF_GET_USHORT(subtable);
+  coverage = TTF_GET_USHORT(subtable + 2);
+  format1  = TTF_GET_USHORT(subtable + 4);
+  size     = get_value_size(format1) + get_value_size(TTF_GET_USHORT(subtable + 6));
+  xadvance = get_value_size(format1 & 0x03);
+
+  TTF_DEBUG("read_pair_pos: format=%u, valueFormat1=0x%04x, size=%u\n", format, format1, size);
+
+  if (!(format1 & 0x04) || coverage >= length)
+    return (true);			// No XAdvance for the first glyph
+
+  if (format == 1)
+  {
+    // Specific pairs, count them...
+    num_sets = TTF_GET_USHORT(subtable + 8);
+
+    if ((10 + 2 * (size_t)num_sets) > length)
+      return (true);
+
+    for (n = 0, num_pairs = 0; get_range(subtable + coverage, length - coverage, false, n, &first, &last, &value); n ++)
+    {
+      for (glyph = first; glyph <= last; glyph ++, value ++)
+      {
+        if (value >= num_sets || (set = TTF_GET_USHORT(subtable + 10 + 2 * value)) > (length - 2))
+          continue;
+
+        if ((set + 2 + TTF_GET_USHORT(subtable + set) * (size_t)(size + 2)) <= length)
+          num_pairs += TTF_GET_USHORT(subtable + set);
+      }
+    }
+
+    if (num_pairs == 0)
+      return (true);
+
+    if ((font->num_kerning + num_pairs) > TTF_FONT_MAX_KERNING)
+    {
+      TTF_DEBUG("read_pair_pos: Too many pairs (%u) in font, returning false.\n", (unsigned)(font->num_kerning + num_pairs));
+      return (false);
+    }
+
+    if ((kp = add_kerning(font, NULL, num_pairs)) == NULL)
+      return (false);
+
+    // Then copy the pairs...
+    for (n = 0; get_range(subtable + coverage, length - coverage, false, n, &first, &last, &value); n ++)
+    {
+      for (glyph = first; glyph <= last; glyph ++, value ++)
+      {
+        if (value >= num_sets || (set = TTF_GET_USHORT(subtable + 10 + 2 * value)) > (length - 2))
+          continue;
+
+        if ((set + 2 + TTF_GET_USHORT(subtable + set) * (size_t)(size + 2)) > length)
+          continue;
+
+        for (i = TTF_GET_USHORT(subtable + set), set += 2; i > 0; i --, set += size + 2, kp += TTF_KERNING_SIZE)
+        {
+          kp[0] = (unsigned char)(glyph >> 8);
+          kp[1] = (unsigned char)glyph;
+          kp[2] = subtable[set];
+          kp[3] = subtable[set + 1];
+          kp[4] = subtable[set + 2 + xadvance];
+          kp[5] = subtable[set + 3 + xadvance];
+        }
+      }
+    }
+  }
+  else if (format == 2 && length >= 16)
+  {
+    // Class pairs...
+    classdef1    = TTF_GET_USHORT(subtable + 8);
+    classdef2    = TTF_GET_USHORT(subtable + 10);
+    num_classes1 = TTF_GET_USHORT(subtable + 12);
+    num_classes2 = TTF_GET_USHORT(subtable + 14);
+
+    if (classdef1 >= length || classdef2 >= length || num_classes1 == 0 || num_classes2 == 0 || (16 + (size_t)num_classes1 * num_classes2 * size) > length)
+      return (true);
+
+    if (((size_t)num_classes1 * num_classes2) > TTF_FONT_MAX_KERNING)
+    {
+      TTF_DEBUG("read_pair_pos: Too many classes (%ux%u), ignoring.\n", num_classes1, num_classes2);
+      return (true);
+    }
+
+    // Find the range of left glyphs from the coverage and the range of right
+    // glyphs from the right ClassDef...
+    for (n = 0, min_glyph = 0xffff, max_glyph = 0; get_range(subtable + coverage, length - coverage, false, n, &first, &last, &value); n ++)
+    {
+      if (first < min_glyph)
+        min_glyph = first;
+      if (last > max_glyph)
+        max_glyph = last;
+    }
+
+    if (min_glyph > max_glyph)
+      return (true);
+
+    first_left = min_glyph;
+    num_left   = max_glyph - min_glyph + 1;
+
+    for (n = 0, min_glyph = 0xffff, max_glyph = 0; get_range(subtable + classdef2, length - classdef2, true, n, &first, &last, &value); n ++)
+    {
+      if (first < min_glyph)
+        min_glyph = first;
+      if (last > max_glyph)
+        max_glyph = last;
+    }
+
+    if (min_glyph > max_glyph)
+      min_glyph = max_glyph = 0;
+
+    if ((kc = add_kern_class(font, first_left, num_left, min_glyph, max_glyph - min_glyph + 1, num_classes1, num_classes2)) == NULL)
+      return (false);
+
+    // Fill in the left classes, which default to class 0 for covered glyphs...
+    for (n = 0; get_range(subtable + coverage, length - coverage, false, n, &first, &last, &value); n ++)
+    {
+      for (glyph = first; glyph <= last; glyph ++)
+        kc->left_classes[glyph - kc->first_left] = 0;
+    }
+
+    for (n = 0; get_range(subtable + classdef1, length - classdef1, true, n, &first, &last, &value); n ++)
+    {
+      for (glyph = first; glyph <= last; glyph ++)
+      {
+        if (glyph >= kc->first_left && (glyph - kc->first_left) < kc->num_left && kc->left_classes[glyph - kc->first_left] != 0xffff)
+          kc->left_classes[glyph - kc->first_left] = (unsigned short)(value < num_classes1 ? value : 0);
+      }
+    }
+
+    // and the right classes...
+    for (n = 0; get_range(subtable + classdef2, length - classdef2, true, n, &first, &last, &value); n ++)
+    {
+      for (glyph = first; glyph <= last; glyph ++)
+        kc->right_classes[glyph - kc->first_right] = (unsigned short)(value < num_classes2 ? value : 0);
+    }
+
+    // Then copy the XAdvance values from the Class1Records...
+    for (i = 0; i < ((size_t)num_classes1 * num_classes2); i ++)
+      kc->values[i] = TTF_GET_SHORT(subtable + 16 + i * size + xadvance);
+  }
+
+  return (true);
+}
+
+
 //
 // 'read_post()' - Read the PostScript table.
 //
@@ -2436,7 +5551,7 @@ read_table(ttf_t  *font)		// I - Font
       temp != 0x74727565 /* true */ &&
       temp != 0x74746366 /* ttcf */)
   {
-    errorf(font, "Invalid font file - version is 0x%08x.", temp);
+    _ttfError(font, "Invalid font file - version is 0x%08x.", temp);
     return (false);
   }
 
@@ -2451,7 +5566,7 @@ read_table(ttf_t  *font)		// I - Font
     /* Version */
     if ((temp = read_ulong(font)) != 0x10000 && temp != 0x20000)
     {
-      errorf(font, "Unsupported font collection version %f.", temp / 65536.0);
+      _ttfError(font, "Unsupported font collection version %f.", temp / 65536.0);
       return (false);
     }
 
@@ -2460,7 +5575,7 @@ read_table(ttf_t  *font)		// I - Font
     /* numFonts */
     if ((temp = read_ulong(font)) == 0)
     {
-      errorf(font, "No fonts in collection.");
+      _ttfError(font, "No fonts in collection.");
       return (false);
     }
 
@@ -2480,7 +5595,7 @@ read_table(ttf_t  *font)		// I - Font
 
     if (!(font->seek_cb)(font, temp + 4))
     {
-      errorf(font, "Unable to seek to font %u: %s", (unsigned)font->idx, strerror(errno));
+      _ttfError(font, "Unable to seek to font %u: %s", (unsigned)font->idx, strerror(errno));
       return (false);
     }
   }
@@ -2493,7 +5608,7 @@ read_table(ttf_t  *font)		// I - Font
   // numTables
   if ((font->table.num_entries = read_ushort(font)) <= 0)
   {
-    errorf(font, "Unable to read font tables.");
+    _ttfError(font, "Unable to read font tables.");
     return (false);
   }
 
@@ -2502,21 +5617,21 @@ read_table(ttf_t  *font)		// I - Font
   // searchRange
   if (read_ushort(font) < 0)
   {
-    errorf(font, "Unable to read font tables.");
+    _ttfError(font, "Unable to read font tables.");
     return (false);
   }
 
   // entrySelector
   if (read_ushort(font) < 0)
   {
-    errorf(font, "Unable to read font tables.");
+    _ttfError(font, "Unable to read font tables.");
     return (false);
   }
 
   // rangeShift
   if (read_ushort(font) < 0)
   {
-    errorf(font, "Unable to read font tables.");
+    _ttfError(font, "Unable to read font tables.");
     return (false);
   }
 
@@ -2526,7 +5641,7 @@ read_table(ttf_t  *font)		// I - Font
 
   if ((font->table.entries = calloc((size_t)font->table.num_entries, sizeof(_ttf_off_dir_t))) == NULL)
   {
-    errorf(font, "Unable to allocate memory for font tables.");
+    _ttfError(font, "Unable to allocate memory for font tables.");
     return (false);
   }
 
@@ -2609,7 +5724,7 @@ seek_table(ttf_t    *font,		// I - Font
       else
       {
         // Seek failed...
-        errorf(font, "Unable to seek to %c%c%c%c table: %s", (tag >> 24) & 255, (tag >> 16) & 255, (tag >> 8) & 255, tag & 255, strerror(errno));
+        _ttfError(font, "Unable to seek to %c%c%c%c table: %s", (tag >> 24) & 255, (tag >> 16) & 255, (tag >> 8) & 255, tag & 255, strerror(errno));
         TTF_DEBUG("seek_table: Failure, returning 0.\n");
         return (0);
       }
@@ -2618,9 +5733,94 @@ seek_table(ttf_t    *font,		// I - Font
 
   // Not found, return 0...
   if (required)
-    errorf(font, "%c%c%c%c table not found.", (tag >> 24) & 255, (tag >> 16) & 255, (tag >> 8) & 255, tag & 255);
+    _ttfError(font, "%c%c%c%c table not found.", (tag >> 24) & 255, (tag >> 16) & 255, (tag >> 8) & 255, tag & 255);
 
   TTF_DEBUG("seek_table: Not found, returning 0.\n");
 
   return (0);
 }
+
+
+//
+// 'sort_kerning()' - Sort the merged kerning pairs.
+//
+// When a pair appears in more than one subtable the first one wins, so the
+// pairs are sorted along with their original order and the later duplicates
+// are removed.
+//
+
+static void
+sort_kerning(ttf_t *font)		// I - Font
+{
+  unsigned char	*sorted,		// Pairs with their original order
+		*sp,			// Current sorted pair
+		*kp;			// Current kerning pair
+  size_t	i,			// Looping var
+		num_pairs;		// Number of unique pairs
+
+
+  if ((sorted = (unsigned char *)malloc(font->num_kerning * TTF_KERNING_ORDER_SIZE)) == NULL)
+  {
+    // Sort the pairs in place, leaving any duplicates in an arbitrary order...
+    TTF_DEBUG("sort_kerning: Unable to allocate memory for %u kerning pairs, sorting in place.\n", (unsigned)font->num_kerning);
+    qsort(font->kerning_buffer, font->num_kerning, TTF_KERNING_SIZE, (int (*)(const void *, const void *))compare_kerning);
+    return;
+  }
+
+  // Each sorted pair holds the left and right glyphs, the big-endian order of
+  // the pair, and the adjustment...
+  for (i = 0, sp = sorted, kp = font->kerning_buffer; i < font->num_kerning; i ++, sp += TTF_KERNING_ORDER_SIZE, kp += TTF_KERNING_SIZE)
+  {
+    memcpy(sp, kp, 4);
+    sp[4] = (unsigned char)(i >> 24);
+    sp[5] = (unsigned char)(i >> 16);
+    sp[6] = (unsigned char)(i >> 8);
+    sp[7] = (unsigned char)i;
+    sp[8] = kp[4];
+    sp[9] = kp[5];
+  }
+
+  qsort(sorted, font->num_kerning, TTF_KERNING_ORDER_SIZE, (int (*)(const void *, const void *))compare_kerning_order);
+
+  // Then copy the first of each pair back...
+  for (i = 0, num_pairs = 0, sp = sorted, kp = font->kerning_buffer; i < font->num_kerning; i ++, sp += TTF_KERNING_ORDER_SIZE)
+  {
+    if (num_pairs > 0 && !memcmp(kp - TTF_KERNING_SIZE, sp, 4))
+      continue;
+
+    memcpy(kp, sp, 4);
+    kp[4] = sp[8];
+    kp[5] = sp[9];
+
+    kp += TTF_KERNING_SIZE;
+    num_pairs ++;
+  }
+
+  TTF_DEBUG("sort_kerning: %u of %u pairs are unique.\n", (unsigned)num_pairs, (unsigned)font->num_kerning);
+
+  font->num_kerning = num_pairs;
+
+  free(sorted);
+}
+
+
+//
+// 'store_extents()' - Store a string in the extents cache.
+//
+
+static void
+store_extents(
+    ttf_t                *font,		// I - Font
+    const _ttf_extents_t *cached)	// I - Extents to cache
+{
+  _ttf_extents_shard_t	*shard;		// Shard for this string
+  _ttf_extents_t	*entry;		// Cache entry for this string
+
+
+  shard = font->extents + (cached->hash % TTF_EXTENTS_SHARDS);
+  entry = shard->entries + (cached->hash / TTF_EXTENTS_SHARDS) % shard->num_entries;
+
+  _ttfMutexLock(&shard->mutex);
+  memcpy(entry, cached, sizeof(_ttf_extents_t));
+  _ttfMutexUnlock(&shard->mutex);
+}
@@ -0,0 +1,698 @@
+//
+// Glyph outline code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+
+
+//
+// Constants...
+//
+
+#define TTF_GLYF_ARG_1_AND_2_ARE_WORDS	0x0001
+#define TTF_GLYF_ARGS_ARE_XY_VALUES	0x0002
+#define TTF_GLYF_WE_HAVE_A_SCALE	0x0008
+#define TTF_GLYF_MORE_COMPONENTS	0x0020
+#define TTF_GLYF_WE_HAVE_AN_X_AND_Y_SCALE 0x0040
+#define TTF_GLYF_WE_HAVE_A_TWO_BY_TWO	0x0080
+#define TTF_GLYF_SCALED_COMPONENT_OFFSET 0x0800
+
+#define TTF_GLYF_ON_CURVE_POINT		0x01
+#define TTF_GLYF_X_SHORT_VECTOR		0x02
+#define TTF_GLYF_Y_SHORT_VECTOR		0x04
+#define TTF_GLYF_REPEAT_FLAG		0x08
+#define TTF_GLYF_X_IS_SAME_OR_POSITIVE	0x10
+#define TTF_GLYF_Y_IS_SAME_OR_POSITIVE	0x20
+
+#define TTF_GLYF_MAX_DEPTH	8	// Maximum composite glyph nesting
+#define TTF_OUTLINE_CACHE_MAX	256	// Maximum number of cached outlines per font
+
+
+//
+// Local types...
+//
+
+typedef struct _ttf_path_buffer_s	// Path segment buffer
+{
+  float		scale;			// Scaling factor to 1000ths
+  size_t	num_path,		// Number of segments
+		alloc_path;		// Allocated segments
+  ttf_path_t	*path;			// Segments
+  bool		error;			// Out of memory?
+} _ttf_path_buffer_t;
+
+
+//
+// Local functions...
+//
+
+static void	emit_point(_ttf_outline_cb_t cb, void *data, const float *matrix, _ttf_outline_t op, float x1, float y1, float x2, float y2);
+static bool	get_glyf_outline(ttf_t *font, unsigned glyph, const float *matrix, int depth, _ttf_outline_cb_t cb, void *data);
+static bool	get_outline(ttf_t *font, int glyph, const ttf_path_t **path, size_t *num_path);
+static void	path_cb(_ttf_path_buffer_t *pb, _ttf_outline_t op, const float *points);
+
+
+//
+// 'ttfGetGlyphOutline()' - Get the outline of a glyph.
+//
+// This function calls "cb" for each segment of the glyph's outline, relative
+// to the glyph origin in 1000ths.  TrueType ("glyf") outlines use quadratic
+// curves and CFF outlines use cubic curves.  Every contour starts with a
+// `TTF_PATH_MOVE` segment and ends with a `TTF_PATH_CLOSE` segment.
+//
+// Decoded outlines are kept in a per-font cache of recently used glyphs.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfGetGlyphOutline(ttf_t         *font,	// I - Font
+                   int           glyph,	// I - Glyph index
+                   ttf_path_cb_t cb,	// I - Outline callback
+                   void          *cbdata)
+					// I - Outline callback data
+{
+  const ttf_path_t	*path;		// Cached path segments
+  ttf_path_t		*copy = NULL;	// Copy of path segments
+  size_t		i,		// Looping var
+			num_path;	// Number of path segments
+
+
+  // Range check input...
+  if (!font || !cb)
+    return (false);
+
+  // Copy the outline so the callback does not run with the font locked...
+  _ttfMutexLock(&font->lock);
+
+  if (!get_outline(font, glyph, &path, &num_path) || (num_path > 0 && (copy = malloc(num_path * sizeof(ttf_path_t))) == NULL))
+  {
+    _ttfMutexUnlock(&font->lock);
+    return (false);
+  }
+
+  if (num_path > 0)
+    memcpy(copy, path, num_path * sizeof(ttf_path_t));
+
+  _ttfMutexUnlock(&font->lock);
+
+  // Send the segments to the callback...
+  for (i = 0; i < num_path; i ++)
+    (cb)(cbdata, copy + i);
+
+  free(copy);
+
+  return (true);
+}
+
+
+//
+// 'ttfGetGlyphPath()' - Get the outline of a glyph as an array of path segments.
+//
+// This function copies up to "max_path" segments of the glyph's outline to the
+// "path" array and returns the total number of segments in the outline, which
+// can be larger than "max_path".  Pass `NULL` and `0` to get the number of
+// segments.  See @link ttfGetGlyphOutline@ for a description of the segments.
+//
+
+size_t					// O - Number of segments or `0` if empty or on error
+ttfGetGlyphPath(ttf_t      *font,	// I - Font
+                int        glyph,	// I - Glyph index
+                ttf_path_t *path,	// O - Path segments or `NULL`
+                size_t     max_path)	// I - Maximum number of path segments
+{
+  const ttf_path_t	*cpath;		// Cached path segments
+  size_t		num_path;	// Number of path segments
+
+
+  // Range check input...
+  if (!font || (!path && max_path > 0))
+    return (0);
+
+  _ttfMutexLock(&font->lock);
+
+  if (get_outline(font, glyph, &cpath, &num_path))
+  {
+    if (num_path > 0 && max_path > 0)
+      memcpy(path, cpath, (num_path < max_path ? num_path : max_path) * sizeof(ttf_path_t));
+  }
+  else
+  {
+    num_path = 0;
+  }
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (num_path);
+}
+
+
+//
+// 'emit_point()' - Transform and send an outline point or curve.
+//
+
+static void
+emit_point(_ttf_outline_cb_t cb,	// I - Outline callback
+           void              *data,	// I - Outline callback data
+           const float       *matrix,	// I - Transform matrix
+           _ttf_outline_t    op,	// I - Outline operation
+           float             x1,	// I - First X position
+           float             y1,	// I - First Y position
+           float             x2,	// I - Second X position (quadratic curves)
+           float             y2)	// I - Second Y position (quadratic curves)
+{
+  float	points[4];			// Transformed points
+
+
+  points[0] = matrix[0] * x1 + matrix[2] * y1 + matrix[4];
+  points[1] = matrix[1] * x1 + matrix[3] * y1 + matrix[5];
+  points[2] = matrix[0] * x2 + matrix[2] * y2 + matrix[4];
+  points[3] = matrix[1] * x2 + matrix[3] * y2 + matrix[5];
+
+  (cb)(data, op, points);
+}
+
+
+//
+// 'get_glyf_outline()' - Decode a TrueType glyph outline.
+//
+// Simple glyphs are sent as quadratic curves with the implied on-curve points
+// added.  Composite glyphs are decoded recursively with each component's
+// transform.  Components positioned by point numbers are not supported and
+// are placed at the origin.
+//
+
+static bool				// O - `true` on success, `false` on error
+get_glyf_outline(
+    ttf_t             *font,		// I - Font
+    unsigned          glyph,		// I - Glyph index
+    const float       *matrix,		// I - Transform matrix
+    int               depth,		// I - Composite nesting depth
+    _ttf_outline_cb_t cb,		// I - Outline callback
+    void              *data)		// I - Outline callback data
+{
+  const unsigned char	*gdata,		// Glyph data
+			*gptr,		// Pointer into glyph data
+			*gend;		// End of glyph data
+  size_t		bytes;		// Size of glyph data
+  int			num_contours;	// Number of contours
+  unsigned		num_points,	// Number of points
+			i,		// Looping var
+			start,		// First point in contour
+			end;		// Last point in contour
+  unsigned char		*flags;		// Point flags
+  short			*xs,		// X coordinates
+			*ys;		// Y coordinates
+  int			value;		// Current coordinate
+
+
+  if ((gdata = _ttfGetGlyphData(font, glyph, &bytes)) == NULL)
+    return (false);
+
+  if (bytes == 0)
+    return (true);			// Empty glyph
+
+  if (bytes < 10)
+    return (false);
+
+  gend         = gdata + bytes;
+  num_contours = TTF_GET_SHORT(gdata);
+
+  if (num_contours < 0)
+  {
+    // Composite glyph: flags, glyphIndex, argument1, argument2, and an
+    // optional transform for each component...
+    unsigned	cflags;			// Component flags
+    unsigned	component;		// Component glyph
+    float	a = 1.0f, b = 0.0f,	// Component transform
+		c = 0.0f, d = 1.0f,
+		dx, dy;
+    float	cmatrix[6];		// Combined transform
+
+    if (depth >= TTF_GLYF_MAX_DEPTH)
+      return (false);
+
+    gptr = gdata + 10;
+
+    do
+    {
+      if ((gend - gptr) < 4)
+        return (false);
+
+      cflags    = TTF_GET_USHORT(gptr);
+      component = TTF_GET_USHORT(gptr + 2);
+      gptr      += 4;
+
+      if (cflags & TTF_GLYF_ARG_1_AND_2_ARE_WORDS)
+      {
+        if ((gend - gptr) < 4)
+          return (false);
+
+        dx   = TTF_GET_SHORT(gptr);
+        dy   = TTF_GET_SHORT(gptr + 2);
+        gptr += 4;
+      }
+      else
+      {
+        if ((gend - gptr) < 2)
+          return (false);
+
+        dx   = (signed char)gptr[0];
+        dy   = (signed char)gptr[1];
+        gptr += 2;
+      }
+
+      if (!(cflags & TTF_GLYF_ARGS_ARE_XY_VALUES))
+        dx = dy = 0.0f;			// Point numbers are not supported
+
+      a = d = 1.0f;
+      b = c = 0.0f;
+
+      if (cflags & TTF_GLYF_WE_HAVE_A_SCALE)
+      {
+        if ((gend - gptr) < 2)
+          return (false);
+
+        a = d = TTF_GET_SHORT(gptr) / 16384.0f;
+        gptr += 2;
+      }
+      else if (cflags & TTF_GLYF_WE_HAVE_AN_X_AND_Y_SCALE)
+      {
+        if ((gend - gptr) < 4)
+          return (false);
+
+        a    = TTF_GET_SHORT(gptr) / 16384.0f;
+        d    = TTF_GET_SHORT(gptr + 2) / 16384.0f;
+        gptr += 4;
+      }
+      else if (cflags & TTF_GLYF_WE_HAVE_A_TWO_BY_TWO)
+      {
+        if ((gend - gptr) < 8)
+          return (false);
+
+        a    = TTF_GET_SHORT(gptr) / 16384.0f;
+        b    = TTF_GET_SHORT(gptr + 2) / 16384.0f;
+        c    = TTF_GET_SHORT(gptr + 4) / 16384.0f;
+        d    = TTF_GET_SHORT(gptr + 6) / 16384.0f;
+        gptr += 8;
+      }
+
+      if (cflags & TTF_GLYF_SCALED_COMPONENT_OFFSET)
+      {
+        float tx = a * dx + c * dy;	// Scaled offset
+
+        dy = b * dx + d * dy;
+        dx = tx;
+      }
+
+      // Combine the component transform with the current one...
+      cmatrix[0] = matrix[0] * a + matrix[2] * b;
+      cmatrix[1] = matrix[1] * a + matrix[3] * b;
+      cmatrix[2] = matrix[0] * c + matrix[2] * d;
+      cmatrix[3] = matrix[1] * c + matrix[3] * d;
+      cmatrix[4] = matrix[0] * dx + matrix[2] * dy + matrix[4];
+      cmatrix[5] = matrix[1] * dx + matrix[3] * dy + matrix[5];
+
+      if (!get_glyf_outline(font, component, cmatrix, depth + 1, cb, data))
+        return (false);
+    }
+    while (cflags & TTF_GLYF_MORE_COMPONENTS);
+
+    return (true);
+  }
+  else if (num_contours == 0)
+  {
+    return (true);
+  }
+
+  // Simple glyph: endPtsOfContours[numberOfContours], instructionLength,
+  // instructions[], flags[], xCoordinates[], yCoordinates[]
+  if ((size_t)(gend - gdata) < (12 + 2 * (size_t)num_contours))
+    return (false);
+
+  num_points = TTF_GET_USHORT(gdata + 10 + 2 * (num_contours - 1)) + 1;
+  gptr       = gdata + 12 + 2 * num_contours;
+  gptr       += TTF_GET_USHORT(gptr - 2);
+
+  // Allocate the X and Y coordinates and flags together...
+  if (gptr > gend || (xs = malloc(num_points * (2 * sizeof(short) + 1))) == NULL)
+    return (false);
+
+  ys    = xs + num_points;
+  flags = (unsigned char *)(ys + num_points);
+
+  // Read the flags...
+  for (i = 0; i < num_points && gptr < gend;)
+  {
+    unsigned char	flag = *gptr++;	// Current flag
+    unsigned		count = 1;	// Repeat count
+
+    if (flag & TTF_GLYF_REPEAT_FLAG)
+    {
+      if (gptr >= gend)
+        break;
+
+      count += *gptr++;
+    }
+
+    while (count > 0 && i < num_points)
+    {
+      flags[i ++] = flag;
+      count --;
+    }
+  }
+
+  if (i < num_points)
+    goto error;
+
+  // Read the X and Y coordinates...
+  for (i = 0, value = 0; i < num_points; i ++)
+  {
+    if (flags[i] & TTF_GLYF_X_SHORT_VECTOR)
+    {
+      if (gptr >= gend)
+        goto error;
+
+      value += (flags[i] & TTF_GLYF_X_IS_SAME_OR_POSITIVE) ? *gptr : -*gptr;
+      gptr ++;
+    }
+    else if (!(flags[i] & TTF_GLYF_X_IS_SAME_OR_POSITIVE))
+    {
+      if ((gend - gptr) < 2)
+        goto error;
+
+      value += TTF_GET_SHORT(gptr);
+      gptr  += 2;
+    }
+
+    xs[i] = (short)value;
+  }
+
+  for (i = 0, value = 0; i < num_points; i ++)
+  {
+    if (flags[i] & TTF_GLYF_Y_SHORT_VECTOR)
+    {
+      if (gptr >= gend)
+        goto error;
+
+      value += (flags[i] & TTF_GLYF_Y_IS_SAME_OR_POSITIVE) ? *gptr : -*gptr;
+      gptr ++;
+    }
+    else if (!(flags[i] & TTF_GLYF_Y_IS_SAME_OR_POSITIVE))
+    {
+      if ((gend - gptr) < 2)
+        goto error;
+
+      value += TTF_GET_SHORT(gptr);
+      gptr  += 2;
+    }
+
+    ys[i] = (short)value;
+  }
+
+  // Send each contour...
+  for (start = 0, i = 0; i < (unsigned)num_contours; i ++, start = end + 1)
+  {
+    unsigned	first,			// First point to visit
+		count,			// Number of points to visit
+		j,			// Looping var
+		pt;			// Current point
+    float	x0, y0,			// Start of contour
+		cx = 0.0f, cy = 0.0f;	// Pending off-curve control point
+    bool	have_control = false;	// Have a pending control point?
+
+    end = TTF_GET_USHORT(gdata + 10 + 2 * i);
+
+    if (end < start || end >= num_points)
+      goto error;
+
+    if (flags[start] & TTF_GLYF_ON_CURVE_POINT)
+    {
+      // Start on the first point...
+      x0    = xs[start];
+      y0    = ys[start];
+      first = start + 1;
+      count = end - start;
+    }
+    else if (flags[end] & TTF_GLYF_ON_CURVE_POINT)
+    {
+      // Start on the last point...
+      x0    = xs[end];
+      y0    = ys[end];
+      first = start;
+      count = end - start;
+    }
+    else
+    {
+      // Start on the implied point between the last and first points...
+      x0    = 0.5f * (xs[start] + xs[end]);
+      y0    = 0.5f * (ys[start] + ys[end]);
+      first = start;
+      count = end - start + 1;
+    }
+
+    emit_point(cb, data, matrix, _TTF_OUTLINE_MOVE, x0, y0, 0.0f, 0.0f);
+
+    for (j = 0, pt = first; j < count; j ++, pt ++)
+    {
+      if (flags[pt] & TTF_GLYF_ON_CURVE_POINT)
+      {
+        if (have_control)
+          emit_point(cb, data, matrix, _TTF_OUTLINE_QUAD, cx, cy, xs[pt], ys[pt]);
+        else
+          emit_point(cb, data, matrix, _TTF_OUTLINE_LINE, xs[pt], ys[pt], 0.0f, 0.0f);
+
+        have_control = false;
+      }
+      else
+      {
+        if (have_control)
+          emit_point(cb, data, matrix, _TTF_OUTLINE_QUAD, cx, cy, 0.5f * (cx + xs[pt]), 0.5f * (cy + ys[pt]));
+
+        cx           = xs[pt];
+        cy           = ys[pt];
+        have_control = true;
+      }
+    }
+
+    if (have_control)
+      emit_point(cb, data, matrix, _TTF_OUTLINE_QUAD, cx, cy, x0, y0);
+
+    emit_point(cb, data, matrix, _TTF_OUTLINE_CLOSE, 0.0f, 0.0f, 0.0f, 0.0f);
+  }
+
+  free(xs);
+
+  return (true);
+
+  // If we get here the glyph data is bad...
+  error:
+
+  free(xs);
+
+  return (false);
+}
+
+
+//
+// 'get_outline()' - Get the cached outline of a glyph.
+//
+// The caller holds the font lock.  The returned segments are valid until the
+// lock is released.
+//
+
+static bool				// O - `true` on success, `false` on error
+get_outline(ttf_t            *font,	// I - Font
+            int              glyph,	// I - Glyph index
+            const ttf_path_t **path,	// O - Path segments
+            size_t           *num_path)	// O - Number of path segments
+{
+  int			n;		// Cache entry number
+  _ttf_outline_cache_t	*entry;		// Cache entry
+  _ttf_path_buffer_t	pb;		// Path buffer
+  size_t		bytes;		// Size of glyph data
+  static const float	identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+					// Identity transform
+
+
+  *path     = NULL;
+  *num_path = 0;
+
+  if (glyph < 0 || (size_t)glyph >= font->num_glyphs)
+    return (false);
+
+  if (!font->outline_index)
+  {
+    // Allocate the cache...
+    if ((font->outline_index = calloc(font->num_glyphs, sizeof(unsigned short))) == NULL)
+      return (false);
+
+    if ((font->outlines = calloc(TTF_OUTLINE_CACHE_MAX, sizeof(_ttf_outline_cache_t))) == NULL)
+    {
+      free(font->outline_index);
+      font->outline_index = NULL;
+      return (false);
+    }
+
+    font->outline_first = font->outline_last = -1;
+  }
+
+  if ((n = font->outline_index[glyph] - 1) >= 0)
+  {
+    // Use the cached outline...
+    entry = font->outlines + n;
+  }
+  else
+  {
+    // Decode the outline...
+    memset(&pb, 0, sizeof(pb));
+    pb.scale = 1000.0f / font->units;
+
+    if (_ttfGetGlyphData(font, (unsigned)glyph, &bytes))
+    {
+      if (!get_glyf_outline(font, (unsigned)glyph, identity, 0, (_ttf_outline_cb_t)path_cb, &pb))
+        pb.error = true;
+    }
+    else
+    {
+      if (!font->cff_loaded)
+      {
+        font->cff        = _ttfCFFCreate(font);
+        font->cff_loaded = true;
+      }
+
+      if (!font->cff || !_ttfCFFGetOutline(font->cff, (unsigned)glyph, (_ttf_outline_cb_t)path_cb, &pb))
+        pb.error = true;
+    }
+
+    if (pb.error)
+    {
+      free(pb.path);
+      return (false);
+    }
+
+    if (font->num_outlines < TTF_OUTLINE_CACHE_MAX)
+    {
+      // Use a new entry...
+      n = (int)font->num_outlines ++;
+    }
+    else
+    {
+      // Reuse the least recently used entry...
+      n     = font->outline_last;
+      entry = font->outlines + n;
+
+      font->outline_index[entry->glyph] = 0;
+      font->outline_last                = entry->prev;
+      font->outlines[entry->prev].next  = -1;
+
+      free(entry->path);
+    }
+
+    entry           = font->outlines + n;
+    entry->glyph    = glyph;
+    entry->prev     = -1;
+    entry->next     = font->outline_first;
+    entry->num_path = pb.num_path;
+    entry->path     = pb.path;
+
+    if (font->outline_first >= 0)
+      font->outlines[font->outline_first].prev = n;
+    else
+      font->outline_last = n;
+
+    font->outline_first        = n;
+    font->outline_index[glyph] = (unsigned short)(n + 1);
+  }
+
+  if (n != font->outline_first)
+  {
+    // Move the entry to the front of the list...
+    font->outlines[entry->prev].next = entry->next;
+
+    if (entry->next >= 0)
+      font->outlines[entry->next].prev = entry->prev;
+    else
+      font->outline_last = entry->prev;
+
+    entry->prev                              = -1;
+    entry->next                              = font->outline_first;
+    font->outlines[font->outline_first].prev = n;
+    font->outline_first                      = n;
+  }
+
+  *path     = entry->path;
+  *num_path = entry->num_path;
+
+  return (true);
+}
+
+
+//
+// 'path_cb()' - Add an outline segment to a path buffer.
+//
+
+static void
+path_cb(_ttf_path_buffer_t *pb,		// I - Path buffer
+        _ttf_outline_t     op,		// I - Outline operation
+        const float        *points)	// I - Points
+{
+  ttf_path_t	*segment;		// New segment
+
+
+  if (pb->error)
+    return;
+
+  if (pb->num_path >= pb->alloc_path)
+  {
+    if ((segment = realloc(pb->path, (pb->alloc_path + 32) * sizeof(ttf_path_t))) == NULL)
+    {
+      pb->error = true;
+      return;
+    }
+
+    pb->path       = segment;
+    pb->alloc_path += 32;
+  }
+
+  segment = pb->path + pb->num_path ++;
+
+  memset(segment, 0, sizeof(ttf_path_t));
+
+  switch (op)
+  {
+    case _TTF_OUTLINE_MOVE :
+    case _TTF_OUTLINE_LINE :
+        segment->op = op == _TTF_OUTLINE_MOVE ? TTF_PATH_MOVE : TTF_PATH_LINE;
+        segment->x  = pb->scale * points[0];
+        segment->y  = pb->scale * points[1];
+        break;
+
+    case _TTF_OUTLINE_QUAD :
+        segment->op = TTF_PATH_QUAD;
+        segment->x1 = pb->scale * points[0];
+        segment->y1 = pb->scale * points[1];
+        segment->x  = pb->scale * points[2];
+        segment->y  = pb->scale * points[3];
+        break;
+
+    case _TTF_OUTLINE_CUBIC :
+        segment->op = TTF_PATH_CUBIC;
+        segment->x1 = pb->scale * points[0];
+        segment->y1 = pb->scale * points[1];
+        segment->x2 = pb->scale * points[2];
+        segment->y2 = pb->scale * points[3];
+        segment->x  = pb->scale * points[4];
+        segment->y  = pb->scale * points[5];
+        break;
+
+    case _TTF_OUTLINE_CLOSE :
+        segment->op = TTF_PATH_CLOSE;
+        break;
+  }
+}
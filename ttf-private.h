@@ -26,6 +26,7 @@
 #  include <stdio.h>
 #  include <stdlib.h>
 #  include <stdarg.h>
+#  include <stdint.h>
 #  include <string.h>
 #  include <ctype.h>
 #  include <fcntl.h>
@@ -67,11 +68,56 @@
 typedef __int64 ssize_t;		// POSIX type not present on Windows... @private@
 #  else
 #    include <unistd.h>
+#    include <sys/mman.h>
      // Map Windows value for binary file I/O...
 #    define O_BINARY	0
 #  endif // _WIN32
 
 
+//
+// Mutexes protect the caches that are shared between threads...
+//
+
+#  ifdef _WIN32
+#    include <windows.h>
+typedef SRWLOCK _ttf_mutex_t;		// Mutex @private@
+#    define _ttfMutexDestroy(m)
+#    define _ttfMutexInit(m)	InitializeSRWLock(m)
+#    define _ttfMutexLock(m)	AcquireSRWLockExclusive(m)
+#    define _ttfMutexUnlock(m)	ReleaseSRWLockExclusive(m)
+#  else
+#    include <pthread.h>
+typedef pthread_mutex_t _ttf_mutex_t;	// Mutex @private@
+#    define _ttfMutexDestroy(m)	pthread_mutex_destroy(m)
+#    define _ttfMutexInit(m)	pthread_mutex_init((m), NULL)
+#    define _ttfMutexLock(m)	pthread_mutex_lock(m)
+#    define _ttfMutexUnlock(m)	pthread_mutex_unlock(m)
+#  endif // _WIN32
+
+
+//
+// Lazily loaded tables are published with an atomic pointer store so that
+// they can be used without locking once loaded...
+//
+
+#  ifdef _WIN32
+#    define _ttfAtomicGetByte(p) (unsigned char)InterlockedOr8((char volatile *)(p), 0)
+#    define _ttfAtomicGetPtr(p)	InterlockedCompareExchangePointer((PVOID volatile *)(p), NULL, NULL)
+#    define _ttfAtomicOrByte(p,v) InterlockedOr8((char volatile *)(p), (char)(v))
+#    define _ttfAtomicSetPtr(p,v) InterlockedExchangePointer((PVOID volatile *)(p), (PVOID)(v))
+#  elif defined(__GNUC__)
+#    define _ttfAtomicGetByte(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#    define _ttfAtomicGetPtr(p)	__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#    define _ttfAtomicOrByte(p,v) __atomic_fetch_or((p), (v), __ATOMIC_RELEASE)
+#    define _ttfAtomicSetPtr(p,v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  else
+#    define _ttfAtomicGetByte(p) (*(p))
+#    define _ttfAtomicGetPtr(p)	(*(p))
+#    define _ttfAtomicOrByte(p,v) (*(p) |= (v))
+#    define _ttfAtomicSetPtr(p,v) (*(p) = (v))
+#  endif // _WIN32
+
+
 //
 // DEBUG is typically defined for debug builds.  TTF_DEBUG maps to fprintf when
 // DEBUG is defined and is a no-op otherwise...
@@ -94,4 +140,348 @@ typedef __int64 ssize_t;		// POSIX type not present on Windows... @private@
 #  else
 #    define TTF_FORMAT_ARGS(a,b)
 #  endif // __has_extension || __GNUC__
+
+
+//
+// Constants...
+//
+
+#  define TTF_BITMAP_CACHE_BYTES 1048576	// Maximum size of cached glyph bitmaps per font
+#  define TTF_BITMAP_CACHE_MAX	1024	// Maximum number of cached glyph bitmaps per font
+#  define TTF_CFF_CharStrings	17	// CFF CharStrings DICT operator
+#  define TTF_CFF_Private	18	// CFF Private DICT operator
+#  define TTF_CFF_Subrs		19	// CFF Subrs DICT operator
+#  define TTF_CFF_FDArray	(0x0c00 | 36)
+					// CFF FDArray DICT operator
+#  define TTF_CFF_FDSelect	(0x0c00 | 37)
+					// CFF FDSelect DICT operator
+#  define TTF_COVERAGE_PAGES	(TTF_FONT_MAX_CHAR / 256)
+					// Number of 256-character pages
+#  define TTF_COVERAGE_SUMMARY	(TTF_COVERAGE_PAGES / 64)
+					// Number of words in coverage page summary
+#  define TTF_FONT_MAX_CHAR	262144	// Maximum number of character values
+#  define TTF_EXTENTS_MAX_LEN	64	// Maximum length of cached extents strings
+#  define TTF_LATIN_COUNT	191	// Number of printable ASCII/Latin-1 characters
+#  define TTF_LATIN_INDEX(ch)	((ch) >= 0x20 && (ch) < 0x7f ? (ch) - 0x20 : (ch) >= 0xa0 && (ch) < 0x100 ? (ch) - 0x41 : -1)
+					// Index of a printable ASCII/Latin-1 character or -1
+#  define TTF_GET_SHORT(p)	((short)TTF_GET_USHORT(p))
+					// Get a big-endian 16-bit signed integer
+#  define TTF_GET_ULONG(p)	((unsigned)TTF_GET_USHORT(p) << 16 | (unsigned)TTF_GET_USHORT((const unsigned char *)(p) + 2))
+					// Get a big-endian 32-bit unsigned integer
+#  define TTF_GET_USHORT(p)	((unsigned)(((const unsigned char *)(p))[0] << 8 | ((const unsigned char *)(p))[1]))
+					// Get a big-endian 16-bit unsigned integer
+#  define TTF_PIXEL_MAX	256	// Maximum pixel size with cached device metrics
+#  define TTF_KERNING_SIZE	6	// Size of a kerning pair (left, right, adjustment)
+
+
+//
+// Types...
+//
+
+typedef struct _ttf_bitmap_s		// Cached glyph bitmap
+{
+  int		glyph;			// Glyph index or -1 if unused
+  unsigned	size;			// Font size in 1/64th pixels
+  int		prev,			// Previous (more recently used) entry or -1
+		next,			// Next (less recently used or free) entry or -1
+		hash_next;		// Next entry in hash bucket or -1
+  int		left,			// Left edge relative to the origin in pixels
+		top,			// Top edge relative to the baseline in pixels
+		width,			// Width in pixels
+		height;			// Height in pixels
+  unsigned char	*pixels;		// 8-bit coverage values, if any
+} _ttf_bitmap_t;
+
+typedef struct _ttf_bounds_s		// Glyph bounding box
+{
+  short		x_min,			// Left (empty if greater than x_max)
+		y_min,			// Bottom
+		x_max,			// Right
+		y_max;			// Top
+} _ttf_bounds_t;
+
+typedef struct _ttf_cff_index_s		// CFF INDEX
+{
+  size_t	offset,			// Offset of INDEX
+		end;			// Offset after INDEX
+  unsigned	count,			// Number of objects
+		off_size;		// Size of offsets
+} _ttf_cff_index_t;
+
+typedef struct _ttf_cff_s		// CFF outline data
+{
+  const unsigned char *data;		// CFF table
+  size_t	length;			// Length of CFF table
+  _ttf_cff_index_t charstrings,		// CharStrings INDEX
+		gsubrs;			// Global Subrs INDEX
+  size_t	num_subrs;		// Number of local Subrs INDEXes
+  _ttf_cff_index_t *subrs;		// Local Subrs INDEX for each Font DICT
+  const unsigned char *fdselect;	// FDSelect data or `NULL`
+  size_t	fdselect_length;	// Maximum length of FDSelect data
+} _ttf_cff_t;
+
+struct _ttf_coverage_s			// Character coverage
+{
+  uint64_t	summary[TTF_COVERAGE_SUMMARY];
+					// Bitset of pages with characters
+  unsigned short rank[TTF_COVERAGE_SUMMARY];
+					// Number of page bitsets before each summary word
+  bool		printable;		// Are all printable ASCII characters covered?
+  size_t	num_pages,		// Number of page bitsets
+		alloc_pages;		// Allocated page bitsets (0 if not owned)
+  uint64_t	(*pages)[4];		// Page bitsets (256 bits each) in page order
+};
+
+typedef struct _ttf_extents_s		// Cached string extents
+{
+  unsigned	hash;			// Hash of string
+  bool		kerned;			// Kerned extents?
+  float		left;			// Left offset
+  int		width;			// Width in font units
+  size_t	num_adjs;		// Number of kerning adjustments
+  short		adjs[TTF_EXTENTS_MAX_LEN];
+					// Kerning adjustments in font units
+  char		s[TTF_EXTENTS_MAX_LEN];	// String
+} _ttf_extents_t;
+
+typedef struct _ttf_extents_shard_s	// Extents cache shard
+{
+  _ttf_mutex_t	mutex;			// Mutex for this shard
+  size_t	num_entries;		// Number of entries
+  _ttf_extents_t *entries;		// Entries
+  size_t	hits,			// Number of cache hits
+		misses;			// Number of cache misses
+} _ttf_extents_shard_t;
+
+typedef struct _ttf_instance_s		// Named variation instance
+{
+  char		*name;			// Subfamily name, if any
+  float		*coords;		// User-space axis coordinates
+} _ttf_instance_t;
+
+typedef struct _ttf_kern_class_s	// Class-based kerning subtable
+{
+  unsigned	first_left,		// First left glyph
+		num_left,		// Number of left glyphs
+		first_right,		// First right glyph
+		num_right,		// Number of right glyphs
+		num_right_classes;	// Number of right classes
+  unsigned short *left_classes,		// Left glyph classes (`0xffff` if not covered)
+		*right_classes;		// Right glyph classes
+  short		*values;		// Adjustments for each left and right class
+} _ttf_kern_class_t;
+
+typedef struct _ttf_liga_s		// Ligature trie node
+{
+  unsigned short glyph,			// Component glyph
+		ligature;		// Ligature glyph or 0 if none
+  unsigned	children,		// First node for the next component or 0 if none
+		next;			// Next node for this component or 0 if none
+} _ttf_liga_t;
+
+typedef struct _ttf_metric_s		// Font metric information
+{
+  short		width,			// Advance width
+		left_bearing;		// Left side bearing
+} _ttf_metric_t;
+
+typedef struct _ttf_off_dir_s		// OFF/TTF directory entry
+{
+  unsigned	tag;			// Table identifier
+  unsigned	checksum;		// Checksum of table
+  unsigned	offset;			// Offset from the beginning of the file
+  unsigned	length;			// Length
+} _ttf_off_dir_t;
+
+typedef struct _ttf_off_table_s		// OFF/TTF offset table
+{
+  int		num_entries;		// Number of table entries
+  _ttf_off_dir_t *entries;		// Table entries
+} _ttf_off_table_t;
+
+typedef struct _ttf_off_name_s		// OFF/TTF name string
+{
+  unsigned short platform_id,		// Platform identifier
+		encoding_id,		// Encoding identifier
+		language_id,		// Language identifier
+		name_id,		// Name identifier
+		length,			// Length of string
+		offset;			// Offset from start of storage area
+} _ttf_off_name_t;
+
+typedef struct _ttf_off_names_s		// OFF/TTF naming table
+{
+  int		num_names;		// Number of names
+  _ttf_off_name_t *names;		// Names
+  unsigned char	*storage;		// Storage area
+  unsigned	storage_size;		// Size of storage area
+} _ttf_off_names_t;
+
+typedef enum _ttf_outline_e		// Outline operations
+{
+  _TTF_OUTLINE_MOVE,			// Start a contour at (x,y)
+  _TTF_OUTLINE_LINE,			// Line to (x,y)
+  _TTF_OUTLINE_QUAD,			// Quadratic curve to (x2,y2) via (x1,y1)
+  _TTF_OUTLINE_CUBIC,			// Cubic curve to (x3,y3) via (x1,y1) and (x2,y2)
+  _TTF_OUTLINE_CLOSE			// Close the contour
+} _ttf_outline_t;
+
+typedef void (*_ttf_outline_cb_t)(void *data, _ttf_outline_t op, const float *points);
+				// Outline callback
+
+typedef struct _ttf_outline_cache_s	// Cached glyph outline
+{
+  int		glyph;			// Glyph index
+  int		prev,			// Previous (more recently used) entry or -1
+		next;			// Next (less recently used) entry or -1
+  size_t	num_path;		// Number of path segments
+  ttf_path_t	*path;			// Path segments in 1000ths
+} _ttf_outline_cache_t;
+
+typedef struct _ttf_pixel_s		// Device metrics for a pixel size
+{
+  unsigned char	loaded;			// Have the metrics been loaded?
+  const unsigned char *widths;		// Advance widths from hdmx table or `NULL`
+  bool		have_bounds;		// Have y_max/y_min from VDMX table?
+  short		y_max,			// Maximum height in pixels
+		y_min;			// Minimum height in pixels
+} _ttf_pixel_t;
+
+typedef struct _ttf_var_s		// Cached variation instance
+{
+  short		*coords;		// Normalized axis coordinates (F2Dot14)
+  ttf_t		*font;			// Instance font
+} _ttf_var_t;
+
+typedef size_t (*_ttf_read_cb_t)(ttf_t *font, void *buffer, size_t bytes);
+				// Font read callback, returns number of bytes read
+typedef bool (*_ttf_seek_cb_t)(ttf_t *font, size_t offset);
+				// Font seek callback, returns `true` on success
+
+struct _ttf_s
+{
+  _ttf_read_cb_t read_cb;		// Read callback
+  _ttf_seek_cb_t seek_cb;		// Seek callback
+  void		*file_data;		// Mapped or loaded file for ttfCreate
+  bool		file_mapped;		// Is the file memory-mapped?
+  const char	*data;			// Font data
+  size_t	data_size;		// Size of font data
+  size_t	data_offset;		// Offset within input
+  size_t	idx;			// Font number in file
+  ttf_err_cb_t	err_cb;			// Error callback, if any
+  void		*err_cbdata;		// Error callback data
+  _ttf_off_table_t table;		// Offset table
+  _ttf_off_names_t names;		// Names
+  size_t	num_fonts;		// Number of fonts in this file
+  char		*copyright;		// Copyright string
+  char		*family;		// Font family string
+  char		*postscript_name;	// PostScript name string
+  char		*version;		// Font version string
+  bool		is_fixed;		// Is this a fixed-width font?
+  int		fixed_width;		// Width of printable ASCII characters in a fixed-width font or 0
+  int		max_char,		// Last character in font
+		min_char;		// First character in font
+  size_t	num_cmap;		// Number of entries in glyph map
+  int		*cmap;			// Unicode character to glyph map
+  ttf_coverage_t *coverage;		// Character coverage, if loaded
+  _ttf_metric_t	*widths[TTF_FONT_MAX_CHAR / 256];
+					// Character metrics (sparse array)
+  size_t	num_glyphs,		// Number of glyphs
+		num_glyph_widths;	// Number of glyph metrics
+  _ttf_metric_t	*glyph_widths,		// Glyph metrics
+		def_width;		// Metrics for glyphs past the end
+  size_t	num_kerning;		// Number of kerning pairs
+  const unsigned char *kerning;		// Sorted big-endian kerning pairs
+  unsigned char	*kerning_buffer;	// Merged kerning pairs, if not in the font data
+  size_t	num_kerning_index;	// Number of kerning index entries
+  unsigned	*kerning_index;		// First kerning pair for each left glyph
+  size_t	num_kern_classes;	// Number of class-based kerning subtables
+  _ttf_kern_class_t *kern_classes;	// Class-based kerning subtables
+  _ttf_mutex_t	lock;			// Lock for lazily loaded data
+  bool		use_ligatures;		// Apply ligatures when measuring?
+  unsigned char	ligatures_loaded;	// Have the ligatures been loaded?
+  unsigned	*liga_index;		// First ligature node for each glyph, if any
+  size_t	num_liga,		// Number of ligature nodes
+		alloc_liga;		// Allocated ligature nodes
+  _ttf_liga_t	*liga;			// Ligature nodes
+  _ttf_pixel_t	*pixels;		// Device metrics for each pixel size, if loaded
+  bool		cff_loaded;		// Has the CFF outline data been loaded?
+  _ttf_cff_t	*cff;			// CFF outline data, if any
+  _ttf_bounds_t	*glyph_bounds;		// Glyph bounding boxes, if loaded
+  unsigned char	*glyph_bounds_loaded;	// Bitset of loaded glyph bounding boxes
+  unsigned short *outline_index;	// Outline cache entry plus 1 for each glyph, if any
+  size_t	num_outlines;		// Number of cached outlines
+  _ttf_outline_cache_t *outlines;	// Cached outlines, if any
+  int		outline_first,		// Most recently used outline
+		outline_last;		// Least recently used outline
+  _ttf_bitmap_t	*bitmaps;		// Cached glyph bitmaps, if any
+  int		*bitmap_hash;		// First cached bitmap in each hash bucket
+  int		bitmap_first,		// Most recently used bitmap
+		bitmap_last,		// Least recently used bitmap
+		bitmap_free;		// First unused bitmap
+  size_t	bitmap_bytes;		// Size of cached bitmap pixels
+  bool		var_loaded;		// Has the fvar table been loaded?
+  size_t	num_axes;		// Number of variation axes
+  ttf_axis_t	*axes;			// Variation axes
+  size_t	num_instances;		// Number of named instances
+  _ttf_instance_t *instances;		// Named instances
+  size_t	num_vars;		// Number of cached variation instances
+  _ttf_var_t	*vars;			// Cached variation instances
+  unsigned char	vertical_loaded;	// Have the vertical metrics been loaded?
+  size_t	num_vert_metrics;	// Number of vertical glyph metrics
+  _ttf_metric_t	*vert_metrics,		// Vertical glyph metrics (advance height and top side bearing)
+		def_vert_metric;	// Vertical metrics for fonts without a "vmtx" table
+  const unsigned char *vorg;		// Vertical origin records from "VORG" table, if any
+  size_t	num_vorg;		// Number of vertical origin records
+  short		def_vorg;		// Default vertical origin
+  int		*unicodes;		// Glyph to Unicode map, if loaded
+  size_t	num_width_ranges;	// Number of width ranges
+  ttf_glyph_range_t *width_ranges;	// Width ranges for all glyphs, if loaded
+  short		*latin_kerning;		// Printable ASCII/Latin-1 kerning matrix, if loaded
+  _ttf_extents_shard_t *extents;	// Extents cache, if any
+  float		units;			// Width units
+  short		ascent,			// Maximum ascent above baseline
+		descent,		// Maximum descent below baseline
+		line_gap,		// Gap between lines
+		typo_ascent,		// Typographic ascent
+		typo_descent,		// Typographic descent
+		typo_line_gap,		// Typographic gap between lines
+		cap_height,		// "A" height
+		x_height,		// "x" height
+		x_max,			// Bounding box
+		x_min,
+		y_max,
+		y_min,
+		weight;			// Font weight
+  bool		use_typo;		// Use typographic metrics for line height?
+  float		italic_angle;		// Angle of italic text
+  ttf_stretch_t	stretch;		// Font stretch value
+  ttf_style_t	style;			// Font style
+};
+
+
+//
+// Functions...
+//
+
+extern _ttf_cff_t *_ttfCFFCreate(ttf_t *font);
+extern void	_ttfCFFDelete(_ttf_cff_t *cff);
+extern bool	_ttfCFFGetDict(const unsigned char *data, size_t length, unsigned op, int *values, unsigned num_values);
+extern bool	_ttfCFFGetIndex(const unsigned char *cff, size_t length, size_t offset, _ttf_cff_index_t *index);
+extern size_t	_ttfCFFGetObject(const unsigned char *cff, const _ttf_cff_index_t *index, unsigned n, size_t *bytes);
+extern bool	_ttfCFFGetOutline(_ttf_cff_t *cff, unsigned glyph, _ttf_outline_cb_t cb, void *data);
+extern char	*_ttfCopyName(ttf_t *font, unsigned name_id);
+extern bool	_ttfCoverageAddPage(ttf_coverage_t *coverage, unsigned page, const uint64_t *bits);
+extern int	_ttfCoverageGetPage(const ttf_coverage_t *coverage, size_t n, uint64_t *bits);
+extern bool	_ttfCoverageSetPages(ttf_coverage_t *coverage, const uint64_t *summary, const uint64_t (*pages)[4], size_t num_pages);
+extern size_t	_ttfCountPrintable(const char *s, size_t len);
+extern void	_ttfError(ttf_t *font, const char *message, ...) TTF_FORMAT_ARGS(2,3);
+extern const unsigned char *_ttfGetGlyphData(ttf_t *font, unsigned glyph, size_t *bytes);
+extern int	_ttfGetKerning(ttf_t *font, int left, int right);
+extern const short *_ttfGetLatinKerning(ttf_t *font);
+extern const unsigned char *_ttfGetTable(ttf_t *font, unsigned tag, size_t *length);
+extern int	_ttfNextUnicode(ttf_t *font, const char **s);
+extern void	_ttfVarDelete(ttf_t *font);
+
+
 #endif // !TTF_PRIVATE_H
@@ -0,0 +1,840 @@
+//
+// Glyph rasterization code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+#include <math.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#  define TTF_USE_SSE2 1
+#endif // __SSE2__ || _M_X64
+
+
+//
+// Constants...
+//
+
+#define TTF_BITMAP_HASH_SIZE	1024	// Number of bitmap hash buckets
+#define TTF_BITMAP_HASH(g,s)	(((unsigned)(g) * 31 + (s)) & (TTF_BITMAP_HASH_SIZE - 1))
+#define TTF_RASTER_MAX_SIZE	2048	// Maximum width or height of a glyph bitmap
+
+
+//
+// Local functions...
+//
+
+static void	accumulate(const float *acc, unsigned char *pixels, int width);
+static _ttf_bitmap_t *add_bitmap(ttf_t *font, _ttf_bitmap_t *temp);
+static void	blit_bitmap(const _ttf_bitmap_t *bitmap, unsigned char *pixels, int width, int height, int stride, int x, int y);
+static void	draw_line(float *acc, int width, int height, float x0, float y0, float x1, float y1);
+static _ttf_bitmap_t *find_bitmap(ttf_t *font, int glyph, unsigned size);
+static bool	rasterize_glyph(ttf_t *font, int glyph, unsigned size, _ttf_bitmap_t *bitmap);
+static bool	render_glyph(ttf_t *font, int glyph, unsigned size, unsigned char *pixels, int width, int height, int stride, int x, int y);
+
+
+//
+// 'ttfRenderGlyph()' - Render a glyph into an 8-bit grayscale buffer.
+//
+// This function renders the glyph at the pen position ("x","y") in pixels,
+// where "y" is the baseline and increases downwards.  The "size" argument
+// specifies the font size in pixels.  Coverage values from `0` (none) to `255`
+// (full) are composited with the values already in the buffer.
+//
+// Rendered glyphs are kept in a per-font cache of recently used bitmaps so
+// that repeated glyphs are copied instead of being rasterized again.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfRenderGlyph(ttf_t         *font,	// I - Font
+               float         size,	// I - Font size in pixels
+               int           glyph,	// I - Glyph index
+               unsigned char *pixels,	// I - Grayscale buffer
+               int           width,	// I - Width of buffer in pixels
+               int           height,	// I - Height of buffer in pixels
+               int           stride,	// I - Bytes per line in buffer
+               float         x,		// I - X position of origin in pixels
+               float         y)		// I - Y position of baseline in pixels
+{
+  if (!font || glyph < 0 || (size_t)glyph >= font->num_glyphs || size <= 0.0f || size > TTF_RASTER_MAX_SIZE || !pixels || width <= 0 || height <= 0 || stride < width)
+    return (false);
+
+  return (render_glyph(font, glyph, (unsigned)(size * 64.0f + 0.5f), pixels, width, height, stride, (int)floorf(x + 0.5f), (int)floorf(y + 0.5f)));
+}
+
+
+//
+// 'ttfRenderString()' - Render a string into an 8-bit grayscale buffer.
+//
+// This function renders the UTF-8 string "s" starting at the pen position
+// ("x","y") in pixels, where "y" is the baseline and increases downwards.  The
+// "size" argument specifies the font size in pixels.  Kerning is applied but
+// ligatures and newlines are not.  Glyphs are clipped to the buffer.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfRenderString(ttf_t         *font,	// I - Font
+                float         size,	// I - Font size in pixels
+                const char    *s,	// I - UTF-8 string
+                unsigned char *pixels,	// I - Grayscale buffer
+                int           width,	// I - Width of buffer in pixels
+                int           height,	// I - Height of buffer in pixels
+                int           stride,	// I - Bytes per line in buffer
+                float         x,	// I - X position of origin in pixels
+                float         y)	// I - Y position of baseline in pixels
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		prev = -1,		// Previous glyph
+		pen = 0,		// Pen position in font units
+		iy = (int)floorf(y + 0.5f);
+					// Baseline in pixels
+  unsigned	isize;			// Size in 1/64th pixels
+  float		scale;			// Font units to pixels
+
+
+  if (!font || !s || size <= 0.0f || size > TTF_RASTER_MAX_SIZE || !pixels || width <= 0 || height <= 0 || stride < width)
+    return (false);
+
+  isize = (unsigned)(size * 64.0f + 0.5f);
+  scale = size / font->units;
+
+  while (*s)
+  {
+    ch = _ttfNextUnicode(font, &s);
+
+    if (ch < (int)font->num_cmap && font->cmap[ch] > 0)
+      glyph = font->cmap[ch];
+    else
+      glyph = 0;
+
+    if (prev >= 0)
+      pen += _ttfGetKerning(font, prev, glyph);
+
+    if (!render_glyph(font, glyph, isize, pixels, width, height, stride, (int)floorf(x + pen * scale + 0.5f), iy))
+      return (false);
+
+    if (glyph >= 0 && (size_t)glyph < font->num_glyph_widths)
+      pen += font->glyph_widths[glyph].width;
+    else
+      pen += font->def_width.width;
+
+    prev = glyph;
+  }
+
+  return (true);
+}
+
+
+//
+// 'accumulate()' - Convert a row of signed area accumulations to coverage.
+//
+// The accumulation buffer holds the change in coverage at each pixel, so the
+// running sum across the row gives the coverage of each pixel.  The SSE2 path
+// computes four prefix sums at a time.
+//
+
+static void
+accumulate(const float   *acc,		// I - Accumulation buffer
+           unsigned char *pixels,	// O - Coverage values
+           int           width)		// I - Number of pixels
+{
+  int		x = 0;			// Current column
+  float		sum = 0.0f,		// Running sum
+		v;			// Coverage value
+
+
+#ifdef TTF_USE_SSE2
+  __m128	offset = _mm_setzero_ps(),
+					// Running sum in all lanes
+		sign = _mm_set1_ps(-0.0f),
+					// Sign bit mask
+		one = _mm_set1_ps(1.0f),
+		scale = _mm_set1_ps(255.0f),
+		half = _mm_set1_ps(0.5f),
+		s;			// Prefix sums
+  __m128i	i;			// Integer values
+  int		packed;			// Packed coverage values
+
+
+  for (; (x + 4) <= width; x += 4)
+  {
+    // Compute the prefix sum of four values and add the running sum...
+    s = _mm_loadu_ps(acc + x);
+    s = _mm_add_ps(s, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(s), 4)));
+    s = _mm_add_ps(s, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(s), 8)));
+    s = _mm_add_ps(s, offset);
+    offset = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+
+    // Convert min(|sum|,1) to 0-255 and pack into bytes...
+    s      = _mm_min_ps(_mm_andnot_ps(sign, s), one);
+    i      = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(s, scale), half));
+    i      = _mm_packs_epi32(i, i);
+    i      = _mm_packus_epi16(i, i);
+    packed = _mm_cvtsi128_si32(i);
+
+    memcpy(pixels + x, &packed, 4);
+  }
+
+  sum = _mm_cvtss_f32(offset);
+#endif // TTF_USE_SSE2
+
+  for (; x < width; x ++)
+  {
+    sum += acc[x];
+    v   = fabsf(sum);
+
+    pixels[x] = (unsigned char)(255.0f * (v > 1.0f ? 1.0f : v) + 0.5f);
+  }
+}
+
+
+//
+// 'add_bitmap()' - Add a rasterized glyph to the bitmap cache.
+//
+// The font lock must be held.  The pixels of "temp" are owned by the cache on
+// success.
+//
+
+static _ttf_bitmap_t *			// O - Cached bitmap or `NULL` if not cached
+add_bitmap(ttf_t         *font,		// I - Font
+           _ttf_bitmap_t *temp)		// I - Rasterized glyph
+{
+  int		i,			// Looping var
+		*hptr;			// Pointer into hash chain
+  size_t	bytes = (size_t)temp->width * (size_t)temp->height;
+					// Size of bitmap
+  _ttf_bitmap_t	*bitmap;		// Cached bitmap
+
+
+  if (bytes > TTF_BITMAP_CACHE_BYTES / 4)
+    return (NULL);
+
+  if (!font->bitmaps)
+  {
+    // Allocate the cache the first time...
+    if ((font->bitmaps = calloc(TTF_BITMAP_CACHE_MAX, sizeof(_ttf_bitmap_t))) == NULL)
+      return (NULL);
+
+    if ((font->bitmap_hash = malloc(TTF_BITMAP_HASH_SIZE * sizeof(int))) == NULL)
+    {
+      free(font->bitmaps);
+      font->bitmaps = NULL;
+      return (NULL);
+    }
+
+    for (i = 0; i < TTF_BITMAP_CACHE_MAX; i ++)
+    {
+      font->bitmaps[i].glyph = -1;
+      font->bitmaps[i].next  = i + 1 < TTF_BITMAP_CACHE_MAX ? i + 1 : -1;
+    }
+
+    for (i = 0; i < TTF_BITMAP_HASH_SIZE; i ++)
+      font->bitmap_hash[i] = -1;
+
+    font->bitmap_first = font->bitmap_last = -1;
+    font->bitmap_free  = 0;
+    font->bitmap_bytes = 0;
+  }
+
+  while (font->bitmap_last >= 0 && (font->bitmap_free < 0 || font->bitmap_bytes + bytes > TTF_BITMAP_CACHE_BYTES))
+  {
+    // Evict the least recently used bitmap...
+    i      = font->bitmap_last;
+    bitmap = font->bitmaps + i;
+
+    TTF_DEBUG("add_bitmap: Evicting glyph %d at %u/64 pixels.\n", bitmap->glyph, bitmap->size);
+
+    for (hptr = font->bitmap_hash + TTF_BITMAP_HASH(bitmap->glyph, bitmap->size); *hptr != i; hptr = &font->bitmaps[*hptr].hash_next);
+    *hptr = bitmap->hash_next;
+
+    font->bitmap_last = bitmap->prev;
+    if (bitmap->prev >= 0)
+      font->bitmaps[bitmap->prev].next = -1;
+    else
+      font->bitmap_first = -1;
+
+    font->bitmap_bytes -= (size_t)bitmap->width * (size_t)bitmap->height;
+
+    free(bitmap->pixels);
+    memset(bitmap, 0, sizeof(_ttf_bitmap_t));
+
+    bitmap->glyph     = -1;
+    bitmap->next      = font->bitmap_free;
+    font->bitmap_free = i;
+  }
+
+  // Use the first unused entry...
+  i                 = font->bitmap_free;
+  bitmap            = font->bitmaps + i;
+  font->bitmap_free = bitmap->next;
+
+  *bitmap            = *temp;
+  hptr               = font->bitmap_hash + TTF_BITMAP_HASH(bitmap->glyph, bitmap->size);
+  bitmap->hash_next  = *hptr;
+  *hptr              = i;
+  bitmap->prev       = -1;
+  bitmap->next       = font->bitmap_first;
+  font->bitmap_bytes += bytes;
+
+  if (font->bitmap_first >= 0)
+    font->bitmaps[font->bitmap_first].prev = i;
+  else
+    font->bitmap_last = i;
+
+  font->bitmap_first = i;
+
+  return (bitmap);
+}
+
+
+//
+// 'blit_bitmap()' - Composite a glyph bitmap into a grayscale buffer.
+//
+
+static void
+blit_bitmap(
+    const _ttf_bitmap_t *bitmap,	// I - Glyph bitmap
+    unsigned char       *pixels,	// I - Grayscale buffer
+    int                 width,		// I - Width of buffer
+    int                 height,		// I - Height of buffer
+    int                 stride,		// I - Bytes per line in buffer
+    int                 x,		// I - X position of origin
+    int                 y)		// I - Y position of baseline
+{
+  int			bx, by,		// Position in bitmap
+			left,		// Left edge in buffer
+			top,		// Top edge in buffer
+			xmin, xmax,	// Clipped columns in bitmap
+			ymin, ymax;	// Clipped rows in bitmap
+  const unsigned char	*src;		// Pointer into bitmap
+  unsigned char		*dst;		// Pointer into buffer
+
+
+  left = x + bitmap->left;
+  top  = y - bitmap->top;
+  xmin = left < 0 ? -left : 0;
+  xmax = left + bitmap->width > width ? width - left : bitmap->width;
+  ymin = top < 0 ? -top : 0;
+  ymax = top + bitmap->height > height ? height - top : bitmap->height;
+
+  for (by = ymin; by < ymax; by ++)
+  {
+    src = bitmap->pixels + by * bitmap->width + xmin;
+    dst = pixels + (top + by) * stride + left + xmin;
+
+    for (bx = xmin; bx < xmax; bx ++, src ++, dst ++)
+    {
+      // Composite using "over", which is exact for overlapping glyphs that
+      // don't share edges...
+      if (*src == 255)
+        *dst = 255;
+      else if (*src)
+        *dst = (unsigned char)(*dst + (*src * (255 - *dst) + 127) / 255);
+    }
+  }
+}
+
+
+//
+// 'draw_line()' - Accumulate the signed area of a line.
+//
+// Each pixel that the line crosses gets the fraction of the pixel's area to the
+// right of the line, while the next pixel gets the remainder.  Lines going up
+// and down have opposite signs so that the running sum across a row gives the
+// winding coverage.
+//
+
+static void
+draw_line(float *acc,			// I - Accumulation buffer
+          int   width,			// I - Width of buffer
+          int   height,			// I - Height of buffer
+          float x0,			// I - Starting X
+          float y0,			// I - Starting Y
+          float x1,			// I - Ending X
+          float y1)			// I - Ending Y
+{
+  int	y,				// Current row
+	ystart,				// First row
+	yend,				// Last row
+	xi0, xi1,			// Integer columns
+	xi;				// Current column
+  float	dir,				// Direction of line
+	dxdy,				// Slope of line
+	x,				// Current X
+	xnext,				// X at end of row
+	dy,				// Height within row
+	d,				// Signed height within row
+	xa, xb,				// Sorted X values
+	xmf,				// Midpoint fraction
+	s,				// Inverse width
+	xa_f,				// Fraction of first column
+	xb_f,				// Fraction of last column
+	a0, a1, a2,			// Accumulated areas
+	am;				// Area of last column
+  float	*line;				// Pointer into buffer
+
+
+  if (y0 == y1)
+    return;
+
+  if (y0 < y1)
+  {
+    dir = 1.0f;
+  }
+  else
+  {
+    dir = -1.0f;
+    x   = x0; x0 = x1; x1 = x;
+    x   = y0; y0 = y1; y1 = x;
+  }
+
+  dxdy = (x1 - x0) / (y1 - y0);
+  x    = x0;
+
+  if (y0 < 0.0f)
+    x -= y0 * dxdy;
+
+  ystart = y0 < 0.0f ? 0 : (int)y0;
+  yend   = y1 > height ? height : (int)ceilf(y1);
+
+  for (y = ystart; y < yend; y ++)
+  {
+    line  = acc + y * (width + 2);
+    dy    = (y + 1 < y1 ? y + 1 : y1) - (y > y0 ? y : y0);
+    xnext = x + dxdy * dy;
+    d     = dy * dir;
+
+    if (x < xnext)
+    {
+      xa = x;
+      xb = xnext;
+    }
+    else
+    {
+      xa = xnext;
+      xb = x;
+    }
+
+    // Keep the line within the buffer...
+    if (xa < 0.0f)
+      xa = 0.0f;
+    if (xb < 0.0f)
+      xb = 0.0f;
+    if (xa > width)
+      xa = (float)width;
+    if (xb > width)
+      xb = (float)width;
+
+    xi0 = (int)xa;
+    xi1 = (int)ceilf(xb);
+
+    if (xi1 <= xi0 + 1)
+    {
+      // Line is within a single column...
+      xmf = 0.5f * (xa + xb) - xi0;
+
+      line[xi0]     += d - d * xmf;
+      line[xi0 + 1] += d * xmf;
+    }
+    else
+    {
+      // Line spans multiple columns...
+      s    = 1.0f / (xb - xa);
+      xa_f = xa - xi0;
+      a0   = 0.5f * s * (1.0f - xa_f) * (1.0f - xa_f);
+      xb_f = xb - xi1 + 1.0f;
+      am   = 0.5f * s * xb_f * xb_f;
+
+      line[xi0] += d * a0;
+
+      if (xi1 == xi0 + 2)
+      {
+        line[xi0 + 1] += d * (1.0f - a0 - am);
+      }
+      else
+      {
+        a1 = s * (1.5f - xa_f);
+        line[xi0 + 1] += d * (a1 - a0);
+
+        for (xi = xi0 + 2; xi < xi1 - 1; xi ++)
+          line[xi] += d * s;
+
+        a2 = a1 + (xi1 - xi0 - 3) * s;
+        line[xi1 - 1] += d * (1.0f - a2 - am);
+      }
+
+      line[xi1] += d * am;
+    }
+
+    x = xnext;
+  }
+}
+
+
+//
+// 'find_bitmap()' - Find a glyph in the bitmap cache.
+//
+// The font lock must be held.  The bitmap is moved to the front of the most
+// recently used list.
+//
+
+static _ttf_bitmap_t *			// O - Cached bitmap or `NULL` if none
+find_bitmap(ttf_t    *font,		// I - Font
+            int      glyph,		// I - Glyph index
+            unsigned size)		// I - Font size in 1/64th pixels
+{
+  int		i;			// Current entry
+  _ttf_bitmap_t	*bitmap;		// Cached bitmap
+
+
+  if (!font->bitmaps)
+    return (NULL);
+
+  for (i = font->bitmap_hash[TTF_BITMAP_HASH(glyph, size)]; i >= 0; i = bitmap->hash_next)
+  {
+    bitmap = font->bitmaps + i;
+
+    if (bitmap->glyph == glyph && bitmap->size == size)
+    {
+      if (i != font->bitmap_first)
+      {
+        // Move to the front of the list...
+        font->bitmaps[bitmap->prev].next = bitmap->next;
+
+        if (bitmap->next >= 0)
+          font->bitmaps[bitmap->next].prev = bitmap->prev;
+        else
+          font->bitmap_last = bitmap->prev;
+
+        bitmap->prev = -1;
+        bitmap->next = font->bitmap_first;
+        font->bitmaps[font->bitmap_first].prev = i;
+        font->bitmap_first = i;
+      }
+
+      return (bitmap);
+    }
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'rasterize_glyph()' - Rasterize a glyph outline.
+//
+// Curves are flattened to lines and the signed area of each line is
+// accumulated, giving exact anti-aliased coverage for the flattened outline.
+//
+
+static bool				// O - `true` on success, `false` on error
+rasterize_glyph(ttf_t         *font,	// I - Font
+                int           glyph,	// I - Glyph index
+                unsigned      size,	// I - Font size in 1/64th pixels
+                _ttf_bitmap_t *bitmap)	// O - Glyph bitmap
+{
+  size_t	i,			// Looping var
+		num_path;		// Number of path segments
+  ttf_path_t	*path,			// Path segments
+		*seg;			// Current segment
+  int		j,			// Looping var
+		steps,			// Number of line segments for curve
+		left, right,		// Horizontal bounds in pixels
+		bottom, top;		// Vertical bounds in pixels
+  float		scale,			// 1000ths to pixels
+		xmin, xmax,		// Horizontal bounds of points
+		ymin, ymax,		// Vertical bounds of points
+		px, py,			// Current point
+		x0, y0,			// Start of curve
+		sx, sy,			// Start of contour
+		x1, y1, x2, y2, x, y,	// Segment points in pixels
+		dx, dy,			// Curve deviation
+		t, mt,			// Curve parameter
+		nx, ny;			// Next point
+  float		*acc;			// Accumulation buffer
+
+
+  memset(bitmap, 0, sizeof(_ttf_bitmap_t));
+  bitmap->glyph = glyph;
+  bitmap->size  = size;
+
+  // Get the outline...
+  if ((num_path = ttfGetGlyphPath(font, glyph, NULL, 0)) == 0)
+    return (true);
+
+  if ((path = malloc(num_path * sizeof(ttf_path_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for glyph outline.");
+    return (false);
+  }
+
+  if (ttfGetGlyphPath(font, glyph, path, num_path) != num_path)
+  {
+    free(path);
+    return (false);
+  }
+
+  // Convert to pixels and find the bounds (including control points)...
+  scale = size / 64000.0f;
+  xmin  = ymin = 99999.0f;
+  xmax  = ymax = -99999.0f;
+
+  for (i = num_path, seg = path; i > 0; i --, seg ++)
+  {
+    seg->x1 *= scale;
+    seg->y1 *= scale;
+    seg->x2 *= scale;
+    seg->y2 *= scale;
+    seg->x  *= scale;
+    seg->y  *= scale;
+
+    if (seg->op == TTF_PATH_CLOSE)
+      continue;
+
+    if (seg->x < xmin)
+      xmin = seg->x;
+    if (seg->x > xmax)
+      xmax = seg->x;
+    if (seg->y < ymin)
+      ymin = seg->y;
+    if (seg->y > ymax)
+      ymax = seg->y;
+
+    if (seg->op == TTF_PATH_QUAD || seg->op == TTF_PATH_CUBIC)
+    {
+      if (seg->x1 < xmin)
+        xmin = seg->x1;
+      if (seg->x1 > xmax)
+        xmax = seg->x1;
+      if (seg->y1 < ymin)
+        ymin = seg->y1;
+      if (seg->y1 > ymax)
+        ymax = seg->y1;
+    }
+
+    if (seg->op == TTF_PATH_CUBIC)
+    {
+      if (seg->x2 < xmin)
+        xmin = seg->x2;
+      if (seg->x2 > xmax)
+        xmax = seg->x2;
+      if (seg->y2 < ymin)
+        ymin = seg->y2;
+      if (seg->y2 > ymax)
+        ymax = seg->y2;
+    }
+  }
+
+  if (xmin > xmax || ymin > ymax)
+  {
+    free(path);
+    return (true);
+  }
+
+  left   = (int)floorf(xmin);
+  right  = (int)ceilf(xmax);
+  bottom = (int)floorf(ymin);
+  top    = (int)ceilf(ymax);
+
+  if (right == left)
+    right ++;
+  if (top == bottom)
+    top ++;
+
+  if ((right - left) > TTF_RASTER_MAX_SIZE || (top - bottom) > TTF_RASTER_MAX_SIZE)
+  {
+    _ttfError(font, "Glyph %d is too large to rasterize.", glyph);
+    free(path);
+    return (false);
+  }
+
+  bitmap->left   = left;
+  bitmap->top    = top;
+  bitmap->width  = right - left;
+  bitmap->height = top - bottom;
+
+  // Allocate buffers with an extra column on each row for the right edge...
+  acc            = calloc((size_t)(bitmap->width + 2) * (size_t)bitmap->height + 1, sizeof(float));
+  bitmap->pixels = malloc((size_t)bitmap->width * (size_t)bitmap->height);
+
+  if (!acc || !bitmap->pixels)
+  {
+    _ttfError(font, "Unable to allocate memory for glyph bitmap.");
+    free(acc);
+    free(bitmap->pixels);
+    free(path);
+    bitmap->pixels = NULL;
+    return (false);
+  }
+
+  // Draw the outline, flipping Y so that the first row is the top...
+  px = py = sx = sy = 0.0f;
+
+  for (i = num_path, seg = path; i > 0; i --, seg ++)
+  {
+    x1 = seg->x1 - left;
+    y1 = top - seg->y1;
+    x2 = seg->x2 - left;
+    y2 = top - seg->y2;
+    x  = seg->x - left;
+    y  = top - seg->y;
+
+    switch (seg->op)
+    {
+      case TTF_PATH_MOVE :
+          if (px != sx || py != sy)
+            draw_line(acc, bitmap->width, bitmap->height, px, py, sx, sy);
+
+          px = sx = x;
+          py = sy = y;
+          break;
+
+      case TTF_PATH_LINE :
+          draw_line(acc, bitmap->width, bitmap->height, px, py, x, y);
+          px = x;
+          py = y;
+          break;
+
+      case TTF_PATH_QUAD :
+          // Flatten so that the error is less than 1/10th of a pixel...
+          dx    = px - 2.0f * x1 + x;
+          dy    = py - 2.0f * y1 + y;
+          steps = 1 + (int)sqrtf(sqrtf(dx * dx + dy * dy) * 2.5f);
+
+          if (steps > 100)
+            steps = 100;
+
+          x0 = px;
+          y0 = py;
+
+          for (j = 1; j <= steps; j ++)
+          {
+            t  = (float)j / steps;
+            mt = 1.0f - t;
+            nx = mt * mt * x0 + 2.0f * mt * t * x1 + t * t * x;
+            ny = mt * mt * y0 + 2.0f * mt * t * y1 + t * t * y;
+
+            draw_line(acc, bitmap->width, bitmap->height, px, py, nx, ny);
+            px = nx;
+            py = ny;
+          }
+
+          px = x;
+          py = y;
+          break;
+
+      case TTF_PATH_CUBIC :
+          dx = fabsf(px - 2.0f * x1 + x2) + fabsf(x1 - 2.0f * x2 + x);
+          dy = fabsf(py - 2.0f * y1 + y2) + fabsf(y1 - 2.0f * y2 + y);
+          steps = 1 + (int)sqrtf((dx + dy) * 7.5f);
+
+          if (steps > 100)
+            steps = 100;
+
+          x0 = px;
+          y0 = py;
+
+          for (j = 1; j <= steps; j ++)
+          {
+            t  = (float)j / steps;
+            mt = 1.0f - t;
+            nx = mt * mt * mt * x0 + 3.0f * mt * mt * t * x1 + 3.0f * mt * t * t * x2 + t * t * t * x;
+            ny = mt * mt * mt * y0 + 3.0f * mt * mt * t * y1 + 3.0f * mt * t * t * y2 + t * t * t * y;
+
+            draw_line(acc, bitmap->width, bitmap->height, px, py, nx, ny);
+            px = nx;
+            py = ny;
+          }
+
+          px = x;
+          py = y;
+          break;
+
+      case TTF_PATH_CLOSE :
+          if (px != sx || py != sy)
+            draw_line(acc, bitmap->width, bitmap->height, px, py, sx, sy);
+
+          px = sx;
+          py = sy;
+          break;
+    }
+  }
+
+  if (px != sx || py != sy)
+    draw_line(acc, bitmap->width, bitmap->height, px, py, sx, sy);
+
+  // Convert the accumulated areas to coverage...
+  for (j = 0; j < bitmap->height; j ++)
+    accumulate(acc + j * (bitmap->width + 2), bitmap->pixels + j * bitmap->width, bitmap->width);
+
+  free(acc);
+  free(path);
+
+  return (true);
+}
+
+
+//
+// 'render_glyph()' - Render a glyph using the bitmap cache.
+//
+
+static bool				// O - `true` on success, `false` on error
+render_glyph(ttf_t         *font,	// I - Font
+             int           glyph,	// I - Glyph index
+             unsigned      size,	// I - Font size in 1/64th pixels
+             unsigned char *pixels,	// I - Grayscale buffer
+             int           width,	// I - Width of buffer
+             int           height,	// I - Height of buffer
+             int           stride,	// I - Bytes per line in buffer
+             int           x,		// I - X position of origin
+             int           y)		// I - Y position of baseline
+{
+  _ttf_bitmap_t	*bitmap,		// Cached bitmap
+		temp;			// Newly rasterized bitmap
+
+
+  // Look for a cached bitmap...
+  _ttfMutexLock(&font->lock);
+
+  if ((bitmap = find_bitmap(font, glyph, size)) != NULL)
+  {
+    blit_bitmap(bitmap, pixels, width, height, stride, x, y);
+    _ttfMutexUnlock(&font->lock);
+    return (true);
+  }
+
+  _ttfMutexUnlock(&font->lock);
+
+  // Rasterize without holding the lock, which is also used for the outline...
+  if (!rasterize_glyph(font, glyph, size, &temp))
+    return (false);
+
+  _ttfMutexLock(&font->lock);
+
+  if ((bitmap = find_bitmap(font, glyph, size)) != NULL)
+  {
+    // Another thread added it first...
+    blit_bitmap(bitmap, pixels, width, height, stride, x, y);
+    free(temp.pixels);
+  }
+  else if ((bitmap = add_bitmap(font, &temp)) != NULL)
+  {
+    blit_bitmap(bitmap, pixels, width, height, stride, x, y);
+  }
+  else
+  {
+    blit_bitmap(&temp, pixels, width, height, stride, x, y);
+    free(temp.pixels);
+  }
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (true);
+}
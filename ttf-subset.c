@@ -0,0 +1,1230 @@
+//
+// Font subsetting code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+
+
+//
+// Constants...
+//
+
+#define TTF_OFF_CFF	0x43464620	// Compact Font Format table
+#define TTF_OFF_OS_2	0x4f532f32	// OS/2 and Windows specific metrics
+#define TTF_OFF_cmap	0x636d6170	// Character to glyph mapping
+#define TTF_OFF_cvt	0x63767420	// Control values
+#define TTF_OFF_fpgm	0x6670676d	// Font program
+#define TTF_OFF_gasp	0x67617370	// Grid-fitting and scan-conversion procedure
+#define TTF_OFF_glyf	0x676c7966	// Glyph data
+#define TTF_OFF_head	0x68656164	// Font header
+#define TTF_OFF_hhea	0x68686561	// Horizontal header
+#define TTF_OFF_hmtx	0x686d7478	// Horizontal metrics
+#define TTF_OFF_loca	0x6c6f6361	// Glyph locations
+#define TTF_OFF_maxp	0x6d617870	// Maximum profile
+#define TTF_OFF_name	0x6e616d65	// Naming table
+#define TTF_OFF_post	0x706f7374	// PostScript information
+#define TTF_OFF_prep	0x70726570	// Control value program
+
+#define TTF_CFF_charset		15	// charset operator
+#define TTF_CFF_Encoding	16	// Encoding operator
+#define TTF_CFF_MAX_FDS		256	// Maximum number of Font DICTs
+
+#define TTF_GLYF_ARG_1_AND_2_ARE_WORDS	0x0001
+					// Component arguments are 16-bit
+#define TTF_GLYF_WE_HAVE_A_SCALE	0x0008
+					// Component has a single scale
+#define TTF_GLYF_MORE_COMPONENTS	0x0020
+					// More components follow
+#define TTF_GLYF_WE_HAVE_AN_X_AND_Y_SCALE 0x0040
+					// Component has X and Y scales
+#define TTF_GLYF_WE_HAVE_A_TWO_BY_TWO	0x0080
+					// Component has a 2x2 transform
+
+
+//
+// Local types...
+//
+
+typedef struct _ttf_cff_private_s	// CFF Private DICT
+{
+  size_t	size,			// Size of Private DICT
+		offset,			// Offset of Private DICT
+		length,			// Length of Private DICT and local Subrs
+		new_offset;		// Offset in subset
+} _ttf_cff_private_t;
+
+typedef struct _ttf_subset_s		// Subset output
+{
+  ttf_t		*font;			// Font
+  unsigned char	*buffer;		// Output buffer
+  size_t	bufsize,		// Size of output buffer
+		length;			// Length of output
+  unsigned char	*used;			// Bitset of used glyphs
+  unsigned	*offsets;		// New glyf offsets for each glyph
+  bool		long_loca;		// Use long loca offsets?
+} _ttf_subset_t;
+
+typedef struct _ttf_cmap_group_s	// Group of mapped characters
+{
+  unsigned	start,			// First character
+		end,			// Last character
+		glyph;			// Glyph for first character
+} _ttf_cmap_group_t;
+
+
+//
+// Local functions...
+//
+
+static bool	copy_cff_range(_ttf_subset_t *subset, const unsigned char *cff, size_t length, size_t offset, size_t bytes);
+static unsigned	get_cff_off_size(size_t offset);
+static void	put_bytes(_ttf_subset_t *subset, const void *data, size_t bytes);
+static void	put_cff_dict(_ttf_subset_t *subset, const unsigned char *data, size_t length, const int *values);
+static void	put_cff_index(_ttf_subset_t *subset, unsigned count, const size_t *sizes);
+static void	put_cff_int(_ttf_subset_t *subset, int value);
+static void	put_ulong(_ttf_subset_t *subset, unsigned value);
+static void	put_ushort(_ttf_subset_t *subset, unsigned value);
+static bool	write_cff(_ttf_subset_t *subset);
+static bool	write_cmap(_ttf_subset_t *subset);
+static bool	write_glyf(_ttf_subset_t *subset);
+static void	write_head(_ttf_subset_t *subset);
+static void	write_loca(_ttf_subset_t *subset);
+static void	write_post(_ttf_subset_t *subset);
+
+
+//
+// 'ttfSubset()' - Write a subset of a font for embedding.
+//
+// This function writes a TrueType/OpenType font containing only the glyphs
+// listed in the "glyphs" array, for example to embed a font in a PDF file.
+// The ".notdef" glyph and any glyphs used by composite glyphs are always
+// included.  Glyph indices are preserved so that the subset can be used with
+// the same glyph indices and metrics as the original font; unused glyphs are
+// empty.  Use the @link ttfGetGlyphs@ or @link ttfGetGlyphsUTF32@ functions
+// to map text to glyphs.
+//
+// The subset contains the "cmap", "head", "hhea", "hmtx", "maxp", and "post"
+// tables, the "glyf" and "loca" tables or the "CFF " table, and the hinting,
+// "name", and "OS/2" tables from the original font.
+//
+// The subset is written to the "buffer" argument if it is large enough.  The
+// size of the subset in bytes is returned, which may be larger than "bufsize".
+// Call with a `NULL` buffer and `0` size to get the size of the subset.
+// `0` is returned on error.
+//
+
+size_t					// O - Size of subset in bytes or `0` on error
+ttfSubset(ttf_t     *font,		// I - Font
+          const int *glyphs,		// I - Used glyphs
+          size_t    num_glyphs,		// I - Number of used glyphs
+          void      *buffer,		// I - Output buffer or `NULL`
+          size_t    bufsize)		// I - Size of output buffer
+{
+  _ttf_subset_t	subset;			// Subset output
+  size_t	i,			// Looping var
+		num_tables = 0,		// Number of tables
+		length,			// Length of table
+		offset,			// Offset of table
+		offsets[16],		// Offsets of tables
+		lengths[16];		// Lengths of tables
+  unsigned	tags[16],		// Tags of tables
+		checksum;		// Checksum
+  unsigned char	*bufptr;		// Pointer into buffer
+  bool		cff,			// CFF font?
+		ret = true;		// Return value
+  static const unsigned all_tags[] =	// Tags in sorted order
+  {
+    TTF_OFF_CFF,
+    TTF_OFF_OS_2,
+    TTF_OFF_cmap,
+    TTF_OFF_cvt,
+    TTF_OFF_fpgm,
+    TTF_OFF_gasp,
+    TTF_OFF_glyf,
+    TTF_OFF_head,
+    TTF_OFF_hhea,
+    TTF_OFF_hmtx,
+    TTF_OFF_loca,
+    TTF_OFF_maxp,
+    TTF_OFF_name,
+    TTF_OFF_post,
+    TTF_OFF_prep
+  };
+
+
+  TTF_DEBUG("ttfSubset(font=%p, glyphs=%p, num_glyphs=%u, buffer=%p, bufsize=%u)\n", (void *)font, (void *)glyphs, (unsigned)num_glyphs, buffer, (unsigned)bufsize);
+
+  // Range check input...
+  if (!font || (!glyphs && num_glyphs > 0) || (!buffer && bufsize > 0) || !font->num_glyphs)
+    return (0);
+
+  cff = _ttfGetTable(font, TTF_OFF_CFF, &length) != NULL;
+
+  if (!cff && (!_ttfGetTable(font, TTF_OFF_glyf, &length) || !_ttfGetTable(font, TTF_OFF_loca, &length)))
+  {
+    _ttfError(font, "Unable to subset font without glyph outlines.");
+    return (0);
+  }
+
+  // Initialize the subset...
+  memset(&subset, 0, sizeof(subset));
+
+  subset.font    = font;
+  subset.buffer  = (unsigned char *)buffer;
+  subset.bufsize = bufsize;
+
+  if ((subset.used = (unsigned char *)calloc(font->num_glyphs / 8 + 1, 1)) == NULL || (!cff && (subset.offsets = (unsigned *)calloc(font->num_glyphs + 1, sizeof(unsigned))) == NULL))
+  {
+    _ttfError(font, "Unable to allocate memory for subset.");
+    free(subset.used);
+    return (0);
+  }
+
+  subset.used[0] = 1;			// Always include .notdef
+
+  for (i = 0; i < num_glyphs; i ++)
+  {
+    if (glyphs[i] > 0 && (size_t)glyphs[i] < font->num_glyphs)
+      subset.used[glyphs[i] / 8] |= (unsigned char)(1 << (glyphs[i] & 7));
+  }
+
+  // Figure out which tables to write...
+  for (i = 0; i < (sizeof(all_tags) / sizeof(all_tags[0])); i ++)
+  {
+    if (all_tags[i] == TTF_OFF_cmap || (all_tags[i] == TTF_OFF_CFF && cff) || ((all_tags[i] == TTF_OFF_glyf || all_tags[i] == TTF_OFF_loca) && !cff) || ((all_tags[i] != TTF_OFF_CFF && all_tags[i] != TTF_OFF_glyf && all_tags[i] != TTF_OFF_loca) && _ttfGetTable(font, all_tags[i], &length)))
+      tags[num_tables ++] = all_tags[i];
+  }
+
+  // Write the tables after the table directory...
+  subset.length = 12 + 16 * num_tables;
+
+  for (i = 0; i < num_tables && ret; i ++)
+  {
+    offsets[i] = subset.length;
+
+    switch (tags[i])
+    {
+      case TTF_OFF_CFF :
+          ret = write_cff(&subset);
+          break;
+      case TTF_OFF_cmap :
+          ret = write_cmap(&subset);
+          break;
+      case TTF_OFF_glyf :
+          ret = write_glyf(&subset);
+          break;
+      case TTF_OFF_head :
+          write_head(&subset);
+          break;
+      case TTF_OFF_loca :
+          write_loca(&subset);
+          break;
+      case TTF_OFF_post :
+          write_post(&subset);
+          break;
+      default :
+          // Copy other tables as-is...
+          bufptr = (unsigned char *)_ttfGetTable(font, tags[i], &length);
+          put_bytes(&subset, bufptr, length);
+          break;
+    }
+
+    lengths[i] = subset.length - offsets[i];
+
+    // Pad tables to a multiple of 4 bytes...
+    while (subset.length & 3)
+      put_bytes(&subset, "", 1);
+  }
+
+  free(subset.used);
+  free(subset.offsets);
+
+  if (!ret)
+    return (0);
+
+  TTF_DEBUG("ttfSubset: %u tables, %u bytes.\n", (unsigned)num_tables, (unsigned)subset.length);
+
+  if (subset.length > bufsize)
+    return (subset.length);
+
+  // Write the offset table and table directory...
+  length        = subset.length;
+  subset.length = 0;
+
+  for (i = 0; num_tables >= (2U << i); i ++);
+
+  put_ulong(&subset, cff ? 0x4f54544f : 0x00010000);
+  put_ushort(&subset, (unsigned)num_tables);
+  put_ushort(&subset, 16U << i);
+  put_ushort(&subset, (unsigned)i);
+  put_ushort(&subset, (unsigned)(16 * num_tables - (16U << i)));
+
+  for (i = 0; i < num_tables; i ++)
+  {
+    for (offset = 0, checksum = 0, bufptr = subset.buffer + offsets[i]; offset < lengths[i]; offset += 4, bufptr += 4)
+      checksum += TTF_GET_ULONG(bufptr);
+
+    put_ulong(&subset, tags[i]);
+    put_ulong(&subset, checksum);
+    put_ulong(&subset, (unsigned)offsets[i]);
+    put_ulong(&subset, (unsigned)lengths[i]);
+
+    if (tags[i] == TTF_OFF_head)
+      offset = offsets[i];
+  }
+
+  // Then update the checksum adjustment in the head table...
+  for (i = 0, checksum = 0, bufptr = subset.buffer; i < length; i += 4, bufptr += 4)
+    checksum += TTF_GET_ULONG(bufptr);
+
+  for (i = 0; i < num_tables; i ++)
+  {
+    if (tags[i] == TTF_OFF_head)
+    {
+      subset.length = offsets[i] + 8;
+      put_ulong(&subset, 0xb1b0afba - checksum);
+      break;
+    }
+  }
+
+  return (length);
+}
+
+
+//
+// 'copy_cff_range()' - Copy a range of bytes from the CFF table.
+//
+
+static bool				// O - `true` on success, `false` on error
+copy_cff_range(_ttf_subset_t       *subset,
+					// I - Subset output
+               const unsigned char *cff,// I - CFF table
+               size_t              length,
+					// I - Length of CFF table
+               size_t              offset,
+					// I - Offset of range
+               size_t              bytes)
+					// I - Number of bytes
+{
+  if (offset > length || bytes > (length - offset))
+  {
+    _ttfError(subset->font, "Bad CFF table.");
+    return (false);
+  }
+
+  put_bytes(subset, cff + offset, bytes);
+
+  return (true);
+}
+
+
+//
+// 'get_cff_off_size()' - Get the size of offsets in a CFF INDEX.
+//
+
+static unsigned				// O - Size of offsets in bytes
+get_cff_off_size(size_t offset)		// I - Largest offset
+{
+  return (offset < 0x100 ? 1 : offset < 0x10000 ? 2 : offset < 0x1000000 ? 3 : 4);
+}
+
+
+//
+// 'put_bytes()' - Add bytes to the subset.
+//
+// Bytes are only copied if they fit in the output buffer, but the length is
+// always updated so that the size of the subset can be determined.
+//
+
+static void
+put_bytes(_ttf_subset_t *subset,	// I - Subset output
+          const void    *data,		// I - Data to copy
+          size_t        bytes)		// I - Number of bytes
+{
+  if (subset->length < subset->bufsize && bytes <= (subset->bufsize - subset->length))
+    memcpy(subset->buffer + subset->length, data, bytes);
+
+  subset->length += bytes;
+}
+
+
+//
+// 'put_cff_dict()' - Add a CFF DICT with updated offsets.
+//
+// The operands of the offset operators (charset, Encoding, CharStrings,
+// Private, FDArray, and FDSelect) are replaced by the values in the "values"
+// array, in that order (with two values for Private), using 5-byte integers so
+// the size of the DICT does not depend on the values.  A value of `-1` keeps
+// the original operand.
+//
+
+static void
+put_cff_dict(_ttf_subset_t       *subset,
+					// I - Subset output
+             const unsigned char *data,	// I - DICT data
+             size_t              length,// I - Length of DICT data
+             const int           *values)
+					// I - New operand values
+{
+  const unsigned char	*dataptr,	// Pointer into DICT data
+			*dataend,	// End of DICT data
+			*start;		// Start of operands
+  unsigned		b0,		// First byte of operator or operand
+			op;		// Operator
+  int			index;		// Index into values
+
+
+  for (dataptr = start = data, dataend = data + length; dataptr < dataend;)
+  {
+    b0 = *dataptr;
+
+    if (b0 > 21)
+    {
+      // Skip operand...
+      if (b0 == 28)
+        dataptr += 3;
+      else if (b0 == 29)
+        dataptr += 5;
+      else if (b0 == 30)
+      {
+        for (dataptr ++; dataptr < dataend && (*dataptr & 0x0f) != 0x0f && (*dataptr & 0xf0) != 0xf0; dataptr ++);
+
+        dataptr ++;
+      }
+      else if (b0 >= 247 && b0 <= 254)
+        dataptr += 2;
+      else
+        dataptr ++;
+      continue;
+    }
+
+    // Operator...
+    op = b0;
+
+    if (b0 == 12 && (dataptr + 1) < dataend)
+      op = 0x0c00 | dataptr[1];
+
+    switch (op)
+    {
+      case TTF_CFF_charset :
+          index = 0;
+          break;
+      case TTF_CFF_Encoding :
+          index = 1;
+          break;
+      case TTF_CFF_CharStrings :
+          index = 2;
+          break;
+      case TTF_CFF_Private :
+          index = 3;
+          break;
+      case TTF_CFF_FDArray :
+          index = 5;
+          break;
+      case TTF_CFF_FDSelect :
+          index = 6;
+          break;
+      default :
+          index = -1;
+          break;
+    }
+
+    if (index >= 0 && values[index] >= 0)
+    {
+      // Replace the operands...
+      put_cff_int(subset, values[index]);
+      if (op == TTF_CFF_Private)
+        put_cff_int(subset, values[index + 1]);
+    }
+    else
+    {
+      // Copy the original operands...
+      put_bytes(subset, start, (size_t)(dataptr - start));
+    }
+
+    if (op > 0xff)
+    {
+      put_bytes(subset, dataptr, 2);
+      dataptr += 2;
+    }
+    else
+    {
+      put_bytes(subset, dataptr, 1);
+      dataptr ++;
+    }
+
+    start = dataptr;
+  }
+}
+
+
+//
+// 'put_cff_index()' - Add the header of a CFF INDEX.
+//
+// The caller adds the object data after the header.
+//
+
+static void
+put_cff_index(_ttf_subset_t *subset,	// I - Subset output
+              unsigned      count,	// I - Number of objects
+              const size_t  *sizes)	// I - Size of each object
+{
+  unsigned	i,			// Looping var
+		off_size;		// Size of offsets
+  size_t	offset;			// Current offset
+  unsigned char	buffer[4];		// Offset buffer
+
+
+  put_ushort(subset, count);
+
+  if (count == 0)
+    return;
+
+  for (i = 0, offset = 1; i < count; i ++)
+    offset += sizes[i];
+
+  off_size = get_cff_off_size(offset);
+
+  buffer[0] = (unsigned char)off_size;
+  put_bytes(subset, buffer, 1);
+
+  for (i = 0, offset = 1; i <= count; offset += i < count ? sizes[i] : 0, i ++)
+  {
+    buffer[0] = (unsigned char)(offset >> 24);
+    buffer[1] = (unsigned char)(offset >> 16);
+    buffer[2] = (unsigned char)(offset >> 8);
+    buffer[3] = (unsigned char)offset;
+
+    put_bytes(subset, buffer + 4 - off_size, off_size);
+  }
+}
+
+
+//
+// 'put_cff_int()' - Add a 5-byte CFF DICT integer.
+//
+
+static void
+put_cff_int(_ttf_subset_t *subset,	// I - Subset output
+            int           value)	// I - Value
+{
+  unsigned char	buffer[5];		// Integer buffer
+
+
+  buffer[0] = 29;
+  buffer[1] = (unsigned char)(value >> 24);
+  buffer[2] = (unsigned char)(value >> 16);
+  buffer[3] = (unsigned char)(value >> 8);
+  buffer[4] = (unsigned char)value;
+
+  put_bytes(subset, buffer, 5);
+}
+
+
+//
+// 'put_ulong()' - Add a big-endian 32-bit unsigned integer.
+//
+
+static void
+put_ulong(_ttf_subset_t *subset,	// I - Subset output
+          unsigned      value)		// I - Value
+{
+  unsigned char	buffer[4];		// Integer buffer
+
+
+  buffer[0] = (unsigned char)(value >> 24);
+  buffer[1] = (unsigned char)(value >> 16);
+  buffer[2] = (unsigned char)(value >> 8);
+  buffer[3] = (unsigned char)value;
+
+  put_bytes(subset, buffer, 4);
+}
+
+
+//
+// 'put_ushort()' - Add a big-endian 16-bit unsigned integer.
+//
+
+static void
+put_ushort(_ttf_subset_t *subset,	// I - Subset output
+           unsigned      value)		// I - Value
+{
+  unsigned char	buffer[2];		// Integer buffer
+
+
+  buffer[0] = (unsigned char)(value >> 8);
+  buffer[1] = (unsigned char)value;
+
+  put_bytes(subset, buffer, 2);
+}
+
+
+//
+// 'write_cff()' - Write a subset of the CFF table.
+//
+// The header, Name INDEX, String INDEX, Global Subr INDEX, charset, Encoding,
+// FDSelect, and Private DICTs (with their local Subrs) are copied as-is.  The
+// Top DICT and Font DICTs are rewritten with the new offsets, and unused
+// charstrings are replaced with "endchar".
+//
+
+static bool				// O - `true` on success, `false` on error
+write_cff(_ttf_subset_t *subset)	// I - Subset output
+{
+  ttf_t			*font = subset->font;
+					// Font
+  const unsigned char	*cff;		// CFF table
+  size_t		length,		// Length of CFF table
+			offset,		// Offset of object
+			bytes,		// Size of object
+			top_offset,	// Offset of Top DICT data
+			top_bytes,	// Size of Top DICT data
+			new_top_bytes,	// Size of new Top DICT data
+			charset_bytes = 0,
+					// Size of charset
+			encoding_bytes = 0,
+					// Size of Encoding
+			fdselect_bytes = 0,
+					// Size of FDSelect
+			*sizes = NULL,	// Sizes of objects
+			fd_sizes[TTF_CFF_MAX_FDS];
+					// Sizes of new Font DICTs
+  _ttf_cff_index_t	name_index,	// Name INDEX
+			top_index,	// Top DICT INDEX
+			string_index,	// String INDEX
+			gsubr_index,	// Global Subr INDEX
+			charstrings,	// CharStrings INDEX
+			fd_index,	// FDArray INDEX
+			subrs;		// Local Subrs INDEX
+  _ttf_cff_private_t	privates[TTF_CFF_MAX_FDS + 1];
+					// Private DICTs
+  _ttf_subset_t		measure;	// DICT measurement
+  unsigned		i,		// Looping var
+			num_privates = 0,
+					// Number of Private DICTs
+			glyph;		// Current glyph
+  int			values[7],	// New Top DICT values
+			fd_values[7],	// New Font DICT values
+			charset = 0,	// Offset of charset
+			encoding = 0,	// Offset of Encoding
+			fdselect = 0,	// Offset of FDSelect
+			fdarray = 0,	// Offset of FDArray
+			ops[2];		// Operator values
+  size_t		new_charset = 0,// New offset of charset
+			new_encoding = 0,
+					// New offset of Encoding
+			new_fdselect = 0,
+					// New offset of FDSelect
+			new_charstrings,// New offset of CharStrings
+			new_fdarray = 0;// New offset of FDArray
+  static const unsigned char endchar = 14;
+					// Empty charstring
+
+
+  if ((cff = _ttfGetTable(font, TTF_OFF_CFF, &length)) == NULL || length < 4 || cff[2] < 4)
+    goto bad_cff;
+
+  // Find the INDEXes following the header...
+  if (!_ttfCFFGetIndex(cff, length, cff[2], &name_index) || !_ttfCFFGetIndex(cff, length, name_index.end, &top_index) || top_index.count != 1 || !_ttfCFFGetIndex(cff, length, top_index.end, &string_index) || !_ttfCFFGetIndex(cff, length, string_index.end, &gsubr_index))
+    goto bad_cff;
+
+  top_offset = _ttfCFFGetObject(cff, &top_index, 0, &top_bytes);
+
+  // Get the offsets of the structures referenced by the Top DICT...
+  if (!_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_CharStrings, ops, 1) || !_ttfCFFGetIndex(cff, length, (size_t)ops[0], &charstrings) || charstrings.count != font->num_glyphs)
+    goto bad_cff;
+
+  if (_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_charset, ops, 1) && ops[0] > 2)
+  {
+    // charset: format 0 has a SID per glyph, formats 1 and 2 have ranges...
+    if ((size_t)(charset = ops[0]) >= length)
+      goto bad_cff;
+
+    if (cff[charset] == 0)
+    {
+      charset_bytes = 1 + 2 * (font->num_glyphs - 1);
+    }
+    else if (cff[charset] == 1 || cff[charset] == 2)
+    {
+      for (glyph = 1, offset = (size_t)charset + 1; glyph < font->num_glyphs; offset += cff[charset] == 1 ? 3 : 4)
+      {
+        if ((offset + (cff[charset] == 1 ? 3 : 4)) > length)
+          goto bad_cff;
+
+        glyph += 1 + (cff[charset] == 1 ? cff[offset + 2] : TTF_GET_USHORT(cff + offset + 2));
+      }
+
+      charset_bytes = offset - (size_t)charset;
+    }
+    else
+      goto bad_cff;
+  }
+
+  if (_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_Encoding, ops, 1) && ops[0] > 1)
+  {
+    // Encoding: format 0 has codes, format 1 has ranges, plus supplements...
+    if ((size_t)(encoding = ops[0]) >= (length - 2))
+      goto bad_cff;
+
+    if ((cff[encoding] & 0x7f) == 0)
+      encoding_bytes = 2 + cff[encoding + 1];
+    else
+      encoding_bytes = 2 + 2 * cff[encoding + 1];
+
+    if ((cff[encoding] & 0x80) && ((size_t)encoding + encoding_bytes) < length)
+      encoding_bytes += 1 + 3 * cff[encoding + encoding_bytes];
+  }
+
+  if (_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_FDSelect, ops, 1))
+  {
+    // FDSelect: format 0 has an FD per glyph, format 3 has ranges...
+    if ((size_t)(fdselect = ops[0]) >= (length - 3))
+      goto bad_cff;
+
+    if (cff[fdselect] == 0)
+      fdselect_bytes = 1 + font->num_glyphs;
+    else if (cff[fdselect] == 3)
+      fdselect_bytes = 5 + 3 * (size_t)TTF_GET_USHORT(cff + fdselect + 1);
+    else
+      goto bad_cff;
+  }
+
+  if (_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_FDArray, ops, 1))
+  {
+    // FDArray: INDEX of Font DICTs, each with a Private DICT...
+    if (!_ttfCFFGetIndex(cff, length, (size_t)(fdarray = ops[0]), &fd_index) || fd_index.count > TTF_CFF_MAX_FDS)
+      goto bad_cff;
+
+    for (i = 0; i < fd_index.count; i ++)
+    {
+      offset = _ttfCFFGetObject(cff, &fd_index, i, &bytes);
+
+      if (_ttfCFFGetDict(cff + offset, bytes, TTF_CFF_Private, ops, 2))
+      {
+        privates[num_privates].size   = (size_t)ops[0];
+        privates[num_privates].offset = (size_t)ops[1];
+        num_privates ++;
+      }
+    }
+  }
+  else if (_ttfCFFGetDict(cff + top_offset, top_bytes, TTF_CFF_Private, ops, 2))
+  {
+    privates[0].size   = (size_t)ops[0];
+    privates[0].offset = (size_t)ops[1];
+    num_privates       = 1;
+  }
+
+  // Private DICTs are copied along with any local Subrs that follow them...
+  for (i = 0; i < num_privates; i ++)
+  {
+    if (privates[i].offset > length || privates[i].size > (length - privates[i].offset))
+      goto bad_cff;
+
+    privates[i].length = privates[i].size;
+
+    if (_ttfCFFGetDict(cff + privates[i].offset, privates[i].size, TTF_CFF_Subrs, ops, 1))
+    {
+      if (ops[0] < 0 || !_ttfCFFGetIndex(cff, length, privates[i].offset + (size_t)ops[0], &subrs))
+        goto bad_cff;
+
+      if ((subrs.end - privates[i].offset) > privates[i].length)
+        privates[i].length = subrs.end - privates[i].offset;
+    }
+  }
+
+  // Get the sizes of the new charstrings...
+  if ((sizes = (size_t *)malloc((font->num_glyphs + 1) * sizeof(size_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for subset.");
+    return (false);
+  }
+
+  for (glyph = 0; glyph < font->num_glyphs; glyph ++)
+  {
+    if (subset->used[glyph / 8] & (1 << (glyph & 7)))
+      _ttfCFFGetObject(cff, &charstrings, glyph, sizes + glyph);
+    else
+      sizes[glyph] = 1;
+  }
+
+  // Lay out the new CFF table: header, Name INDEX, Top DICT INDEX, String
+  // INDEX, Global Subr INDEX, charset, Encoding, FDSelect, CharStrings,
+  // FDArray, and then the Private DICTs.  Replaced offsets are always 5 bytes
+  // so the DICTs are measured with placeholder values first...
+  values[0] = charset_bytes ? 0 : -1;
+  values[1] = encoding_bytes ? 0 : -1;
+  values[2] = 0;
+  values[3] = values[4] = num_privates && !fdarray ? 0 : -1;
+  values[5] = fdarray ? 0 : -1;
+  values[6] = fdselect_bytes ? 0 : -1;
+
+  memset(&measure, 0, sizeof(measure));
+  put_cff_dict(&measure, cff + top_offset, top_bytes, values);
+  new_top_bytes = measure.length;
+
+  offset = name_index.end + (new_top_bytes < 255 ? 5 : 7) + new_top_bytes + (gsubr_index.end - string_index.offset);
+
+  if (charset_bytes)
+  {
+    new_charset = offset;
+    offset      += charset_bytes;
+  }
+
+  if (encoding_bytes)
+  {
+    new_encoding = offset;
+    offset       += encoding_bytes;
+  }
+
+  if (fdselect_bytes)
+  {
+    new_fdselect = offset;
+    offset       += fdselect_bytes;
+  }
+
+  new_charstrings = offset;
+
+  for (glyph = 0, bytes = 1; glyph < font->num_glyphs; glyph ++)
+    bytes += sizes[glyph];
+
+  offset += 3 + (font->num_glyphs + 1) * get_cff_off_size(bytes) + bytes - 1;
+
+  if (fdarray)
+  {
+    // Font DICTs are rewritten with new Private offsets...
+    new_fdarray = offset;
+
+    memset(fd_values, -1, sizeof(fd_values));
+    fd_values[3] = 0;
+    fd_values[4] = 0;
+
+    for (i = 0, bytes = 1; i < fd_index.count; i ++)
+    {
+      size_t	fd_offset,		// Offset of Font DICT
+		fd_bytes;		// Size of Font DICT
+
+      fd_offset      = _ttfCFFGetObject(cff, &fd_index, i, &fd_bytes);
+      measure.length = 0;
+      put_cff_dict(&measure, cff + fd_offset, fd_bytes, fd_values);
+      fd_sizes[i]    = measure.length;
+      bytes          += fd_sizes[i];
+    }
+
+    offset += fd_index.count ? 3 + (fd_index.count + 1) * get_cff_off_size(bytes) + bytes - 1 : 2;
+  }
+
+  for (i = 0; i < num_privates; i ++)
+  {
+    privates[i].new_offset = offset;
+    offset                 += privates[i].length;
+  }
+
+  // Write the header, Name INDEX, Top DICT INDEX, String INDEX, and Global
+  // Subr INDEX...
+  values[0] = charset_bytes ? (int)new_charset : -1;
+  values[1] = encoding_bytes ? (int)new_encoding : -1;
+  values[2] = (int)new_charstrings;
+  values[3] = num_privates && !fdarray ? (int)privates[0].size : -1;
+  values[4] = num_privates && !fdarray ? (int)privates[0].new_offset : -1;
+  values[5] = fdarray ? (int)new_fdarray : -1;
+  values[6] = fdselect_bytes ? (int)new_fdselect : -1;
+
+  if (!copy_cff_range(subset, cff, length, 0, name_index.end))
+    goto error;
+
+  put_cff_index(subset, 1, &new_top_bytes);
+  put_cff_dict(subset, cff + top_offset, top_bytes, values);
+
+  if (!copy_cff_range(subset, cff, length, string_index.offset, gsubr_index.end - string_index.offset))
+    goto error;
+
+  // Then the charset, Encoding, and FDSelect...
+  if (charset_bytes && !copy_cff_range(subset, cff, length, (size_t)charset, charset_bytes))
+    goto error;
+
+  if (encoding_bytes && !copy_cff_range(subset, cff, length, (size_t)encoding, encoding_bytes))
+    goto error;
+
+  if (fdselect_bytes && !copy_cff_range(subset, cff, length, (size_t)fdselect, fdselect_bytes))
+    goto error;
+
+  // Then the CharStrings...
+  put_cff_index(subset, font->num_glyphs, sizes);
+
+  for (glyph = 0; glyph < font->num_glyphs; glyph ++)
+  {
+    if (subset->used[glyph / 8] & (1 << (glyph & 7)))
+    {
+      offset = _ttfCFFGetObject(cff, &charstrings, glyph, &bytes);
+
+      if (!copy_cff_range(subset, cff, length, offset, bytes))
+        goto error;
+    }
+    else
+    {
+      put_bytes(subset, &endchar, 1);
+    }
+  }
+
+  // Then the FDArray...
+  if (fdarray)
+  {
+    put_cff_index(subset, fd_index.count, fd_sizes);
+
+    for (i = 0; i < fd_index.count; i ++)
+    {
+      offset       = _ttfCFFGetObject(cff, &fd_index, i, &bytes);
+      fd_values[3] = (int)privates[i].size;
+      fd_values[4] = (int)privates[i].new_offset;
+
+      put_cff_dict(subset, cff + offset, bytes, fd_values);
+    }
+  }
+
+  // And finally the Private DICTs...
+  for (i = 0; i < num_privates; i ++)
+  {
+    if (!copy_cff_range(subset, cff, length, privates[i].offset, privates[i].length))
+      goto error;
+  }
+
+  free(sizes);
+
+  return (true);
+
+  // If we get here the CFF table could not be read...
+  bad_cff:
+
+  _ttfError(font, "Bad CFF table.");
+
+  error:
+
+  free(sizes);
+
+  return (false);
+}
+
+
+//
+// 'write_cmap()' - Write a cmap table for the used glyphs.
+//
+// A format 4 subtable is written for BMP characters and a format 12 subtable
+// is added for fonts with characters outside the BMP.
+//
+
+static bool				// O - `true` on success, `false` on error
+write_cmap(_ttf_subset_t *subset)	// I - Subset output
+{
+  ttf_t			*font = subset->font;
+					// Font
+  _ttf_cmap_group_t	*groups,	// Groups of characters
+			*group;		// Current group
+  size_t		i,		// Looping var
+			num_groups = 0,	// Number of groups
+			num_segments,	// Number of format 4 segments
+			length4,	// Length of format 4 subtable
+			search;		// Search range
+  int			ch,		// Current character
+			glyph;		// Current glyph
+  unsigned		selector;	// Entry selector
+  bool			extended;	// Characters outside the BMP?
+
+
+  // Group consecutive characters that map to consecutive glyphs...
+  if ((groups = (_ttf_cmap_group_t *)malloc((font->num_cmap + 1) * sizeof(_ttf_cmap_group_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for subset.");
+    return (false);
+  }
+
+  for (ch = 0, group = NULL; ch < (int)font->num_cmap; ch ++)
+  {
+    if ((glyph = font->cmap[ch]) <= 0 || (size_t)glyph >= font->num_glyphs || !(subset->used[glyph / 8] & (1 << (glyph & 7))))
+      continue;
+
+    if (group && group->end == (unsigned)ch - 1 && group->glyph + (unsigned)ch - group->start == (unsigned)glyph && ch != 0x10000)
+    {
+      group->end = (unsigned)ch;
+    }
+    else
+    {
+      group        = groups + num_groups ++;
+      group->start = group->end = (unsigned)ch;
+      group->glyph = (unsigned)glyph;
+    }
+  }
+
+  // Count the format 4 segments, including the final 0xFFFF segment...
+  for (i = 0, num_segments = 1, extended = false; i < num_groups; i ++)
+  {
+    if (groups[i].end < 0xffff)
+      num_segments ++;
+    else
+      extended = true;
+  }
+
+  if (num_segments > 8000)
+  {
+    // Too many segments for format 4, only use format 12...
+    num_segments = 1;
+    extended     = true;
+  }
+
+  length4 = 16 + 8 * num_segments;
+
+  for (selector = 0, search = 2; (search * 2) <= (2 * num_segments); selector ++, search *= 2);
+
+  // cmap header and encoding records...
+  put_ushort(subset, 0);		// version
+  put_ushort(subset, extended ? 2 : 1);	// numTables
+  put_ushort(subset, 3);		// platformID (Windows)
+  put_ushort(subset, 1);		// encodingID (Unicode BMP)
+  put_ulong(subset, extended ? 20 : 12);// subtableOffset
+  if (extended)
+  {
+    put_ushort(subset, 3);		// platformID (Windows)
+    put_ushort(subset, 10);		// encodingID (Unicode full)
+    put_ulong(subset, (unsigned)(20 + length4));
+					// subtableOffset
+  }
+
+  // Format 4 subtable...
+  put_ushort(subset, 4);		// format
+  put_ushort(subset, (unsigned)length4);// length
+  put_ushort(subset, 0);		// language
+  put_ushort(subset, (unsigned)(2 * num_segments));
+					// segCountX2
+  put_ushort(subset, (unsigned)search);	// searchRange
+  put_ushort(subset, selector);		// entrySelector
+  put_ushort(subset, (unsigned)(2 * num_segments - search));
+					// rangeShift
+
+  for (i = 0; i < num_groups && num_segments > 1; i ++)
+  {
+    if (groups[i].end < 0xffff)
+      put_ushort(subset, groups[i].end);// endCode
+  }
+  put_ushort(subset, 0xffff);
+
+  put_ushort(subset, 0);		// reservedPad
+
+  for (i = 0; i < num_groups && num_segments > 1; i ++)
+  {
+    if (groups[i].end < 0xffff)
+      put_ushort(subset, groups[i].start);
+					// startCode
+  }
+  put_ushort(subset, 0xffff);
+
+  for (i = 0; i < num_groups && num_segments > 1; i ++)
+  {
+    if (groups[i].end < 0xffff)
+      put_ushort(subset, (groups[i].glyph - groups[i].start) & 0xffff);
+					// idDelta
+  }
+  put_ushort(subset, 1);
+
+  for (i = 0; i < num_segments; i ++)
+    put_ushort(subset, 0);		// idRangeOffset
+
+  if (extended)
+  {
+    // Format 12 subtable...
+    put_ushort(subset, 12);		// format
+    put_ushort(subset, 0);		// reserved
+    put_ulong(subset, (unsigned)(16 + 12 * num_groups));
+					// length
+    put_ulong(subset, 0);		// language
+    put_ulong(subset, (unsigned)num_groups);
+					// numGroups
+
+    for (i = 0; i < num_groups; i ++)
+    {
+      put_ulong(subset, groups[i].start);
+      put_ulong(subset, groups[i].end);
+      put_ulong(subset, groups[i].glyph);
+    }
+  }
+
+  free(groups);
+
+  return (true);
+}
+
+
+//
+// 'write_glyf()' - Write the used glyphs to the glyf table.
+//
+// Components of composite glyphs are added to the used glyphs first.
+//
+
+static bool				// O - `true` on success, `false` on error
+write_glyf(_ttf_subset_t *subset)	// I - Subset output
+{
+  ttf_t			*font = subset->font;
+					// Font
+  const unsigned char	*glyph_data,	// Glyph data
+			*data,		// Pointer into glyph data
+			*dataend;	// End of glyph data
+  size_t		bytes,		// Size of glyph
+			new_offset;	// New offset of glyph
+  unsigned		glyph,		// Current glyph
+			component,	// Component glyph
+			flags,		// Component flags
+			*stack,		// Glyphs to check for components
+			num_stack = 0;	// Number of glyphs on stack
+  static const unsigned char pad = 0;	// Padding byte
+
+
+  // Add the components of composite glyphs...
+  if ((stack = (unsigned *)malloc(font->num_glyphs * sizeof(unsigned))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for subset.");
+    return (false);
+  }
+
+  for (glyph = 0; glyph < font->num_glyphs; glyph ++)
+  {
+    if (subset->used[glyph / 8] & (1 << (glyph & 7)))
+      stack[num_stack ++] = glyph;
+  }
+
+  while (num_stack > 0)
+  {
+    glyph = stack[-- num_stack];
+
+    if ((glyph_data = _ttfGetGlyphData(font, glyph, &bytes)) == NULL || bytes < 10 || TTF_GET_SHORT(glyph_data) >= 0)
+      continue;
+
+    // Composite glyph: flags, glyphIndex, arguments, and transform for each
+    // component...
+    for (data = glyph_data + 10, dataend = glyph_data + bytes; (dataend - data) >= 4; data += 4)
+    {
+      flags     = TTF_GET_USHORT(data);
+      component = TTF_GET_USHORT(data + 2);
+
+      if (component < font->num_glyphs && !(subset->used[component / 8] & (1 << (component & 7))))
+      {
+        subset->used[component / 8] |= (unsigned char)(1 << (component & 7));
+        stack[num_stack ++]         = component;
+      }
+
+      if (!(flags & TTF_GLYF_MORE_COMPONENTS))
+        break;
+
+      data += (flags & TTF_GLYF_ARG_1_AND_2_ARE_WORDS) ? 4 : 2;
+
+      if (flags & TTF_GLYF_WE_HAVE_A_SCALE)
+        data += 2;
+      else if (flags & TTF_GLYF_WE_HAVE_AN_X_AND_Y_SCALE)
+        data += 4;
+      else if (flags & TTF_GLYF_WE_HAVE_A_TWO_BY_TWO)
+        data += 8;
+    }
+  }
+
+  free(stack);
+
+  // Then copy the used glyphs...
+  for (glyph = 0, new_offset = 0; glyph < font->num_glyphs; glyph ++)
+  {
+    subset->offsets[glyph] = (unsigned)new_offset;
+
+    if (!(subset->used[glyph / 8] & (1 << (glyph & 7))) || (glyph_data = _ttfGetGlyphData(font, glyph, &bytes)) == NULL)
+      continue;
+
+    put_bytes(subset, glyph_data, bytes);
+    new_offset += bytes;
+
+    if (bytes & 1)
+    {
+      // Keep glyphs aligned for short loca offsets...
+      put_bytes(subset, &pad, 1);
+      new_offset ++;
+    }
+  }
+
+  subset->offsets[glyph] = (unsigned)new_offset;
+  subset->long_loca      = new_offset > 0x1fffe;
+
+  return (true);
+}
+
+
+//
+// 'write_head()' - Write the head table.
+//
+// The checksum adjustment is cleared and the loca format is updated.
+//
+
+static void
+write_head(_ttf_subset_t *subset)	// I - Subset output
+{
+  const unsigned char	*head;		// head table
+  size_t		length,		// Length of head table
+			start;		// Start of head table in subset
+
+
+  head  = _ttfGetTable(subset->font, TTF_OFF_head, &length);
+  start = subset->length;
+
+  put_bytes(subset, head, 8);
+  put_ulong(subset, 0);			// checkSumAdjustment
+
+  if (length > 12)
+    put_bytes(subset, head + 12, length - 12);
+
+  if (length >= 54 && subset->offsets)
+  {
+    // Update indexToLocFormat for the new loca table...
+    subset->length = start + 50;
+    put_ushort(subset, subset->long_loca ? 1 : 0);
+    subset->length = start + length;
+  }
+}
+
+
+//
+// 'write_loca()' - Write the loca table.
+//
+
+static void
+write_loca(_ttf_subset_t *subset)	// I - Subset output
+{
+  size_t	glyph;			// Current glyph
+
+
+  for (glyph = 0; glyph <= subset->font->num_glyphs; glyph ++)
+  {
+    if (subset->long_loca)
+      put_ulong(subset, subset->offsets[glyph]);
+    else
+      put_ushort(subset, subset->offsets[glyph] / 2);
+  }
+}
+
+
+//
+// 'write_post()' - Write a version 3 post table without glyph names.
+//
+
+static void
+write_post(_ttf_subset_t *subset)	// I - Subset output
+{
+  const unsigned char	*post;		// post table
+  size_t		length;		// Length of post table
+
+
+  if ((post = _ttfGetTable(subset->font, TTF_OFF_post, &length)) == NULL || length < 32)
+    return;
+
+  put_ulong(subset, 0x00030000);	// version
+  put_bytes(subset, post + 4, 28);
+}
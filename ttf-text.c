@@ -0,0 +1,1468 @@
+//
+// Text layout code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+#include <float.h>
+
+
+//
+// Local types...
+//
+
+struct _ttf_measure_s			// Streaming text measurement
+{
+  ttf_t		*font;			// Font
+  float		size;			// Font size
+  bool		kerned;			// Apply kerning?
+  bool		error;			// Invalid UTF-8 seen?
+  bool		first;			// First character?
+  int		ch,			// Partial UTF-8 character
+		remaining,		// Remaining UTF-8 continuation bytes
+		prev;			// Previous glyph
+  float		left;			// Left offset
+  long long	width;			// Width in font units
+};
+
+struct _ttf_text_s			// Prepared text
+{
+  size_t	num_chars;		// Number of characters
+  int		*chars;			// Unicode characters
+  size_t	num_fonts,		// Number of fonts
+		alloc_fonts;		// Allocated fonts
+  struct _ttf_text_font_s *fonts;	// Per-font data
+};
+
+typedef struct _ttf_text_font_s		// Per-font data for prepared text
+{
+  ttf_t		*font;			// Font
+  int		*glyphs;		// Glyph for each character
+  long long	width,			// Width in font units
+		kerning;		// Total kerning in font units
+  short		left_bearing;		// Left bearing of first glyph
+} _ttf_text_font_t;
+
+typedef struct _ttf_word_s		// Word in a paragraph
+{
+  size_t	start,			// Offset of first byte in word
+		end;			// Offset after last byte in word
+  int		width,			// Width of word in font units
+		space;			// Width of trailing spaces in font units
+} _ttf_word_t;
+
+
+//
+// Local functions...
+//
+
+static size_t	add_lines(ttf_t *font, float size, _ttf_word_t *words, size_t num_words, long long line_width, ttf_wrap_t wrap, size_t num_lines, size_t max_lines, ttf_line_t *lines);
+static int	get_advance(ttf_t *font, int ch);
+static int	get_cells(int ch);
+static int	get_glyph(ttf_t *font, int ch);
+static _ttf_metric_t *get_metric(ttf_t *font, int glyph);
+static _ttf_text_font_t *get_text_font(ttf_text_t *text, ttf_t *font);
+static bool	is_break_after(int ch);
+static bool	is_ideographic(int ch);
+static bool	is_space(int ch);
+static int	next_char(const unsigned char **ptr, const unsigned char *end);
+
+
+//
+// 'ttfBreakLines()' - Break a paragraph of text into lines.
+//
+// This function breaks the UTF-8 string "s" into lines that are no wider than
+// "line_width" when rendered using the specified font "font" and size "size".
+// Lines are broken at spaces, after hyphens and dashes, and between
+// ideographic characters.  Newlines in the string always start a new line.
+//
+// The "wrap" argument specifies the line breaking algorithm -
+// `TTF_WRAP_GREEDY` puts as many words on each line as will fit while
+// `TTF_WRAP_OPTIMAL` chooses the breaks that minimize the total raggedness of
+// the paragraph (the sum of the squared unused space on each line except the
+// last) in the manner of the Knuth-Plass algorithm.  Each word is measured,
+// with kerning, exactly once.
+//
+// The "lines" argument points to an array of up to "max_lines" `ttf_line_t`
+// structures that receive the byte offsets and width of each line.  The return
+// value is the total number of lines in the paragraph, which may be larger than
+// "max_lines".
+//
+// This function does not modify the font and may be called for different
+// paragraphs from multiple threads at the same time.
+//
+
+size_t					// O - Number of lines
+ttfBreakLines(ttf_t      *font,		// I - Font
+              float      size,		// I - Font size
+              const char *s,		// I - String
+              float      line_width,	// I - Maximum width of a line
+              ttf_wrap_t wrap,		// I - Line breaking algorithm
+              size_t     max_lines,	// I - Maximum number of lines
+              ttf_line_t *lines)	// O - Lines
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		prev = -1;		// Previous glyph
+  const char	*sptr,			// Pointer into string
+		*next;			// Pointer to next character
+  _ttf_word_t	*words = NULL,		// Words in paragraph
+		*word;			// Current word
+  size_t	num_words = 0,		// Number of words
+		alloc_words = 0,	// Allocated words
+		first_word = 0,		// First word in the current paragraph
+		num_lines = 0;		// Number of lines
+  bool		in_space = false,	// In trailing spaces?
+		pending = false;	// Break after the last character?
+  long long	lwidth;			// Line width in font units
+
+
+  TTF_DEBUG("ttfBreakLines(font=%p, size=%.2f, s=\"%s\", line_width=%.2f, wrap=%d, max_lines=%u, lines=%p)\n", (void *)font, size, s, line_width, wrap, (unsigned)max_lines, (void *)lines);
+
+  // Range check input...
+  if (lines && max_lines > 0)
+    memset(lines, 0, max_lines * sizeof(ttf_line_t));
+
+  if (!font || size <= 0.0f || !s || line_width <= 0.0f || (max_lines > 0 && !lines))
+    return (0);
+
+  lwidth = (long long)(line_width * font->units / size);
+
+  // Split the string into words, measuring each one as we go...
+  for (sptr = s, word = NULL;; sptr = next)
+  {
+    next = sptr;
+    ch   = _ttfNextUnicode(font, &next);
+
+    if (!ch && !word)
+      break;				// String ends with a newline
+
+    if (!word || (ch && !is_space(ch) && ch != '\n' && (in_space || pending || (is_ideographic(ch) && prev >= 0))))
+    {
+      // Start a new word...
+      if (word && !in_space)
+        word->end = (size_t)(sptr - s);
+
+      if (num_words >= alloc_words)
+      {
+        _ttf_word_t *temp;		// New words array
+
+        if ((temp = (_ttf_word_t *)realloc(words, (alloc_words + 256) * sizeof(_ttf_word_t))) == NULL)
+        {
+          free(words);
+          return (0);
+        }
+
+        words       = temp;
+        alloc_words += 256;
+      }
+
+      word = words + num_words;
+      num_words ++;
+
+      memset(word, 0, sizeof(_ttf_word_t));
+      word->start = word->end = (size_t)(sptr - s);
+
+      in_space = false;
+      pending  = false;
+      prev     = -1;
+    }
+
+    if (!ch)
+    {
+      // End of string...
+      if (!in_space)
+        word->end = (size_t)(sptr - s);
+      break;
+    }
+    else if (ch == '\n')
+    {
+      // Hard line break...
+      if (!in_space)
+        word->end = (size_t)(sptr - s);
+
+      // Lay out this paragraph and start a new one...
+      num_lines  = add_lines(font, size, words + first_word, num_words - first_word, lwidth, wrap, num_lines, max_lines, lines);
+      first_word = num_words;
+      word       = NULL;
+      continue;
+    }
+    else if (is_space(ch))
+    {
+      // Trailing space...
+      if (!in_space)
+        word->end = (size_t)(sptr - s);
+
+      word->space += get_advance(font, ch == '\t' || ch == '\r' ? ' ' : ch);
+      in_space    = true;
+      pending     = false;
+      prev        = -1;
+    }
+    else
+    {
+      // Part of the word...
+      glyph       = get_glyph(font, ch);
+      word->width += get_advance(font, ch);
+
+      if (prev >= 0)
+        word->width += _ttfGetKerning(font, prev, glyph);
+
+      prev    = glyph;
+      pending = is_break_after(ch);
+    }
+  }
+
+  // Lay out the last paragraph...
+  if (first_word < num_words)
+    num_lines = add_lines(font, size, words + first_word, num_words - first_word, lwidth, wrap, num_lines, max_lines, lines);
+
+  free(words);
+
+  TTF_DEBUG("ttfBreakLines: Returning %u.\n", (unsigned)num_lines);
+
+  return (num_lines);
+}
+
+
+//
+// 'ttfFindCaret()' - Find the character boundary closest to a position.
+//
+// This function does a binary search of the caret positions returned by
+// @link ttfGetCaretPositions@ and returns the index of the boundary that is
+// closest to "x".  Positions before the first boundary return 0 and positions
+// after the last boundary return "num_carets - 1".
+//
+
+size_t					// O - Index of closest boundary
+ttfFindCaret(const float *carets,	// I - Caret positions
+             size_t      num_carets,	// I - Number of caret positions
+             float       x)		// I - Position
+{
+  size_t	left,			// Left index
+		right,			// Right index
+		current;		// Current index
+
+
+  if (!carets || num_carets < 2 || x <= carets[0])
+    return (0);
+  else if (x >= carets[num_carets - 1])
+    return (num_carets - 1);
+
+  // Find the first boundary at or after x...
+  for (left = 0, right = num_carets - 1; left < right;)
+  {
+    current = (left + right) / 2;
+
+    if (carets[current] < x)
+      left = current + 1;
+    else
+      right = current;
+  }
+
+  // Then choose the closer of it and the previous boundary...
+  if (left > 0 && (x - carets[left - 1]) < (carets[left] - x))
+    left --;
+
+  return (left);
+}
+
+
+//
+// 'ttfGetBlockExtents()' - Get the extents of a block of text.
+//
+// This function measures the UTF-8 string "s" as a block of lines separated by
+// newlines.  Tabs advance to the next multiple of "tab_width" - if
+// "tab_width" is 0, tab stops are every 8 spaces.
+//
+// The first line's baseline is at 0 and each following baseline is
+// @link ttfGetLineHeight@ below the previous one.  The block extents go from 0
+// on the left to the widest line on the right and from the top of the first
+// line to the bottom of the last line, using the font's bounding box.
+//
+// The "lines" argument points to an array of up to "max_lines" `ttf_line_t`
+// structures that receive the byte offsets (not including the newline) and
+// width of each line.  The return value is the total number of lines in the
+// block, which may be larger than "max_lines".
+//
+
+size_t					// O - Number of lines
+ttfGetBlockExtents(ttf_t      *font,	// I - Font
+                   float      size,	// I - Font size
+                   const char *s,	// I - String
+                   float      tab_width,// I - Distance between tab stops or 0 for default
+                   bool       kerned,	// I - Apply kerning?
+                   ttf_rect_t *extents,	// O - Extents of the block
+                   size_t     max_lines,// I - Maximum number of lines
+                   ttf_line_t *lines)	// O - Lines
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		prev = -1;		// Previous glyph
+  const char	*sptr,			// Pointer into string
+		*line,			// Start of current line
+		*end;			// End of current line
+  long long	x = 0,			// Current position in font units
+		max_x = 0,		// Widest line in font units
+		tab;			// Distance between tab stops in font units
+  size_t	num_lines = 0;		// Number of lines
+  int		line_height;		// Line height in font units
+
+
+  TTF_DEBUG("ttfGetBlockExtents(font=%p, size=%.2f, s=\"%s\", tab_width=%.2f, kerned=%s, extents=%p, max_lines=%u, lines=%p)\n", (void *)font, size, s, tab_width, kerned ? "true" : "false", (void *)extents, (unsigned)max_lines, (void *)lines);
+
+  // Range check input...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (lines && max_lines > 0)
+    memset(lines, 0, max_lines * sizeof(ttf_line_t));
+
+  if (!font || size <= 0.0f || !s || !extents || (max_lines > 0 && !lines))
+    return (0);
+
+  if (tab_width > 0.0f)
+    tab = (long long)(tab_width * font->units / size);
+  else
+    tab = 8 * get_advance(font, ' ');
+
+  if (font->use_typo)
+    line_height = font->typo_ascent - font->typo_descent + font->typo_line_gap;
+  else
+    line_height = font->ascent - font->descent + font->line_gap;
+
+  // Measure each line...
+  for (sptr = line = end = s; *sptr;)
+  {
+    if ((ch = _ttfNextUnicode(font, &sptr)) == 0)
+      break;
+
+    if (ch == '\n')
+    {
+      // End of line...
+      if (num_lines < max_lines)
+      {
+        lines[num_lines].start = (size_t)(line - s);
+        lines[num_lines].end   = (size_t)(end - s);
+        lines[num_lines].width = (float)(size * (double)x / font->units);
+      }
+
+      num_lines ++;
+
+      if (x > max_x)
+        max_x = x;
+
+      x    = 0;
+      prev = -1;
+      line = end = sptr;
+      continue;
+    }
+    else if (ch == '\r')
+    {
+      // Ignore carriage returns...
+      continue;
+    }
+    else if (ch == '\t')
+    {
+      // Advance to the next tab stop...
+      if (tab > 0)
+        x = (x / tab + 1) * tab;
+
+      prev = -1;
+    }
+    else
+    {
+      // Add the width of the character and any kerning...
+      x += get_advance(font, ch);
+
+      if (kerned)
+      {
+        glyph = get_glyph(font, ch);
+
+        if (prev >= 0)
+          x += _ttfGetKerning(font, prev, glyph);
+
+        prev = glyph;
+      }
+    }
+
+    end = sptr;
+  }
+
+  if (*line)
+  {
+    // Add the last line...
+    if (num_lines < max_lines)
+    {
+      lines[num_lines].start = (size_t)(line - s);
+      lines[num_lines].end   = (size_t)(end - s);
+      lines[num_lines].width = (float)(size * (double)x / font->units);
+    }
+
+    num_lines ++;
+
+    if (x > max_x)
+      max_x = x;
+  }
+
+  // Calculate the bounding box for the block and return...
+  if (num_lines > 0)
+  {
+    extents->bottom = size * ((float)font->y_min - (float)(num_lines - 1) * line_height) / font->units;
+    extents->right  = (float)(size * (double)max_x / font->units);
+    extents->top    = size * font->y_max / font->units;
+  }
+
+  TTF_DEBUG("ttfGetBlockExtents: Returning %u.\n", (unsigned)num_lines);
+
+  return (num_lines);
+}
+
+
+//
+// 'ttfGetCaretPositions()' - Get the position of every character boundary.
+//
+// This function measures the UTF-8 string "s" once and stores the kerned
+// position of each character boundary in the "carets" array - `carets[0]` is
+// always 0, `carets[i]` is the start of the i-th character (including any
+// kerning adjustment with the previous character), and the last position is
+// the width of the string.  If "offsets" is not `NULL`, the byte offset of each
+// boundary in the string is stored there as well.
+//
+// Up to "max_carets" positions are stored.  The return value is the total
+// number of boundaries, which is the number of characters plus one.
+//
+
+size_t					// O - Number of caret positions
+ttfGetCaretPositions(
+    ttf_t      *font,			// I - Font
+    float      size,			// I - Font size
+    const char *s,			// I - String
+    size_t     max_carets,		// I - Maximum number of caret positions
+    float      *carets,			// O - Caret positions
+    size_t     *offsets)		// O - Byte offsets of positions or `NULL`
+{
+  int		ch,			// Current character
+		glyph,			// Current glyph
+		prev = -1;		// Previous glyph
+  const char	*sptr;			// Pointer into string
+  long long	x = 0;			// Current position in font units
+  size_t	num_carets = 0;		// Number of caret positions
+  float		scale;			// Scaling factor
+
+
+  TTF_DEBUG("ttfGetCaretPositions(font=%p, size=%.2f, s=\"%s\", max_carets=%u, carets=%p, offsets=%p)\n", (void *)font, size, s, (unsigned)max_carets, (void *)carets, (void *)offsets);
+
+  // Range check input...
+  if (!font || size <= 0.0f || !s || (max_carets > 0 && !carets))
+    return (0);
+
+  scale = size / font->units;
+
+  for (sptr = s;;)
+  {
+    const char *start = sptr;		// Start of character
+
+    ch = _ttfNextUnicode(font, &sptr);
+
+    if (ch)
+    {
+      // Apply kerning to the start of this character...
+      glyph = get_glyph(font, ch);
+
+      if (prev >= 0)
+        x += _ttfGetKerning(font, prev, glyph);
+
+      prev = glyph;
+    }
+
+    if (num_carets < max_carets)
+    {
+      carets[num_carets] = scale * x;
+
+      if (offsets)
+        offsets[num_carets] = (size_t)(start - s);
+    }
+
+    num_carets ++;
+
+    if (!ch)
+      break;
+
+    x += get_advance(font, ch);
+  }
+
+  TTF_DEBUG("ttfGetCaretPositions: Returning %u.\n", (unsigned)num_carets);
+
+  return (num_carets);
+}
+
+
+//
+// 'ttfGetCellCount()' - Get the number of terminal cells used by a string.
+//
+// This function returns the number of character cells the UTF-8 string "s"
+// occupies in a terminal-style display - East Asian wide and fullwidth
+// characters use 2 cells, combining marks and control characters use 0 cells,
+// and all other characters use 1 cell.
+//
+
+size_t					// O - Number of cells
+ttfGetCellCount(const char *s)		// I - String
+{
+  size_t	cells = 0,		// Number of cells
+		count;			// Number of printable ASCII characters
+  int		ch;			// Current character
+  const unsigned char *ptr,		// Pointer into string
+		*end;			// End of string
+
+
+  if (!s)
+    return (0);
+
+  // There is no font for reporting errors, so stop at any invalid UTF-8...
+  for (ptr = (const unsigned char *)s, end = ptr + strlen(s); ptr < end;)
+  {
+    if ((count = _ttfCountPrintable((const char *)ptr, (size_t)(end - ptr))) > 0)
+    {
+      // Printable ASCII characters use 1 cell each...
+      cells += count;
+      ptr   += count;
+    }
+    else if ((ch = next_char(&ptr, end)) < 0)
+      break;
+    else
+      cells += (size_t)get_cells(ch);
+  }
+
+  return (cells);
+}
+
+
+//
+// 'ttfGetCellExtents()' - Get the extents of a string using terminal cells.
+//
+// This function returns the extents of the UTF-8 string "s" when each
+// character is placed in 1 or 2 fixed-width cells as reported by
+// @link ttfGetCellCount@.  The width of a cell is the width of the printable
+// ASCII characters for fixed-pitch fonts and the width of the digit "0"
+// otherwise.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetCellExtents(ttf_t      *font,	// I - Font
+                  float      size,	// I - Font size
+                  const char *s,	// I - String
+                  ttf_rect_t *extents)	// O - Extents of the string
+{
+  int	cell_width;			// Width of a cell
+
+
+  // Range check input...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (!font || size <= 0.0f || !s || !extents)
+    return (NULL);
+
+  if ((cell_width = font->fixed_width) == 0)
+    cell_width = get_advance(font, '0');
+
+  // Calculate the bounding box for the text and return...
+  extents->bottom = size * font->y_min / font->units;
+  extents->right  = (float)(size * (double)ttfGetCellCount(s) * cell_width / font->units);
+  extents->top    = size * font->y_max / font->units;
+
+  return (extents);
+}
+
+
+//
+// 'ttfGetRunExtents()' - Get the extents of a line of styled text runs.
+//
+// This function measures an array of text runs, each with its own font, size,
+// and UTF-8 string, as a single line of text.  If "len" is 0 for a run, the
+// run's string is nul-terminated.  Kerning (when "kerned" is `true`) is
+// applied within runs and between adjacent runs using the same font and size.
+//
+// The advance width of each run is stored in the "advances" array, which must
+// have room for "num_runs" values.  The line extents use the left offset of
+// the first run, the total advance width, and the largest ascent and descent
+// of the fonts and sizes used.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfGetRunExtents(
+    const ttf_run_t *runs,		// I - Text runs
+    size_t          num_runs,		// I - Number of runs
+    bool            kerned,		// I - Apply kerning?
+    float           *advances,		// O - Advance width of each run
+    ttf_rect_t      *extents)		// O - Extents of line
+{
+  size_t	i;			// Looping var
+  ttf_measure_t	measure;		// Measurement for current run
+  const ttf_run_t *run;			// Current run
+  double	x = 0.0;		// Current position
+  float		ascent,			// Ascent of current run
+		descent;		// Descent of current run
+
+
+  TTF_DEBUG("ttfGetRunExtents(runs=%p, num_runs=%u, kerned=%s, advances=%p, extents=%p)\n", (void *)runs, (unsigned)num_runs, kerned ? "true" : "false", (void *)advances, (void *)extents);
+
+  // Range check input...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (!runs || num_runs == 0 || !advances || !extents)
+    return (NULL);
+
+  memset(advances, 0, num_runs * sizeof(float));
+  memset(&measure, 0, sizeof(measure));
+
+  // Measure each run...
+  for (i = 0, run = runs; i < num_runs; i ++, run ++)
+  {
+    if (!run->font || run->size <= 0.0f || !run->s)
+      return (NULL);
+
+    // Reset the measurement for this run, keeping the previous glyph when the
+    // font and size are the same so that kerning applies between runs...
+    if (measure.font != run->font || measure.size != run->size)
+    {
+      measure.font   = run->font;
+      measure.size   = run->size;
+      measure.kerned = kerned;
+
+      ttfMeasureReset(&measure);
+    }
+    else
+    {
+      measure.width = 0;
+    }
+
+    measure.first = i == 0;
+
+    if (!ttfMeasureAdd(&measure, run->s, run->len ? run->len : strlen(run->s)))
+      return (NULL);
+
+    // Save the advance and update the line box...
+    advances[i] = (float)(run->size * (double)measure.width / run->font->units);
+    x           += advances[i];
+
+    if (i == 0)
+      extents->left = measure.left;
+
+    ascent  = run->size * run->font->ascent / run->font->units;
+    descent = run->size * run->font->descent / run->font->units;
+
+    if (i == 0 || ascent > extents->top)
+      extents->top = ascent;
+
+    if (i == 0 || descent < extents->bottom)
+      extents->bottom = descent;
+  }
+
+  extents->right = (float)(x + extents->left);
+
+  return (extents);
+}
+
+
+//
+// 'ttfMeasureAdd()' - Add a chunk of text to a streaming measurement.
+//
+// This function adds "len" bytes of UTF-8 text from "s" to the measurement.
+// Chunks can split UTF-8 sequences and kerning pairs - the partial character
+// and previous glyph are carried over to the next call.  Widths are
+// accumulated using 64-bit integers so that very long lines do not overflow.
+//
+// `false` is returned if the text contains an invalid UTF-8 sequence, in which
+// case the remaining text is ignored until @link ttfMeasureReset@ is called.
+//
+
+bool					// O - `true` on success, `false` on error
+ttfMeasureAdd(ttf_measure_t *measure,	// I - Measurement
+              const char    *s,		// I - Chunk of UTF-8 text
+              size_t        len)	// I - Length of chunk in bytes
+{
+  ttf_t		*font;			// Font
+  int		ch,			// Current byte or character
+		glyph;			// Current glyph
+  _ttf_metric_t	*widths;		// Widths
+
+
+  // Range check input...
+  if (!measure || (!s && len > 0))
+    return (false);
+  else if (measure->error)
+    return (false);
+
+  font = measure->font;
+
+  // Decode and measure each character...
+  for (; len > 0; s ++, len --)
+  {
+    ch = *s & 255;
+
+    if (measure->remaining > 0)
+    {
+      // Continuation byte...
+      if ((ch & 0xc0) != 0x80)
+        break;
+
+      measure->ch = (measure->ch << 6) | (ch & 0x3f);
+
+      if (-- measure->remaining > 0)
+        continue;
+
+      ch = measure->ch;
+    }
+    else if (ch == 0)
+    {
+      // Ignore nul bytes...
+      continue;
+    }
+    else if ((ch & 0xe0) == 0xc0)
+    {
+      // Start of two byte UTF-8...
+      measure->ch        = ch & 0x1f;
+      measure->remaining = 1;
+      continue;
+    }
+    else if ((ch & 0xf0) == 0xe0)
+    {
+      // Start of three byte UTF-8...
+      measure->ch        = ch & 0x0f;
+      measure->remaining = 2;
+      continue;
+    }
+    else if ((ch & 0xf8) == 0xf0)
+    {
+      // Start of four byte UTF-8...
+      measure->ch        = ch & 0x07;
+      measure->remaining = 3;
+      continue;
+    }
+    else if (ch & 0x80)
+    {
+      // Invalid UTF-8...
+      break;
+    }
+
+    // Find the character's width...
+    if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
+      widths += ch & 255;
+    else
+      widths = font->widths[0];		// Use the ".notdef" (0) glyph width...
+
+    if (widths)
+    {
+      if (measure->first)
+        measure->left = -widths->left_bearing / font->units;
+
+      measure->width += widths->width;
+    }
+
+    measure->first = false;
+
+    // Then any kerning...
+    if (measure->kerned)
+    {
+      glyph = get_glyph(font, ch);
+
+      if (measure->prev >= 0)
+        measure->width += _ttfGetKerning(font, measure->prev, glyph);
+
+      measure->prev = glyph;
+    }
+  }
+
+  if (len > 0)
+  {
+    _ttfError(font, "Invalid UTF-8 sequence starting with 0x%02X.", *s & 255);
+    measure->error = true;
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'ttfMeasureCreate()' - Create a streaming text measurement.
+//
+// This function creates an object for measuring text that arrives in chunks,
+// for example from a file or network stream.  Add text using the
+// @link ttfMeasureAdd@ function and get the extents of the text so far using
+// the @link ttfMeasureGetExtents@ function.
+//
+
+ttf_measure_t *				// O - Measurement or `NULL` on error
+ttfMeasureCreate(ttf_t *font,		// I - Font
+                 float size,		// I - Font size
+                 bool  kerned)		// I - Apply kerning?
+{
+  ttf_measure_t	*measure;		// Measurement
+
+
+  // Range check input...
+  if (!font || size <= 0.0f)
+    return (NULL);
+
+  // Allocate memory...
+  if ((measure = (ttf_measure_t *)calloc(1, sizeof(ttf_measure_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for text measurement.");
+    return (NULL);
+  }
+
+  measure->font   = font;
+  measure->size   = size;
+  measure->kerned = kerned;
+
+  ttfMeasureReset(measure);
+
+  return (measure);
+}
+
+
+//
+// 'ttfMeasureDelete()' - Delete a streaming text measurement.
+//
+
+void
+ttfMeasureDelete(
+    ttf_measure_t *measure)		// I - Measurement
+{
+  free(measure);
+}
+
+
+//
+// 'ttfMeasureGetExtents()' - Get the extents of the measured text.
+//
+// This function returns the extents of the text added so far, in the same
+// form as @link ttfGetExtents@ or @link ttfGetKernedExtents@.  An incomplete
+// UTF-8 sequence at the end of the last chunk is not included.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfMeasureGetExtents(
+    ttf_measure_t *measure,		// I - Measurement
+    ttf_rect_t    *extents)		// O - Extents of the text
+{
+  ttf_t	*font;				// Font
+
+
+  // Range check input...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (!measure || !extents)
+    return (NULL);
+
+  font = measure->font;
+
+  extents->left   = measure->left;
+  extents->bottom = measure->size * font->y_min / font->units;
+  extents->right  = (float)(measure->size * (double)measure->width / font->units + measure->left);
+  extents->top    = measure->size * font->y_max / font->units;
+
+  return (extents);
+}
+
+
+//
+// 'ttfMeasureReset()' - Reset a streaming text measurement.
+//
+
+void
+ttfMeasureReset(ttf_measure_t *measure)	// I - Measurement
+{
+  if (!measure)
+    return;
+
+  measure->error     = false;
+  measure->first     = true;
+  measure->ch        = 0;
+  measure->remaining = 0;
+  measure->prev      = -1;
+  measure->left      = 0.0f;
+  measure->width     = 0;
+}
+
+
+//
+// 'ttfTextCreate()' - Create a prepared text object.
+//
+// This function decodes the UTF-8 string "s" once so that it can be measured
+// repeatedly using different fonts and sizes.  The glyphs and widths for each
+// font are computed the first time the font is used with the text, after
+// which measuring the text at any size takes constant time.
+//
+// Fonts used with a prepared text object must not be deleted before the text
+// object.  A prepared text object must not be used from multiple threads at
+// the same time.
+//
+
+ttf_text_t *				// O - Prepared text or `NULL` on error
+ttfTextCreate(const char *s)		// I - UTF-8 string
+{
+  ttf_text_t	*text;			// Prepared text
+  const unsigned char *sptr,		// Pointer into string
+		*send;			// End of string
+  int		ch;			// Current character
+
+
+  // Range check input...
+  if (!s)
+    return (NULL);
+
+  // Allocate memory - a UTF-8 string never has more characters than bytes...
+  if ((text = (ttf_text_t *)calloc(1, sizeof(ttf_text_t))) == NULL)
+    return (NULL);
+
+  if ((text->chars = (int *)malloc((strlen(s) + 1) * sizeof(int))) == NULL)
+  {
+    free(text);
+    return (NULL);
+  }
+
+  // Decode the string, stopping at any invalid UTF-8 like ttfGetExtents...
+  for (sptr = (const unsigned char *)s, send = sptr + strlen(s); sptr < send && (ch = next_char(&sptr, send)) >= 0;)
+    text->chars[text->num_chars ++] = ch;
+
+  return (text);
+}
+
+
+//
+// 'ttfTextDelete()' - Delete a prepared text object.
+//
+
+void
+ttfTextDelete(ttf_text_t *text)		// I - Prepared text
+{
+  size_t	i;			// Looping var
+
+
+  if (!text)
+    return;
+
+  for (i = 0; i < text->num_fonts; i ++)
+    free(text->fonts[i].glyphs);
+
+  free(text->fonts);
+  free(text->chars);
+  free(text);
+}
+
+
+//
+// 'ttfTextGetExtents()' - Get the extents of prepared text.
+//
+// This function returns the same extents as @link ttfGetExtents@ (when
+// "kerned" is `false`) or @link ttfGetKernedExtents@ (when "kerned" is `true`)
+// for the prepared text.
+//
+
+ttf_rect_t *				// O - Pointer to extents or `NULL` on error
+ttfTextGetExtents(ttf_text_t *text,	// I - Prepared text
+                  ttf_t      *font,	// I - Font
+                  float      size,	// I - Font size
+                  bool       kerned,	// I - Apply kerning?
+                  ttf_rect_t *extents)	// O - Extents of the text
+{
+  _ttf_text_font_t	*tf;		// Per-font data
+
+
+  // Range check input...
+  if (extents)
+    memset(extents, 0, sizeof(ttf_rect_t));
+
+  if (!text || !font || size <= 0.0f || !extents || (tf = get_text_font(text, font)) == NULL)
+    return (NULL);
+
+  // Calculate the bounding box for the text and return...
+  if (text->num_chars > 0)
+    extents->left = -tf->left_bearing / font->units;
+
+  extents->bottom = size * font->y_min / font->units;
+  extents->right  = (float)(size * (double)(kerned ? tf->width + tf->kerning : tf->width) / font->units + extents->left);
+  extents->top    = size * font->y_max / font->units;
+
+  return (extents);
+}
+
+
+//
+// 'ttfTextGetFitSize()' - Get the largest font size for which prepared text fits.
+//
+// This function returns the largest font size for which the prepared text is
+// no wider than "width" and, if "height" is greater than 0, no taller than
+// "height" using the font's bounding box.  0 is returned on error.
+//
+
+float					// O - Font size or 0 on error
+ttfTextGetFitSize(ttf_text_t *text,	// I - Prepared text
+                  ttf_t      *font,	// I - Font
+                  bool       kerned,	// I - Apply kerning?
+                  float      width,	// I - Maximum width
+                  float      height)	// I - Maximum height or 0 for any
+{
+  _ttf_text_font_t	*tf;		// Per-font data
+  long long		twidth;		// Width of text in font units
+  float			size;		// Font size
+
+
+  // Range check input...
+  if (!text || !font || width <= 0.0f || (tf = get_text_font(text, font)) == NULL)
+    return (0.0f);
+
+  // The width of text is proportional to the font size, so just compute the
+  // largest size directly...
+  twidth = kerned ? tf->width + tf->kerning : tf->width;
+
+  if (twidth > 0)
+    size = (float)((double)width * font->units / twidth);
+  else
+    size = FLT_MAX;
+
+  if (height > 0.0f && font->y_max > font->y_min && (height * font->units / (font->y_max - font->y_min)) < size)
+    size = height * font->units / (font->y_max - font->y_min);
+
+  return (size < FLT_MAX ? size : 0.0f);
+}
+
+
+//
+// 'ttfTextGetGlyphs()' - Get the glyphs for prepared text.
+//
+// This function returns the glyph for each character in the prepared text
+// using the specified font.  Characters not present in the font use glyph 0
+// (".notdef").  The returned array is owned by the prepared text object.
+//
+
+const int *				// O - Array of glyphs or `NULL` on error
+ttfTextGetGlyphs(ttf_text_t *text,	// I - Prepared text
+                 ttf_t      *font,	// I - Font
+                 size_t     *num_glyphs)// O - Number of glyphs
+{
+  _ttf_text_font_t	*tf;		// Per-font data
+
+
+  if (num_glyphs)
+    *num_glyphs = 0;
+
+  if (!text || !font || !num_glyphs || (tf = get_text_font(text, font)) == NULL)
+    return (NULL);
+
+  *num_glyphs = text->num_chars;
+
+  return (tf->glyphs);
+}
+
+
+//
+// 'add_lines()' - Break a list of words into lines.
+//
+
+static size_t				// O - New number of lines
+add_lines(ttf_t       *font,		// I - Font
+          float       size,		// I - Font size
+          _ttf_word_t *words,		// I - Words
+          size_t      num_words,	// I - Number of words
+          long long   line_width,	// I - Line width in font units
+          ttf_wrap_t  wrap,		// I - Line breaking algorithm
+          size_t      num_lines,	// I - Current number of lines
+          size_t      max_lines,	// I - Maximum number of lines
+          ttf_line_t  *lines)		// O - Lines
+{
+  size_t	i, j,			// Looping vars
+		count;			// Number of lines in paragraph
+  long long	*offsets = NULL,	// Offset of each word from the start
+		width;			// Width of line
+  double	*costs = NULL,		// Cost of breaking before each word
+		cost;			// Cost of current line
+  size_t	*breaks = NULL;		// Previous break for each word
+
+
+  // Compute the offsets of each word...
+  if ((offsets = (long long *)malloc((num_words + 1) * sizeof(long long))) == NULL)
+    return (num_lines);
+
+  for (i = 0, offsets[0] = 0; i < num_words; i ++)
+    offsets[i + 1] = offsets[i] + words[i].width + words[i].space;
+
+  // Then figure out the breaks for each line...
+  if ((breaks = (size_t *)malloc((num_words + 1) * sizeof(size_t))) == NULL)
+    goto done;
+
+  if (wrap == TTF_WRAP_OPTIMAL)
+  {
+    // Find the lowest cost set of breaks using dynamic programming - the cost
+    // of a line is the square of its unused width...
+    if ((costs = (double *)malloc((num_words + 1) * sizeof(double))) == NULL)
+      goto done;
+
+    costs[0]  = 0.0;
+    breaks[0] = 0;
+
+    for (j = 1; j <= num_words; j ++)
+    {
+      costs[j]  = DBL_MAX;
+      breaks[j] = j - 1;
+
+      for (i = j; i > 0; i --)
+      {
+        // Words i-1 through j-1...
+        width = offsets[j] - offsets[i - 1] - words[j - 1].space;
+
+        if (width > line_width && i < j)
+          break;			// Won't fit with any more words
+
+        if (width > line_width)
+          cost = (double)(width - line_width) * (double)(width - line_width) * 1000.0;
+        else if (j == num_words)
+          cost = 0.0;			// Don't penalize the last line
+        else
+          cost = (double)(line_width - width) * (double)(line_width - width);
+
+        if ((costs[i - 1] + cost) < costs[j])
+        {
+          costs[j]  = costs[i - 1] + cost;
+          breaks[j] = i - 1;
+        }
+      }
+    }
+  }
+  else
+  {
+    // Greedily fill each line, recording the breaks from the end...
+    size_t	*starts;		// Start of each line
+
+    if ((starts = (size_t *)malloc((num_words + 1) * sizeof(size_t))) == NULL)
+      goto done;
+
+    for (i = 0, count = 0; i < num_words; count ++)
+    {
+      starts[count] = i;
+
+      for (j = i + 1; j < num_words; j ++)
+      {
+        if ((offsets[j + 1] - offsets[i] - words[j].space) > line_width)
+          break;
+      }
+
+      i = j;
+    }
+
+    for (i = count, j = num_words; i > 0; i --)
+    {
+      breaks[j] = starts[i - 1];
+      j         = starts[i - 1];
+    }
+
+    free(starts);
+  }
+
+  // Count the lines...
+  for (j = num_words, count = 0; j > 0; j = breaks[j])
+    count ++;
+
+  // Copy the lines, working backwards from the last one...
+  for (j = num_words, i = num_lines + count; j > 0; j = breaks[j])
+  {
+    i --;
+
+    if (i < max_lines)
+    {
+      width = offsets[j] - offsets[breaks[j]] - words[j - 1].space;
+
+      lines[i].start = words[breaks[j]].start;
+      lines[i].end   = words[j - 1].end;
+      lines[i].width = size * width / font->units;
+    }
+  }
+
+  num_lines += count;
+
+  done:
+
+  free(offsets);
+  free(costs);
+  free(breaks);
+
+  return (num_lines);
+}
+
+
+//
+// 'get_advance()' - Get the advance width of a character in font units.
+//
+
+static int				// O - Advance width
+get_advance(ttf_t *font,		// I - Font
+            int   ch)			// I - Character
+{
+  _ttf_metric_t	*widths;		// Widths
+
+
+  if (ch < TTF_FONT_MAX_CHAR && (widths = font->widths[ch / 256]) != NULL)
+    return (widths[ch & 255].width);
+  else if ((widths = font->widths[0]) != NULL)
+    return (widths[0].width);		// Use the ".notdef" (0) glyph width...
+  else
+    return (0);
+}
+
+
+//
+// 'get_cells()' - Get the number of terminal cells used by a character.
+//
+
+static int				// O - Number of cells (0 to 2)
+get_cells(int ch)			// I - Character
+{
+  size_t	left,			// Left index
+		right,			// Right index
+		current;		// Current index
+  static const int ranges[][3] =	// Ranges of non-single-cell characters
+  {
+    { 0x0000, 0x001F, 0 },		// C0 controls
+    { 0x007F, 0x009F, 0 },		// DEL and C1 controls
+    { 0x0300, 0x036F, 0 },		// Combining diacritical marks
+    { 0x0483, 0x0489, 0 },		// Combining Cyrillic
+    { 0x0591, 0x05BD, 0 },		// Hebrew points
+    { 0x064B, 0x065F, 0 },		// Arabic marks
+    { 0x1100, 0x115F, 2 },		// Hangul Jamo initials
+    { 0x1AB0, 0x1AFF, 0 },		// Combining diacritical marks extended
+    { 0x1DC0, 0x1DFF, 0 },		// Combining diacritical marks supplement
+    { 0x200B, 0x200F, 0 },		// Zero-width spaces and marks
+    { 0x20D0, 0x20FF, 0 },		// Combining marks for symbols
+    { 0x231A, 0x231B, 2 },		// Watch and hourglass
+    { 0x2329, 0x232A, 2 },		// Angle brackets
+    { 0x2E80, 0x303E, 2 },		// CJK radicals and punctuation
+    { 0x3041, 0x33FF, 2 },		// Kana, Bopomofo, and CJK compatibility
+    { 0x3400, 0x4DBF, 2 },		// CJK unified ideographs extension A
+    { 0x4E00, 0x9FFF, 2 },		// CJK unified ideographs
+    { 0xA000, 0xA4CF, 2 },		// Yi
+    { 0xA960, 0xA97F, 2 },		// Hangul Jamo extended A
+    { 0xAC00, 0xD7A3, 2 },		// Hangul syllables
+    { 0xF900, 0xFAFF, 2 },		// CJK compatibility ideographs
+    { 0xFE00, 0xFE0F, 0 },		// Variation selectors
+    { 0xFE10, 0xFE19, 2 },		// Vertical forms
+    { 0xFE20, 0xFE2F, 0 },		// Combining half marks
+    { 0xFE30, 0xFE6F, 2 },		// CJK compatibility and small forms
+    { 0xFEFF, 0xFEFF, 0 },		// Zero-width no-break space
+    { 0xFF00, 0xFF60, 2 },		// Fullwidth forms
+    { 0xFFE0, 0xFFE6, 2 },		// Fullwidth signs
+    { 0x16FE0, 0x16FE4, 2 },		// Ideographic symbols
+    { 0x17000, 0x18CFF, 2 },		// Tangut and Khitan
+    { 0x1B000, 0x1B2FF, 2 },		// Kana supplement and Nushu
+    { 0x1F300, 0x1F64F, 2 },		// Pictographs and emoticons
+    { 0x1F900, 0x1F9FF, 2 },		// Supplemental symbols and pictographs
+    { 0x20000, 0x2FFFD, 2 },		// CJK unified ideographs extension B+
+    { 0x30000, 0x3FFFD, 2 },		// CJK unified ideographs extension G+
+    { 0xE0100, 0xE01EF, 0 }		// Variation selectors supplement
+  };
+
+
+  // Binary search for the range containing the character...
+  for (left = 0, right = sizeof(ranges) / sizeof(ranges[0]); left < right;)
+  {
+    current = (left + right) / 2;
+
+    if (ch < ranges[current][0])
+      right = current;
+    else if (ch > ranges[current][1])
+      left = current + 1;
+    else
+      return (ranges[current][2]);
+  }
+
+  return (1);
+}
+
+
+//
+// 'get_glyph()' - Get the glyph for a character.
+//
+
+static int				// O - Glyph index
+get_glyph(ttf_t *font,			// I - Font
+          int   ch)			// I - Character
+{
+  if (ch < (int)font->num_cmap && font->cmap[ch] > 0)
+    return (font->cmap[ch]);
+  else
+    return (0);
+}
+
+
+//
+// 'get_metric()' - Get the metrics for a glyph.
+//
+
+static _ttf_metric_t *			// O - Glyph metrics
+get_metric(ttf_t *font,			// I - Font
+           int   glyph)			// I - Glyph index
+{
+  if (glyph >= 0 && (size_t)glyph < font->num_glyph_widths)
+    return (font->glyph_widths + glyph);
+  else
+    return (&font->def_width);
+}
+
+
+//
+// 'get_text_font()' - Get the per-font data for prepared text.
+//
+
+static _ttf_text_font_t *		// O - Per-font data or `NULL` on error
+get_text_font(ttf_text_t *text,		// I - Prepared text
+              ttf_t      *font)		// I - Font
+{
+  size_t		i;		// Looping var
+  _ttf_text_font_t	*tf;		// Per-font data
+  int			glyph,		// Current glyph
+			prev = -1;	// Previous glyph
+
+
+  // See if we've already used this font...
+  for (i = text->num_fonts, tf = text->fonts; i > 0; i --, tf ++)
+  {
+    if (tf->font == font)
+      return (tf);
+  }
+
+  // No, add it...
+  if (text->num_fonts >= text->alloc_fonts)
+  {
+    if ((tf = (_ttf_text_font_t *)realloc(text->fonts, (text->alloc_fonts + 4) * sizeof(_ttf_text_font_t))) == NULL)
+    {
+      _ttfError(font, "Unable to allocate memory for prepared text.");
+      return (NULL);
+    }
+
+    text->fonts       = tf;
+    text->alloc_fonts += 4;
+  }
+
+  tf = text->fonts + text->num_fonts;
+  memset(tf, 0, sizeof(_ttf_text_font_t));
+
+  if ((tf->glyphs = (int *)malloc((text->num_chars + 1) * sizeof(int))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for prepared text.");
+    return (NULL);
+  }
+
+  tf->font = font;
+
+  // Map the characters to glyphs and add up the widths and kerning...
+  for (i = 0; i < text->num_chars; i ++)
+  {
+    tf->glyphs[i] = glyph = get_glyph(font, text->chars[i]);
+    tf->width     += get_metric(font, glyph)->width;
+
+    if (prev >= 0)
+      tf->kerning += _ttfGetKerning(font, prev, glyph);
+
+    prev = glyph;
+  }
+
+  if (text->num_chars > 0)
+    tf->left_bearing = get_metric(font, tf->glyphs[0])->left_bearing;
+
+  text->num_fonts ++;
+
+  return (tf);
+}
+
+
+//
+// 'is_break_after()' - Determine whether a line can be broken after a character.
+//
+
+static bool				// O - `true` if a break is allowed, `false` otherwise
+is_break_after(int ch)			// I - Character
+{
+  return (ch == '-' || ch == 0x200B || (ch >= 0x2010 && ch <= 0x2014) || is_ideographic(ch));
+}
+
+
+//
+// 'is_ideographic()' - Determine whether a character is ideographic.
+//
+// Lines can be broken before and after ideographic characters.
+//
+
+static bool				// O - `true` if ideographic, `false` otherwise
+is_ideographic(int ch)			// I - Character
+{
+  return ((ch >= 0x2E80 && ch <= 0x2FFF) || (ch >= 0x3040 && ch <= 0x9FFF) || (ch >= 0xAC00 && ch <= 0xD7AF) || (ch >= 0xF900 && ch <= 0xFAFF) || (ch >= 0xFF01 && ch <= 0xFF60) || (ch >= 0x20000 && ch <= 0x3FFFF));
+}
+
+
+//
+// 'is_space()' - Determine whether a character is a breaking space.
+//
+
+static bool				// O - `true` if a space, `false` otherwise
+is_space(int ch)			// I - Character
+{
+  return (ch == ' ' || ch == '\t' || ch == '\r' || (ch >= 0x2000 && ch <= 0x200A) || ch == 0x3000);
+}
+
+
+//
+// 'next_char()' - Decode the next UTF-8 character.
+//
+// Unlike `_ttfNextUnicode`, invalid UTF-8 is not reported since there is no
+// font for the error callback.
+//
+
+static int				// O  - Unicode character or `-1` if invalid
+next_char(const unsigned char **ptr,	// IO - Pointer into string
+          const unsigned char *end)	// I  - End of string
+{
+  const unsigned char	*p = *ptr;	// Pointer into string
+  int			ch;		// Unicode character
+
+
+  if (*p < 0x80)
+  {
+    ch = *p++;
+  }
+  else if ((*p & 0xe0) == 0xc0 && (end - p) >= 2 && (p[1] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+    p  += 2;
+  }
+  else if ((*p & 0xf0) == 0xe0 && (end - p) >= 3 && (p[1] & 0xc0) == 0x80 && (p[2] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+    p  += 3;
+  }
+  else if ((*p & 0xf8) == 0xf0 && (end - p) >= 4 && (p[1] & 0xc0) == 0x80 && (p[2] & 0xc0) == 0x80 && (p[3] & 0xc0) == 0x80)
+  {
+    ch = ((p[0] & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+    p  += 4;
+  }
+  else
+  {
+    // Invalid UTF-8, skip a byte...
+    ch = -1;
+    p  ++;
+  }
+
+  *ptr = p;
+
+  return (ch);
+}
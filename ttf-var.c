@@ -0,0 +1,885 @@
+//
+// Variable font code for TTF library
+//
+// https://www.msweet.org/ttf
+//
+// Copyright © 2026 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#include "ttf-private.h"
+#include <math.h>
+
+
+//
+// Constants...
+//
+
+#define TTF_OFF_avar	0x61766172	// Axis variations
+#define TTF_OFF_fvar	0x66766172	// Font variations
+#define TTF_OFF_HVAR	0x48564152	// Horizontal metrics variations
+#define TTF_OFF_MVAR	0x4d564152	// Metrics variations
+
+#define TTF_MVAR_cpht	0x63706874	// Cap height
+#define TTF_MVAR_hasc	0x68617363	// Horizontal ascender
+#define TTF_MVAR_hdsc	0x68647363	// Horizontal descender
+#define TTF_MVAR_hlgp	0x686c6770	// Horizontal line gap
+#define TTF_MVAR_xhgt	0x78686774	// X height
+
+#define TTF_VAR_ital	0x6974616c	// Italic axis
+#define TTF_VAR_slnt	0x736c6e74	// Slant axis
+#define TTF_VAR_wdth	0x77647468	// Width axis
+#define TTF_VAR_wght	0x77676874	// Weight axis
+
+#define TTF_VAR_MAX_AXES 64		// Maximum number of variation axes
+
+
+//
+// Local functions...
+//
+
+static ttf_t	*create_instance(ttf_t *font, const float *coords, const short *ncoords);
+static float	get_delta(const unsigned char *store, size_t length, const float *scalars, unsigned num_regions, unsigned outer, unsigned inner);
+static void	get_mapping(const unsigned char *map, size_t length, unsigned n, unsigned *outer, unsigned *inner);
+static float	*get_scalars(const unsigned char *store, size_t length, const short *ncoords, size_t num_ncoords, unsigned *num_regions);
+static bool	load_fvar(ttf_t *font);
+static void	normalize_coords(ttf_t *font, float *coords, short *ncoords);
+static void	read_hvar(ttf_t *font, const short *ncoords, size_t num_ncoords);
+static void	read_mvar(ttf_t *font, const short *ncoords, size_t num_ncoords);
+
+
+//
+// '_ttfVarDelete()' - Free the variation data and cached instances of a font.
+//
+// This function must be called before the font data is unmapped since the
+// cached instances share it.
+//
+
+void
+_ttfVarDelete(ttf_t *font)		// I - Font
+{
+  size_t	i;			// Looping var
+
+
+  for (i = 0; i < font->num_vars; i ++)
+  {
+    ttfDelete(font->vars[i].font);
+    free(font->vars[i].coords);
+  }
+
+  free(font->vars);
+
+  for (i = 0; i < font->num_instances; i ++)
+  {
+    free(font->instances[i].name);
+    free(font->instances[i].coords);
+  }
+
+  free(font->instances);
+  free(font->axes);
+}
+
+
+//
+// 'ttfGetAxes()' - Get the variation axes of a font.
+//
+// `NULL` is returned for fonts without an "fvar" table.
+//
+
+const ttf_axis_t *			// O - Variation axes or `NULL` if none
+ttfGetAxes(ttf_t  *font,		// I - Font
+           size_t *num_axes)		// O - Number of variation axes
+{
+  if (num_axes)
+    *num_axes = 0;
+
+  if (!font || !num_axes)
+    return (NULL);
+
+  _ttfMutexLock(&font->lock);
+  load_fvar(font);
+  _ttfMutexUnlock(&font->lock);
+
+  *num_axes = font->num_axes;
+
+  return (font->axes);
+}
+
+
+//
+// 'ttfGetInstance()' - Get a named instance of a variable font.
+//
+// The returned font is managed by the base font and should not be deleted.
+//
+
+ttf_t *					// O - Instance font or `NULL` on error
+ttfGetInstance(ttf_t  *font,		// I - Font
+               size_t n)		// I - Instance number (0-based)
+{
+  if (n >= ttfGetNumInstances(font))
+    return (NULL);
+
+  return (ttfGetVariation(font, font->instances[n].coords, font->num_axes));
+}
+
+
+//
+// 'ttfGetInstanceName()' - Get the subfamily name of a named instance.
+//
+
+const char *				// O - Subfamily name or `NULL` if none
+ttfGetInstanceName(ttf_t  *font,	// I - Font
+                   size_t n)		// I - Instance number (0-based)
+{
+  if (n >= ttfGetNumInstances(font))
+    return (NULL);
+
+  return (font->instances[n].name);
+}
+
+
+//
+// 'ttfGetNumInstances()' - Get the number of named instances in a variable font.
+//
+
+size_t					// O - Number of named instances
+ttfGetNumInstances(ttf_t *font)		// I - Font
+{
+  if (!font)
+    return (0);
+
+  _ttfMutexLock(&font->lock);
+  load_fvar(font);
+  _ttfMutexUnlock(&font->lock);
+
+  return (font->num_instances);
+}
+
+
+//
+// 'ttfGetVariation()' - Get an instance of a variable font.
+//
+// The "coords" argument specifies user-space coordinates in the order of the
+// axes returned by @link ttfGetAxes@ - missing coordinates use the default
+// value of the axis.  The advance widths and vertical metrics of the instance
+// are computed once from the "HVAR" and "MVAR" tables and the instance is
+// cached by its normalized coordinates, so subsequent calls for the same
+// instance return the same font object.
+//
+// The font itself is returned for static fonts and for the default instance.
+// Other instances are managed by the base font and should not be deleted.
+//
+
+ttf_t *					// O - Instance font or `NULL` on error
+ttfGetVariation(ttf_t       *font,	// I - Font
+                const float *coords,	// I - User-space axis coordinates
+                size_t      num_coords)	// I - Number of coordinates
+{
+  ttf_t		*instance = NULL;	// Instance font
+  float		ucoords[TTF_VAR_MAX_AXES];
+					// User-space coordinates
+  short		ncoords[TTF_VAR_MAX_AXES];
+					// Normalized coordinates
+  size_t	i;			// Looping var
+  _ttf_var_t	*var;			// Cached instance
+
+
+  // Range check input...
+  if (!font || (num_coords && !coords))
+    return (NULL);
+
+  _ttfMutexLock(&font->lock);
+
+  if (!load_fvar(font) || font->num_axes == 0)
+  {
+    _ttfMutexUnlock(&font->lock);
+    return (font);
+  }
+
+  // Normalize the coordinates...
+  for (i = 0; i < font->num_axes; i ++)
+    ucoords[i] = i < num_coords ? coords[i] : font->axes[i].default_value;
+
+  normalize_coords(font, ucoords, ncoords);
+
+  for (i = 0; i < font->num_axes; i ++)
+  {
+    if (ncoords[i])
+      break;
+  }
+
+  if (i >= font->num_axes)
+  {
+    // Default instance...
+    _ttfMutexUnlock(&font->lock);
+    return (font);
+  }
+
+  // Look for a cached instance...
+  for (i = font->num_vars, var = font->vars; i > 0; i --, var ++)
+  {
+    if (!memcmp(var->coords, ncoords, font->num_axes * sizeof(short)))
+    {
+      instance = var->font;
+      break;
+    }
+  }
+
+  if (!instance && (var = realloc(font->vars, (font->num_vars + 1) * sizeof(_ttf_var_t))) != NULL)
+  {
+    // Create a new instance...
+    font->vars = var;
+    var        += font->num_vars;
+
+    if ((var->coords = malloc(font->num_axes * sizeof(short))) != NULL)
+    {
+      if ((instance = create_instance(font, ucoords, ncoords)) != NULL)
+      {
+        memcpy(var->coords, ncoords, font->num_axes * sizeof(short));
+        var->font = instance;
+        font->num_vars ++;
+      }
+      else
+      {
+        free(var->coords);
+      }
+    }
+  }
+
+  _ttfMutexUnlock(&font->lock);
+
+  return (instance);
+}
+
+
+//
+// 'create_instance()' - Create an instance of a variable font.
+//
+// The caller holds the font lock.
+//
+
+static ttf_t *				// O - Instance font or `NULL` on error
+create_instance(ttf_t       *font,	// I - Base font
+                const float *coords,	// I - User-space coordinates
+                const short *ncoords)	// I - Normalized coordinates
+{
+  ttf_t		*instance;		// Instance font
+  size_t	i,			// Looping var
+		j,			// Looping var
+		best;			// Closest stretch
+  static const float percents[] =	// Width percentages for each stretch
+  {
+    100.0f,				// normal
+    50.0f,				// ultra-condensed
+    62.5f,				// extra-condensed
+    75.0f,				// condensed
+    87.5f,				// semi-condensed
+    112.5f,				// semi-expanded
+    125.0f,				// expanded
+    150.0f,				// extra-expanded
+    200.0f				// ultra-expanded
+  };
+
+
+  // Load the default instance from the shared font data...
+  if ((instance = ttfCreateData(font->data, font->data_size, font->idx, font->err_cb, font->err_cbdata)) == NULL)
+    return (NULL);
+
+  // Apply the metrics variations...
+  read_hvar(instance, ncoords, font->num_axes);
+  read_mvar(instance, ncoords, font->num_axes);
+
+  // Update the style from the registered axes...
+  for (i = 0; i < font->num_axes; i ++)
+  {
+    switch (TTF_GET_ULONG((const unsigned char *)font->axes[i].tag))
+    {
+      case TTF_VAR_ital :
+          if (coords[i] >= 0.5f)
+            instance->style = TTF_STYLE_ITALIC;
+          else if (instance->style == TTF_STYLE_ITALIC)
+            instance->style = TTF_STYLE_NORMAL;
+          break;
+
+      case TTF_VAR_slnt :
+          instance->italic_angle = coords[i];
+
+          if (coords[i] != 0.0f && instance->style == TTF_STYLE_NORMAL)
+            instance->style = TTF_STYLE_OBLIQUE;
+          else if (coords[i] == 0.0f && instance->style == TTF_STYLE_OBLIQUE)
+            instance->style = TTF_STYLE_NORMAL;
+          break;
+
+      case TTF_VAR_wdth :
+          for (j = 1, best = 0; j < (sizeof(percents) / sizeof(percents[0])); j ++)
+          {
+            if (fabsf(coords[i] - percents[j]) < fabsf(coords[i] - percents[best]))
+              best = j;
+          }
+
+          instance->stretch = (ttf_stretch_t)best;
+          break;
+
+      case TTF_VAR_wght :
+          if (coords[i] < 150.0f)
+            instance->weight = 100;
+          else if (coords[i] >= 850.0f)
+            instance->weight = 900;
+          else
+            instance->weight = (short)(100 * (int)((coords[i] + 50.0f) / 100.0f));
+          break;
+    }
+  }
+
+  return (instance);
+}
+
+
+//
+// 'get_delta()' - Get a delta value from an item variation store.
+//
+
+static float				// O - Delta value
+get_delta(const unsigned char *store,	// I - Item variation store
+          size_t              length,	// I - Length of store
+          const float         *scalars,	// I - Region scalars
+          unsigned            num_regions,
+					// I - Number of regions
+          unsigned            outer,	// I - Outer (data) index
+          unsigned            inner)	// I - Inner (row) index
+{
+  const unsigned char	*data,		// Item variation data
+			*row;		// Delta set row
+  size_t		offset;		// Offset of item variation data
+  unsigned		i,		// Looping var
+			num_items,	// Number of rows
+			num_words,	// Number of word deltas
+			num_indices,	// Number of region indices
+			word_size,	// Size of word deltas
+			row_size,	// Size of row
+			region;		// Region index
+  int			value;		// Delta value for region
+  float			delta = 0.0f;	// Delta value
+
+
+  // ItemVariationStore: format, variationRegionListOffset,
+  // itemVariationDataCount, itemVariationDataOffsets[]
+  if (outer >= TTF_GET_USHORT(store + 6) || (8 + 4 * (size_t)outer) > (length - 4))
+    return (0.0f);
+
+  if ((offset = TTF_GET_ULONG(store + 8 + 4 * outer)) == 0 || offset > (length - 6))
+    return (0.0f);
+
+  // ItemVariationData: itemCount, wordDeltaCount, regionIndexCount,
+  // regionIndexes[], deltaSets[]
+  data        = store + offset;
+  num_items   = TTF_GET_USHORT(data);
+  num_words   = TTF_GET_USHORT(data + 2) & 0x7fff;
+  word_size   = (TTF_GET_USHORT(data + 2) & 0x8000) ? 4 : 2;
+  num_indices = TTF_GET_USHORT(data + 4);
+
+  if (inner >= num_items || num_words > num_indices)
+    return (0.0f);
+
+  row_size = num_words * word_size + (num_indices - num_words) * word_size / 2;
+
+  if ((offset + 6 + 2 * (size_t)num_indices + (size_t)num_items * row_size) > length)
+    return (0.0f);
+
+  row = data + 6 + 2 * num_indices + inner * row_size;
+
+  for (i = 0; i < num_indices; i ++)
+  {
+    if (i < num_words)
+    {
+      value = word_size == 4 ? (int)TTF_GET_ULONG(row) : (short)TTF_GET_USHORT(row);
+      row   += word_size;
+    }
+    else if (word_size == 4)
+    {
+      value = (short)TTF_GET_USHORT(row);
+      row   += 2;
+    }
+    else
+    {
+      value = (signed char)*row++;
+    }
+
+    if ((region = TTF_GET_USHORT(data + 6 + 2 * i)) < num_regions)
+      delta += scalars[region] * value;
+  }
+
+  return (delta);
+}
+
+
+//
+// 'get_mapping()' - Get the outer and inner indices from a delta set index map.
+//
+// Without a map the outer index is 0 and the inner index is the item number.
+//
+
+static void
+get_mapping(const unsigned char *map,	// I - Delta set index map or `NULL`
+            size_t              length,	// I - Length of map
+            unsigned            n,	// I - Item number
+            unsigned            *outer,	// O - Outer (data) index
+            unsigned            *inner)	// O - Inner (row) index
+{
+  unsigned	format,			// Map format
+		entry_format,		// Entry format
+		entry_size,		// Size of each entry
+		inner_bits,		// Number of inner index bits
+		count,			// Number of entries
+		entry,			// Entry value
+		i;			// Looping var
+  size_t	offset;			// Offset of entries
+
+
+  *outer = 0;
+  *inner = n;
+
+  if (!map || length < 4)
+    return;
+
+  format       = map[0];
+  entry_format = map[1];
+  entry_size   = ((entry_format >> 4) & 3) + 1;
+  inner_bits   = (entry_format & 15) + 1;
+
+  if (format == 0)
+  {
+    count  = TTF_GET_USHORT(map + 2);
+    offset = 4;
+  }
+  else if (format == 1 && length >= 6)
+  {
+    count  = TTF_GET_ULONG(map + 2);
+    offset = 6;
+  }
+  else
+  {
+    return;
+  }
+
+  if (count == 0)
+    return;
+
+  if (n >= count)
+    n = count - 1;			// Last entry is used for the rest
+
+  if ((offset += (size_t)n * entry_size) > (length - entry_size))
+    return;
+
+  for (i = 0, entry = 0; i < entry_size; i ++)
+    entry = (entry << 8) | map[offset + i];
+
+  *outer = entry >> inner_bits;
+  *inner = entry & ((1U << inner_bits) - 1);
+}
+
+
+//
+// 'get_scalars()' - Compute the region scalars of an item variation store.
+//
+
+static float *				// O - Region scalars or `NULL` on error
+get_scalars(const unsigned char *store,	// I - Item variation store
+            size_t              length,	// I - Length of store
+            const short         *ncoords,
+					// I - Normalized coordinates
+            size_t              num_ncoords,
+					// I - Number of coordinates
+            unsigned            *num_regions)
+					// O - Number of regions
+{
+  const unsigned char	*list,		// Region list
+			*region;	// Current region
+  size_t		offset;		// Offset of region list
+  unsigned		num_axes,	// Number of axes in regions
+			i,		// Looping var
+			j;		// Looping var
+  float			*scalars;	// Region scalars
+
+
+  *num_regions = 0;
+
+  if (length < 8 || TTF_GET_USHORT(store) != 1 || (offset = TTF_GET_ULONG(store + 2)) > (length - 4))
+    return (NULL);
+
+  // VariationRegionList: axisCount, regionCount, variationRegions[]
+  list     = store + offset;
+  num_axes = TTF_GET_USHORT(list);
+
+  if ((*num_regions = TTF_GET_USHORT(list + 2)) == 0 || (offset + 4 + 6 * (size_t)num_axes * *num_regions) > length || (scalars = calloc(*num_regions, sizeof(float))) == NULL)
+  {
+    *num_regions = 0;
+    return (NULL);
+  }
+
+  for (i = 0, region = list + 4; i < *num_regions; i ++)
+  {
+    scalars[i] = 1.0f;
+
+    // Each region has start, peak, and end coordinates for each axis...
+    for (j = 0; j < num_axes; j ++, region += 6)
+    {
+      int	start = (short)TTF_GET_USHORT(region),
+					// Start coordinate
+		peak = (short)TTF_GET_USHORT(region + 2),
+					// Peak coordinate
+		end = (short)TTF_GET_USHORT(region + 4),
+					// End coordinate
+		coord = j < num_ncoords ? ncoords[j] : 0;
+					// Instance coordinate
+
+      if (start > peak || peak > end || (start < 0 && end > 0) || peak == 0 || coord == peak)
+        continue;			// Axis does not participate
+
+      if (coord <= start || coord >= end)
+        scalars[i] = 0.0f;
+      else if (coord < peak)
+        scalars[i] *= (float)(coord - start) / (float)(peak - start);
+      else
+        scalars[i] *= (float)(end - coord) / (float)(end - peak);
+    }
+  }
+
+  return (scalars);
+}
+
+
+//
+// 'load_fvar()' - Load the variation axes and named instances of a font.
+//
+// The caller holds the font lock.
+//
+
+static bool				// O - `true` if the font has variation axes, `false` otherwise
+load_fvar(ttf_t *font)			// I - Font
+{
+  const unsigned char	*fvar,		// Font variations table
+			*axis,		// Current axis record
+			*record;	// Current instance record
+  size_t		length;		// Length of table
+  unsigned		axes_offset,	// Offset of axes
+			num_axes,	// Number of axes
+			axis_size,	// Size of axis records
+			num_instances,	// Number of instances
+			instance_size,	// Size of instance records
+			i,		// Looping var
+			j;		// Looping var
+
+
+  if (font->var_loaded)
+    return (font->num_axes > 0);
+
+  font->var_loaded = true;
+
+  // fvar header: majorVersion, minorVersion, axesArrayOffset, reserved,
+  // axisCount, axisSize, instanceCount, instanceSize
+  if ((fvar = _ttfGetTable(font, TTF_OFF_fvar, &length)) == NULL || length < 16)
+    return (false);
+
+  axes_offset   = TTF_GET_USHORT(fvar + 4);
+  num_axes      = TTF_GET_USHORT(fvar + 8);
+  axis_size     = TTF_GET_USHORT(fvar + 10);
+  num_instances = TTF_GET_USHORT(fvar + 12);
+  instance_size = TTF_GET_USHORT(fvar + 14);
+
+  if (TTF_GET_USHORT(fvar) != 1 || num_axes == 0 || num_axes > TTF_VAR_MAX_AXES || axis_size < 20 || instance_size < (4 + 4 * num_axes) || (axes_offset + (size_t)num_axes * axis_size + (size_t)num_instances * instance_size) > length)
+  {
+    _ttfError(font, "Invalid fvar table.");
+    return (false);
+  }
+
+  if ((font->axes = calloc(num_axes, sizeof(ttf_axis_t))) == NULL)
+  {
+    _ttfError(font, "Unable to allocate memory for variation axes.");
+    return (false);
+  }
+
+  // VariationAxisRecord: axisTag, minValue, defaultValue, maxValue, flags,
+  // axisNameID
+  for (i = 0, axis = fvar + axes_offset; i < num_axes; i ++, axis += axis_size)
+  {
+    memcpy(font->axes[i].tag, axis, 4);
+    font->axes[i].min_value     = (int)TTF_GET_ULONG(axis + 4) / 65536.0f;
+    font->axes[i].default_value = (int)TTF_GET_ULONG(axis + 8) / 65536.0f;
+    font->axes[i].max_value     = (int)TTF_GET_ULONG(axis + 12) / 65536.0f;
+
+    TTF_DEBUG("load_fvar: axes[%u]=\"%s\" %g/%g/%g\n", i, font->axes[i].tag, font->axes[i].min_value, font->axes[i].default_value, font->axes[i].max_value);
+  }
+
+  font->num_axes = num_axes;
+
+  if (num_instances == 0 || (font->instances = calloc(num_instances, sizeof(_ttf_instance_t))) == NULL)
+    return (true);
+
+  // InstanceRecord: subfamilyNameID, flags, coordinates[axisCount]
+  for (i = 0, record = axis; i < num_instances; i ++, record += instance_size)
+  {
+    _ttf_instance_t	*instance = font->instances + font->num_instances;
+					// Current instance
+
+    if ((instance->coords = calloc(num_axes, sizeof(float))) == NULL)
+      break;
+
+    for (j = 0; j < num_axes; j ++)
+      instance->coords[j] = (int)TTF_GET_ULONG(record + 4 + 4 * j) / 65536.0f;
+
+    instance->name = _ttfCopyName(font, TTF_GET_USHORT(record));
+
+    TTF_DEBUG("load_fvar: instances[%u]=\"%s\"\n", i, instance->name);
+
+    font->num_instances ++;
+  }
+
+  return (true);
+}
+
+
+//
+// 'normalize_coords()' - Normalize user-space coordinates.
+//
+// The user-space coordinates are clamped to the axis limits and the normalized
+// coordinates are mapped through the "avar" table, if present.
+//
+
+static void
+normalize_coords(ttf_t *font,		// I - Font
+                 float *coords,		// IO - User-space coordinates
+                 short *ncoords)	// O - Normalized coordinates (F2Dot14)
+{
+  size_t		i;		// Looping var
+  const ttf_axis_t	*axis;		// Current axis
+  const unsigned char	*avar,		// Axis variations table
+			*segment;	// Current segment map
+  size_t		length;		// Length of table
+  float			n;		// Normalized coordinate
+
+
+  for (i = 0, axis = font->axes; i < font->num_axes; i ++, axis ++)
+  {
+    if (coords[i] < axis->min_value)
+      coords[i] = axis->min_value;
+    else if (coords[i] > axis->max_value)
+      coords[i] = axis->max_value;
+
+    if (coords[i] < axis->default_value)
+      n = (coords[i] - axis->default_value) / (axis->default_value - axis->min_value);
+    else if (coords[i] > axis->default_value)
+      n = (coords[i] - axis->default_value) / (axis->max_value - axis->default_value);
+    else
+      n = 0.0f;
+
+    ncoords[i] = (short)lrintf(n * 16384.0f);
+  }
+
+  // avar header: majorVersion, minorVersion, reserved, axisCount, then a
+  // segment map for each axis...
+  if ((avar = _ttfGetTable(font, TTF_OFF_avar, &length)) == NULL || length < 8 || TTF_GET_USHORT(avar) != 1 || TTF_GET_USHORT(avar + 6) != font->num_axes)
+    return;
+
+  for (i = 0, segment = avar + 8; i < font->num_axes; i ++)
+  {
+    unsigned	j,			// Looping var
+		count;			// Number of position maps
+    int		from0, to0,		// Previous position map
+		from1, to1;		// Current position map
+
+    if ((size_t)(segment - avar) > (length - 2))
+      break;
+
+    count = TTF_GET_USHORT(segment);
+
+    if ((size_t)(segment - avar) + 2 + 4 * (size_t)count > length)
+      break;
+
+    for (j = 1; j < count; j ++)
+    {
+      from0 = (short)TTF_GET_USHORT(segment + 4 * j - 2);
+      to0   = (short)TTF_GET_USHORT(segment + 4 * j);
+      from1 = (short)TTF_GET_USHORT(segment + 4 * j + 2);
+      to1   = (short)TTF_GET_USHORT(segment + 4 * j + 4);
+
+      if (ncoords[i] < from0)
+        break;
+
+      if (ncoords[i] <= from1)
+      {
+        if (from1 == from0)
+          ncoords[i] = (short)to1;
+        else
+          ncoords[i] = (short)(to0 + (ncoords[i] - from0) * (to1 - to0) / (from1 - from0));
+        break;
+      }
+    }
+
+    segment += 2 + 4 * count;
+  }
+}
+
+
+//
+// 'read_hvar()' - Apply the advance width variations of an instance.
+//
+// The glyph metrics are expanded to cover every glyph and the character
+// metrics are rebuilt from the varied glyph metrics.
+//
+
+static void
+read_hvar(ttf_t       *font,		// I - Instance font
+          const short *ncoords,		// I - Normalized coordinates
+          size_t      num_ncoords)	// I - Number of coordinates
+{
+  const unsigned char	*hvar,		// Horizontal metrics variations table
+			*store,		// Item variation store
+			*map = NULL;	// Advance width mapping
+  size_t		length,		// Length of table
+			store_length,	// Length of item variation store
+			map_length = 0,	// Length of advance width mapping
+			offset,		// Offset in table
+			i;		// Looping var
+  unsigned		num_regions,	// Number of regions
+			outer,		// Outer (data) index
+			inner;		// Inner (row) index
+  int			glyph;		// Glyph index
+  float			*scalars;	// Region scalars
+  _ttf_metric_t		*widths;	// Varied glyph metrics
+
+
+  // HVAR header: majorVersion, minorVersion, itemVariationStoreOffset,
+  // advanceWidthMappingOffset, lsbMappingOffset, rsbMappingOffset
+  if ((hvar = _ttfGetTable(font, TTF_OFF_HVAR, &length)) == NULL || length < 20 || TTF_GET_USHORT(hvar) != 1 || font->num_glyphs == 0)
+    return;
+
+  if ((offset = TTF_GET_ULONG(hvar + 4)) == 0 || offset >= length)
+    return;
+
+  store        = hvar + offset;
+  store_length = length - offset;
+
+  if ((offset = TTF_GET_ULONG(hvar + 8)) != 0 && offset < length)
+  {
+    map        = hvar + offset;
+    map_length = length - offset;
+  }
+
+  if ((scalars = get_scalars(store, store_length, ncoords, num_ncoords, &num_regions)) == NULL)
+    return;
+
+  if ((widths = calloc(font->num_glyphs, sizeof(_ttf_metric_t))) == NULL)
+  {
+    free(scalars);
+    return;
+  }
+
+  for (i = 0; i < font->num_glyphs; i ++)
+  {
+    widths[i] = i < font->num_glyph_widths ? font->glyph_widths[i] : font->def_width;
+
+    get_mapping(map, map_length, (unsigned)i, &outer, &inner);
+    widths[i].width = (short)lrintf(widths[i].width + get_delta(store, store_length, scalars, num_regions, outer, inner));
+  }
+
+  free(scalars);
+  free(font->glyph_widths);
+
+  font->glyph_widths     = widths;
+  font->num_glyph_widths = font->num_glyphs;
+
+  // Rebuild the character metrics...
+  for (i = 0; i < font->num_cmap; i ++)
+  {
+    if ((glyph = font->cmap[i]) >= 0 && font->widths[i / 256])
+      font->widths[i / 256][i & 255] = (size_t)glyph < font->num_glyphs ? widths[glyph] : font->def_width;
+  }
+
+  if (font->fixed_width)
+  {
+    // Check that printable ASCII still has the same width...
+    for (i = ' '; i < 0x7f; i ++)
+    {
+      if (font->widths[0][i].width != font->widths[0][' '].width)
+        break;
+    }
+
+    font->fixed_width = i == 0x7f ? font->widths[0][' '].width : 0;
+  }
+}
+
+
+//
+// 'read_mvar()' - Apply the font-wide metrics variations of an instance.
+//
+
+static void
+read_mvar(ttf_t       *font,		// I - Instance font
+          const short *ncoords,		// I - Normalized coordinates
+          size_t      num_ncoords)	// I - Number of coordinates
+{
+  const unsigned char	*mvar,		// Metrics variations table
+			*store,		// Item variation store
+			*record;	// Current value record
+  size_t		length,		// Length of table
+			offset;		// Offset of item variation store
+  unsigned		record_size,	// Size of value records
+			num_records,	// Number of value records
+			num_regions,	// Number of regions
+			i;		// Looping var
+  float			*scalars;	// Region scalars
+  short			delta;		// Delta value
+
+
+  // MVAR header: majorVersion, minorVersion, reserved, valueRecordSize,
+  // valueRecordCount, itemVariationStoreOffset, valueRecords[]
+  if ((mvar = _ttfGetTable(font, TTF_OFF_MVAR, &length)) == NULL || length < 12 || TTF_GET_USHORT(mvar) != 1)
+    return;
+
+  record_size = TTF_GET_USHORT(mvar + 6);
+  num_records = TTF_GET_USHORT(mvar + 8);
+
+  if ((offset = TTF_GET_USHORT(mvar + 10)) == 0 || offset >= length || record_size < 8 || (12 + (size_t)num_records * record_size) > length)
+    return;
+
+  store = mvar + offset;
+
+  if ((scalars = get_scalars(store, length - offset, ncoords, num_ncoords, &num_regions)) == NULL)
+    return;
+
+  for (i = 0, record = mvar + 12; i < num_records; i ++, record += record_size)
+  {
+    delta = (short)lrintf(get_delta(store, length - offset, scalars, num_regions, TTF_GET_USHORT(record + 4), TTF_GET_USHORT(record + 6)));
+
+    switch (TTF_GET_ULONG(record))
+    {
+      case TTF_MVAR_cpht :
+          font->cap_height += delta;
+          break;
+
+      case TTF_MVAR_hasc :
+          font->ascent      += delta;
+          font->typo_ascent += delta;
+          break;
+
+      case TTF_MVAR_hdsc :
+          font->descent      += delta;
+          font->typo_descent += delta;
+          break;
+
+      case TTF_MVAR_hlgp :
+          font->line_gap      += delta;
+          font->typo_line_gap += delta;
+          break;
+
+      case TTF_MVAR_xhgt :
+          font->x_height += delta;
+          break;
+    }
+  }
+
+  free(scalars);
+}
@@ -3,7 +3,7 @@
 //
 // https://www.msweet.org/ttf
 //
-// Copyright © 2018-2025 by Michael R Sweet.
+// Copyright © 2018-2026 by Michael R Sweet.
 //
 // Licensed under Apache License v2.0.  See the file "LICENSE" for more
 // information.
@@ -25,12 +25,79 @@ extern "C" {
 
 typedef struct _ttf_s ttf_t;	// Font object
 
+typedef struct ttf_axis_s	// Variation axis
+{
+  char		tag[5];			// Axis tag ("wght", "wdth", etc.)
+  float		min_value;		// Minimum value
+  float		default_value;		// Default value
+  float		max_value;		// Maximum value
+} ttf_axis_t;
+
 typedef struct _ttf_cache_s ttf_cache_t;
 				// Font cache
 
+typedef struct _ttf_coverage_s ttf_coverage_t;
+				// Character coverage
+
 typedef void (*ttf_err_cb_t)(void *data, const char *message);
 				// Font error callback
 
+typedef struct ttf_font_run_s	// Run of text using one font from a font stack
+{
+  size_t	start;			// Offset of first byte in run
+  size_t	end;			// Offset after last byte in run
+  size_t	font_index;		// Index of font in stack or number of fonts for ".notdef"
+  ttf_t		*font;			// Font or `NULL` for ".notdef"
+} ttf_font_run_t;
+
+typedef struct ttf_glyph_range_s	// Range of glyphs
+{
+  int		first;			// First glyph
+  int		last;			// Last glyph
+  int		value;			// Value for first glyph
+} ttf_glyph_range_t;
+
+typedef struct ttf_line_s	// Line of text
+{
+  size_t	start;			// Offset of first byte in line
+  size_t	end;			// Offset after last byte in line
+  float		width;			// Width of line
+} ttf_line_t;
+
+typedef enum ttf_path_op_e	// Glyph outline path operation
+{
+  TTF_PATH_MOVE,		// Start a contour at (x,y)
+  TTF_PATH_LINE,		// Line to (x,y)
+  TTF_PATH_QUAD,		// Quadratic curve to (x,y) via (x1,y1)
+  TTF_PATH_CUBIC,		// Cubic curve to (x,y) via (x1,y1) and (x2,y2)
+  TTF_PATH_CLOSE		// Close the contour
+} ttf_path_op_t;
+
+typedef struct ttf_path_s	// Glyph outline path segment
+{
+  ttf_path_op_t	op;			// Operation
+  float		x1, y1;			// First control point
+  float		x2, y2;			// Second control point
+  float		x, y;			// End point
+} ttf_path_t;
+
+typedef void (*ttf_path_cb_t)(void *data, const ttf_path_t *segment);
+				// Glyph outline callback
+
+typedef struct _ttf_measure_s ttf_measure_t;
+				// Streaming text measurement
+
+typedef struct _ttf_text_s ttf_text_t;
+				// Prepared text
+
+typedef struct ttf_run_s	// Run of styled text
+{
+  ttf_t		*font;			// Font
+  float		size;			// Font size
+  const char	*s;			// UTF-8 string
+  size_t	len;			// Length of string or 0 if nul-terminated
+} ttf_run_t;
+
 typedef enum ttf_stretch_e	// Font stretch
 {
   TTF_STRETCH_UNSPEC = -1,	// Unspecified
@@ -67,6 +134,12 @@ typedef enum ttf_weight_e	// Font weight
   TTF_WEIGHT_900 = 900		// Weight 900 (Black/Heavy)
 } ttf_weight_t;
 
+typedef enum ttf_wrap_e		// Line breaking algorithm
+{
+  TTF_WRAP_GREEDY,		// Fill each line as much as possible
+  TTF_WRAP_OPTIMAL		// Minimize raggedness of the whole paragraph
+} ttf_wrap_t;
+
 typedef struct ttf_rect_s	// Bounding rectangle
 {
   float	left;			// Left offset
@@ -80,13 +153,19 @@ typedef struct ttf_rect_s	// Bounding rectangle
 // Functions...
 //
 
+extern size_t		ttfBreakLines(ttf_t *font, float size, const char *s, float line_width, ttf_wrap_t wrap, size_t max_lines, ttf_line_t *lines);
 extern void		ttfCacheAdd(ttf_cache_t *cache, ttf_t *font, const char *filename);
 extern ttf_cache_t      *ttfCacheCreate(const char *appname, ttf_err_cb_t err_cb, void *err_data);
 extern void             ttfCacheDelete(ttf_cache_t *cache);
 extern ttf_t            *ttfCacheFind(ttf_cache_t *cache, const char *family, ttf_style_t style, ttf_weight_t weight, ttf_stretch_t stretch);
+extern ttf_t		*ttfCacheFindChar(ttf_cache_t *cache, int ch, ttf_style_t style, ttf_weight_t weight, ttf_stretch_t stretch);
+extern size_t		ttfCacheFindFonts(ttf_cache_t *cache, const char * const *families, size_t num_families, ttf_style_t style, ttf_weight_t weight, ttf_stretch_t stretch, ttf_t **fonts);
+extern size_t		ttfCacheGetCharFonts(ttf_cache_t *cache, int ch, size_t max_fonts, size_t *fonts);
+extern const ttf_coverage_t *ttfCacheGetCoverage(ttf_cache_t *cache, size_t n);
 extern const char       *ttfCacheGetFilename(ttf_cache_t *cache, size_t n);
 extern const char       *ttfCacheGetFamily(ttf_cache_t *cache, size_t n);
 extern size_t		ttfCacheGetIndex(ttf_cache_t *cache, size_t n);
+extern size_t		ttfCacheGetInstance(ttf_cache_t *cache, size_t n);
 extern ttf_stretch_t    ttfCacheGetStretch(ttf_cache_t *cache, size_t n);
 extern ttf_style_t      ttfCacheGetStyle(ttf_cache_t *cache, size_t n);
 extern ttf_weight_t     ttfCacheGetWeight(ttf_cache_t *cache, size_t n);
@@ -94,35 +173,96 @@ extern ttf_t            *ttfCacheGetFont(ttf_cache_t *cache, size_t n);
 extern size_t           ttfCacheGetNumFonts(ttf_cache_t *cache);
 extern bool		ttfContainsChar(ttf_t *font, int ch);
 extern bool		ttfContainsChars(ttf_t *font, const char *s);
+extern bool		ttfCoverageContainsChar(const ttf_coverage_t *coverage, int ch);
+extern ttf_coverage_t	*ttfCoverageCopy(const ttf_coverage_t *coverage);
+extern void		ttfCoverageDelete(ttf_coverage_t *coverage);
+extern size_t		ttfCoverageFindMissing(const ttf_coverage_t *coverage, const char *s, size_t len);
+extern size_t		ttfCoverageGetCount(const ttf_coverage_t *coverage);
+extern bool		ttfCoverageIntersect(ttf_coverage_t *coverage, const ttf_coverage_t *other);
+extern bool		ttfCoverageUnion(ttf_coverage_t *coverage, const ttf_coverage_t *other);
 extern ttf_t		*ttfCreate(const char *filename, size_t idx, ttf_err_cb_t err_cb, void *err_data);
 extern ttf_t		*ttfCreateData(const void *data, size_t data_size, size_t idx, ttf_err_cb_t err_cb, void *err_data);
 
 extern void		ttfDelete(ttf_t *font);
+extern size_t		ttfFindCaret(const float *carets, size_t num_carets, float x);
 
 extern int		ttfGetAscent(ttf_t *font);
+extern size_t		ttfGetBlockExtents(ttf_t *font, float size, const char *s, float tab_width, bool kerned, ttf_rect_t *extents, size_t max_lines, ttf_line_t *lines);
+extern const ttf_axis_t	*ttfGetAxes(ttf_t *font, size_t *num_axes);
 extern ttf_rect_t	*ttfGetBounds(ttf_t *font, ttf_rect_t *bounds);
+extern size_t		ttfGetCaretPositions(ttf_t *font, float size, const char *s, size_t max_carets, float *carets, size_t *offsets);
+extern size_t		ttfGetCellCount(const char *s);
+extern ttf_rect_t	*ttfGetCellExtents(ttf_t *font, float size, const char *s, ttf_rect_t *extents);
 extern const int	*ttfGetCMap(ttf_t *font, size_t *num_cmap);
 extern int		ttfGetCapHeight(ttf_t *font);
 extern const char	*ttfGetCopyright(ttf_t *font);
+extern const ttf_coverage_t *ttfGetCoverage(ttf_t *font);
 extern int		ttfGetDescent(ttf_t *font);
 extern ttf_rect_t	*ttfGetExtents(ttf_t *font, float size, const char *s, ttf_rect_t *extents);
+extern void		ttfGetExtentsCacheStats(ttf_t *font, size_t *hits, size_t *misses);
 extern const char	*ttfGetFamily(ttf_t *font);
 extern const char       *ttfGetFilename(ttf_t *ttf);
+extern size_t		ttfGetFontRuns(ttf_t **fonts, size_t num_fonts, const char *s, size_t len, size_t max_runs, ttf_font_run_t *runs);
+extern int		ttfGetGlyphAdvance(ttf_t *font, int glyph);
+extern ttf_rect_t	*ttfGetGlyphBounds(ttf_t *font, int glyph, ttf_rect_t *bounds);
+extern int		ttfGetGlyphKerning(ttf_t *font, int left, int right);
+extern int		ttfGetGlyphLeftBearing(ttf_t *font, int glyph);
+extern bool		ttfGetGlyphOutline(ttf_t *font, int glyph, ttf_path_cb_t cb, void *cbdata);
+extern size_t		ttfGetGlyphPath(ttf_t *font, int glyph, ttf_path_t *path, size_t max_path);
+extern size_t		ttfGetGlyphs(ttf_t *font, const char *s, size_t len, int *glyphs, size_t max_glyphs);
+extern size_t		ttfGetGlyphsUTF32(ttf_t *font, const int *chars, size_t num_chars, int *glyphs);
+extern int		ttfGetGlyphVerticalAdvance(ttf_t *font, int glyph);
+extern int		ttfGetGlyphVerticalOrigin(ttf_t *font, int glyph);
+extern ttf_rect_t	*ttfGetInkExtents(ttf_t *font, float size, const char *s, ttf_rect_t *extents);
+extern ttf_t		*ttfGetInstance(ttf_t *font, size_t n);
+extern const char	*ttfGetInstanceName(ttf_t *font, size_t n);
 extern float		ttfGetItalicAngle(ttf_t *font);
 extern size_t		ttfGetKernedExtents(ttf_t *font, float size, const char *s, ttf_rect_t *extents, size_t max_adjs, double *adjs);
+extern int		ttfGetLineGap(ttf_t *font);
+extern int		ttfGetLineHeight(ttf_t *font);
 extern int		ttfGetMaxChar(ttf_t *font);
 extern int		ttfGetMinChar(ttf_t *font);
 extern size_t		ttfGetNumFonts(ttf_t *font);
+extern size_t		ttfGetNumInstances(ttf_t *font);
+extern ttf_rect_t	*ttfGetPixelExtents(ttf_t *font, int ppem, const char *s, ttf_rect_t *extents);
 extern const char	*ttfGetPostScriptName(ttf_t *font);
+extern ttf_rect_t	*ttfGetRunExtents(const ttf_run_t *runs, size_t num_runs, bool kerned, float *advances, ttf_rect_t *extents);
 extern ttf_stretch_t	ttfGetStretch(ttf_t *font);
 extern ttf_style_t	ttfGetStyle(ttf_t *font);
+extern int		ttfGetTypoAscent(ttf_t *font);
+extern int		ttfGetTypoDescent(ttf_t *font);
+extern int		ttfGetTypoLineGap(ttf_t *font);
+extern const int	*ttfGetUnicodeMap(ttf_t *font, size_t *num_glyphs);
+extern size_t		ttfGetUnicodeRanges(ttf_t *font, const int *glyphs, size_t num_glyphs, ttf_glyph_range_t *ranges, size_t max_ranges);
+extern ttf_t		*ttfGetVariation(ttf_t *font, const float *coords, size_t num_coords);
 extern const char	*ttfGetVersion(ttf_t *font);
+extern ttf_rect_t	*ttfGetVerticalExtents(ttf_t *font, float size, const char *s, ttf_rect_t *extents);
 extern int		ttfGetWidth(ttf_t *font, int ch);
 extern ttf_weight_t	ttfGetWeight(ttf_t *font);
+extern size_t		ttfGetWidthRanges(ttf_t *font, const int *glyphs, size_t num_glyphs, ttf_glyph_range_t *ranges, size_t max_ranges);
 extern int		ttfGetXHeight(ttf_t *font);
 
 extern bool		ttfIsFixedPitch(ttf_t *font);
 
+extern bool		ttfMeasureAdd(ttf_measure_t *measure, const char *s, size_t len);
+extern ttf_measure_t	*ttfMeasureCreate(ttf_t *font, float size, bool kerned);
+extern void		ttfMeasureDelete(ttf_measure_t *measure);
+extern ttf_rect_t	*ttfMeasureGetExtents(ttf_measure_t *measure, ttf_rect_t *extents);
+extern void		ttfMeasureReset(ttf_measure_t *measure);
+
+extern bool		ttfRenderGlyph(ttf_t *font, float size, int glyph, unsigned char *pixels, int width, int height, int stride, float x, float y);
+extern bool		ttfRenderString(ttf_t *font, float size, const char *s, unsigned char *pixels, int width, int height, int stride, float x, float y);
+
+extern bool		ttfSetExtentsCache(ttf_t *font, size_t num_entries);
+extern bool		ttfSetLigatures(ttf_t *font, bool enable);
+extern size_t		ttfSubset(ttf_t *font, const int *glyphs, size_t num_glyphs, void *buffer, size_t bufsize);
+
+extern ttf_text_t	*ttfTextCreate(const char *s);
+extern void		ttfTextDelete(ttf_text_t *text);
+extern ttf_rect_t	*ttfTextGetExtents(ttf_text_t *text, ttf_t *font, float size, bool kerned, ttf_rect_t *extents);
+extern float		ttfTextGetFitSize(ttf_text_t *text, ttf_t *font, bool kerned, float width, float height);
+extern const int	*ttfTextGetGlyphs(ttf_text_t *text, ttf_t *font, size_t *num_glyphs);
+
 
 #  ifdef __cplusplus
 }